@@ -0,0 +1,766 @@
+#include "Canonicalizer.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <numeric>
+#include <set>
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+namespace {
+
+constexpr size_t kBatchGrainSize = 256;
+constexpr size_t kMaxAromaticRingSize = 7;
+constexpr uint32_t kNone = UINT32_MAX;
+
+uint64_t mix64(uint64_t value) {
+    // splitmix64 终结函数
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+    return value;
+}
+
+bool isOrganicSubset(int atomicNumber) {
+    switch (atomicNumber) {
+        case 5: case 6: case 7: case 8: case 9:
+        case 15: case 16: case 17: case 35: case 53:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool hasAromaticSymbol(int atomicNumber) {
+    switch (atomicNumber) {
+        case 5: case 6: case 7: case 8: case 15: case 16: case 33: case 34:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 规范化用的精简分子表示
+ * 
+ * 氢原子折叠进所连重原子的氢计数，芳香性与键级在此副本上修改，不影响输入分子图。
+ */
+struct WorkAtom {
+    int element = 0;
+    int charge = 0;
+    int isotope = 0;
+    int hydrogens = 0;
+    bool aromatic = false;
+    uint32_t source = 0;    // 输入分子图中的原子序号
+};
+
+struct WorkBond {
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint8_t order = 1;
+    bool inRing = false;
+    uint32_t source = 0;    // 输入分子图中的键序号
+};
+
+class CanonicalBuilder {
+public:
+    explicit CanonicalBuilder(const MolecularGraph& graph) {
+        load(graph);
+        buildAdjacency();
+        perceiveAromaticity();
+    }
+    
+    std::string build() {
+        if (m_atoms.empty()) return std::string();
+        
+        computeCanonicalRanks();
+        return writeSmiles();
+    }
+    
+    /**
+     * @brief 把感知到的芳香原子和芳香键写回输入分子图
+     */
+    void applyAromaticity(MolecularGraph& graph) const {
+        for (const WorkAtom& work : m_atoms) {
+            if (work.aromatic) graph.atoms[work.source].aromatic = true;
+        }
+        for (const WorkBond& work : m_bonds) {
+            if (work.order == AromaticBondOrder) graph.bonds[work.source].order = AromaticBondOrder;
+        }
+    }
+
+private:
+    // ---------- 构建 ----------
+    void load(const MolecularGraph& graph) {
+        size_t count = graph.atoms.size();
+        std::vector<uint32_t> mapping(count, kNone);
+        std::vector<uint32_t> foldedInto(count, kNone);
+        
+        for (uint32_t i = 0; i < count; ++i) {
+            const Atom& atom = graph.atoms[i];
+            
+            // 普通的单连接氢原子折叠到所连重原子上
+            if (atom.atomicNumber == 1 && atom.charge == 0 && atom.isotope == 0 && graph.degree(i) == 1) {
+                uint32_t neighbor = graph.otherAtom(*graph.neighborBondsBegin(i), i);
+                if (graph.atoms[neighbor].atomicNumber != 1) {
+                    foldedInto[i] = neighbor;
+                    continue;
+                }
+            }
+            
+            mapping[i] = static_cast<uint32_t>(m_atoms.size());
+            WorkAtom work;
+            work.element = atom.atomicNumber;
+            work.charge = atom.charge;
+            work.isotope = atom.isotope;
+            work.hydrogens = atom.implicitHydrogens + atom.explicitHydrogens;
+            work.aromatic = atom.aromatic;
+            work.source = i;
+            m_atoms.push_back(work);
+        }
+        
+        for (uint32_t i = 0; i < count; ++i) {
+            if (foldedInto[i] != kNone && mapping[foldedInto[i]] != kNone) {
+                ++m_atoms[mapping[foldedInto[i]]].hydrogens;
+            }
+        }
+        
+        for (uint32_t i = 0; i < graph.bonds.size(); ++i) {
+            const Bond& bond = graph.bonds[i];
+            uint32_t a = mapping[bond.begin];
+            uint32_t b = mapping[bond.end];
+            if (a == kNone || b == kNone) continue;
+            
+            WorkBond work;
+            work.a = a;
+            work.b = b;
+            work.order = bond.order;
+            work.inRing = bond.inRing;
+            work.source = i;
+            m_bonds.push_back(work);
+        }
+    }
+    
+    void buildAdjacency() {
+        m_offsets.assign(m_atoms.size() + 1, 0);
+        for (const WorkBond& bond : m_bonds) {
+            ++m_offsets[bond.a + 1];
+            ++m_offsets[bond.b + 1];
+        }
+        for (size_t i = 0; i < m_atoms.size(); ++i) {
+            m_offsets[i + 1] += m_offsets[i];
+        }
+        
+        m_adjacency.resize(m_bonds.size() * 2);
+        std::vector<uint32_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+        for (uint32_t b = 0; b < m_bonds.size(); ++b) {
+            m_adjacency[cursor[m_bonds[b].a]++] = b;
+            m_adjacency[cursor[m_bonds[b].b]++] = b;
+        }
+    }
+    
+    uint32_t other(uint32_t bond, uint32_t atom) const {
+        return m_bonds[bond].a == atom ? m_bonds[bond].b : m_bonds[bond].a;
+    }
+    
+    size_t degree(uint32_t atom) const {
+        return m_offsets[atom + 1] - m_offsets[atom];
+    }
+    
+    // ---------- 芳香性感知 ----------
+    /**
+     * @brief 枚举经过每条环键的最短环（仅限可能芳香的小环）
+     */
+    std::vector<std::vector<uint32_t>> findSmallRings() {
+        std::vector<std::vector<uint32_t>> rings;
+        std::set<std::vector<uint32_t>> seen;
+        
+        std::vector<uint32_t> stamp(m_atoms.size(), 0);
+        std::vector<uint32_t> parent(m_atoms.size(), kNone);
+        std::vector<uint32_t> depth(m_atoms.size(), 0);
+        std::vector<uint32_t> queue;
+        uint32_t epoch = 0;
+        
+        for (uint32_t e = 0; e < m_bonds.size(); ++e) {
+            if (!m_bonds[e].inRing) continue;
+            
+            uint32_t source = m_bonds[e].a;
+            uint32_t target = m_bonds[e].b;
+            ++epoch;
+            
+            queue.clear();
+            queue.push_back(source);
+            stamp[source] = epoch;
+            parent[source] = kNone;
+            depth[source] = 0;
+            
+            bool found = false;
+            for (size_t head = 0; head < queue.size() && !found; ++head) {
+                uint32_t atom = queue[head];
+                if (depth[atom] + 1 >= kMaxAromaticRingSize) continue;
+                
+                for (uint32_t k = m_offsets[atom]; k < m_offsets[atom + 1]; ++k) {
+                    uint32_t bond = m_adjacency[k];
+                    if (bond == e || !m_bonds[bond].inRing) continue;
+                    
+                    uint32_t next = other(bond, atom);
+                    if (stamp[next] == epoch) continue;
+                    
+                    stamp[next] = epoch;
+                    parent[next] = atom;
+                    depth[next] = depth[atom] + 1;
+                    if (next == target) {
+                        found = true;
+                        break;
+                    }
+                    queue.push_back(next);
+                }
+            }
+            
+            if (!found) continue;
+            
+            std::vector<uint32_t> ring;
+            for (uint32_t atom = target; atom != kNone; atom = parent[atom]) {
+                ring.push_back(atom);
+            }
+            
+            std::vector<uint32_t> key = ring;
+            std::sort(key.begin(), key.end());
+            if (seen.insert(key).second) {
+                rings.push_back(std::move(ring));
+            }
+        }
+        
+        return rings;
+    }
+    
+    /**
+     * @brief 计算原子为所在环贡献的π电子数（-1表示该原子不可能芳香）
+     */
+    int piElectrons(uint32_t atom) const {
+        const WorkAtom& work = m_atoms[atom];
+        bool ringDouble = false;
+        bool exoDouble = false;
+        bool aromaticBond = false;
+        
+        for (uint32_t k = m_offsets[atom]; k < m_offsets[atom + 1]; ++k) {
+            const WorkBond& bond = m_bonds[m_adjacency[k]];
+            if (bond.order == 3) return -1;
+            if (bond.order == 2) {
+                if (bond.inRing) ringDouble = true;
+                else exoDouble = true;
+            }
+            if (bond.order == AromaticBondOrder) aromaticBond = true;
+        }
+        
+        bool flagged = work.aromatic && aromaticBond;
+        size_t connections = degree(atom) + static_cast<size_t>(work.hydrogens);
+        
+        switch (work.element) {
+            case 6:
+                if (exoDouble) return 0;
+                if (ringDouble || flagged) return 1;
+                if (work.charge < 0) return 2;
+                if (work.charge > 0) return 0;
+                return -1;
+            case 7:
+            case 15:
+                if (ringDouble) return 1;
+                if (flagged) {
+                    return (work.charge == 0 && connections == 3) ? 2 : 1;
+                }
+                if (work.charge == 0 && connections == 3) return 2;
+                return -1;
+            case 8:
+            case 16:
+            case 34:
+                if (ringDouble) return 1;
+                if (work.charge == 0 && degree(atom) == 2) return 2;
+                return -1;
+            case 5:
+                if (ringDouble || flagged) return 1;
+                return 0;
+            default:
+                return -1;
+        }
+    }
+    
+    void perceiveAromaticity() {
+        std::vector<std::vector<uint32_t>> rings = findSmallRings();
+        if (rings.empty()) return;
+        
+        std::vector<bool> done(rings.size(), false);
+        bool changed = true;
+        
+        // 迭代：稠环中先判定的环会影响相邻环的π电子计数
+        while (changed) {
+            changed = false;
+            
+            for (size_t r = 0; r < rings.size(); ++r) {
+                if (done[r]) continue;
+                const std::vector<uint32_t>& ring = rings[r];
+                
+                bool allAromatic = true;
+                int electrons = 0;
+                for (uint32_t atom : ring) {
+                    if (!m_atoms[atom].aromatic) allAromatic = false;
+                    int contribution = piElectrons(atom);
+                    if (contribution < 0) {
+                        electrons = -1;
+                        break;
+                    }
+                    electrons += contribution;
+                }
+                
+                if (allAromatic) {
+                    done[r] = true;
+                    continue;
+                }
+                if (electrons < 0 || electrons % 4 != 2) continue;
+                
+                for (size_t i = 0; i < ring.size(); ++i) {
+                    uint32_t a = ring[i];
+                    uint32_t b = ring[(i + 1) % ring.size()];
+                    m_atoms[a].aromatic = true;
+                    
+                    for (uint32_t k = m_offsets[a]; k < m_offsets[a + 1]; ++k) {
+                        uint32_t bond = m_adjacency[k];
+                        if (other(bond, a) == b) {
+                            m_bonds[bond].order = AromaticBondOrder;
+                        }
+                    }
+                }
+                
+                done[r] = true;
+                changed = true;
+            }
+        }
+    }
+    
+    // ---------- 规范编号 ----------
+    uint64_t atomInvariant(uint32_t atom) const {
+        const WorkAtom& work = m_atoms[atom];
+        bool inRing = false;
+        for (uint32_t k = m_offsets[atom]; k < m_offsets[atom + 1]; ++k) {
+            if (m_bonds[m_adjacency[k]].inRing) inRing = true;
+        }
+        
+        uint64_t invariant = 0;
+        invariant = (invariant << 4) | std::min<uint64_t>(degree(atom), 15);
+        invariant = (invariant << 8) | static_cast<uint64_t>(work.element & 0xFF);
+        invariant = (invariant << 1) | (work.aromatic ? 1 : 0);
+        invariant = (invariant << 6) | static_cast<uint64_t>((work.charge + 32) & 0x3F);
+        invariant = (invariant << 4) | static_cast<uint64_t>(std::min(work.hydrogens, 15));
+        invariant = (invariant << 10) | static_cast<uint64_t>(work.isotope & 0x3FF);
+        invariant = (invariant << 1) | (inRing ? 1 : 0);
+        return invariant;
+    }
+    
+    /**
+     * @brief 按 (当前秩, 排序后的邻居秩与键级) 反复细化，直到等价类数不再增加
+     */
+    size_t refineRanks() {
+        size_t n = m_atoms.size();
+        std::vector<uint64_t> neighborKeys(m_adjacency.size());
+        std::vector<uint32_t> order(n);
+        std::vector<uint32_t> newRanks(n);
+        
+        size_t classCount = countClasses();
+        
+        while (true) {
+            for (uint32_t atom = 0; atom < n; ++atom) {
+                for (uint32_t k = m_offsets[atom]; k < m_offsets[atom + 1]; ++k) {
+                    uint32_t bond = m_adjacency[k];
+                    neighborKeys[k] = (static_cast<uint64_t>(m_ranks[other(bond, atom)]) << 3) | m_bonds[bond].order;
+                }
+                std::sort(neighborKeys.begin() + m_offsets[atom], neighborKeys.begin() + m_offsets[atom + 1]);
+            }
+            
+            auto less = [&](uint32_t x, uint32_t y) {
+                if (m_ranks[x] != m_ranks[y]) return m_ranks[x] < m_ranks[y];
+                return std::lexicographical_compare(
+                    neighborKeys.begin() + m_offsets[x], neighborKeys.begin() + m_offsets[x + 1],
+                    neighborKeys.begin() + m_offsets[y], neighborKeys.begin() + m_offsets[y + 1]);
+            };
+            
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), less);
+            
+            uint32_t rank = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (i > 0 && less(order[i - 1], order[i])) ++rank;
+                newRanks[order[i]] = rank;
+            }
+            
+            size_t newCount = static_cast<size_t>(rank) + 1;
+            m_ranks.swap(newRanks);
+            if (newCount == classCount) break;
+            classCount = newCount;
+        }
+        
+        return classCount;
+    }
+    
+    size_t countClasses() const {
+        std::vector<uint32_t> sorted = m_ranks;
+        std::sort(sorted.begin(), sorted.end());
+        return static_cast<size_t>(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+    }
+    
+    void denseRanks(const std::vector<uint64_t>& keys) {
+        size_t n = keys.size();
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&keys](uint32_t x, uint32_t y) { return keys[x] < keys[y]; });
+        
+        m_ranks.assign(n, 0);
+        uint32_t rank = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0 && keys[order[i - 1]] != keys[order[i]]) ++rank;
+            m_ranks[order[i]] = rank;
+        }
+    }
+    
+    void computeCanonicalRanks() {
+        size_t n = m_atoms.size();
+        std::vector<uint64_t> keys(n);
+        for (uint32_t atom = 0; atom < n; ++atom) {
+            keys[atom] = atomInvariant(atom);
+        }
+        denseRanks(keys);
+        
+        size_t classCount = refineRanks();
+        
+        // 破除对称：在最小的并列类中任选一个原子提前，再继续细化
+        while (classCount < n) {
+            std::vector<uint32_t> counts(n, 0);
+            for (uint32_t rank : m_ranks) ++counts[rank];
+            
+            uint32_t tiedRank = 0;
+            while (counts[tiedRank] < 2) ++tiedRank;
+            
+            bool chosen = false;
+            for (uint32_t atom = 0; atom < n; ++atom) {
+                uint64_t key = static_cast<uint64_t>(m_ranks[atom]) * 2;
+                if (m_ranks[atom] == tiedRank) {
+                    if (chosen) key += 1;
+                    chosen = true;
+                }
+                keys[atom] = key;
+            }
+            denseRanks(keys);
+            classCount = refineRanks();
+        }
+    }
+    
+    // ---------- SMILES 输出 ----------
+    std::string atomSymbol(uint32_t atom) const {
+        const WorkAtom& work = m_atoms[atom];
+        const ElementInfo* element = findElement(work.element);
+        std::string symbol = element ? element->symbol : "*";
+        
+        bool aromatic = work.aromatic && hasAromaticSymbol(work.element);
+        if (aromatic) {
+            symbol[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(symbol[0])));
+        }
+        
+        int bondSum = 0;
+        bool aromaticBond = false;
+        for (uint32_t k = m_offsets[atom]; k < m_offsets[atom + 1]; ++k) {
+            uint8_t order = m_bonds[m_adjacency[k]].order;
+            if (order == AromaticBondOrder) {
+                aromaticBond = true;
+                bondSum += 1;
+            } else {
+                bondSum += order;
+            }
+        }
+        
+        bool bare = work.charge == 0 && work.isotope == 0 &&
+                    (work.element == 0 ? work.hydrogens == 0 :
+                     isOrganicSubset(work.element) &&
+                     (!work.aromatic || aromatic) &&
+                     work.hydrogens == defaultImplicitHydrogens(work.element, 0, work.aromatic && aromaticBond, bondSum));
+        if (bare) {
+            return symbol;
+        }
+        
+        std::string result = "[";
+        if (work.isotope > 0) result += std::to_string(work.isotope);
+        result += symbol;
+        if (work.hydrogens > 0) {
+            result += 'H';
+            if (work.hydrogens > 1) result += std::to_string(work.hydrogens);
+        }
+        if (work.charge != 0) {
+            result += work.charge > 0 ? '+' : '-';
+            if (std::abs(work.charge) > 1) result += std::to_string(std::abs(work.charge));
+        }
+        result += ']';
+        return result;
+    }
+    
+    std::string bondSymbol(uint32_t bond) const {
+        const WorkBond& work = m_bonds[bond];
+        bool bothAromatic = m_atoms[work.a].aromatic && m_atoms[work.b].aromatic;
+        
+        switch (work.order) {
+            case 2: return "=";
+            case 3: return "#";
+            case AromaticBondOrder: return bothAromatic ? "" : ":";
+            default: return bothAromatic ? "-" : "";
+        }
+    }
+    
+    std::string writeSmiles() {
+        size_t n = m_atoms.size();
+        
+        // 邻居按规范秩排序
+        std::vector<uint32_t> sortedAdjacency = m_adjacency;
+        for (uint32_t atom = 0; atom < n; ++atom) {
+            std::sort(sortedAdjacency.begin() + m_offsets[atom], sortedAdjacency.begin() + m_offsets[atom + 1],
+                [&](uint32_t x, uint32_t y) { return m_ranks[other(x, atom)] < m_ranks[other(y, atom)]; });
+        }
+        
+        // 第一遍DFS：确定访问顺序、树边子节点和环闭合键
+        std::vector<uint32_t> visitOrder(n, kNone);
+        std::vector<uint32_t> parentBond(n, kNone);
+        std::vector<std::vector<uint32_t>> children(n);
+        std::vector<std::vector<uint32_t>> closures(n);
+        std::vector<bool> closureSeen(m_bonds.size(), false);
+        
+        std::vector<uint32_t> atomsByRank(n);
+        std::iota(atomsByRank.begin(), atomsByRank.end(), 0);
+        std::sort(atomsByRank.begin(), atomsByRank.end(),
+            [this](uint32_t x, uint32_t y) { return m_ranks[x] < m_ranks[y]; });
+        
+        std::vector<uint32_t> roots;
+        uint32_t counter = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        
+        for (uint32_t root : atomsByRank) {
+            if (visitOrder[root] != kNone) continue;
+            roots.push_back(root);
+            
+            visitOrder[root] = counter++;
+            stack.emplace_back(root, m_offsets[root]);
+            
+            while (!stack.empty()) {
+                uint32_t atom = stack.back().first;
+                uint32_t& cursor = stack.back().second;
+                
+                if (cursor == m_offsets[atom + 1]) {
+                    stack.pop_back();
+                    continue;
+                }
+                
+                uint32_t bond = sortedAdjacency[cursor++];
+                if (bond == parentBond[atom]) continue;
+                
+                uint32_t next = other(bond, atom);
+                if (visitOrder[next] == kNone) {
+                    visitOrder[next] = counter++;
+                    parentBond[next] = bond;
+                    children[atom].push_back(next);
+                    stack.emplace_back(next, m_offsets[next]);
+                } else if (!closureSeen[bond]) {
+                    closureSeen[bond] = true;
+                    closures[atom].push_back(bond);
+                    closures[next].push_back(bond);
+                }
+            }
+        }
+        
+        for (uint32_t atom = 0; atom < n; ++atom) {
+            std::sort(closures[atom].begin(), closures[atom].end(), [&](uint32_t x, uint32_t y) {
+                return visitOrder[other(x, atom)] < visitOrder[other(y, atom)];
+            });
+        }
+        
+        // 第二遍：按访问顺序输出
+        std::vector<std::string> fragments;
+        std::vector<int> bondDigit(m_bonds.size(), 0);
+        std::vector<bool> digitUsed(100, false);
+        std::vector<bool> emitted(n, false);
+        
+        struct Frame {
+            uint32_t atom;
+            size_t nextChild;
+            bool closeBranch;
+        };
+        std::vector<Frame> frames;
+        
+        for (uint32_t root : roots) {
+            std::string text;
+            
+            auto emitAtom = [&](uint32_t atom) {
+                text += atomSymbol(atom);
+                emitted[atom] = true;
+                
+                for (uint32_t bond : closures[atom]) {
+                    int digit = bondDigit[bond];
+                    if (digit == 0) {
+                        digit = 1;
+                        while (digitUsed[digit]) ++digit;
+                        digitUsed[digit] = true;
+                        bondDigit[bond] = digit;
+                        text += bondSymbol(bond);
+                    } else {
+                        digitUsed[digit] = false;
+                    }
+                    if (digit >= 10) text += '%';
+                    text += std::to_string(digit);
+                }
+            };
+            
+            emitAtom(root);
+            frames.push_back({root, 0, false});
+            
+            while (!frames.empty()) {
+                Frame& frame = frames.back();
+                const std::vector<uint32_t>& kids = children[frame.atom];
+                
+                if (frame.nextChild == kids.size()) {
+                    if (frame.closeBranch) text += ')';
+                    frames.pop_back();
+                    continue;
+                }
+                
+                uint32_t child = kids[frame.nextChild++];
+                bool branch = frame.nextChild < kids.size();
+                if (branch) text += '(';
+                text += bondSymbol(parentBond[child]);
+                emitAtom(child);
+                frames.push_back({child, 0, branch});
+            }
+            
+            fragments.push_back(std::move(text));
+        }
+        
+        // 各片段独立规范，按字典序拼接使结果与片段书写顺序无关
+        std::sort(fragments.begin(), fragments.end());
+        std::string result;
+        for (size_t i = 0; i < fragments.size(); ++i) {
+            if (i > 0) result += '.';
+            result += fragments[i];
+        }
+        return result;
+    }
+    
+    std::vector<WorkAtom> m_atoms;
+    std::vector<WorkBond> m_bonds;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_adjacency;
+    std::vector<uint32_t> m_ranks;
+};
+
+} // namespace
+
+// StructureKey 实现
+std::string StructureKey::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        hex[15 - i] = digits[(high >> (i * 4)) & 0xF];
+        hex[31 - i] = digits[(low >> (i * 4)) & 0xF];
+    }
+    return hex;
+}
+
+StructureKey StructureKey::fromHex(const std::string& hex) {
+    StructureKey key;
+    if (hex.size() != 32) return key;
+    
+    for (size_t i = 0; i < 32; ++i) {
+        char c = static_cast<char>(std::tolower(static_cast<unsigned char>(hex[i])));
+        uint64_t value;
+        if (c >= '0' && c <= '9') value = static_cast<uint64_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') value = static_cast<uint64_t>(c - 'a' + 10);
+        else return StructureKey();
+        
+        uint64_t& half = i < 16 ? key.high : key.low;
+        half = (half << 4) | value;
+    }
+    return key;
+}
+
+// Canonicalizer 实现
+std::string Canonicalizer::canonicalSmiles(const MolecularGraph& graph) {
+    CanonicalBuilder builder(graph);
+    return builder.build();
+}
+
+void Canonicalizer::perceiveAromaticity(MolecularGraph& graph) {
+    CanonicalBuilder builder(graph);
+    builder.applyAromaticity(graph);
+}
+
+bool Canonicalizer::canonicalize(const std::string& content, const std::string& format, std::string& smiles) {
+    thread_local MolecularGraph graph;
+    
+    if (!MoleculeParser::parse(content, format, graph)) {
+        smiles.clear();
+        return false;
+    }
+    
+    smiles = canonicalSmiles(graph);
+    return !smiles.empty();
+}
+
+StructureKey Canonicalizer::structureKey(const std::string& canonical) {
+    StructureKey key;
+    if (canonical.empty()) return key;
+    
+    // 两路独立的64位哈希拼成128位键
+    uint64_t fnv = 0xCBF29CE484222325ULL;
+    uint64_t mixed = 0x9E3779B97F4A7C15ULL ^ canonical.size();
+    for (unsigned char c : canonical) {
+        fnv = (fnv ^ c) * 0x100000001B3ULL;
+        mixed = mix64(mixed + c);
+    }
+    
+    key.high = mix64(fnv);
+    key.low = mixed;
+    if (key.isNull()) key.low = 1;
+    return key;
+}
+
+StructureKey Canonicalizer::computeKey(const std::string& content, const std::string& format) {
+    std::string smiles;
+    if (!canonicalize(content, format, smiles)) {
+        return StructureKey();
+    }
+    return structureKey(smiles);
+}
+
+size_t Canonicalizer::computeKeysBatch(const std::vector<Data::DataRecord>& records, StructureKey* keys) {
+    std::atomic<size_t> failed{0};
+    
+    Utils::ThreadPool::instance().parallelFor(0, records.size(), kBatchGrainSize,
+        [&](size_t begin, size_t end) {
+            size_t localFailed = 0;
+            for (size_t i = begin; i < end; ++i) {
+                keys[i] = computeKey(records[i].content, records[i].format);
+                if (keys[i].isNull()) ++localFailed;
+            }
+            failed += localFailed;
+        });
+    
+    return failed.load();
+}
+
+bool Canonicalizer::isStructureFormat(const std::string& format) {
+    std::string upper = format;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return upper == "SMILES" || upper == "SMI" || upper == "MOL" || upper == "SDF";
+}
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
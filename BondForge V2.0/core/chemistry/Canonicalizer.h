@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "MolecularGraph.h"
+#include "../data/DataRecord.h"
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+/**
+ * @brief 定长结构键（规范SMILES的128位哈希）
+ * 
+ * 同一化合物的不同SMILES写法（原子顺序、Kekulé/芳香写法、显式/隐式氢）得到相同的结构键。
+ */
+struct StructureKey {
+    uint64_t high = 0;
+    uint64_t low = 0;
+    
+    /**
+     * @brief 是否为空键（非结构数据或解析失败）
+     */
+    bool isNull() const { return high == 0 && low == 0; }
+    
+    /**
+     * @brief 转换为32位十六进制字符串
+     */
+    std::string toHex() const;
+    
+    /**
+     * @brief 从十六进制字符串解析（格式错误时返回空键）
+     */
+    static StructureKey fromHex(const std::string& hex);
+    
+    bool operator==(const StructureKey& other) const { return high == other.high && low == other.low; }
+    bool operator!=(const StructureKey& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 结构键哈希函数（用于unordered容器）
+ */
+struct StructureKeyHash {
+    size_t operator()(const StructureKey& key) const {
+        return static_cast<size_t>(key.low ^ (key.high * 0x9E3779B97F4A7C15ULL));
+    }
+};
+
+/**
+ * @brief 分子规范化器
+ * 
+ * 先感知芳香性（把Kekulé写法的5/6元芳环统一为芳香形式），再通过迭代邻居不变量细化
+ * 和破除对称来得到规范原子序号，最后按序号深度优先生成规范SMILES。
+ * 当前不处理立体化学，立体异构体得到相同的结构键。
+ */
+class Canonicalizer {
+public:
+    /**
+     * @brief 生成分子图的规范SMILES
+     * 
+     * @param graph 已解析的分子图
+     * @return 规范SMILES（空分子返回空字符串）
+     */
+    static std::string canonicalSmiles(const MolecularGraph& graph);
+    
+    /**
+     * @brief 按规范化使用的规则感知芳香性并写回分子图
+     * 
+     * 判定为芳香的原子置为芳香，环内相应的键改为芳香键，
+     * 使Kekulé写法与芳香写法得到相同的分子图。
+     * 
+     * @param graph 已解析的分子图
+     */
+    static void perceiveAromaticity(MolecularGraph& graph);
+    
+    /**
+     * @brief 解析分子并生成规范SMILES
+     * 
+     * @param content 分子数据（SMILES或MOL块）
+     * @param format 数据格式
+     * @param smiles 输出规范SMILES
+     * @return 是否解析成功
+     */
+    static bool canonicalize(const std::string& content, const std::string& format, std::string& smiles);
+    
+    /**
+     * @brief 由规范SMILES计算结构键
+     * 
+     * @param canonical 规范SMILES
+     * @return 结构键
+     */
+    static StructureKey structureKey(const std::string& canonical);
+    
+    /**
+     * @brief 解析分子并计算结构键
+     * 
+     * @param content 分子数据
+     * @param format 数据格式
+     * @return 结构键（解析失败返回空键）
+     */
+    static StructureKey computeKey(const std::string& content, const std::string& format);
+    
+    /**
+     * @brief 并行批量计算结构键
+     * 
+     * @param records 数据记录
+     * @param keys 输出结构键数组（长度不小于记录数）
+     * @return 解析失败的记录数
+     */
+    static size_t computeKeysBatch(const std::vector<Data::DataRecord>& records, StructureKey* keys);
+    
+    /**
+     * @brief 判断数据格式是否为分子结构格式（SMILES/SMI/MOL/SDF）
+     * 
+     * @param format 数据格式
+     * @return 是否为结构格式
+     */
+    static bool isStructureFormat(const std::string& format);
+};
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
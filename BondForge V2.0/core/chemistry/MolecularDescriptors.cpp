@@ -0,0 +1,327 @@
+#include "MolecularDescriptors.h"
+#include "Canonicalizer.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+namespace {
+
+// 每个批处理块的分子数：足够摊薄调度开销，又能让线程间负载均衡
+constexpr size_t kBatchGrainSize = 512;
+
+bool isHalogen(int atomicNumber) {
+    return atomicNumber == 9 || atomicNumber == 17 || atomicNumber == 35 || atomicNumber == 53;
+}
+
+bool isHeteroatom(int atomicNumber) {
+    return atomicNumber != 1 && atomicNumber != 6 && atomicNumber != 0;
+}
+
+size_t heavyDegree(const MolecularGraph& graph, uint32_t atom) {
+    size_t degree = 0;
+    for (const uint32_t* it = graph.neighborBondsBegin(atom); it != graph.neighborBondsEnd(atom); ++it) {
+        if (graph.atoms[graph.otherAtom(*it, atom)].atomicNumber != 1) {
+            ++degree;
+        }
+    }
+    return degree;
+}
+
+/**
+ * @brief 原子质量：标注了同位素时取该同位素的质量，否则取元素的平均原子量
+ */
+double atomMass(const Atom& atom, const ElementInfo* element) {
+    if (atom.isotope <= 0) {
+        return element ? element->atomicWeight : 0.0;
+    }
+    
+    struct IsotopeMass { int atomicNumber; int massNumber; double mass; };
+    static const IsotopeMass isotopes[] = {
+        {1, 1, 1.007825}, {1, 2, 2.014102}, {1, 3, 3.016049},
+        {6, 11, 11.011434}, {6, 12, 12.000000}, {6, 13, 13.003355}, {6, 14, 14.003242},
+        {7, 14, 14.003074}, {7, 15, 15.000109},
+        {8, 16, 15.994915}, {8, 17, 16.999132}, {8, 18, 17.999160},
+        {9, 18, 18.000938}, {9, 19, 18.998403},
+        {15, 31, 30.973762}, {15, 32, 31.973907},
+        {16, 32, 31.972071}, {16, 34, 33.967867}, {16, 35, 34.969032},
+        {17, 35, 34.968853}, {17, 36, 35.968307}, {17, 37, 36.965903},
+        {35, 79, 78.918338}, {35, 81, 80.916291},
+        {53, 123, 122.905589}, {53, 125, 124.904630}, {53, 127, 126.904473}, {53, 131, 130.906125}
+    };
+    
+    for (const IsotopeMass& isotope : isotopes) {
+        if (isotope.atomicNumber == atom.atomicNumber && isotope.massNumber == atom.isotope) {
+            return isotope.mass;
+        }
+    }
+    // 表中没有的同位素用质量数近似（误差小于0.1）
+    return static_cast<double>(atom.isotope);
+}
+
+bool hasTripleBond(const MolecularGraph& graph, uint32_t atom) {
+    for (const uint32_t* it = graph.neighborBondsBegin(atom); it != graph.neighborBondsEnd(atom); ++it) {
+        if (graph.bonds[*it].order == 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 按块并行计算的公共实现
+ * 
+ * @param count 分子数
+ * @param fetch 取第i个分子的内容和格式
+ */
+template <typename Fetch>
+size_t computeBatchImpl(size_t count, Fetch fetch, double* out, size_t rowStride, uint8_t* valid) {
+    std::atomic<size_t> failed{0};
+    
+    Utils::ThreadPool::instance().parallelFor(0, count, kBatchGrainSize,
+        [&](size_t begin, size_t end) {
+            size_t localFailed = 0;
+            
+            for (size_t i = begin; i < end; ++i) {
+                const std::string* content = nullptr;
+                const std::string* format = nullptr;
+                fetch(i, content, format);
+                
+                // 解析、感知芳香性并计算，失败时该行置0
+                bool ok = DescriptorCalculator::compute(*content, *format, out + i * rowStride);
+                if (!ok) ++localFailed;
+                
+                if (valid) {
+                    valid[i] = ok ? 1 : 0;
+                }
+            }
+            
+            failed += localFailed;
+        });
+    
+    return failed.load();
+}
+
+} // namespace
+
+const std::vector<std::string>& DescriptorCalculator::descriptorNames() {
+    static const std::vector<std::string> names = {
+        "molecular_weight",
+        "heavy_atom_count",
+        "heteroatom_count",
+        "halogen_count",
+        "ring_count",
+        "aromatic_atom_count",
+        "hbond_donors",
+        "hbond_acceptors",
+        "rotatable_bonds",
+        "logp"
+    };
+    return names;
+}
+
+void DescriptorCalculator::compute(const MolecularGraph& graph, double* out) {
+    thread_local MolecularGraph perceived;
+    
+    perceived = graph;
+    Canonicalizer::perceiveAromaticity(perceived);
+    computePerceived(perceived, out);
+}
+
+void DescriptorCalculator::computePerceived(const MolecularGraph& graph, double* out) {
+    double weight = 0.0;
+    size_t heavyAtoms = 0;
+    size_t heteroatoms = 0;
+    size_t halogens = 0;
+    size_t aromaticAtoms = 0;
+    size_t donors = 0;
+    size_t acceptors = 0;
+    
+    const double hydrogenWeight = findElement(1)->atomicWeight;
+    
+    for (size_t i = 0; i < graph.atoms.size(); ++i) {
+        const Atom& atom = graph.atoms[i];
+        const ElementInfo* element = findElement(atom.atomicNumber);
+        
+        weight += atomMass(atom, element);
+        weight += (atom.implicitHydrogens + atom.explicitHydrogens) * hydrogenWeight;
+        
+        if (atom.atomicNumber == 1) continue;
+        
+        ++heavyAtoms;
+        if (isHeteroatom(atom.atomicNumber)) ++heteroatoms;
+        if (isHalogen(atom.atomicNumber)) ++halogens;
+        if (atom.aromatic) ++aromaticAtoms;
+        
+        if (atom.atomicNumber == 7 || atom.atomicNumber == 8) {
+            ++acceptors;
+            if (graph.totalHydrogens(i) > 0) ++donors;
+        }
+    }
+    
+    size_t rotatable = 0;
+    for (const Bond& bond : graph.bonds) {
+        if (bond.order != 1 || bond.inRing) continue;
+        if (graph.atoms[bond.begin].atomicNumber == 1 || graph.atoms[bond.end].atomicNumber == 1) continue;
+        if (heavyDegree(graph, bond.begin) < 2 || heavyDegree(graph, bond.end) < 2) continue;
+        if (hasTripleBond(graph, bond.begin) || hasTripleBond(graph, bond.end)) continue;
+        ++rotatable;
+    }
+    
+    double rings = static_cast<double>(graph.bonds.size()) -
+                   static_cast<double>(graph.atoms.size()) +
+                   static_cast<double>(graph.componentCount());
+    
+    out[static_cast<size_t>(Descriptor::MolecularWeight)] = weight;
+    out[static_cast<size_t>(Descriptor::HeavyAtomCount)] = static_cast<double>(heavyAtoms);
+    out[static_cast<size_t>(Descriptor::HeteroatomCount)] = static_cast<double>(heteroatoms);
+    out[static_cast<size_t>(Descriptor::HalogenCount)] = static_cast<double>(halogens);
+    out[static_cast<size_t>(Descriptor::RingCount)] = std::max(0.0, rings);
+    out[static_cast<size_t>(Descriptor::AromaticAtomCount)] = static_cast<double>(aromaticAtoms);
+    out[static_cast<size_t>(Descriptor::HBondDonors)] = static_cast<double>(donors);
+    out[static_cast<size_t>(Descriptor::HBondAcceptors)] = static_cast<double>(acceptors);
+    out[static_cast<size_t>(Descriptor::RotatableBonds)] = static_cast<double>(rotatable);
+    out[static_cast<size_t>(Descriptor::LogP)] = estimateLogP(graph);
+}
+
+bool DescriptorCalculator::compute(const std::string& content, const std::string& format, double* out) {
+    thread_local MolecularGraph graph;
+    
+    if (!MoleculeParser::parse(content, format, graph)) {
+        std::fill(out, out + DescriptorCount, 0.0);
+        return false;
+    }
+    
+    Canonicalizer::perceiveAromaticity(graph);
+    computePerceived(graph, out);
+    return true;
+}
+
+size_t DescriptorCalculator::computeBatch(
+    const std::vector<Data::DataRecord>& records,
+    double* out,
+    size_t rowStride,
+    uint8_t* valid) {
+    
+    return computeBatchImpl(records.size(),
+        [&records](size_t i, const std::string*& content, const std::string*& format) {
+            content = &records[i].content;
+            format = &records[i].format;
+        },
+        out, rowStride, valid);
+}
+
+size_t DescriptorCalculator::computeBatch(
+    const std::vector<std::string>& smilesList,
+    double* out,
+    size_t rowStride,
+    uint8_t* valid) {
+    
+    static const std::string smilesFormat = "SMILES";
+    return computeBatchImpl(smilesList.size(),
+        [&smilesList](size_t i, const std::string*& content, const std::string*& format) {
+            content = &smilesList[i];
+            format = &smilesFormat;
+        },
+        out, rowStride, valid);
+}
+
+DescriptorBatch DescriptorCalculator::computeBatch(const std::vector<Data::DataRecord>& records) {
+    DescriptorBatch batch;
+    batch.rows = records.size();
+    batch.cols = DescriptorCount;
+    batch.values.resize(batch.rows * batch.cols);
+    batch.valid.resize(batch.rows);
+    batch.failedCount = computeBatch(records, batch.values.data(), batch.cols, batch.valid.data());
+    return batch;
+}
+
+double DescriptorCalculator::estimateLogP(const MolecularGraph& graph) {
+    // 简化的Wildman-Crippen原子贡献法：按元素、芳香性、杂原子邻居和氢数粗分原子类型
+    double logP = 0.0;
+    
+    for (uint32_t i = 0; i < graph.atoms.size(); ++i) {
+        const Atom& atom = graph.atoms[i];
+        int hydrogens = graph.totalHydrogens(i);
+        
+        bool heteroNeighbor = false;
+        bool doubleToHetero = false;
+        bool doubleBond = false;
+        for (const uint32_t* it = graph.neighborBondsBegin(i); it != graph.neighborBondsEnd(i); ++it) {
+            const Bond& bond = graph.bonds[*it];
+            int neighbor = graph.atoms[graph.otherAtom(*it, i)].atomicNumber;
+            if (isHeteroatom(neighbor)) {
+                heteroNeighbor = true;
+                if (bond.order == 2) doubleToHetero = true;
+            }
+            if (bond.order == 2) doubleBond = true;
+        }
+        
+        double contribution = 0.0;
+        double hydrogenContribution = 0.0;
+        
+        switch (atom.atomicNumber) {
+            case 6:
+                if (atom.aromatic) {
+                    contribution = heteroNeighbor ? 0.2713 : (hydrogens > 0 ? 0.1581 : 0.1360);
+                } else if (doubleToHetero) {
+                    contribution = -0.1002;
+                } else if (heteroNeighbor) {
+                    contribution = -0.2035;
+                } else if (doubleBond) {
+                    contribution = 0.1551;
+                } else {
+                    contribution = hydrogens >= 2 ? 0.1441 : 0.0;
+                }
+                hydrogenContribution = 0.1230;
+                break;
+            case 7:
+                if (atom.charge > 0) {
+                    contribution = -1.0;
+                } else if (atom.aromatic) {
+                    contribution = -0.4806;
+                } else if (hydrogens >= 2) {
+                    contribution = -1.0190;
+                } else if (hydrogens == 1) {
+                    contribution = -0.7096;
+                } else {
+                    contribution = -0.3187;
+                }
+                hydrogenContribution = 0.2142;
+                break;
+            case 8:
+                if (atom.charge < 0) {
+                    contribution = -1.0;
+                } else if (atom.aromatic) {
+                    contribution = 0.1552;
+                } else if (doubleBond) {
+                    contribution = -0.1526;
+                } else if (hydrogens > 0) {
+                    contribution = -0.2893;
+                } else {
+                    contribution = -0.0684;
+                }
+                hydrogenContribution = -0.2677;
+                break;
+            case 9: contribution = 0.4202; break;
+            case 17: contribution = 0.6895; break;
+            case 35: contribution = 0.8456; break;
+            case 53: contribution = 0.8857; break;
+            case 16: contribution = atom.aromatic ? 0.6237 : 0.6482; hydrogenContribution = 0.1230; break;
+            case 15: contribution = 0.8612; break;
+            case 1: continue;  // 显式氢原子已计入所连重原子的氢贡献
+            default: break;
+        }
+        
+        logP += contribution + hydrogens * hydrogenContribution;
+    }
+    
+    return logP;
+}
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "MolecularGraph.h"
+#include "../data/DataRecord.h"
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+/**
+ * @brief 分子描述符类型（同时也是特征矩阵中的列序号）
+ */
+enum class Descriptor {
+    MolecularWeight,    // 分子量（含隐式氢）
+    HeavyAtomCount,     // 重原子数
+    HeteroatomCount,    // 杂原子数（非C、非H）
+    HalogenCount,       // 卤素原子数
+    RingCount,          // 环数（环秩 = 键数 - 原子数 + 连通分量数）
+    AromaticAtomCount,  // 芳香原子数
+    HBondDonors,        // 氢键供体数（带氢的N/O）
+    HBondAcceptors,     // 氢键受体数（N/O总数）
+    RotatableBonds,     // 可旋转键数
+    LogP,               // 基于原子贡献的logP估算
+    Count
+};
+
+/**
+ * @brief 批量描述符计算结果
+ */
+struct DescriptorBatch {
+    size_t rows = 0;                // 分子数
+    size_t cols = 0;                // 描述符数
+    std::vector<double> values;     // 行主序连续存储的特征矩阵
+    std::vector<uint8_t> valid;     // 每行是否解析成功
+    size_t failedCount = 0;         // 解析失败的分子数
+};
+
+/**
+ * @brief 分子描述符计算器
+ * 
+ * 批量接口在共享线程池上按块并行，每个线程复用一个分子图实例，
+ * 结果直接写入调用方提供的连续特征矩阵，不为单个分子分配结果向量。
+ */
+class DescriptorCalculator {
+public:
+    static constexpr size_t DescriptorCount = static_cast<size_t>(Descriptor::Count);
+    
+    /**
+     * @brief 获取描述符名称（与列顺序一致）
+     * 
+     * @return 名称列表
+     */
+    static const std::vector<std::string>& descriptorNames();
+    
+    /**
+     * @brief 计算单个分子图的全部描述符
+     * 
+     * 先在分子图的副本上感知芳香性，Kekulé写法与芳香写法得到相同的芳香原子数和logP。
+     * 
+     * @param graph 已解析的分子图
+     * @param out 输出缓冲区（至少 DescriptorCount 个元素）
+     */
+    static void compute(const MolecularGraph& graph, double* out);
+    
+    /**
+     * @brief 解析并计算单个分子的全部描述符
+     * 
+     * @param content 分子数据（SMILES或MOL块）
+     * @param format 数据格式
+     * @param out 输出缓冲区（解析失败时全部置0）
+     * @return 是否解析成功
+     */
+    static bool compute(const std::string& content, const std::string& format, double* out);
+    
+    /**
+     * @brief 并行批量计算，结果写入调用方的矩阵
+     * 
+     * @param records 数据记录
+     * @param out 输出矩阵首地址（行主序）
+     * @param rowStride 相邻两行的间隔（元素数，不小于 DescriptorCount）
+     * @param valid 可选，输出每行是否解析成功
+     * @return 解析失败的分子数
+     */
+    static size_t computeBatch(
+        const std::vector<Data::DataRecord>& records,
+        double* out,
+        size_t rowStride,
+        uint8_t* valid = nullptr);
+    
+    /**
+     * @brief 并行批量计算SMILES列表
+     * 
+     * @param smilesList SMILES列表
+     * @param out 输出矩阵首地址（行主序）
+     * @param rowStride 相邻两行的间隔（元素数）
+     * @param valid 可选，输出每行是否解析成功
+     * @return 解析失败的分子数
+     */
+    static size_t computeBatch(
+        const std::vector<std::string>& smilesList,
+        double* out,
+        size_t rowStride,
+        uint8_t* valid = nullptr);
+    
+    /**
+     * @brief 并行批量计算并返回新分配的特征矩阵
+     * 
+     * @param records 数据记录
+     * @return 批量计算结果
+     */
+    static DescriptorBatch computeBatch(const std::vector<Data::DataRecord>& records);
+
+private:
+    /**
+     * @brief 在已感知芳香性的分子图上计算描述符
+     */
+    static void computePerceived(const MolecularGraph& graph, double* out);
+    
+    static double estimateLogP(const MolecularGraph& graph);
+};
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
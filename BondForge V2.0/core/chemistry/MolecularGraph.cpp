@@ -0,0 +1,851 @@
+#include "MolecularGraph.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+namespace {
+
+// 元素表（按原子序数排列，下标0为通配原子 *）
+const ElementInfo kElements[] = {
+    {"*", 0, 0.0},
+    {"H", 1, 1.008}, {"He", 2, 4.0026}, {"Li", 3, 6.94}, {"Be", 4, 9.0122},
+    {"B", 5, 10.81}, {"C", 6, 12.011}, {"N", 7, 14.007}, {"O", 8, 15.999},
+    {"F", 9, 18.998}, {"Ne", 10, 20.180}, {"Na", 11, 22.990}, {"Mg", 12, 24.305},
+    {"Al", 13, 26.982}, {"Si", 14, 28.085}, {"P", 15, 30.974}, {"S", 16, 32.06},
+    {"Cl", 17, 35.45}, {"Ar", 18, 39.948}, {"K", 19, 39.098}, {"Ca", 20, 40.078},
+    {"Sc", 21, 44.956}, {"Ti", 22, 47.867}, {"V", 23, 50.942}, {"Cr", 24, 51.996},
+    {"Mn", 25, 54.938}, {"Fe", 26, 55.845}, {"Co", 27, 58.933}, {"Ni", 28, 58.693},
+    {"Cu", 29, 63.546}, {"Zn", 30, 65.38}, {"Ga", 31, 69.723}, {"Ge", 32, 72.630},
+    {"As", 33, 74.922}, {"Se", 34, 78.971}, {"Br", 35, 79.904}, {"Kr", 36, 83.798},
+    {"Rb", 37, 85.468}, {"Sr", 38, 87.62}, {"Y", 39, 88.906}, {"Zr", 40, 91.224},
+    {"Nb", 41, 92.906}, {"Mo", 42, 95.95}, {"Tc", 43, 98.0}, {"Ru", 44, 101.07},
+    {"Rh", 45, 102.91}, {"Pd", 46, 106.42}, {"Ag", 47, 107.87}, {"Cd", 48, 112.41},
+    {"In", 49, 114.82}, {"Sn", 50, 118.71}, {"Sb", 51, 121.76}, {"Te", 52, 127.60},
+    {"I", 53, 126.90}, {"Xe", 54, 131.29}, {"Cs", 55, 132.91}, {"Ba", 56, 137.33}
+};
+
+// 原子序数大于56的常见元素
+const ElementInfo kHeavyElements[] = {
+    {"Gd", 64, 157.25}, {"W", 74, 183.84}, {"Os", 76, 190.23}, {"Ir", 77, 192.22},
+    {"Pt", 78, 195.08}, {"Au", 79, 196.97}, {"Hg", 80, 200.59}, {"Tl", 81, 204.38},
+    {"Pb", 82, 207.2}, {"Bi", 83, 208.98}, {"U", 92, 238.03}
+};
+
+constexpr size_t kElementCount = sizeof(kElements) / sizeof(kElements[0]);
+constexpr size_t kHeavyElementCount = sizeof(kHeavyElements) / sizeof(kHeavyElements[0]);
+
+/**
+ * @brief 有机子集元素的默认价态（以0结尾）
+ */
+const int* defaultValences(int atomicNumber) {
+    static const int boron[] = {3, 0};
+    static const int carbon[] = {4, 0};
+    static const int nitrogen[] = {3, 5, 0};
+    static const int oxygen[] = {2, 0};
+    static const int phosphorus[] = {3, 5, 0};
+    static const int sulfur[] = {2, 4, 6, 0};
+    static const int halogen[] = {1, 0};
+    
+    switch (atomicNumber) {
+        case 5: return boron;
+        case 6: return carbon;
+        case 7: return nitrogen;
+        case 8: return oxygen;
+        case 15: return phosphorus;
+        case 16: return sulfur;
+        case 9: case 17: case 35: case 53: return halogen;
+        default: return nullptr;
+    }
+}
+
+/**
+ * @brief 解析芳香小写元素符号，返回原子序数（0表示不是芳香符号）
+ */
+int aromaticAtomicNumber(const char* text, size_t length, size_t& consumed) {
+    if (length >= 2 && text[0] == 's' && text[1] == 'e') { consumed = 2; return 34; }
+    if (length >= 2 && text[0] == 'a' && text[1] == 's') { consumed = 2; return 33; }
+    
+    consumed = 1;
+    switch (text[0]) {
+        case 'b': return 5;
+        case 'c': return 6;
+        case 'n': return 7;
+        case 'o': return 8;
+        case 'p': return 15;
+        case 's': return 16;
+        default: consumed = 0; return 0;
+    }
+}
+
+/**
+ * @brief SMILES解析器的内部状态
+ */
+class SmilesReader {
+public:
+    SmilesReader(const std::string& text, MolecularGraph& graph)
+        : m_text(text), m_graph(graph) {
+        std::fill(std::begin(m_ringAtom), std::end(m_ringAtom), -1);
+    }
+    
+    bool read() {
+        while (m_pos < m_text.size()) {
+            char ch = m_text[m_pos];
+            
+            if (ch == '(') {
+                if (m_previous < 0) return false;
+                m_branchStack.push_back(m_previous);
+                ++m_pos;
+            } else if (ch == ')') {
+                if (m_branchStack.empty()) return false;
+                m_previous = m_branchStack.back();
+                m_branchStack.pop_back();
+                ++m_pos;
+            } else if (ch == '.') {
+                m_previous = -1;
+                ++m_pos;
+            } else if (ch == '-' || ch == '/' || ch == '\\') {
+                m_pendingOrder = 1;
+                ++m_pos;
+            } else if (ch == '=') {
+                m_pendingOrder = 2;
+                ++m_pos;
+            } else if (ch == '#') {
+                m_pendingOrder = 3;
+                ++m_pos;
+            } else if (ch == '$') {
+                m_pendingOrder = 3;  // 四重键按三重键处理
+                ++m_pos;
+            } else if (ch == ':') {
+                m_pendingOrder = AromaticBondOrder;
+                ++m_pos;
+            } else if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '%') {
+                if (!readRingClosure()) return false;
+            } else if (ch == '[') {
+                if (!readBracketAtom()) return false;
+            } else if (std::isspace(static_cast<unsigned char>(ch))) {
+                break;  // 空白之后为分子名称
+            } else {
+                if (!readOrganicAtom()) return false;
+            }
+        }
+        
+        // 未闭合的环或分支视为错误
+        if (!m_branchStack.empty()) return false;
+        for (int atom : m_ringAtom) {
+            if (atom >= 0) return false;
+        }
+        return !m_graph.atoms.empty();
+    }
+
+private:
+    void addAtom(const Atom& atom) {
+        int index = static_cast<int>(m_graph.atoms.size());
+        m_graph.atoms.push_back(atom);
+        
+        if (m_previous >= 0) {
+            addBond(m_previous, index, m_pendingOrder);
+        }
+        
+        m_previous = index;
+        m_pendingOrder = 0;
+    }
+    
+    void addBond(int a, int b, int order) {
+        Bond bond;
+        bond.begin = static_cast<uint32_t>(a);
+        bond.end = static_cast<uint32_t>(b);
+        
+        if (order == 0) {
+            bool aromatic = m_graph.atoms[a].aromatic && m_graph.atoms[b].aromatic;
+            bond.order = aromatic ? AromaticBondOrder : 1;
+        } else {
+            bond.order = static_cast<uint8_t>(order);
+        }
+        
+        m_graph.bonds.push_back(bond);
+    }
+    
+    bool readRingClosure() {
+        int number;
+        if (m_text[m_pos] == '%') {
+            if (m_pos + 2 >= m_text.size() ||
+                !std::isdigit(static_cast<unsigned char>(m_text[m_pos + 1])) ||
+                !std::isdigit(static_cast<unsigned char>(m_text[m_pos + 2]))) {
+                return false;
+            }
+            number = (m_text[m_pos + 1] - '0') * 10 + (m_text[m_pos + 2] - '0');
+            m_pos += 3;
+        } else {
+            number = m_text[m_pos] - '0';
+            ++m_pos;
+        }
+        
+        if (m_previous < 0) return false;
+        
+        if (m_ringAtom[number] < 0) {
+            m_ringAtom[number] = m_previous;
+            m_ringOrder[number] = m_pendingOrder;
+        } else {
+            int order = m_pendingOrder != 0 ? m_pendingOrder : m_ringOrder[number];
+            if (m_ringAtom[number] == m_previous) return false;
+            addBond(m_ringAtom[number], m_previous, order);
+            m_ringAtom[number] = -1;
+        }
+        
+        m_pendingOrder = 0;
+        return true;
+    }
+    
+    bool readOrganicAtom() {
+        const char* text = m_text.c_str() + m_pos;
+        size_t remaining = m_text.size() - m_pos;
+        Atom atom;
+        
+        if (text[0] == '*') {
+            atom.atomicNumber = 0;
+            m_pos += 1;
+        } else if (remaining >= 2 && text[0] == 'C' && text[1] == 'l') {
+            atom.atomicNumber = 17;
+            m_pos += 2;
+        } else if (remaining >= 2 && text[0] == 'B' && text[1] == 'r') {
+            atom.atomicNumber = 35;
+            m_pos += 2;
+        } else if (std::strchr("BCNOPSFI", text[0]) != nullptr) {
+            const ElementInfo* element = findElement(text, 1);
+            atom.atomicNumber = element->atomicNumber;
+            m_pos += 1;
+        } else {
+            size_t consumed = 0;
+            int number = aromaticAtomicNumber(text, 1, consumed);
+            if (number == 0) return false;
+            atom.atomicNumber = number;
+            atom.aromatic = true;
+            m_pos += consumed;
+        }
+        
+        addAtom(atom);
+        return true;
+    }
+    
+    bool readBracketAtom() {
+        size_t close = m_text.find(']', m_pos);
+        if (close == std::string::npos) return false;
+        
+        const char* text = m_text.c_str();
+        size_t pos = m_pos + 1;
+        Atom atom;
+        atom.bracket = true;
+        
+        // 同位素
+        while (pos < close && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            atom.isotope = atom.isotope * 10 + (text[pos] - '0');
+            ++pos;
+        }
+        
+        // 元素符号
+        if (pos >= close) return false;
+        if (text[pos] == '*') {
+            atom.atomicNumber = 0;
+            ++pos;
+        } else if (std::islower(static_cast<unsigned char>(text[pos]))) {
+            size_t consumed = 0;
+            int number = aromaticAtomicNumber(text + pos, close - pos, consumed);
+            if (number == 0) return false;
+            atom.atomicNumber = number;
+            atom.aromatic = true;
+            pos += consumed;
+        } else {
+            size_t length = 1;
+            if (pos + 1 < close && std::islower(static_cast<unsigned char>(text[pos + 1]))) {
+                length = 2;
+            }
+            const ElementInfo* element = findElement(text + pos, length);
+            if (!element && length == 2) {
+                length = 1;
+                element = findElement(text + pos, length);
+            }
+            if (!element) return false;
+            atom.atomicNumber = element->atomicNumber;
+            pos += length;
+        }
+        
+        // 手性标记
+        while (pos < close && text[pos] == '@') ++pos;
+        
+        // 氢计数
+        if (pos < close && text[pos] == 'H') {
+            ++pos;
+            atom.explicitHydrogens = 1;
+            if (pos < close && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+                atom.explicitHydrogens = text[pos] - '0';
+                ++pos;
+            }
+        }
+        
+        // 电荷
+        while (pos < close && (text[pos] == '+' || text[pos] == '-')) {
+            int sign = text[pos] == '+' ? 1 : -1;
+            ++pos;
+            if (pos < close && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+                atom.charge += sign * (text[pos] - '0');
+                ++pos;
+            } else {
+                atom.charge += sign;
+            }
+        }
+        
+        // 原子类别 :n 忽略
+        m_pos = close + 1;
+        addAtom(atom);
+        return true;
+    }
+    
+    const std::string& m_text;
+    MolecularGraph& m_graph;
+    size_t m_pos = 0;
+    int m_previous = -1;
+    int m_pendingOrder = 0;
+    std::vector<int> m_branchStack;
+    int m_ringAtom[100];
+    int m_ringOrder[100] = {};
+};
+
+/**
+ * @brief 解析定宽字段中的整数
+ */
+int parseFixedInt(const std::string& line, size_t start, size_t width) {
+    if (start >= line.size()) return 0;
+    std::string field = line.substr(start, width);
+    return std::atoi(field.c_str());
+}
+
+/**
+ * @brief 解析定宽字段中的浮点数
+ */
+float parseFixedFloat(const std::string& line, size_t start, size_t width) {
+    if (start >= line.size()) return 0.0f;
+    std::string field = line.substr(start, width);
+    return static_cast<float>(std::atof(field.c_str()));
+}
+
+/**
+ * @brief 绘制和成键判断用的共价半径（埃）
+ */
+float covalentRadius(int atomicNumber) {
+    switch (atomicNumber) {
+        case 1: return 0.31f;
+        case 6: return 0.76f;
+        case 7: return 0.71f;
+        case 8: return 0.66f;
+        case 9: return 0.57f;
+        case 15: return 1.07f;
+        case 16: return 1.05f;
+        case 17: return 1.02f;
+        case 34: return 1.20f;
+        case 35: return 1.20f;
+        case 53: return 1.39f;
+        default: return 1.30f;
+    }
+}
+
+/**
+ * @brief 按原子间距推断PDB中未用CONECT声明的化学键
+ * 
+ * 以4埃为边长的空间网格分桶，每个原子只与相邻27个格子中的原子比较，整体为线性复杂度。
+ */
+void perceiveBondsByDistance(MolecularGraph& graph) {
+    const float cellSize = 4.0f;
+    const float tolerance = 0.45f;
+    
+    float minX = graph.atoms[0].x, minY = graph.atoms[0].y, minZ = graph.atoms[0].z;
+    for (const Atom& atom : graph.atoms) {
+        minX = std::min(minX, atom.x);
+        minY = std::min(minY, atom.y);
+        minZ = std::min(minZ, atom.z);
+    }
+    
+    auto cellOf = [&](const Atom& atom, int& cx, int& cy, int& cz) {
+        cx = static_cast<int>((atom.x - minX) / cellSize);
+        cy = static_cast<int>((atom.y - minY) / cellSize);
+        cz = static_cast<int>((atom.z - minZ) / cellSize);
+    };
+    auto cellKey = [](int cx, int cy, int cz) {
+        return (static_cast<uint64_t>(cx) << 42) | (static_cast<uint64_t>(cy) << 21) | static_cast<uint64_t>(cz);
+    };
+    
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    for (uint32_t i = 0; i < graph.atoms.size(); ++i) {
+        int cx, cy, cz;
+        cellOf(graph.atoms[i], cx, cy, cz);
+        cells[cellKey(cx, cy, cz)].push_back(i);
+    }
+    
+    for (uint32_t i = 0; i < graph.atoms.size(); ++i) {
+        const Atom& atom = graph.atoms[i];
+        int cx, cy, cz;
+        cellOf(atom, cx, cy, cz);
+        
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    if (cx + dx < 0 || cy + dy < 0 || cz + dz < 0) continue;
+                    auto it = cells.find(cellKey(cx + dx, cy + dy, cz + dz));
+                    if (it == cells.end()) continue;
+                    
+                    for (uint32_t j : it->second) {
+                        if (j <= i) continue;
+                        const Atom& other = graph.atoms[j];
+                        // 两个氢原子之间不成键
+                        if (atom.atomicNumber == 1 && other.atomicNumber == 1) continue;
+                        
+                        float limit = covalentRadius(atom.atomicNumber) + covalentRadius(other.atomicNumber) + tolerance;
+                        float ddx = atom.x - other.x;
+                        float ddy = atom.y - other.y;
+                        float ddz = atom.z - other.z;
+                        float distance2 = ddx * ddx + ddy * ddy + ddz * ddz;
+                        if (distance2 > 0.16f && distance2 < limit * limit) {
+                            Bond bond;
+                            bond.begin = i;
+                            bond.end = j;
+                            graph.bonds.push_back(bond);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::string toUpper(const std::string& text) {
+    std::string result = text;
+    std::transform(result.begin(), result.end(), result.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return result;
+}
+
+} // namespace
+
+const ElementInfo* findElement(int atomicNumber) {
+    if (atomicNumber >= 0 && static_cast<size_t>(atomicNumber) < kElementCount) {
+        return &kElements[atomicNumber];
+    }
+    for (size_t i = 0; i < kHeavyElementCount; ++i) {
+        if (kHeavyElements[i].atomicNumber == atomicNumber) {
+            return &kHeavyElements[i];
+        }
+    }
+    return nullptr;
+}
+
+const ElementInfo* findElement(const char* symbol, size_t length) {
+    auto matches = [symbol, length](const ElementInfo& element) {
+        return std::strlen(element.symbol) == length &&
+               std::strncmp(element.symbol, symbol, length) == 0;
+    };
+    
+    for (size_t i = 1; i < kElementCount; ++i) {
+        if (matches(kElements[i])) return &kElements[i];
+    }
+    for (size_t i = 0; i < kHeavyElementCount; ++i) {
+        if (matches(kHeavyElements[i])) return &kHeavyElements[i];
+    }
+    return nullptr;
+}
+
+// MolecularGraph 实现
+void MolecularGraph::clear() {
+    atoms.clear();
+    bonds.clear();
+    hasCoordinates = false;
+    m_adjacencyOffsets.clear();
+    m_adjacency.clear();
+    m_componentCount = 0;
+}
+
+int MolecularGraph::totalHydrogens(size_t atom) const {
+    int count = atoms[atom].implicitHydrogens + atoms[atom].explicitHydrogens;
+    for (const uint32_t* it = neighborBondsBegin(atom); it != neighborBondsEnd(atom); ++it) {
+        if (atoms[otherAtom(*it, static_cast<uint32_t>(atom))].atomicNumber == 1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void MolecularGraph::finalize() {
+    buildAdjacency();
+    perceiveRingBonds();
+    assignImplicitHydrogens();
+}
+
+void MolecularGraph::buildAdjacency() {
+    size_t atomCount = atoms.size();
+    m_adjacencyOffsets.assign(atomCount + 1, 0);
+    
+    for (const Bond& bond : bonds) {
+        ++m_adjacencyOffsets[bond.begin + 1];
+        ++m_adjacencyOffsets[bond.end + 1];
+    }
+    for (size_t i = 0; i < atomCount; ++i) {
+        m_adjacencyOffsets[i + 1] += m_adjacencyOffsets[i];
+    }
+    
+    m_adjacency.resize(bonds.size() * 2);
+    m_stack.assign(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+    for (uint32_t b = 0; b < bonds.size(); ++b) {
+        m_adjacency[m_stack[bonds[b].begin]++] = b;
+        m_adjacency[m_stack[bonds[b].end]++] = b;
+    }
+}
+
+void MolecularGraph::perceiveRingBonds() {
+    // 迭代式Tarjan桥检测：不是桥的键即为环内键
+    const uint32_t unvisited = UINT32_MAX;
+    size_t atomCount = atoms.size();
+    
+    m_discovery.assign(atomCount, unvisited);
+    m_low.assign(atomCount, 0);
+    m_stack.clear();
+    
+    // 回边不可能是桥，先全部标记为环内键，再在回溯时修正树边
+    for (Bond& bond : bonds) {
+        bond.inRing = true;
+    }
+    
+    // 栈中每个元素占3个槽：原子、进入该原子的键、下一个待访问的邻接位置
+    std::vector<uint32_t>& stack = m_stack;
+    uint32_t timer = 0;
+    m_componentCount = 0;
+    
+    for (uint32_t root = 0; root < atomCount; ++root) {
+        if (m_discovery[root] != unvisited) continue;
+        ++m_componentCount;
+        
+        m_discovery[root] = m_low[root] = timer++;
+        stack.push_back(root);
+        stack.push_back(unvisited);
+        stack.push_back(m_adjacencyOffsets[root]);
+        
+        while (!stack.empty()) {
+            size_t top = stack.size() - 3;
+            uint32_t atom = stack[top];
+            uint32_t parentBond = stack[top + 1];
+            uint32_t& cursor = stack[top + 2];
+            
+            if (cursor < m_adjacencyOffsets[atom + 1]) {
+                uint32_t bond = m_adjacency[cursor++];
+                if (bond == parentBond) continue;
+                
+                uint32_t next = otherAtom(bond, atom);
+                if (m_discovery[next] == unvisited) {
+                    m_discovery[next] = m_low[next] = timer++;
+                    stack.push_back(next);
+                    stack.push_back(bond);
+                    stack.push_back(m_adjacencyOffsets[next]);
+                } else {
+                    m_low[atom] = std::min(m_low[atom], m_discovery[next]);
+                }
+            } else {
+                stack.resize(top);
+                if (parentBond != unvisited) {
+                    uint32_t parent = otherAtom(parentBond, atom);
+                    m_low[parent] = std::min(m_low[parent], m_low[atom]);
+                    bonds[parentBond].inRing = m_low[atom] <= m_discovery[parent];
+                }
+            }
+        }
+    }
+}
+
+void MolecularGraph::assignImplicitHydrogens() {
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        Atom& atom = atoms[i];
+        atom.implicitHydrogens = 0;
+        if (atom.bracket) continue;
+        
+        int bondSum = 0;
+        bool hasAromaticBond = false;
+        for (const uint32_t* it = neighborBondsBegin(i); it != neighborBondsEnd(i); ++it) {
+            uint8_t order = bonds[*it].order;
+            if (order == AromaticBondOrder) {
+                hasAromaticBond = true;
+                bondSum += 1;
+            } else {
+                bondSum += order;
+            }
+        }
+        
+        atom.implicitHydrogens = defaultImplicitHydrogens(
+            atom.atomicNumber, atom.charge, atom.aromatic && hasAromaticBond, bondSum);
+    }
+}
+
+int defaultImplicitHydrogens(int atomicNumber, int charge, bool aromatic, int bondOrderSum) {
+    const int* valences = defaultValences(atomicNumber);
+    if (!valences) return 0;
+    
+    // 芳香原子额外占用一个价态（π电子）
+    if (aromatic) {
+        bondOrderSum += 1;
+    }
+    
+    // 电荷修正：氮族/氧族正电荷增加价态，其余元素电荷减少可用价态
+    int adjust = (atomicNumber == 7 || atomicNumber == 8 || atomicNumber == 15 || atomicNumber == 16)
+                 ? charge : -std::abs(charge);
+    
+    // 芳香原子只使用最低价态（如吡咯型n(C)不会被推算出氢）
+    if (aromatic) {
+        return std::max(0, valences[0] + adjust - bondOrderSum);
+    }
+    
+    for (const int* v = valences; *v != 0; ++v) {
+        int target = *v + adjust;
+        if (target >= bondOrderSum) {
+            return target - bondOrderSum;
+        }
+    }
+    return 0;
+}
+
+// MoleculeParser 实现
+bool MoleculeParser::parseSmiles(const std::string& smiles, MolecularGraph& graph) {
+    graph.clear();
+    
+    size_t start = 0;
+    while (start < smiles.size() && std::isspace(static_cast<unsigned char>(smiles[start]))) {
+        ++start;
+    }
+    if (start == smiles.size()) return false;
+    
+    std::string trimmed;
+    if (start > 0) {
+        trimmed = smiles.substr(start);
+    }
+    
+    SmilesReader reader(start == 0 ? smiles : trimmed, graph);
+    if (!reader.read()) {
+        graph.clear();
+        return false;
+    }
+    
+    graph.finalize();
+    return true;
+}
+
+bool MoleculeParser::parseMolBlock(const std::string& molBlock, MolecularGraph& graph) {
+    graph.clear();
+    
+    // 按行切分，只保留到第一个 M  END
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start <= molBlock.size()) {
+        size_t end = molBlock.find('\n', start);
+        if (end == std::string::npos) end = molBlock.size();
+        std::string line = molBlock.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.compare(0, 6, "M  END") == 0) break;
+        lines.push_back(std::move(line));
+        start = end + 1;
+    }
+    
+    // 计数行通常是第4行；部分导出工具省略了标题行，此时按 V2000 标记定位
+    size_t countsLine = 3;
+    for (size_t i = 0; i < 3 && i < lines.size(); ++i) {
+        if (lines[i].find("V2000") != std::string::npos) {
+            countsLine = i;
+            break;
+        }
+    }
+    if (lines.size() <= countsLine) return false;
+    
+    const std::string& counts = lines[countsLine];
+    size_t atomLine = countsLine + 1;
+    if (counts.find("V3000") != std::string::npos) return false;
+    
+    int atomCount = parseFixedInt(counts, 0, 3);
+    int bondCount = parseFixedInt(counts, 3, 3);
+    if (atomCount <= 0 || lines.size() < atomLine + atomCount + bondCount) {
+        return false;
+    }
+    
+    graph.atoms.resize(atomCount);
+    for (int i = 0; i < atomCount; ++i) {
+        const std::string& line = lines[atomLine + i];
+        Atom& atom = graph.atoms[i];
+        
+        atom.x = parseFixedFloat(line, 0, 10);
+        atom.y = parseFixedFloat(line, 10, 10);
+        atom.z = parseFixedFloat(line, 20, 10);
+        if (atom.x != 0.0f || atom.y != 0.0f || atom.z != 0.0f) {
+            graph.hasCoordinates = true;
+        }
+        
+        std::string symbol = line.size() > 31 ? line.substr(31, 3) : std::string();
+        symbol.erase(std::remove_if(symbol.begin(), symbol.end(),
+            [](unsigned char c) { return std::isspace(c); }), symbol.end());
+        const ElementInfo* element = findElement(symbol.c_str(), symbol.size());
+        if (!element) {
+            graph.clear();
+            return false;
+        }
+        atom.atomicNumber = element->atomicNumber;
+        
+        // 旧式电荷字段：1=+3 2=+2 3=+1 5=-1 6=-2 7=-3
+        int chargeCode = parseFixedInt(line, 36, 3);
+        if (chargeCode >= 1 && chargeCode <= 7 && chargeCode != 4) {
+            atom.charge = 4 - chargeCode;
+        }
+    }
+    
+    graph.bonds.resize(bondCount);
+    for (int i = 0; i < bondCount; ++i) {
+        const std::string& line = lines[atomLine + atomCount + i];
+        int a = parseFixedInt(line, 0, 3) - 1;
+        int b = parseFixedInt(line, 3, 3) - 1;
+        int type = parseFixedInt(line, 6, 3);
+        
+        if (a < 0 || b < 0 || a >= atomCount || b >= atomCount || a == b) {
+            graph.clear();
+            return false;
+        }
+        
+        Bond& bond = graph.bonds[i];
+        bond.begin = static_cast<uint32_t>(a);
+        bond.end = static_cast<uint32_t>(b);
+        bond.order = (type >= 1 && type <= 3) ? static_cast<uint8_t>(type) : AromaticBondOrder;
+        
+        if (bond.order == AromaticBondOrder) {
+            graph.atoms[a].aromatic = true;
+            graph.atoms[b].aromatic = true;
+        }
+    }
+    
+    // 属性块中的 M  CHG 覆盖原子行中的电荷
+    for (size_t i = atomLine + atomCount + bondCount; i < lines.size(); ++i) {
+        const std::string& line = lines[i];
+        if (line.compare(0, 6, "M  CHG") != 0) continue;
+        
+        int entries = parseFixedInt(line, 6, 3);
+        for (int e = 0; e < entries; ++e) {
+            int atomIndex = parseFixedInt(line, 10 + e * 8, 3) - 1;
+            int charge = parseFixedInt(line, 14 + e * 8, 3);
+            if (atomIndex >= 0 && atomIndex < atomCount) {
+                graph.atoms[atomIndex].charge = charge;
+            }
+        }
+    }
+    
+    graph.finalize();
+    return true;
+}
+
+bool MoleculeParser::parsePdb(const std::string& pdb, MolecularGraph& graph) {
+    graph.clear();
+    
+    std::unordered_map<int, uint32_t> serialToIndex;
+    std::vector<std::pair<int, int>> connections;
+    
+    size_t start = 0;
+    while (start < pdb.size()) {
+        size_t end = pdb.find('\n', start);
+        if (end == std::string::npos) end = pdb.size();
+        std::string line = pdb.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        start = end + 1;
+        
+        // END 或 ENDMDL：多模型文件只取第一个模型
+        if (line.compare(0, 3, "END") == 0) break;
+        
+        if (line.compare(0, 6, "ATOM  ") == 0 || line.compare(0, 6, "HETATM") == 0) {
+            // 元素列（77-78）缺失时由原子名（13-16）推断
+            std::string symbol = line.size() >= 78 ? line.substr(76, 2) : std::string();
+            symbol.erase(std::remove_if(symbol.begin(), symbol.end(),
+                [](unsigned char c) { return std::isspace(c); }), symbol.end());
+            if (symbol.empty() && line.size() > 13) {
+                size_t nameStart = line[12] == ' ' ? 13 : 12;
+                symbol = line.substr(nameStart, 1);
+            }
+            for (size_t c = 1; c < symbol.size(); ++c) {
+                symbol[c] = static_cast<char>(std::tolower(static_cast<unsigned char>(symbol[c])));
+            }
+            
+            const ElementInfo* element = findElement(symbol.c_str(), symbol.size());
+            if (!element) {
+                graph.clear();
+                return false;
+            }
+            
+            Atom atom;
+            atom.atomicNumber = element->atomicNumber;
+            atom.bracket = true;    // PDB不推算隐式氢
+            atom.x = parseFixedFloat(line, 30, 8);
+            atom.y = parseFixedFloat(line, 38, 8);
+            atom.z = parseFixedFloat(line, 46, 8);
+            
+            serialToIndex[parseFixedInt(line, 6, 5)] = static_cast<uint32_t>(graph.atoms.size());
+            graph.atoms.push_back(atom);
+        } else if (line.compare(0, 6, "CONECT") == 0) {
+            int source = parseFixedInt(line, 6, 5);
+            for (size_t field = 11; field + 5 <= line.size() && field < 31; field += 5) {
+                int target = parseFixedInt(line, field, 5);
+                if (target > source) {
+                    connections.emplace_back(source, target);
+                }
+            }
+        }
+    }
+    
+    if (graph.atoms.empty()) return false;
+    graph.hasCoordinates = true;
+    
+    if (connections.empty()) {
+        perceiveBondsByDistance(graph);
+    } else {
+        for (const auto& connection : connections) {
+            auto a = serialToIndex.find(connection.first);
+            auto b = serialToIndex.find(connection.second);
+            if (a == serialToIndex.end() || b == serialToIndex.end()) continue;
+            
+            Bond bond;
+            bond.begin = a->second;
+            bond.end = b->second;
+            graph.bonds.push_back(bond);
+        }
+    }
+    
+    graph.finalize();
+    return true;
+}
+
+bool MoleculeParser::parse(const std::string& content, const std::string& format, MolecularGraph& graph) {
+    std::string upperFormat = toUpper(format);
+    
+    if (upperFormat == "MOL" || upperFormat == "SDF") {
+        return parseMolBlock(content, graph);
+    }
+    if (upperFormat == "PDB" || upperFormat == "ENT") {
+        return parsePdb(content, graph);
+    }
+    if (upperFormat == "SMILES" || upperFormat == "SMI") {
+        return parseSmiles(content, graph);
+    }
+    
+    // 未声明格式时按内容判断
+    if (content.find("V2000") != std::string::npos || content.find("M  END") != std::string::npos) {
+        return parseMolBlock(content, graph);
+    }
+    if (content.find("ATOM  ") != std::string::npos || content.find("HETATM") != std::string::npos) {
+        return parsePdb(content, graph);
+    }
+    return parseSmiles(content, graph);
+}
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
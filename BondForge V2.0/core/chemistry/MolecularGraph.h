@@ -0,0 +1,196 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+/**
+ * @brief 元素信息
+ */
+struct ElementInfo {
+    const char* symbol;     // 元素符号
+    int atomicNumber;       // 原子序数
+    double atomicWeight;    // 平均原子量
+};
+
+/**
+ * @brief 原子
+ */
+struct Atom {
+    int atomicNumber = 0;       // 原子序数
+    int charge = 0;             // 形式电荷
+    int isotope = 0;            // 同位素质量数（0表示未指定）
+    int explicitHydrogens = 0;  // 方括号内显式写出的氢数
+    int implicitHydrogens = 0;  // 根据默认价态推算的隐式氢数
+    bool aromatic = false;      // 是否芳香
+    bool bracket = false;       // 是否为方括号原子（不推算隐式氢）
+    float x = 0.0f;             // 坐标（仅MOL/SDF提供）
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+/**
+ * @brief 化学键
+ */
+struct Bond {
+    uint32_t begin = 0;     // 起始原子下标
+    uint32_t end = 0;       // 终止原子下标
+    uint8_t order = 1;      // 键级（1/2/3，芳香键为4）
+    bool inRing = false;    // 是否为环内键
+};
+
+/**
+ * @brief 芳香键的键级标记
+ */
+constexpr uint8_t AromaticBondOrder = 4;
+
+/**
+ * @brief 分子图
+ * 
+ * 以邻接表（CSR形式）存储原子和化学键，clear() 保留已分配容量，
+ * 便于批量处理时在每个线程内复用同一实例。
+ */
+class MolecularGraph {
+public:
+    std::vector<Atom> atoms;
+    std::vector<Bond> bonds;
+    bool hasCoordinates = false;    // 是否带有原子坐标
+    
+    /**
+     * @brief 清空分子但保留容量
+     */
+    void clear();
+    
+    /**
+     * @brief 原子的邻接键下标
+     * 
+     * @param atom 原子下标
+     * @return [起始指针, 结束指针)
+     */
+    const uint32_t* neighborBondsBegin(size_t atom) const { return m_adjacency.data() + m_adjacencyOffsets[atom]; }
+    const uint32_t* neighborBondsEnd(size_t atom) const { return m_adjacency.data() + m_adjacencyOffsets[atom + 1]; }
+    
+    /**
+     * @brief 原子的度（相连的键数）
+     */
+    size_t degree(size_t atom) const { return m_adjacencyOffsets[atom + 1] - m_adjacencyOffsets[atom]; }
+    
+    /**
+     * @brief 获取键另一端的原子
+     */
+    uint32_t otherAtom(uint32_t bond, uint32_t atom) const {
+        return bonds[bond].begin == atom ? bonds[bond].end : bonds[bond].begin;
+    }
+    
+    /**
+     * @brief 原子上的总氢数（隐式 + 显式 + 作为邻居原子的氢）
+     */
+    int totalHydrogens(size_t atom) const;
+    
+    /**
+     * @brief 连通分量数
+     */
+    size_t componentCount() const { return m_componentCount; }
+    
+    /**
+     * @brief 在原子和键填充完毕后建立邻接表、环键标记和隐式氢
+     */
+    void finalize();
+
+private:
+    void buildAdjacency();
+    void perceiveRingBonds();
+    void assignImplicitHydrogens();
+    
+    std::vector<uint32_t> m_adjacencyOffsets;
+    std::vector<uint32_t> m_adjacency;
+    size_t m_componentCount = 0;
+    
+    // perceiveRingBonds 的工作区，随实例复用
+    std::vector<uint32_t> m_discovery;
+    std::vector<uint32_t> m_low;
+    std::vector<uint32_t> m_stack;
+};
+
+/**
+ * @brief 分子解析器
+ * 
+ * 支持SMILES（含方括号原子、分支、环闭合、芳香原子）、MOL V2000/SDF记录和PDB坐标文件。
+ */
+class MoleculeParser {
+public:
+    /**
+     * @brief 解析SMILES
+     * 
+     * @param smiles SMILES字符串
+     * @param graph 输出分子图（会被清空）
+     * @return 是否成功
+     */
+    static bool parseSmiles(const std::string& smiles, MolecularGraph& graph);
+    
+    /**
+     * @brief 解析MOL V2000块（SDF记录取第一个分子）
+     * 
+     * @param molBlock MOL文本
+     * @param graph 输出分子图（会被清空）
+     * @return 是否成功
+     */
+    static bool parseMolBlock(const std::string& molBlock, MolecularGraph& graph);
+    
+    /**
+     * @brief 解析PDB（ATOM/HETATM记录，多模型时取第一个模型）
+     * 
+     * 有CONECT记录时按其建键，否则按原子间距推断化学键；键级一律为单键。
+     * 
+     * @param pdb PDB文本
+     * @param graph 输出分子图（会被清空）
+     * @return 是否成功
+     */
+    static bool parsePdb(const std::string& pdb, MolecularGraph& graph);
+    
+    /**
+     * @brief 根据数据格式自动选择解析方式
+     * 
+     * @param content 数据内容
+     * @param format 数据格式（SMILES/MOL/SDF/PDB，其他格式按内容判断）
+     * @param graph 输出分子图
+     * @return 是否成功
+     */
+    static bool parse(const std::string& content, const std::string& format, MolecularGraph& graph);
+};
+
+/**
+ * @brief 按有机子集默认价态推算隐式氢数
+ * 
+ * @param atomicNumber 原子序数
+ * @param charge 形式电荷
+ * @param aromatic 是否为带芳香键的芳香原子
+ * @param bondOrderSum 键级之和（芳香键按1计）
+ * @return 隐式氢数（非有机子集元素返回0）
+ */
+int defaultImplicitHydrogens(int atomicNumber, int charge, bool aromatic, int bondOrderSum);
+
+/**
+ * @brief 按原子序数查找元素信息
+ * 
+ * @param atomicNumber 原子序数
+ * @return 元素信息（未知元素返回nullptr）
+ */
+const ElementInfo* findElement(int atomicNumber);
+
+/**
+ * @brief 按元素符号查找元素信息
+ * 
+ * @param symbol 元素符号（区分大小写）
+ * @param length 符号长度
+ * @return 元素信息（未知元素返回nullptr）
+ */
+const ElementInfo* findElement(const char* symbol, size_t length);
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
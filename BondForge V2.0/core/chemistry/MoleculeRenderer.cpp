@@ -1,5 +1,9 @@
 #include "MoleculeRenderer.h"
+#include "MolecularGraph.h"
+#include "MoleculeView3D.h"
 #include <QGraphicsEllipseItem>
+#include <QGraphicsPixmapItem>
+#include <QImage>
 #include <QGraphicsLineItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsProxyWidget>
@@ -12,6 +16,32 @@ namespace BondForge {
 namespace Core {
 namespace Chemistry {
 
+namespace {
+
+/**
+ * @brief 用软件3D视图把带坐标的分子绘制为一张图片加入场景
+ * 
+ * 整个分子只产生一个场景图元，大分子也不会因逐原子创建图元而卡顿。
+ */
+bool addSoftware3DImage(QGraphicsScene* scene, const MolecularGraph& graph) {
+    MoleculeView3D view;
+    view.setViewport(700, 500);
+    if (!view.setMolecule(graph)) {
+        return false;
+    }
+    
+    const uint32_t* pixels = view.render();
+    QImage image(reinterpret_cast<const uchar*>(pixels), view.width(), view.height(),
+                 view.width() * 4, QImage::Format_ARGB32_Premultiplied);
+    
+    // fromImage 会复制像素，视图对象随后可以销毁
+    QGraphicsPixmapItem* item = scene->addPixmap(QPixmap::fromImage(image));
+    scene->setSceneRect(item->boundingRect());
+    return true;
+}
+
+} // namespace
+
 // SimpleMoleculeRenderer 实现
 bool SimpleMoleculeRenderer::renderMolecule(
     QGraphicsScene* scene, 
@@ -26,9 +56,16 @@ bool SimpleMoleculeRenderer::renderMolecule(
     // 清除现有内容
     scene->clear();
     
+    // 带坐标的结构（MOL/SDF/PDB）在3D模式下使用软件3D视图
+    MolecularGraph graph;
+    bool drawn3D = is3D && MoleculeParser::parse(record.content, record.format, graph) &&
+                   addSoftware3DImage(scene, graph);
+    
     // 简化的分子渲染（仅支持演示用）
     // 检测内容是否包含碳原子标识符，如果是则渲染一个简单的苯环结构
-    if (record.content.find("C") != std::string::npos || record.content.find("c") != std::string::npos) {
+    if (drawn3D) {
+        // 已由软件3D视图绘制
+    } else if (record.content.find("C") != std::string::npos || record.content.find("c") != std::string::npos) {
         renderSimpleBenzene(scene, is3D);
     } else {
         // 否则仅显示内容文本
@@ -224,9 +261,15 @@ void RDKitMoleculeRenderer::renderMolecule2D(QGraphicsScene* scene, RDKit::ROMol
 }
 
 void RDKitMoleculeRenderer::renderMolecule3D(QGraphicsScene* scene, RDKit::ROMol* mol) {
-    // 3D渲染实现（简化版）
-    // 实际应用中可以使用更高级的3D渲染
-    renderMolecule2D(scene, mol);  // 回退到2D渲染
+    // 有构象时经MOL块转换为分子图，交给软件3D视图绘制
+    if (mol->getNumConformers() > 0) {
+        MolecularGraph graph;
+        if (MoleculeParser::parseMolBlock(RDKit::MolToMolBlock(*mol), graph) && addSoftware3DImage(scene, graph)) {
+            return;
+        }
+    }
+    
+    renderMolecule2D(scene, mol);  // 没有坐标时回退到2D渲染
 }
 #endif
 
@@ -8,6 +8,7 @@
 #ifdef USE_RDKIT
 #include <GraphMol/MolDraw2D/MolDraw2DQt.h>
 #include <GraphMol/ROMol.h>
+#include <GraphMol/FileParsers/MolWriters.h>
 #endif
 
 namespace BondForge {
@@ -0,0 +1,505 @@
+#include "MoleculeView3D.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+// 细节层次阈值
+constexpr float kPointRadiusPx = 1.5f;          // 碳原子像素半径低于此值时只画点
+constexpr float kMinBondRadiusPx = 3.0f;        // 碳原子像素半径低于此值时不画键
+constexpr size_t kFullDetailAtoms = 3000;       // 可见原子数超过此值时不画键
+constexpr size_t kInteractiveFullDetailAtoms = 800;
+constexpr size_t kInteractivePointAtoms = 40000;
+
+constexpr int kBandHeight = 32;                 // 并行光栅化的条带高度（行）
+constexpr int kMaxSpriteRadius = 160;
+constexpr int kMaxBondSteps = 8192;
+constexpr size_t kMaxSortMovesPerItem = 16;     // 增量排序移动次数超过 n*此值 时改用完整排序
+constexpr size_t kRotateGrainSize = 4096;
+
+constexpr float kBondRadius = 0.15f;            // 键的显示半径（埃）
+
+// CPK配色
+enum PaletteIndex : uint8_t {
+    PaletteCarbon, PaletteHydrogen, PaletteNitrogen, PaletteOxygen, PaletteFluorine,
+    PaletteChlorine, PaletteBromine, PaletteIodine, PaletteSulfur, PalettePhosphorus,
+    PaletteMetal, PaletteOther, PaletteSize
+};
+
+const uint32_t kPalette[PaletteSize] = {
+    0xFF505050u, 0xFFE8E8E8u, 0xFF3050F8u, 0xFFFF0D0Du, 0xFF90E050u,
+    0xFF1FF01Fu, 0xFFA62929u, 0xFF940094u, 0xFFFFD030u, 0xFFFF8000u,
+    0xFF8080A0u, 0xFFFF1493u
+};
+
+uint8_t paletteIndex(int atomicNumber) {
+    switch (atomicNumber) {
+        case 6: return PaletteCarbon;
+        case 1: return PaletteHydrogen;
+        case 7: return PaletteNitrogen;
+        case 8: return PaletteOxygen;
+        case 9: return PaletteFluorine;
+        case 17: return PaletteChlorine;
+        case 35: return PaletteBromine;
+        case 53: return PaletteIodine;
+        case 16: return PaletteSulfur;
+        case 15: return PalettePhosphorus;
+        case 11: case 12: case 19: case 20: case 25: case 26: case 27:
+        case 28: case 29: case 30:
+            return PaletteMetal;
+        default: return PaletteOther;
+    }
+}
+
+/**
+ * @brief 球棍模型中原子的显示半径（埃）
+ */
+float displayRadius(int atomicNumber) {
+    switch (atomicNumber) {
+        case 1: return 0.25f;
+        case 6: return 0.40f;
+        case 7: return 0.38f;
+        case 8: return 0.36f;
+        case 9: return 0.35f;
+        case 15: case 16: case 17: return 0.50f;
+        case 35: return 0.52f;
+        case 53: return 0.58f;
+        default: return 0.45f;
+    }
+}
+
+/**
+ * @brief 预乘像素的 source-over 混合
+ */
+inline uint32_t blendOver(uint32_t src, uint32_t dst) {
+    uint32_t alpha = src >> 24;
+    if (alpha == 255) return src;
+    uint32_t inverse = 255 - alpha;
+    
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t s = (src >> shift) & 0xFF;
+        uint32_t d = (dst >> shift) & 0xFF;
+        uint32_t c = s + (d * inverse + 127) / 255;
+        result |= std::min<uint32_t>(c, 255) << shift;
+    }
+    return result;
+}
+
+inline uint32_t scaleColor(uint32_t argb, float factor) {
+    uint32_t r = static_cast<uint32_t>(std::min(255.0f, ((argb >> 16) & 0xFF) * factor));
+    uint32_t g = static_cast<uint32_t>(std::min(255.0f, ((argb >> 8) & 0xFF) * factor));
+    uint32_t b = static_cast<uint32_t>(std::min(255.0f, (argb & 0xFF) * factor));
+    return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+} // namespace
+
+MoleculeView3D::MoleculeView3D()
+    : m_sprites(PaletteSize) {
+}
+
+bool MoleculeView3D::setMolecule(const MolecularGraph& graph) {
+    if (!graph.hasCoordinates || graph.atoms.empty()) {
+        return false;
+    }
+    
+    m_atomCount = graph.atoms.size();
+    m_x.resize(m_atomCount);
+    m_y.resize(m_atomCount);
+    m_z.resize(m_atomCount);
+    m_radius.resize(m_atomCount);
+    m_color.resize(m_atomCount);
+    
+    float minX = graph.atoms[0].x, maxX = minX;
+    float minY = graph.atoms[0].y, maxY = minY;
+    float minZ = graph.atoms[0].z, maxZ = minZ;
+    for (const Atom& atom : graph.atoms) {
+        minX = std::min(minX, atom.x); maxX = std::max(maxX, atom.x);
+        minY = std::min(minY, atom.y); maxY = std::max(maxY, atom.y);
+        minZ = std::min(minZ, atom.z); maxZ = std::max(maxZ, atom.z);
+    }
+    
+    // 平移到包围盒中心，旋转时分子绕自身中心转动
+    float centerX = (minX + maxX) * 0.5f;
+    float centerY = (minY + maxY) * 0.5f;
+    float centerZ = (minZ + maxZ) * 0.5f;
+    
+    float boundingRadius = 0.0f;
+    for (size_t i = 0; i < m_atomCount; ++i) {
+        const Atom& atom = graph.atoms[i];
+        m_x[i] = atom.x - centerX;
+        m_y[i] = atom.y - centerY;
+        m_z[i] = atom.z - centerZ;
+        m_radius[i] = displayRadius(atom.atomicNumber);
+        m_color[i] = paletteIndex(atom.atomicNumber);
+        
+        float distance = std::sqrt(m_x[i] * m_x[i] + m_y[i] * m_y[i] + m_z[i] * m_z[i]);
+        boundingRadius = std::max(boundingRadius, distance + m_radius[i]);
+    }
+    m_boundingRadius = std::max(boundingRadius, 1.0f);
+    
+    m_bondAtoms.resize(graph.bonds.size() * 2);
+    for (size_t b = 0; b < graph.bonds.size(); ++b) {
+        m_bondAtoms[b * 2] = graph.bonds[b].begin;
+        m_bondAtoms[b * 2 + 1] = graph.bonds[b].end;
+    }
+    
+    size_t primitiveCount = m_atomCount + graph.bonds.size();
+    m_rx.resize(m_atomCount);
+    m_ry.resize(m_atomCount);
+    m_sx.resize(m_atomCount);
+    m_sy.resize(m_atomCount);
+    m_radiusPx.resize(m_atomCount);
+    m_depth.resize(primitiveCount);
+    m_order.clear();
+    
+    m_orderValid = false;
+    m_rotationDirty = true;
+    m_frameDirty = true;
+    return true;
+}
+
+void MoleculeView3D::setViewport(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == m_width && height == m_height) return;
+    
+    m_width = width;
+    m_height = height;
+    m_frameDirty = true;
+}
+
+void MoleculeView3D::setRotation(float yawDegrees, float pitchDegrees) {
+    if (yawDegrees == m_yaw && pitchDegrees == m_pitch) return;
+    
+    m_yaw = yawDegrees;
+    m_pitch = pitchDegrees;
+    m_rotationDirty = true;
+}
+
+void MoleculeView3D::setZoom(float zoom) {
+    zoom = std::max(zoom, 0.01f);
+    if (zoom == m_zoom) return;
+    
+    // 正交投影下缩放不改变深度顺序，只需重新光栅化
+    m_zoom = zoom;
+    m_frameDirty = true;
+}
+
+void MoleculeView3D::setBackground(uint32_t argb) {
+    if (argb == m_background) return;
+    
+    m_background = argb;
+    m_frameDirty = true;
+}
+
+void MoleculeView3D::setInteractive(bool interactive) {
+    if (interactive == m_interactive) return;
+    
+    m_interactive = interactive;
+    m_frameDirty = true;
+}
+
+const uint32_t* MoleculeView3D::render() {
+    if (m_atomCount == 0) {
+        return nullptr;
+    }
+    
+    m_statistics.sortMoves = 0;
+    m_statistics.fullSort = false;
+    
+    if (m_rotationDirty) {
+        rotate();
+        sortByDepth();
+        m_rotationDirty = false;
+        m_frameDirty = true;
+    }
+    
+    if (!m_frameDirty && m_frame.size() == static_cast<size_t>(m_width) * m_height) {
+        return m_frame.data();
+    }
+    
+    m_frame.resize(static_cast<size_t>(m_width) * m_height);
+    
+    // 正交投影：scale 为每埃对应的像素数，zoom=1 时包围球充满较短的视口边
+    float scale = std::min(m_width, m_height) * 0.5f * 0.92f / m_boundingRadius * m_zoom;
+    float halfWidth = m_width * 0.5f;
+    float halfHeight = m_height * 0.5f;
+    
+    size_t visibleAtoms = 0;
+    for (size_t i = 0; i < m_atomCount; ++i) {
+        float sx = halfWidth + m_rx[i] * scale;
+        float sy = halfHeight - m_ry[i] * scale;
+        float r = m_radius[i] * scale;
+        m_sx[i] = sx;
+        m_sy[i] = sy;
+        
+        bool onScreen = sx + r >= 0.0f && sx - r < m_width && sy + r >= 0.0f && sy - r < m_height;
+        if (onScreen) {
+            int radius = static_cast<int>(r + 0.5f);
+            m_radiusPx[i] = static_cast<uint16_t>(std::min(std::max(radius, 1), kMaxSpriteRadius));
+            ++visibleAtoms;
+        } else {
+            m_radiusPx[i] = 0;
+        }
+    }
+    
+    DetailLevel level = chooseDetailLevel(scale, visibleAtoms);
+    
+    // 贴图在光栅化之前串行生成，条带线程只读
+    if (level != DetailLevel::Points) {
+        for (size_t i = 0; i < m_atomCount; ++i) {
+            if (m_radiusPx[i] > 0) {
+                prepareSprite(m_color[i], m_radiusPx[i]);
+            }
+        }
+    }
+    
+    int bondHalfWidth = std::min(6, std::max(0, static_cast<int>(kBondRadius * scale)));
+    int bandCount = (m_height + kBandHeight - 1) / kBandHeight;
+    Utils::ThreadPool::instance().parallelFor(0, static_cast<size_t>(bandCount), 1,
+        [this, bondHalfWidth, level](size_t begin, size_t end) {
+            for (size_t band = begin; band < end; ++band) {
+                int rowBegin = static_cast<int>(band) * kBandHeight;
+                int rowEnd = std::min(rowBegin + kBandHeight, m_height);
+                rasterizeBand(rowBegin, rowEnd, bondHalfWidth, level);
+            }
+        });
+    
+    m_statistics.level = level;
+    m_statistics.visibleAtoms = visibleAtoms;
+    m_statistics.drawnBonds = level == DetailLevel::Full ? m_bondAtoms.size() / 2 : 0;
+    m_frameDirty = false;
+    return m_frame.data();
+}
+
+void MoleculeView3D::rotate() {
+    float yaw = m_yaw * kPi / 180.0f;
+    float pitch = m_pitch * kPi / 180.0f;
+    float cosYaw = std::cos(yaw), sinYaw = std::sin(yaw);
+    float cosPitch = std::cos(pitch), sinPitch = std::sin(pitch);
+    
+    // 先绕y轴偏航，再绕x轴俯仰；z轴朝向观察者
+    Utils::ThreadPool::instance().parallelFor(0, m_atomCount, kRotateGrainSize,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                float x = cosYaw * m_x[i] + sinYaw * m_z[i];
+                float z = -sinYaw * m_x[i] + cosYaw * m_z[i];
+                m_rx[i] = x;
+                m_ry[i] = cosPitch * m_y[i] - sinPitch * z;
+                m_depth[i] = sinPitch * m_y[i] + cosPitch * z;
+            }
+        });
+    
+    size_t bondCount = m_bondAtoms.size() / 2;
+    for (size_t b = 0; b < bondCount; ++b) {
+        m_depth[m_atomCount + b] = (m_depth[m_bondAtoms[b * 2]] + m_depth[m_bondAtoms[b * 2 + 1]]) * 0.5f;
+    }
+}
+
+void MoleculeView3D::sortByDepth() {
+    const std::vector<float>& depth = m_depth;
+    auto farther = [&depth](uint32_t a, uint32_t b) {
+        return depth[a] < depth[b] || (depth[a] == depth[b] && a < b);
+    };
+    
+    if (!m_orderValid || m_order.size() != depth.size()) {
+        m_order.resize(depth.size());
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        std::sort(m_order.begin(), m_order.end(), farther);
+        m_orderValid = true;
+        m_statistics.fullSort = true;
+        return;
+    }
+    
+    // 上一帧的顺序在小角度旋转后几乎有序，插入排序接近线性
+    size_t moves = 0;
+    size_t limit = m_order.size() * kMaxSortMovesPerItem;
+    for (size_t i = 1; i < m_order.size(); ++i) {
+        uint32_t key = m_order[i];
+        size_t j = i;
+        while (j > 0 && farther(key, m_order[j - 1])) {
+            m_order[j] = m_order[j - 1];
+            --j;
+        }
+        m_order[j] = key;
+        moves += i - j;
+        
+        if (moves > limit) {
+            // 大角度跳转：放弃增量排序
+            std::sort(m_order.begin(), m_order.end(), farther);
+            m_statistics.fullSort = true;
+            break;
+        }
+    }
+    m_statistics.sortMoves = moves;
+}
+
+DetailLevel MoleculeView3D::chooseDetailLevel(float scale, size_t visibleAtoms) const {
+    float carbonRadiusPx = displayRadius(6) * scale;
+    
+    if (carbonRadiusPx < kPointRadiusPx) {
+        return DetailLevel::Points;
+    }
+    if (m_interactive && visibleAtoms > kInteractivePointAtoms) {
+        return DetailLevel::Points;
+    }
+    
+    size_t fullLimit = m_interactive ? kInteractiveFullDetailAtoms : kFullDetailAtoms;
+    if (visibleAtoms > fullLimit || carbonRadiusPx < kMinBondRadiusPx) {
+        return DetailLevel::Spheres;
+    }
+    return DetailLevel::Full;
+}
+
+void MoleculeView3D::prepareSprite(uint8_t color, int radius) {
+    std::vector<Sprite>& sprites = m_sprites[color];
+    if (sprites.size() <= static_cast<size_t>(radius)) {
+        sprites.resize(radius + 1);
+    }
+    Sprite& sprite = sprites[radius];
+    if (sprite.radius == radius) return;
+    
+    // 左上方光源的Lambert漫反射 + Blinn高光，边缘一个像素做覆盖率抗锯齿
+    const float lightX = -0.45f, lightY = 0.55f, lightZ = 0.70f;
+    const float lightLength = std::sqrt(lightX * lightX + lightY * lightY + lightZ * lightZ);
+    const float lx = lightX / lightLength, ly = lightY / lightLength, lz = lightZ / lightLength;
+    const float hLength = std::sqrt(lx * lx + ly * ly + (lz + 1.0f) * (lz + 1.0f));
+    const float hx = lx / hLength, hy = ly / hLength, hz = (lz + 1.0f) / hLength;
+    
+    uint32_t base = kPalette[color];
+    float baseR = static_cast<float>((base >> 16) & 0xFF);
+    float baseG = static_cast<float>((base >> 8) & 0xFF);
+    float baseB = static_cast<float>(base & 0xFF);
+    
+    int size = radius * 2 + 1;
+    float outer = radius + 0.5f;
+    sprite.radius = radius;
+    sprite.pixels.assign(static_cast<size_t>(size) * size, 0u);
+    
+    for (int dy = -radius; dy <= radius; ++dy) {
+        for (int dx = -radius; dx <= radius; ++dx) {
+            float distance = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+            float coverage = std::min(1.0f, outer - distance);
+            if (coverage <= 0.0f) continue;
+            
+            float nx = dx / outer;
+            float ny = -dy / outer;
+            float nz = std::sqrt(std::max(0.0f, 1.0f - nx * nx - ny * ny));
+            
+            float diffuse = std::max(0.0f, nx * lx + ny * ly + nz * lz);
+            float specular = std::pow(std::max(0.0f, nx * hx + ny * hy + nz * hz), 24.0f) * 0.45f;
+            float intensity = 0.25f + 0.75f * diffuse;
+            
+            float r = std::min(255.0f, baseR * intensity + 255.0f * specular) * coverage;
+            float g = std::min(255.0f, baseG * intensity + 255.0f * specular) * coverage;
+            float b = std::min(255.0f, baseB * intensity + 255.0f * specular) * coverage;
+            uint32_t alpha = static_cast<uint32_t>(255.0f * coverage + 0.5f);
+            
+            sprite.pixels[static_cast<size_t>(dy + radius) * size + (dx + radius)] =
+                (alpha << 24) |
+                (static_cast<uint32_t>(r + 0.5f) << 16) |
+                (static_cast<uint32_t>(g + 0.5f) << 8) |
+                static_cast<uint32_t>(b + 0.5f);
+        }
+    }
+}
+
+void MoleculeView3D::rasterizeBand(int rowBegin, int rowEnd, int bondHalfWidth, DetailLevel level) {
+    std::fill(m_frame.begin() + static_cast<size_t>(rowBegin) * m_width,
+              m_frame.begin() + static_cast<size_t>(rowEnd) * m_width,
+              m_background);
+    
+    for (uint32_t primitive : m_order) {
+        if (primitive >= m_atomCount) {
+            if (level == DetailLevel::Full) {
+                drawBond(primitive - static_cast<uint32_t>(m_atomCount), bondHalfWidth, rowBegin, rowEnd);
+            }
+            continue;
+        }
+        
+        int radius = m_radiusPx[primitive];
+        if (radius == 0) continue;
+        
+        int cx = static_cast<int>(std::floor(m_sx[primitive]));
+        int cy = static_cast<int>(std::floor(m_sy[primitive]));
+        
+        if (level == DetailLevel::Points) {
+            if (cy < rowBegin || cy >= rowEnd || cx < 0 || cx >= m_width) continue;
+            // 远处的点略暗，提供深度提示
+            float depth = 0.5f + 0.5f * m_depth[primitive] / m_boundingRadius;
+            m_frame[static_cast<size_t>(cy) * m_width + cx] = scaleColor(kPalette[m_color[primitive]], 0.55f + 0.45f * depth);
+            continue;
+        }
+        
+        if (cy + radius < rowBegin || cy - radius >= rowEnd) continue;
+        drawSprite(m_sprites[m_color[primitive]][radius], cx, cy, rowBegin, rowEnd);
+    }
+}
+
+void MoleculeView3D::drawSprite(const Sprite& sprite, int cx, int cy, int rowBegin, int rowEnd) {
+    int radius = sprite.radius;
+    int size = radius * 2 + 1;
+    int yBegin = std::max(cy - radius, rowBegin);
+    int yEnd = std::min(cy + radius + 1, rowEnd);
+    int xBegin = std::max(cx - radius, 0);
+    int xEnd = std::min(cx + radius + 1, m_width);
+    
+    for (int y = yBegin; y < yEnd; ++y) {
+        const uint32_t* source = sprite.pixels.data() + static_cast<size_t>(y - cy + radius) * size + (xBegin - cx + radius);
+        uint32_t* target = m_frame.data() + static_cast<size_t>(y) * m_width + xBegin;
+        for (int x = xBegin; x < xEnd; ++x, ++source, ++target) {
+            uint32_t pixel = *source;
+            if (pixel == 0) continue;
+            *target = blendOver(pixel, *target);
+        }
+    }
+}
+
+void MoleculeView3D::drawBond(uint32_t bond, int halfWidth, int rowBegin, int rowEnd) {
+    uint32_t a = m_bondAtoms[bond * 2];
+    uint32_t b = m_bondAtoms[bond * 2 + 1];
+    if (m_radiusPx[a] == 0 && m_radiusPx[b] == 0) return;
+    
+    float x0 = m_sx[a], y0 = m_sy[a];
+    float x1 = m_sx[b], y1 = m_sy[b];
+    if (std::max(y0, y1) + halfWidth < rowBegin || std::min(y0, y1) - halfWidth >= rowEnd) return;
+    
+    // 两半分别用两端原子的颜色，稍暗于原子本身
+    uint32_t colorA = scaleColor(kPalette[m_color[a]], 0.85f);
+    uint32_t colorB = scaleColor(kPalette[m_color[b]], 0.85f);
+    
+    int steps = static_cast<int>(std::ceil(std::max(std::fabs(x1 - x0), std::fabs(y1 - y0))));
+    steps = std::min(std::max(steps, 1), kMaxBondSteps);
+    float stepX = (x1 - x0) / steps;
+    float stepY = (y1 - y0) / steps;
+    
+    for (int s = 0; s <= steps; ++s) {
+        int x = static_cast<int>(std::floor(x0 + stepX * s));
+        int y = static_cast<int>(std::floor(y0 + stepY * s));
+        uint32_t color = s * 2 <= steps ? colorA : colorB;
+        
+        int yBegin = std::max(y - halfWidth, rowBegin);
+        int yEnd = std::min(y + halfWidth + 1, rowEnd);
+        int xBegin = std::max(x - halfWidth, 0);
+        int xEnd = std::min(x + halfWidth + 1, m_width);
+        if (xBegin >= xEnd) continue;
+        for (int py = yBegin; py < yEnd; ++py) {
+            uint32_t* row = m_frame.data() + static_cast<size_t>(py) * m_width;
+            std::fill(row + xBegin, row + xEnd, color);
+        }
+    }
+}
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
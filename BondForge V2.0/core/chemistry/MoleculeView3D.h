@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "MolecularGraph.h"
+
+namespace BondForge {
+namespace Core {
+namespace Chemistry {
+
+/**
+ * @brief 3D视图的细节层次
+ */
+enum class DetailLevel {
+    Full,       // 着色球体 + 化学键
+    Spheres,    // 着色球体，不画化学键
+    Points      // 每个原子一个像素点
+};
+
+/**
+ * @brief 最近一帧的绘制统计
+ */
+struct ViewStatistics {
+    DetailLevel level = DetailLevel::Full;
+    size_t visibleAtoms = 0;    // 落在视口内的原子数
+    size_t drawnBonds = 0;      // 绘制的化学键数
+    size_t sortMoves = 0;       // 增量深度排序的移动次数
+    bool fullSort = false;      // 本帧是否退回完整排序
+};
+
+/**
+ * @brief 软件3D分子视图
+ * 
+ * 不依赖GPU和场景图：所有原子和键按深度排序后批量光栅化到一块ARGB32帧缓冲，
+ * 由调用方一次性包装为QImage显示。细节层次按缩放后的原子像素半径和可见原子数自动选择。
+ * 
+ * 旋转只重新计算旋转后的坐标，并在上一帧的深度顺序上做插入排序（小角度旋转时几乎有序）；
+ * 缩放和背景色变化不改变深度顺序，只重新光栅化。光栅化按水平条带分给线程池并行执行。
+ */
+class MoleculeView3D {
+public:
+    MoleculeView3D();
+    
+    /**
+     * @brief 设置要显示的分子
+     * 
+     * @param graph 带坐标的分子图（hasCoordinates 为 false 时拒绝）
+     * @return 是否成功
+     */
+    bool setMolecule(const MolecularGraph& graph);
+    
+    /**
+     * @brief 设置视口大小（像素）
+     */
+    void setViewport(int width, int height);
+    
+    /**
+     * @brief 设置旋转角度（绕竖直轴的偏航角和绕水平轴的俯仰角，单位为度）
+     */
+    void setRotation(float yawDegrees, float pitchDegrees);
+    
+    /**
+     * @brief 设置缩放倍数（1.0 表示整个分子恰好充满视口）
+     */
+    void setZoom(float zoom);
+    
+    /**
+     * @brief 设置背景色（0xAARRGGBB）
+     */
+    void setBackground(uint32_t argb);
+    
+    /**
+     * @brief 交互模式（拖动滑块期间）下使用更低的细节层次以保证帧率
+     */
+    void setInteractive(bool interactive);
+    
+    /**
+     * @brief 按需重绘并返回帧缓冲
+     * 
+     * 帧缓冲为 width*height 个预乘 ARGB32 像素（与 QImage::Format_ARGB32_Premultiplied 布局一致），
+     * 在下一次修改视图参数之前保持有效。
+     * 
+     * @return 帧缓冲首地址（未设置分子时返回nullptr）
+     */
+    const uint32_t* render();
+    
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t atomCount() const { return m_atomCount; }
+    bool isEmpty() const { return m_atomCount == 0; }
+    
+    /**
+     * @brief 最近一帧的绘制统计
+     */
+    const ViewStatistics& statistics() const { return m_statistics; }
+
+private:
+    struct Sprite {
+        int radius = 0;
+        std::vector<uint32_t> pixels;   // (2r+1)^2 个预乘像素，透明处为0
+    };
+    
+    void rotate();
+    void sortByDepth();
+    DetailLevel chooseDetailLevel(float scale, size_t visibleAtoms) const;
+    void prepareSprite(uint8_t color, int radius);
+    void rasterizeBand(int rowBegin, int rowEnd, int bondHalfWidth, DetailLevel level);
+    void drawSprite(const Sprite& sprite, int cx, int cy, int rowBegin, int rowEnd);
+    void drawBond(uint32_t bond, int halfWidth, int rowBegin, int rowEnd);
+    
+    // 原子（结构数组，已平移到包围球中心）
+    size_t m_atomCount = 0;
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_radius;            // 显示半径（埃）
+    std::vector<uint8_t> m_color;           // 调色板下标
+    std::vector<uint32_t> m_bondAtoms;      // 每条键两个原子下标
+    float m_boundingRadius = 1.0f;
+    
+    // 旋转后的坐标（图元0..n-1为原子，n..为化学键，m_depth按图元存储）
+    std::vector<float> m_rx, m_ry;
+    std::vector<float> m_depth;
+    std::vector<uint32_t> m_order;          // 由远到近的图元顺序，跨帧复用
+    
+    // 当前缩放下的屏幕坐标和像素半径（半径为0表示不在视口内）
+    std::vector<float> m_sx, m_sy;
+    std::vector<uint16_t> m_radiusPx;
+    
+    // 视图参数
+    int m_width = 640;
+    int m_height = 480;
+    float m_yaw = 0.0f;
+    float m_pitch = 0.0f;
+    float m_zoom = 1.0f;
+    uint32_t m_background = 0xFFFFFFFFu;
+    bool m_interactive = false;
+    
+    bool m_rotationDirty = true;
+    bool m_frameDirty = true;
+    bool m_orderValid = false;
+    
+    // 帧缓冲与球体贴图缓存（按颜色和像素半径）
+    std::vector<uint32_t> m_frame;
+    std::vector<std::vector<Sprite>> m_sprites;
+    ViewStatistics m_statistics;
+};
+
+} // namespace Chemistry
+} // namespace Core
+} // namespace BondForge
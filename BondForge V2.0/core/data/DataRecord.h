@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <sstream>
 #include <unordered_set>
 #include <cstdint>
 
@@ -21,6 +22,7 @@ struct DataRecord {
     std::string category;          // 数据分类
     std::string uploader;          // 上传用户
     uint64_t timestamp;            // 上传时间戳
+    std::string structureKey;      // 结构键（规范SMILES的哈希，非结构数据为空）
     
     /**
      * @brief 序列化标签为字符串
@@ -1,61 +1,134 @@
 #include "DataService.h"
+#include "../../utils/ThreadPool.h"
 #include <algorithm>
 
 namespace BondForge {
 namespace Core {
 namespace Data {
 
+namespace {
+
+/**
+ * @brief 由内容重新计算结构键（在加锁之前调用，避免持锁做规范化）
+ * 
+ * 调用者提供的结构键不可信（可能过时或伪造，会破坏结构索引和查重），总是按内容重算；
+ * 非结构格式的记录结构键为空。
+ */
+DataRecord withStructureKey(const DataRecord& record) {
+    DataRecord result = record;
+    result.structureKey.clear();
+    if (Chemistry::Canonicalizer::isStructureFormat(result.format)) {
+        Chemistry::StructureKey key = Chemistry::Canonicalizer::computeKey(result.content, result.format);
+        if (!key.isNull()) {
+            result.structureKey = key.toHex();
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 待补算结构键的记录（在共享锁下复制，规范化时不持锁）
+ */
+struct PendingKey {
+    std::string id;
+    std::string content;
+    std::string format;
+    std::string structureKey;
+};
+
+/**
+ * @brief 全局递增的版本计数器（各实例共用，版本号不会在实例之间重复）
+ */
+uint64_t nextDataVersion() {
+    static std::atomic<uint64_t> counter(0);
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+} // namespace
+
+DataService::DataService() : m_version(nextDataVersion()) {
+}
+
 bool DataService::addData(const DataRecord& record) {
-    std::unique_lock<std::shared_mutex> lock(m_mutex);
-    
-    // 检查ID是否已存在
-    auto it = std::find_if(m_records.begin(), m_records.end(),
-        [&record](const DataRecord& r) { return r.id == record.id; });
+    DataRecord keyed = withStructureKey(record);
+    bool notify = false;
+    uint64_t version = 0;
     
-    if (it != m_records.end()) {
-        return false; // ID已存在
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        
+        // 检查ID是否已存在
+        if (m_idIndex.count(keyed.id) > 0) {
+            return false; // ID已存在
+        }
+        
+        // 在数据锁下读取：订阅返回之后的插入一定会通知
+        notify = m_hasListeners;
+        m_idIndex[keyed.id] = m_records.size();
+        if (notify) {
+            m_records.push_back(keyed);     // 保留副本用于通知
+        } else {
+            m_records.push_back(std::move(keyed));
+        }
+        indexStructure(m_records.back());
+        bumpVersion();
+        version = m_version.load(std::memory_order_relaxed);
     }
     
-    m_records.push_back(record);
+    if (notify) {
+        notifyInsertion(keyed, version);
+    }
     return true;
 }
 
 bool DataService::deleteData(const std::string& id) {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
     
-    auto it = std::find_if(m_records.begin(), m_records.end(),
-        [&id](const DataRecord& r) { return r.id == id; });
+    auto indexIt = m_idIndex.find(id);
+    if (indexIt == m_idIndex.end()) {
+        return false; // 未找到
+    }
+    
+    size_t position = indexIt->second;
+    unindexStructure(m_records[position]);
+    m_idIndex.erase(indexIt);
     
-    if (it != m_records.end()) {
-        m_records.erase(it);
-        return true;
+    // 最后一条记录移入空位，只需更新它一条的下标
+    if (position + 1 != m_records.size()) {
+        m_records[position] = std::move(m_records.back());
+        m_idIndex[m_records[position].id] = position;
     }
+    m_records.pop_back();
     
-    return false; // 未找到
+    bumpVersion();
+    return true;
 }
 
 bool DataService::updateData(const DataRecord& record) {
-    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    // 内容可能已变化，总是重新计算结构键
+    DataRecord keyed = withStructureKey(record);
     
-    auto it = std::find_if(m_records.begin(), m_records.end(),
-        [&record](const DataRecord& r) { return r.id == record.id; });
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
     
-    if (it != m_records.end()) {
-        *it = record;
-        return true;
+    auto indexIt = m_idIndex.find(keyed.id);
+    if (indexIt == m_idIndex.end()) {
+        return false; // 未找到
     }
     
-    return false; // 未找到
+    DataRecord& existing = m_records[indexIt->second];
+    unindexStructure(existing);
+    existing = std::move(keyed);
+    indexStructure(existing);
+    bumpVersion();
+    return true;
 }
 
 std::unique_ptr<DataRecord> DataService::getData(const std::string& id) {
     std::shared_lock<std::shared_mutex> lock(m_mutex);
     
-    auto it = std::find_if(m_records.begin(), m_records.end(),
-        [&id](const DataRecord& r) { return r.id == id; });
-    
-    if (it != m_records.end()) {
-        return std::make_unique<DataRecord>(*it);
+    auto indexIt = m_idIndex.find(id);
+    if (indexIt != m_idIndex.end()) {
+        return std::make_unique<DataRecord>(m_records[indexIt->second]);
     }
     
     return nullptr; // 未找到
@@ -66,6 +139,20 @@ std::vector<DataRecord> DataService::getAllData() {
     return m_records; // 返回副本
 }
 
+size_t DataService::getDataCount() {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_records.size();
+}
+
+std::vector<DataRecord> DataService::getDataRange(size_t offset, size_t limit) {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (offset >= m_records.size()) {
+        return {};
+    }
+    size_t end = offset + std::min(limit, m_records.size() - offset);
+    return std::vector<DataRecord>(m_records.begin() + offset, m_records.begin() + end);
+}
+
 std::vector<DataRecord> DataService::queryData(
     const std::string& category,
     const std::unordered_set<std::string>& tags) {
@@ -103,6 +190,166 @@ std::vector<DataRecord> DataService::queryData(
     return result;
 }
 
+std::vector<DataRecord> DataService::findByStructure(
+    const std::string& content,
+    const std::string& format) {
+    
+    Chemistry::StructureKey key = Chemistry::Canonicalizer::computeKey(content, format);
+    if (key.isNull()) {
+        return {};
+    }
+    
+    return findByStructureKey(key);
+}
+
+std::vector<DataRecord> DataService::findByStructureKey(const Chemistry::StructureKey& key) {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return recordsForKey(key);
+}
+
+std::vector<std::vector<std::string>> DataService::findDuplicateStructures() {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<std::vector<std::string>> duplicates;
+    
+    for (const auto& entry : m_structureIndex) {
+        if (entry.second.size() > 1) {
+            duplicates.push_back(entry.second);
+        }
+    }
+    
+    return duplicates;
+}
+
+size_t DataService::backfillStructureKeys() {
+    // 在共享锁下复制待补算的记录，读取者不被阻塞
+    std::vector<PendingKey> pending;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        for (const DataRecord& record : m_records) {
+            if (record.structureKey.empty() && Chemistry::Canonicalizer::isStructureFormat(record.format)) {
+                pending.push_back({record.id, record.content, record.format, std::string()});
+            }
+        }
+    }
+    if (pending.empty()) {
+        return 0;
+    }
+    
+    // 不持锁并行规范化，每个元素只被一个线程写入
+    Utils::ThreadPool::instance().parallelFor(0, pending.size(), 256,
+        [&pending](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Chemistry::StructureKey key =
+                    Chemistry::Canonicalizer::computeKey(pending[i].content, pending[i].format);
+                if (!key.isNull()) {
+                    pending[i].structureKey = key.toHex();
+                }
+            }
+        });
+    
+    // 持写锁只写回结构键并建立索引；期间已删除、已修改或已有结构键的记录跳过
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    size_t filled = 0;
+    for (const PendingKey& item : pending) {
+        if (item.structureKey.empty()) {
+            continue;
+        }
+        auto indexIt = m_idIndex.find(item.id);
+        if (indexIt == m_idIndex.end()) {
+            continue;
+        }
+        DataRecord& record = m_records[indexIt->second];
+        if (!record.structureKey.empty() || record.content != item.content || record.format != item.format) {
+            continue;
+        }
+        record.structureKey = item.structureKey;
+        indexStructure(record);
+        ++filled;
+    }
+    
+    return filled;
+}
+
+uint64_t DataService::getDataVersion() {
+    return m_version.load(std::memory_order_acquire);
+}
+
+void DataService::bumpVersion() {
+    m_version.store(nextDataVersion(), std::memory_order_release);
+}
+
+uint64_t DataService::subscribeInsertions(InsertionListener listener) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    uint64_t subscription = m_nextSubscription++;
+    m_insertionListeners.emplace_back(subscription, std::move(listener));
+    
+    std::unique_lock<std::shared_mutex> dataLock(m_mutex);
+    m_hasListeners = true;
+    return subscription;
+}
+
+void DataService::unsubscribeInsertions(uint64_t subscription) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_insertionListeners.erase(
+        std::remove_if(m_insertionListeners.begin(), m_insertionListeners.end(),
+                       [subscription](const auto& entry) { return entry.first == subscription; }),
+        m_insertionListeners.end());
+    
+    std::unique_lock<std::shared_mutex> dataLock(m_mutex);
+    m_hasListeners = !m_insertionListeners.empty();
+}
+
+void DataService::notifyInsertion(const DataRecord& record, uint64_t version) {
+    // 通知期间持有监听锁：取消订阅返回后不会再有进行中的回调
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (const auto& entry : m_insertionListeners) {
+        try {
+            entry.second(record, version);
+        } catch (...) {
+            // 记录已经插入，监听函数的异常不影响 addData() 的结果和其他监听函数
+        }
+    }
+}
+
+void DataService::indexStructure(const DataRecord& record) {
+    Chemistry::StructureKey key = Chemistry::StructureKey::fromHex(record.structureKey);
+    if (!key.isNull()) {
+        m_structureIndex[key].push_back(record.id);
+    }
+}
+
+void DataService::unindexStructure(const DataRecord& record) {
+    Chemistry::StructureKey key = Chemistry::StructureKey::fromHex(record.structureKey);
+    auto it = m_structureIndex.find(key);
+    if (it == m_structureIndex.end()) {
+        return;
+    }
+    
+    auto& ids = it->second;
+    ids.erase(std::remove(ids.begin(), ids.end(), record.id), ids.end());
+    if (ids.empty()) {
+        m_structureIndex.erase(it);
+    }
+}
+
+std::vector<DataRecord> DataService::recordsForKey(const Chemistry::StructureKey& key) const {
+    std::vector<DataRecord> result;
+    
+    auto it = m_structureIndex.find(key);
+    if (it == m_structureIndex.end()) {
+        return result;
+    }
+    
+    for (const auto& id : it->second) {
+        auto indexIt = m_idIndex.find(id);
+        if (indexIt != m_idIndex.end()) {
+            result.push_back(m_records[indexIt->second]);
+        }
+    }
+    
+    return result;
+}
+
 } // namespace Data
 } // namespace Core
-} // namespace BondForge
\ No newline at end of file
+} // namespace BondForge
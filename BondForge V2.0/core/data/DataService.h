@@ -1,9 +1,15 @@
 #pragma once
 
 #include "DataRecord.h"
+#include "../chemistry/Canonicalizer.h"
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 
 namespace BondForge {
 namespace Core {
@@ -21,6 +27,8 @@ public:
     /**
      * @brief 添加数据记录
      * 
+     * 结构键总是由内容重新计算，忽略调用者提供的值。
+     * 
      * @param record 要添加的数据记录
      * @return 是否成功
      */
@@ -57,6 +65,22 @@ public:
      */
     virtual std::vector<DataRecord> getAllData() = 0;
     
+    /**
+     * @brief 获取数据记录总数
+     * 
+     * @return 记录数
+     */
+    virtual size_t getDataCount() = 0;
+    
+    /**
+     * @brief 按存储顺序分页获取数据记录（用于逐块遍历全部数据而不一次性复制）
+     * 
+     * @param offset 起始位置
+     * @param limit 最多返回的记录数
+     * @return 从 offset 开始的至多 limit 条记录（offset 超出范围时为空）
+     */
+    virtual std::vector<DataRecord> getDataRange(size_t offset, size_t limit) = 0;
+    
     /**
      * @brief 根据条件查询数据记录
      * 
@@ -67,6 +91,79 @@ public:
     virtual std::vector<DataRecord> queryData(
         const std::string& category = "",
         const std::unordered_set<std::string>& tags = {}) = 0;
+    
+    /**
+     * @brief 按分子结构精确查找（与SMILES写法无关）
+     * 
+     * @param content 分子数据（SMILES或MOL块）
+     * @param format 数据格式
+     * @return 结构相同的数据记录列表
+     */
+    virtual std::vector<DataRecord> findByStructure(
+        const std::string& content,
+        const std::string& format) = 0;
+    
+    /**
+     * @brief 按结构键查找
+     * 
+     * @param key 结构键
+     * @return 结构相同的数据记录列表
+     */
+    virtual std::vector<DataRecord> findByStructureKey(const Chemistry::StructureKey& key) = 0;
+    
+    /**
+     * @brief 查找结构重复的记录
+     * 
+     * @return 每组为结构相同的记录ID（仅包含两条及以上的组）
+     */
+    virtual std::vector<std::vector<std::string>> findDuplicateStructures() = 0;
+    
+    /**
+     * @brief 为尚无结构键的记录并行补算结构键并建立索引
+     * 
+     * 规范化不持有数据锁，期间读写照常进行；写回时跳过已被删除或修改的记录。
+     * 
+     * @return 补算的记录数
+     */
+    virtual size_t backfillStructureKeys() = 0;
+    
+    /**
+     * @brief 获取数据版本号
+     * 
+     * 每次成功的增删改操作后版本号都会改变，且不同的数据服务实例不会出现相同的版本号。
+     * 缓存由记录计算出的结果（如特征矩阵）时，以版本号判断数据是否发生过变化。
+     * 
+     * @return 当前数据版本号
+     */
+    virtual uint64_t getDataVersion() = 0;
+    
+    /**
+     * @brief 记录插入的监听函数
+     * 
+     * 参数为插入的记录（含结构键）和插入后的数据版本号。
+     */
+    using InsertionListener = std::function<void(const DataRecord& record, uint64_t version)>;
+    
+    /**
+     * @brief 订阅记录插入（数据变更通知）
+     * 
+     * 订阅返回之后完成的每次 addData() 都会通知：监听函数在执行插入的线程上、释放数据锁之后按订阅顺序调用，
+     * 因此可以读取数据服务。并发插入的通知互相串行，但不保证按版本号顺序到达。
+     * 监听函数应尽快返回（耗时的处理交给其他线程），不能在其中订阅或取消订阅。
+     * 
+     * @param listener 监听函数
+     * @return 订阅号（不为0，用于取消订阅）
+     */
+    virtual uint64_t subscribeInsertions(InsertionListener listener) = 0;
+    
+    /**
+     * @brief 取消订阅
+     * 
+     * 返回时正在进行的通知已经结束，之后不会再调用该监听函数。
+     * 
+     * @param subscription subscribeInsertions() 返回的订阅号
+     */
+    virtual void unsubscribeInsertions(uint64_t subscription) = 0;
 };
 
 /**
@@ -76,18 +173,49 @@ public:
  */
 class DataService : public IDataService {
 private:
-    std::vector<DataRecord> m_records;
+    using StructureIndex = std::unordered_map<
+        Chemistry::StructureKey, std::vector<std::string>, Chemistry::StructureKeyHash>;
+    
+    std::vector<DataRecord> m_records;                   // 删除时由最后一条记录填补空位（删除后存储顺序不再是插入顺序）
+    std::unordered_map<std::string, size_t> m_idIndex;   // ID -> m_records下标
+    StructureIndex m_structureIndex;                     // 结构键 -> 记录ID
     mutable std::shared_mutex m_mutex;
+    std::atomic<uint64_t> m_version;                     // 数据版本号（持写锁修改）
+    
+    std::vector<std::pair<uint64_t, InsertionListener>> m_insertionListeners;
+    std::mutex m_listenerMutex;                          // 保护监听列表，通知期间持有（在 m_mutex 之前获取）
+    uint64_t m_nextSubscription = 1;
+    bool m_hasListeners = false;                         // 是否有订阅（持写锁修改和读取）
+    
+    void indexStructure(const DataRecord& record);
+    void unindexStructure(const DataRecord& record);
+    std::vector<DataRecord> recordsForKey(const Chemistry::StructureKey& key) const;
+    
+    void bumpVersion();
+    void notifyInsertion(const DataRecord& record, uint64_t version);
     
 public:
+    DataService();
+    
     bool addData(const DataRecord& record) override;
     bool deleteData(const std::string& id) override;
     bool updateData(const DataRecord& record) override;
     std::unique_ptr<DataRecord> getData(const std::string& id) override;
     std::vector<DataRecord> getAllData() override;
+    size_t getDataCount() override;
+    std::vector<DataRecord> getDataRange(size_t offset, size_t limit) override;
     std::vector<DataRecord> queryData(
         const std::string& category = "",
         const std::unordered_set<std::string>& tags = {}) override;
+    std::vector<DataRecord> findByStructure(
+        const std::string& content,
+        const std::string& format) override;
+    std::vector<DataRecord> findByStructureKey(const Chemistry::StructureKey& key) override;
+    std::vector<std::vector<std::string>> findDuplicateStructures() override;
+    size_t backfillStructureKeys() override;
+    uint64_t getDataVersion() override;
+    uint64_t subscribeInsertions(InsertionListener listener) override;
+    void unsubscribeInsertions(uint64_t subscription) override;
 };
 
 } // namespace Data
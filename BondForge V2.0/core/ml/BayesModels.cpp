@@ -0,0 +1,519 @@
+#include "BayesModels.h"
+#include "ModelCommon.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 每个行块的目标行数和行块数上限；行块划分只取决于数据形状，与线程数无关
+constexpr size_t kChunkRows = 16384;
+constexpr size_t kMaxChunks = 64;
+
+// 所有行块的部分统计量合计占用的内存上限
+constexpr size_t kStatisticsBudgetBytes = size_t(256) << 20;
+
+constexpr size_t kPredictGrainSize = 4096;
+
+// 模型文件中的节
+constexpr uint32_t kSmoothingSection = sectionTag("SMTH");
+constexpr uint32_t kClassesSection = sectionTag("CLAS");
+constexpr uint32_t kCountsSection = sectionTag("CONT");
+constexpr uint32_t kMeansSection = sectionTag("MEAN");
+constexpr uint32_t kSquaresSection = sectionTag("SQRS");
+
+constexpr double kLogTwoPi = 1.8378770664093453;
+
+/**
+ * @brief 固定的行块划分
+ */
+struct RowChunks {
+    size_t count = 1;
+    size_t rows = 0;
+    
+    RowChunks(size_t totalRows, size_t bytesPerChunk) : rows(totalRows) {
+        size_t budgetChunks = std::max<size_t>(1, kStatisticsBudgetBytes / std::max<size_t>(1, bytesPerChunk));
+        count = std::min({(totalRows + kChunkRows - 1) / kChunkRows, kMaxChunks, budgetChunks});
+        count = std::max<size_t>(1, count);
+    }
+    
+    size_t begin(size_t chunk) const { return rows * chunk / count; }
+    size_t end(size_t chunk) const { return rows * (chunk + 1) / count; }
+};
+
+/**
+ * @brief 把一组（样本数, 均值, 离差平方和）合并进另一组（Chan等人的并行方差公式）
+ */
+void mergeMoments(double& count, double* mean, double* squares,
+                  double otherCount, const double* otherMean, const double* otherSquares, size_t p) {
+    if (otherCount == 0.0) {
+        return;
+    }
+    double total = count + otherCount;
+    double weight = otherCount / total;
+    double cross = count * otherCount / total;
+    for (size_t f = 0; f < p; ++f) {
+        double delta = otherMean[f] - mean[f];
+        mean[f] += delta * weight;
+        squares[f] += otherSquares[f] + delta * delta * cross;
+    }
+    count = total;
+}
+
+} // namespace
+
+// NaiveBayesModel 实现
+TrainingResult NaiveBayesModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+TrainingResult NaiveBayesModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+template <typename Features>
+TrainingResult NaiveBayesModel::fit(
+    const Features& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    m_varSmoothing = std::max(0.0, parameterOr(parameters, "varSmoothing", 1e-9));
+    m_classes.clear();
+    m_counts.clear();
+    m_means = Matrix();
+    m_squares = Matrix();
+    accumulate(trainingData, trainingLabels);
+    refreshLikelihoods();
+    
+    evaluate(predict(trainingData), trainingLabels, result);
+    result.success = true;
+    result.additionalMetrics["classes"] = static_cast<double>(m_classes.size());
+    result.additionalMetrics["varSmoothing"] = m_varSmoothing;
+    return result;
+}
+
+TrainingResult NaiveBayesModel::partialFit(
+    const ConstMatrixView& chunk,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (chunk.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (labels.size() != chunk.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    m_varSmoothing = std::max(0.0, parameterOr(parameters, "varSmoothing", m_varSmoothing));
+    if (!accumulate(chunk, labels)) {
+        result.errorMessage = "Feature count does not match previous chunks";
+        return result;
+    }
+    refreshLikelihoods();
+    
+    double samplesSeen = 0.0;
+    for (double count : m_counts) {
+        samplesSeen += count;
+    }
+    
+    // 指标在当前数据块上统计
+    evaluate(predict(chunk), labels, result);
+    result.success = true;
+    result.additionalMetrics["classes"] = static_cast<double>(m_classes.size());
+    result.additionalMetrics["samplesSeen"] = samplesSeen;
+    return result;
+}
+
+bool NaiveBayesModel::insertClasses(const std::vector<double>& labels, size_t p) {
+    if (!m_classes.empty() && m_means.cols() != p) {
+        return false;
+    }
+    
+    // 新出现的类别按升序插入，已有类别的统计量随之移动到新的行
+    std::vector<double> chunkClasses(labels);
+    std::sort(chunkClasses.begin(), chunkClasses.end());
+    chunkClasses.erase(std::unique(chunkClasses.begin(), chunkClasses.end()), chunkClasses.end());
+    std::vector<double> classes;
+    std::set_union(m_classes.begin(), m_classes.end(), chunkClasses.begin(), chunkClasses.end(),
+                   std::back_inserter(classes));
+    if (classes.size() != m_classes.size()) {
+        std::vector<double> counts(classes.size(), 0.0);
+        Matrix means(classes.size(), p);
+        Matrix squares(classes.size(), p);
+        for (size_t c = 0; c < m_classes.size(); ++c) {
+            size_t target = std::lower_bound(classes.begin(), classes.end(), m_classes[c]) - classes.begin();
+            counts[target] = m_counts[c];
+            std::copy(m_means.row(c), m_means.row(c) + p, means.row(target));
+            std::copy(m_squares.row(c), m_squares.row(c) + p, squares.row(target));
+        }
+        m_classes = std::move(classes);
+        m_counts = std::move(counts);
+        m_means = std::move(means);
+        m_squares = std::move(squares);
+    }
+    return true;
+}
+
+bool NaiveBayesModel::accumulate(const ConstMatrixView& data, const std::vector<double>& labels) {
+    const size_t p = data.cols();
+    if (!insertClasses(labels, p)) {
+        return false;
+    }
+    
+    // 各行块内按类别用Welford算法统计，再按块序号合并
+    const size_t numClasses = m_classes.size();
+    RowChunks chunks(data.rows(), numClasses * (2 * p + 1) * sizeof(double));
+    std::vector<double> partialCounts(chunks.count * numClasses, 0.0);
+    std::vector<double> partialMeans(chunks.count * numClasses * p, 0.0);
+    std::vector<double> partialSquares(chunks.count * numClasses * p, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            double* counts = partialCounts.data() + chunk * numClasses;
+            for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                size_t c = std::lower_bound(m_classes.begin(), m_classes.end(), labels[i]) - m_classes.begin();
+                double* mean = partialMeans.data() + (chunk * numClasses + c) * p;
+                double* squares = partialSquares.data() + (chunk * numClasses + c) * p;
+                const double* x = data.row(i);
+                counts[c] += 1.0;
+                double invCount = 1.0 / counts[c];
+                for (size_t f = 0; f < p; ++f) {
+                    double delta = x[f] - mean[f];
+                    mean[f] += delta * invCount;
+                    squares[f] += delta * (x[f] - mean[f]);
+                }
+            }
+        }
+    });
+    
+    for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+        for (size_t c = 0; c < numClasses; ++c) {
+            size_t offset = (chunk * numClasses + c) * p;
+            mergeMoments(m_counts[c], m_means.row(c), m_squares.row(c),
+                         partialCounts[chunk * numClasses + c], partialMeans.data() + offset,
+                         partialSquares.data() + offset, p);
+        }
+    }
+    return true;
+}
+
+bool NaiveBayesModel::accumulate(const SparseMatrixView& data, const std::vector<double>& labels) {
+    const size_t p = data.cols();
+    if (!insertClasses(labels, p)) {
+        return false;
+    }
+    
+    // 各行块内按类别累加非零元素的和与平方和，换算为（均值, 离差平方和）后按块序号合并
+    const size_t numClasses = m_classes.size();
+    RowChunks chunks(data.rows(), numClasses * (2 * p + 1) * sizeof(double));
+    std::vector<double> partialCounts(chunks.count * numClasses, 0.0);
+    std::vector<double> partialSums(chunks.count * numClasses * p, 0.0);
+    std::vector<double> partialSquares(chunks.count * numClasses * p, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        std::vector<uint32_t> scratch;
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            double* counts = partialCounts.data() + chunk * numClasses;
+            for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                size_t c = std::lower_bound(m_classes.begin(), m_classes.end(), labels[i]) - m_classes.begin();
+                double* sums = partialSums.data() + (chunk * numClasses + c) * p;
+                double* squares = partialSquares.data() + (chunk * numClasses + c) * p;
+                SparseRow row = data.row(i, scratch);
+                counts[c] += 1.0;
+                for (size_t k = 0; k < row.size; ++k) {
+                    double value = row.value(k);
+                    sums[row.indices[k]] += value;
+                    squares[row.indices[k]] += value * value;
+                }
+            }
+            for (size_t c = 0; c < numClasses; ++c) {
+                if (counts[c] == 0.0) {
+                    continue;
+                }
+                double* means = partialSums.data() + (chunk * numClasses + c) * p;
+                double* squares = partialSquares.data() + (chunk * numClasses + c) * p;
+                for (size_t f = 0; f < p; ++f) {
+                    means[f] /= counts[c];
+                    squares[f] = std::max(0.0, squares[f] - counts[c] * means[f] * means[f]);
+                }
+            }
+        }
+    });
+    
+    for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+        for (size_t c = 0; c < numClasses; ++c) {
+            size_t offset = (chunk * numClasses + c) * p;
+            mergeMoments(m_counts[c], m_means.row(c), m_squares.row(c),
+                         partialCounts[chunk * numClasses + c], partialSums.data() + offset,
+                         partialSquares.data() + offset, p);
+        }
+    }
+    return true;
+}
+
+void NaiveBayesModel::refreshLikelihoods() {
+    const size_t numClasses = m_classes.size();
+    const size_t p = m_means.cols();
+    
+    double total = 0.0;
+    double maxVariance = 0.0;
+    for (size_t c = 0; c < numClasses; ++c) {
+        total += m_counts[c];
+        for (size_t f = 0; f < p; ++f) {
+            maxVariance = std::max(maxVariance, m_squares(c, f) / m_counts[c]);
+        }
+    }
+    
+    // 所有特征方差都为0时退化为绝对平滑量
+    double epsilon = m_varSmoothing * maxVariance;
+    if (!(epsilon > 0.0)) {
+        epsilon = m_varSmoothing > 0.0 ? m_varSmoothing : 1e-9;
+    }
+    
+    m_logPriors.assign(numClasses, 0.0);
+    m_logNormalizers.assign(numClasses, 0.0);
+    m_zeroLogLikelihoods.assign(numClasses, 0.0);
+    m_invVariances.assign(numClasses, p);
+    for (size_t c = 0; c < numClasses; ++c) {
+        m_logPriors[c] = std::log(m_counts[c] / total);
+        double normalizer = 0.0;
+        double zeroDistance = 0.0;
+        for (size_t f = 0; f < p; ++f) {
+            double variance = m_squares(c, f) / m_counts[c] + epsilon;
+            m_invVariances(c, f) = 1.0 / variance;
+            normalizer += kLogTwoPi + std::log(variance);
+            zeroDistance += m_means(c, f) * m_means(c, f) * m_invVariances(c, f);
+        }
+        m_logNormalizers[c] = -0.5 * normalizer;
+        m_zeroLogLikelihoods[c] = m_logPriors[c] + m_logNormalizers[c] - 0.5 * zeroDistance;
+    }
+}
+
+void NaiveBayesModel::jointLogLikelihood(const double* sample, double* out) const {
+    const size_t p = m_means.cols();
+    for (size_t c = 0; c < m_classes.size(); ++c) {
+        const double* mean = m_means.row(c);
+        const double* invVariance = m_invVariances.row(c);
+        double distance = 0.0;
+        for (size_t f = 0; f < p; ++f) {
+            double delta = sample[f] - mean[f];
+            distance += delta * delta * invVariance[f];
+        }
+        out[c] = m_logPriors[c] + m_logNormalizers[c] - 0.5 * distance;
+    }
+}
+
+void NaiveBayesModel::jointLogLikelihood(const SparseRow& sample, double* out) const {
+    // (x - μ)² - μ² = x·(x - 2μ)：只有非零元素与全为0的样本不同
+    for (size_t c = 0; c < m_classes.size(); ++c) {
+        const double* mean = m_means.row(c);
+        const double* invVariance = m_invVariances.row(c);
+        double correction = 0.0;
+        for (size_t k = 0; k < sample.size; ++k) {
+            uint32_t f = sample.indices[k];
+            double value = sample.value(k);
+            correction += value * (value - 2.0 * mean[f]) * invVariance[f];
+        }
+        out[c] = m_zeroLogLikelihoods[c] - 0.5 * correction;
+    }
+}
+
+void NaiveBayesModel::evaluate(const std::vector<double>& predictions, const std::vector<double>& labels,
+                               TrainingResult& result) const {
+    const size_t numClasses = m_classes.size();
+    
+    // 每个类别的真阳性、预测数和实际数
+    std::vector<size_t> counts(numClasses * 3, 0);
+    size_t correct = 0;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        size_t predicted = std::lower_bound(m_classes.begin(), m_classes.end(), predictions[i]) - m_classes.begin();
+        size_t actual = std::lower_bound(m_classes.begin(), m_classes.end(), labels[i]) - m_classes.begin();
+        counts[predicted * 3] += predicted == actual ? 1 : 0;
+        counts[predicted * 3 + 1] += 1;
+        counts[actual * 3 + 2] += 1;
+        correct += predicted == actual ? 1 : 0;
+    }
+    
+    // 二分类以较大的标签值为正类，多分类取各类别的宏平均
+    auto ratio = [](size_t numerator, size_t denominator) {
+        return denominator > 0 ? static_cast<double>(numerator) / denominator : 0.0;
+    };
+    if (numClasses == 2) {
+        result.precision = ratio(counts[3], counts[4]);
+        result.recall = ratio(counts[3], counts[5]);
+    } else {
+        for (size_t k = 0; k < numClasses; ++k) {
+            result.precision += ratio(counts[k * 3], counts[k * 3 + 1]);
+            result.recall += ratio(counts[k * 3], counts[k * 3 + 2]);
+        }
+        result.precision /= numClasses;
+        result.recall /= numClasses;
+    }
+    
+    result.accuracy = ratio(correct, labels.size());
+    double precisionRecall = result.precision + result.recall;
+    result.f1Score = precisionRecall > 0.0 ? 2 * result.precision * result.recall / precisionRecall : 0.0;
+}
+
+std::vector<double> NaiveBayesModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_classes.empty() || testData.empty() || testData.cols() != m_means.cols()) {
+        return {};
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            std::vector<double> scores(m_classes.size());
+            for (size_t i = begin; i < end; ++i) {
+                jointLogLikelihood(testData.row(i), scores.data());
+                predictions[i] = m_classes[std::max_element(scores.begin(), scores.end()) - scores.begin()];
+            }
+        });
+    
+    return predictions;
+}
+
+std::vector<double> NaiveBayesModel::predict(const SparseMatrixView& testData) {
+    
+    if (m_classes.empty() || testData.empty() || testData.cols() != m_means.cols()) {
+        return {};
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> scratch;
+            std::vector<double> scores(m_classes.size());
+            for (size_t i = begin; i < end; ++i) {
+                jointLogLikelihood(testData.row(i, scratch), scores.data());
+                predictions[i] = m_classes[std::max_element(scores.begin(), scores.end()) - scores.begin()];
+            }
+        });
+    
+    return predictions;
+}
+
+Matrix NaiveBayesModel::predictProbabilities(const ConstMatrixView& testData) const {
+    
+    if (m_classes.empty() || testData.empty() || testData.cols() != m_means.cols()) {
+        return Matrix();
+    }
+    
+    const size_t numClasses = m_classes.size();
+    Matrix probabilities(testData.rows(), numClasses);
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double* out = probabilities.row(i);
+                jointLogLikelihood(testData.row(i), out);
+                double maxScore = *std::max_element(out, out + numClasses);
+                double sum = 0.0;
+                for (size_t c = 0; c < numClasses; ++c) {
+                    out[c] = std::exp(out[c] - maxScore);
+                    sum += out[c];
+                }
+                for (size_t c = 0; c < numClasses; ++c) {
+                    out[c] /= sum;
+                }
+            }
+        });
+    
+    return probabilities;
+}
+
+bool NaiveBayesModel::saveModel(const std::string& filePath) {
+    try {
+        ModelFileWriter writer(ModelType::NaiveBayes);
+        writer.addArray(kSmoothingSection, &m_varSmoothing, 1);
+        writer.addArray(kClassesSection, m_classes);
+        writer.addArray(kCountsSection, m_counts);
+        writer.addMatrix(kMeansSection, m_means);
+        writer.addMatrix(kSquaresSection, m_squares);
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool NaiveBayesModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::NaiveBayes) {
+            return false;
+        }
+        
+        auto smoothing = file->section<double>(kSmoothingSection);
+        auto classes = file->section<double>(kClassesSection);
+        auto counts = file->section<double>(kCountsSection);
+        auto means = file->section<double>(kMeansSection);
+        auto squares = file->section<double>(kSquaresSection);
+        if (!smoothing.valid || smoothing.count != 1 || !(smoothing.data[0] >= 0.0) || !classes.valid ||
+            classes.count == 0 || !counts.valid || counts.count != classes.count || !means.valid ||
+            means.rows != classes.count || !squares.valid || squares.rows != means.rows || squares.cols != means.cols) {
+            return false;
+        }
+        if (!std::is_sorted(classes.data, classes.data + classes.count)) {
+            return false;
+        }
+        for (size_t k = 0; k < counts.count; ++k) {
+            if (!(counts.data[k] > 0.0)) {
+                return false;
+            }
+        }
+        
+        m_varSmoothing = smoothing.data[0];
+        m_classes.assign(classes.data, classes.data + classes.count);
+        m_counts.assign(counts.data, counts.data + counts.count);
+        m_means = Matrix::copyOf(means.matrix());
+        m_squares = Matrix::copyOf(squares.matrix());
+        refreshLikelihoods();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
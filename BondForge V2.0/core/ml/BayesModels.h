@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include "MLModels.h"
+#include "ModelFile.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 原生高斯朴素贝叶斯分类模型（不依赖mlpack）
+ * 
+ * 每个类别保存样本数、各特征的均值和离差平方和。数据按固定的行块在线程池上并行统计，
+ * 各块的统计量按块序号用Chan等人的合并公式合并，因此结果与线程数无关，
+ * 并且 partialFit() 逐块并入新数据与一次性训练得到的模型相同（只差浮点舍入）。
+ * 增量训练中出现的新类别会加入模型。
+ * 
+ * 预测时各特征方差加上 varSmoothing 倍的最大特征方差，避免方差为0的特征产生无穷大的似然。
+ * 
+ * 稀疏特征（CSR或位矩阵）上只累加非零元素的和与平方和，再换算为均值和离差平方和并入统计量；
+ * 预测时先取全为0的样本的联合对数似然（随统计量预先算好），再对非零元素逐个修正。
+ * 
+ * 训练参数：
+ * - varSmoothing：方差平滑系数（默认1e-9）
+ */
+class NaiveBayesModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsPartialFit() const override { return true; }
+    
+    TrainingResult partialFit(
+        const ConstMatrixView& chunk,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsSparseFeatures() const override { return true; }
+    
+    TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测类别（返回类别标签值）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    std::vector<double> predict(const SparseMatrixView& testData) override;
+    
+    /**
+     * @brief 预测各类别的后验概率
+     * 
+     * @param testData 测试数据
+     * @return 样本数×类别数的概率矩阵（列顺序同 classes()）
+     */
+    Matrix predictProbabilities(const ConstMatrixView& testData) const;
+    
+    ModelType getModelType() const override { return ModelType::NaiveBayes; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 训练数据中出现过的类别标签值（升序）
+     */
+    const std::vector<double>& classes() const { return m_classes; }
+    
+    /**
+     * @brief 每个类别的样本数
+     */
+    const std::vector<double>& classCounts() const { return m_counts; }
+    
+    /**
+     * @brief 每个类别各特征的均值（类别数×特征数）
+     */
+    const Matrix& means() const { return m_means; }
+
+private:
+    template <typename Features>
+    TrainingResult fit(const Features& data, const std::vector<double>& labels,
+                       const std::map<std::string, double>& parameters);
+    
+    bool insertClasses(const std::vector<double>& labels, size_t p);
+    bool accumulate(const ConstMatrixView& data, const std::vector<double>& labels);
+    bool accumulate(const SparseMatrixView& data, const std::vector<double>& labels);
+    void refreshLikelihoods();
+    void jointLogLikelihood(const double* sample, double* out) const;
+    void jointLogLikelihood(const SparseRow& sample, double* out) const;
+    void evaluate(const std::vector<double>& predictions, const std::vector<double>& labels, TrainingResult& result) const;
+    
+    double m_varSmoothing = 1e-9;
+    
+    // 充分统计量
+    std::vector<double> m_classes;
+    std::vector<double> m_counts;
+    Matrix m_means;
+    Matrix m_squares;               // 各特征的离差平方和
+    
+    // 由统计量导出、预测时使用的量
+    std::vector<double> m_logPriors;
+    Matrix m_invVariances;
+    std::vector<double> m_logNormalizers;   // -0.5·Σ log(2πσ²)
+    std::vector<double> m_zeroLogLikelihoods;   // 全为0的样本的联合对数似然
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,879 @@
+#include "ClusteringModels.h"
+#include "ModelCommon.h"
+#include "TrainingJobs.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 每个行块的目标行数和行块数上限；行块划分只取决于数据形状，与线程数无关
+constexpr size_t kChunkRows = 16384;
+constexpr size_t kMaxChunks = 64;
+
+// 所有行块的中心累加和合计占用的内存上限
+constexpr size_t kAccumulatorBudgetBytes = size_t(256) << 20;
+
+// Elkan算法的逐中心下界占用的内存上限，超过时使用Hamerly算法
+constexpr size_t kElkanBoundBudgetBytes = size_t(256) << 20;
+
+constexpr size_t kPredictGrainSize = 4096;
+
+// 小批量K均值：初始化使用的样本数（批大小的倍数）和批损失连续不改善的容忍批数
+constexpr size_t kMiniBatchInitFactor = 3;
+constexpr size_t kMiniBatchPatience = 10;
+
+// 模型文件中的节
+constexpr uint32_t kCentroidsSection = sectionTag("CNTR");
+constexpr uint32_t kClusterSizesSection = sectionTag("SIZE");
+
+/**
+ * @brief 固定的行块划分
+ */
+struct RowChunks {
+    size_t count = 1;
+    size_t rows = 0;
+    
+    RowChunks(size_t totalRows, size_t bytesPerChunk) : rows(totalRows) {
+        size_t budgetChunks = std::max<size_t>(1, kAccumulatorBudgetBytes / std::max<size_t>(1, bytesPerChunk));
+        count = std::min({(totalRows + kChunkRows - 1) / kChunkRows, kMaxChunks, budgetChunks});
+        count = std::max<size_t>(1, count);
+    }
+    
+    size_t begin(size_t chunk) const { return rows * chunk / count; }
+    size_t end(size_t chunk) const { return rows * (chunk + 1) / count; }
+};
+
+/**
+ * @brief 欧氏距离的平方（固定的累加顺序，同样的输入总得到同样的结果）
+ */
+double squaredDistance(const double* a, const double* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    for (; i + 4 <= n; i += 4) {
+        double d0 = a[i] - b[i];
+        double d1 = a[i + 1] - b[i + 1];
+        double d2 = a[i + 2] - b[i + 2];
+        double d3 = a[i + 3] - b[i + 3];
+        acc[0] += d0 * d0;
+        acc[1] += d1 * d1;
+        acc[2] += d2 * d2;
+        acc[3] += d3 * d3;
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        double d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+/**
+ * @brief 找出最近的中心（同时给出次近中心的距离平方）
+ */
+uint32_t nearestCenter(const double* x, const Matrix& centers, double& bestSquared, double& secondSquared) {
+    bestSquared = std::numeric_limits<double>::max();
+    secondSquared = std::numeric_limits<double>::max();
+    uint32_t best = 0;
+    for (size_t j = 0; j < centers.rows(); ++j) {
+        double d = squaredDistance(x, centers.row(j), centers.cols());
+        if (d < bestSquared) {
+            secondSquared = bestSquared;
+            bestSquared = d;
+            best = static_cast<uint32_t>(j);
+        } else if (d < secondSquared) {
+            secondSquared = d;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief k-means++ 初始化：每个新中心按到已选中心的最小距离平方加权采样
+ * 
+ * 最小距离在线程池上按固定行块并行更新，采样时先按块序号累加各块的权重和、定位到块后再在块内查找。
+ */
+Matrix seedPlusPlus(const ConstMatrixView& data, size_t k, std::mt19937_64& rng) {
+    const size_t n = data.rows();
+    const size_t p = data.cols();
+    RowChunks chunks(n, 0);
+    auto& pool = Utils::ThreadPool::instance();
+    
+    Matrix centers(k, p);
+    std::vector<double> minDistance(n, std::numeric_limits<double>::max());
+    std::vector<double> chunkWeights(chunks.count, 0.0);
+    
+    size_t chosen = static_cast<size_t>(rng() % n);
+    for (size_t c = 0; c < k; ++c) {
+        std::copy(data.row(chosen), data.row(chosen) + p, centers.row(c));
+        if (c + 1 == k) {
+            break;
+        }
+        
+        const double* center = centers.row(c);
+        pool.parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+                double weight = 0.0;
+                for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                    minDistance[i] = std::min(minDistance[i], squaredDistance(data.row(i), center, p));
+                    weight += minDistance[i];
+                }
+                chunkWeights[chunk] = weight;
+            }
+        });
+        
+        double total = 0.0;
+        for (double weight : chunkWeights) {
+            total += weight;
+        }
+        if (!(total > 0.0)) {
+            // 剩余样本都与已选中心重合
+            chosen = static_cast<size_t>(rng() % n);
+            continue;
+        }
+        
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        size_t chunk = 0;
+        while (chunk + 1 < chunks.count && target >= chunkWeights[chunk]) {
+            target -= chunkWeights[chunk];
+            ++chunk;
+        }
+        chosen = chunks.end(chunk) - 1;
+        for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+            if (target < minDistance[i]) {
+                chosen = i;
+                break;
+            }
+            target -= minDistance[i];
+        }
+    }
+    return centers;
+}
+
+/**
+ * @brief 随机选取 k 个不同的样本作为初始中心
+ */
+Matrix seedRandom(const ConstMatrixView& data, size_t k, std::mt19937_64& rng) {
+    std::vector<size_t> picked;
+    while (picked.size() < k) {
+        size_t row = static_cast<size_t>(rng() % data.rows());
+        if (std::find(picked.begin(), picked.end(), row) == picked.end()) {
+            picked.push_back(row);
+        }
+    }
+    return Matrix::gatherRows(data, picked);
+}
+
+/**
+ * @brief 带三角不等式剪枝的Lloyd迭代（Hamerly / Elkan）
+ * 
+ * 中心移动后不立即更新每个样本的界，而是记下各中心的移动距离，
+ * 在下一轮分配时顺带调整，每轮只遍历一次数据。
+ */
+class BoundedLloyd {
+public:
+    BoundedLloyd(const ConstMatrixView& data, Matrix& centers, bool elkan)
+        : m_data(data), m_centers(centers), m_elkan(elkan),
+          m_k(centers.rows()), m_p(data.cols()),
+          m_chunks(data.rows(), centers.rows() * (data.cols() + 1) * sizeof(double)),
+          m_assignment(data.rows(), 0), m_upper(data.rows(), 0.0),
+          m_lower(elkan ? data.rows() * centers.rows() : data.rows(), 0.0),
+          m_shift(m_k, 0.0), m_halfGap(m_k, 0.0), m_centerDistance(m_k * m_k, 0.0),
+          m_sums(m_chunks.count * m_k * m_p, 0.0), m_counts(m_chunks.count * m_k, 0),
+          m_changes(m_chunks.count, 0), m_evaluations(m_chunks.count, 0), m_inertia(m_chunks.count, 0.0) {}
+    
+    /**
+     * @brief 一轮迭代：重新分配样本并移动中心
+     * 
+     * @param squaredShift 输出所有中心移动距离的平方和
+     * @return 分配发生变化的样本数
+     */
+    size_t iterate(double& squaredShift) {
+        assign(false);
+        
+        size_t changes = 0;
+        for (size_t chunk = 0; chunk < m_chunks.count; ++chunk) {
+            changes += m_changes[chunk];
+        }
+        
+        // 按块序号合并累加和
+        std::vector<double> sums(m_k * m_p, 0.0);
+        std::vector<uint64_t> counts(m_k, 0);
+        for (size_t chunk = 0; chunk < m_chunks.count; ++chunk) {
+            const double* partial = m_sums.data() + chunk * m_k * m_p;
+            for (size_t t = 0; t < m_k * m_p; ++t) {
+                sums[t] += partial[t];
+            }
+            for (size_t j = 0; j < m_k; ++j) {
+                counts[j] += m_counts[chunk * m_k + j];
+            }
+        }
+        m_clusterSizes.assign(counts.begin(), counts.end());
+        
+        // 空簇移到离自身中心最远（上界最大）的样本上
+        std::vector<size_t> relocated;
+        std::vector<double> newCenter(m_p);
+        squaredShift = 0.0;
+        for (size_t j = 0; j < m_k; ++j) {
+            if (counts[j] > 0) {
+                double scale = 1.0 / static_cast<double>(counts[j]);
+                for (size_t f = 0; f < m_p; ++f) {
+                    newCenter[f] = sums[j * m_p + f] * scale;
+                }
+            } else {
+                size_t farthest = 0;
+                double farthestBound = -1.0;
+                for (size_t i = 0; i < m_upper.size(); ++i) {
+                    if (m_upper[i] > farthestBound &&
+                        std::find(relocated.begin(), relocated.end(), i) == relocated.end()) {
+                        farthest = i;
+                        farthestBound = m_upper[i];
+                    }
+                }
+                relocated.push_back(farthest);
+                std::copy(m_data.row(farthest), m_data.row(farthest) + m_p, newCenter.begin());
+            }
+            double moved = squaredDistance(m_centers.row(j), newCenter.data(), m_p);
+            squaredShift += moved;
+            m_shift[j] = std::sqrt(moved);
+            std::copy(newCenter.begin(), newCenter.end(), m_centers.row(j));
+        }
+        return changes;
+    }
+    
+    /**
+     * @brief 按最终中心完成分配，返回误差平方和
+     */
+    double finish() {
+        assign(true);
+        double inertia = 0.0;
+        for (size_t chunk = 0; chunk < m_chunks.count; ++chunk) {
+            inertia += m_inertia[chunk];
+        }
+        std::vector<double> sizes(m_k, 0.0);
+        for (size_t chunk = 0; chunk < m_chunks.count; ++chunk) {
+            for (size_t j = 0; j < m_k; ++j) {
+                sizes[j] += static_cast<double>(m_counts[chunk * m_k + j]);
+            }
+        }
+        m_clusterSizes = sizes;
+        return inertia;
+    }
+    
+    uint64_t distanceEvaluations() const { return m_totalEvaluations; }
+    const std::vector<double>& clusterSizes() const { return m_clusterSizes; }
+
+private:
+    void assign(bool finalPass) {
+        // 中心间距离和每个中心到最近的其他中心距离的一半
+        for (size_t a = 0; a < m_k; ++a) {
+            m_centerDistance[a * m_k + a] = 0.0;
+            for (size_t b = a + 1; b < m_k; ++b) {
+                double d = std::sqrt(squaredDistance(m_centers.row(a), m_centers.row(b), m_p));
+                m_centerDistance[a * m_k + b] = d;
+                m_centerDistance[b * m_k + a] = d;
+            }
+        }
+        for (size_t a = 0; a < m_k; ++a) {
+            double closest = std::numeric_limits<double>::max();
+            for (size_t b = 0; b < m_k; ++b) {
+                if (b != a) {
+                    closest = std::min(closest, m_centerDistance[a * m_k + b]);
+                }
+            }
+            m_halfGap[a] = m_k > 1 ? 0.5 * closest : std::numeric_limits<double>::max();
+        }
+        
+        // Hamerly下界的调整量：非所属中心的最大移动距离
+        size_t farthestMover = 0;
+        double maxShift = 0.0;
+        double secondShift = 0.0;
+        for (size_t j = 0; j < m_k; ++j) {
+            if (m_shift[j] > maxShift) {
+                secondShift = maxShift;
+                maxShift = m_shift[j];
+                farthestMover = j;
+            } else if (m_shift[j] > secondShift) {
+                secondShift = m_shift[j];
+            }
+        }
+        
+        Utils::ThreadPool::instance().parallelFor(0, m_chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+                double* sums = m_sums.data() + chunk * m_k * m_p;
+                uint64_t* counts = m_counts.data() + chunk * m_k;
+                std::fill(sums, sums + m_k * m_p, 0.0);
+                std::fill(counts, counts + m_k, 0);
+                size_t changes = 0;
+                uint64_t evaluations = 0;
+                double inertia = 0.0;
+                
+                for (size_t i = m_chunks.begin(chunk); i < m_chunks.end(chunk); ++i) {
+                    const double* x = m_data.row(i);
+                    uint32_t before = m_assignment[i];
+                    if (m_elkan) {
+                        evaluations += assignElkan(i, x);
+                    } else {
+                        evaluations += assignHamerly(i, x, farthestMover, maxShift, secondShift);
+                    }
+                    uint32_t a = m_assignment[i];
+                    changes += a != before ? 1 : 0;
+                    
+                    if (finalPass) {
+                        double d = squaredDistance(x, m_centers.row(a), m_p);
+                        inertia += d;
+                    } else {
+                        double* sum = sums + a * m_p;
+                        for (size_t f = 0; f < m_p; ++f) {
+                            sum[f] += x[f];
+                        }
+                    }
+                    ++counts[a];
+                }
+                m_changes[chunk] = changes;
+                m_evaluations[chunk] = evaluations;
+                m_inertia[chunk] = inertia;
+            }
+        });
+        
+        for (size_t chunk = 0; chunk < m_chunks.count; ++chunk) {
+            m_totalEvaluations += m_evaluations[chunk];
+        }
+        std::fill(m_shift.begin(), m_shift.end(), 0.0);
+        m_initialized = true;
+    }
+    
+    uint64_t assignHamerly(size_t i, const double* x, size_t farthestMover, double maxShift, double secondShift) {
+        if (!m_initialized) {
+            double best;
+            double second;
+            m_assignment[i] = nearestCenter(x, m_centers, best, second);
+            m_upper[i] = std::sqrt(best);
+            m_lower[i] = m_k > 1 ? std::sqrt(second) : std::numeric_limits<double>::max();
+            return m_k;
+        }
+        
+        uint32_t a = m_assignment[i];
+        m_upper[i] += m_shift[a];
+        m_lower[i] -= a == farthestMover ? secondShift : maxShift;
+        double bound = std::max(m_halfGap[a], m_lower[i]);
+        if (m_upper[i] <= bound) {
+            return 0;
+        }
+        
+        m_upper[i] = std::sqrt(squaredDistance(x, m_centers.row(a), m_p));
+        if (m_upper[i] <= bound) {
+            return 1;
+        }
+        
+        double best;
+        double second;
+        m_assignment[i] = nearestCenter(x, m_centers, best, second);
+        m_upper[i] = std::sqrt(best);
+        m_lower[i] = std::sqrt(second);
+        return 1 + m_k;
+    }
+    
+    uint64_t assignElkan(size_t i, const double* x) {
+        double* lower = m_lower.data() + i * m_k;
+        if (!m_initialized) {
+            uint32_t best = 0;
+            for (size_t j = 0; j < m_k; ++j) {
+                lower[j] = std::sqrt(squaredDistance(x, m_centers.row(j), m_p));
+                if (lower[j] < lower[best]) {
+                    best = static_cast<uint32_t>(j);
+                }
+            }
+            m_assignment[i] = best;
+            m_upper[i] = lower[best];
+            return m_k;
+        }
+        
+        uint32_t a = m_assignment[i];
+        double upper = m_upper[i] + m_shift[a];
+        for (size_t j = 0; j < m_k; ++j) {
+            lower[j] = std::max(0.0, lower[j] - m_shift[j]);
+        }
+        
+        uint64_t evaluations = 0;
+        if (upper > m_halfGap[a]) {
+            bool tight = false;
+            for (size_t j = 0; j < m_k; ++j) {
+                if (j == a || upper <= lower[j] || upper <= 0.5 * m_centerDistance[a * m_k + j]) {
+                    continue;
+                }
+                if (!tight) {
+                    upper = std::sqrt(squaredDistance(x, m_centers.row(a), m_p));
+                    lower[a] = upper;
+                    tight = true;
+                    ++evaluations;
+                    if (upper <= lower[j] || upper <= 0.5 * m_centerDistance[a * m_k + j]) {
+                        continue;
+                    }
+                }
+                double d = std::sqrt(squaredDistance(x, m_centers.row(j), m_p));
+                lower[j] = d;
+                ++evaluations;
+                if (d < upper) {
+                    a = static_cast<uint32_t>(j);
+                    upper = d;
+                }
+            }
+        }
+        m_assignment[i] = a;
+        m_upper[i] = upper;
+        return evaluations;
+    }
+    
+    const ConstMatrixView& m_data;
+    Matrix& m_centers;
+    bool m_elkan;
+    bool m_initialized = false;
+    size_t m_k;
+    size_t m_p;
+    RowChunks m_chunks;
+    
+    std::vector<uint32_t> m_assignment;
+    std::vector<double> m_upper;            // 到所属中心距离的上界
+    std::vector<double> m_lower;            // Hamerly：到次近中心距离的下界；Elkan：到每个中心距离的下界
+    std::vector<double> m_shift;            // 上一轮各中心的移动距离（尚未计入界）
+    std::vector<double> m_halfGap;
+    std::vector<double> m_centerDistance;
+    
+    std::vector<double> m_sums;             // 每个行块的各中心累加和
+    std::vector<uint64_t> m_counts;
+    std::vector<size_t> m_changes;
+    std::vector<uint64_t> m_evaluations;
+    std::vector<double> m_inertia;
+    std::vector<double> m_clusterSizes;
+    uint64_t m_totalEvaluations = 0;
+};
+
+/**
+ * @brief 小批量K均值的一步更新
+ * 
+ * 把一批样本分配到最近的中心，再令中心 = 旧中心与本批样本按累计样本数加权的平均，
+ * 步长随各中心累计的样本数递减。分配在线程池上并行，累加按样本顺序进行。
+ */
+class MiniBatchUpdater {
+public:
+    MiniBatchUpdater(size_t k, size_t p) : m_sums(k, p), m_counts(k, 0.0) {}
+    
+    /**
+     * @param rows 本批样本在 data 中的行号
+     * @param squaredShift 输出：中心移动量的平方和
+     * @return 本批样本到更新前最近中心的距离平方和
+     */
+    double step(const ConstMatrixView& data, const std::vector<size_t>& rows,
+                Matrix& centers, std::vector<double>& sizes, double& squaredShift) {
+        const size_t k = centers.rows();
+        const size_t p = centers.cols();
+        m_assignment.resize(rows.size());
+        m_distance.resize(rows.size());
+        Utils::ThreadPool::instance().parallelFor(0, rows.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                double second;
+                m_assignment[b] = nearestCenter(data.row(rows[b]), centers, m_distance[b], second);
+            }
+        });
+        
+        m_sums.assign(k, p);
+        std::fill(m_counts.begin(), m_counts.end(), 0.0);
+        double inertia = 0.0;
+        for (size_t b = 0; b < rows.size(); ++b) {
+            const double* x = data.row(rows[b]);
+            double* sum = m_sums.row(m_assignment[b]);
+            for (size_t f = 0; f < p; ++f) {
+                sum[f] += x[f];
+            }
+            m_counts[m_assignment[b]] += 1.0;
+            inertia += m_distance[b];
+        }
+        
+        squaredShift = 0.0;
+        for (size_t j = 0; j < k; ++j) {
+            if (m_counts[j] == 0.0) {
+                continue;
+            }
+            double total = sizes[j] + m_counts[j];
+            double* center = centers.row(j);
+            const double* sum = m_sums.row(j);
+            for (size_t f = 0; f < p; ++f) {
+                double updated = (center[f] * sizes[j] + sum[f]) / total;
+                squaredShift += (updated - center[f]) * (updated - center[f]);
+                center[f] = updated;
+            }
+            sizes[j] = total;
+        }
+        return inertia;
+    }
+
+private:
+    Matrix m_sums;
+    std::vector<double> m_counts;
+    std::vector<uint32_t> m_assignment;
+    std::vector<double> m_distance;
+};
+
+/**
+ * @brief 所有样本到各自最近中心的距离平方和，同时把最近中心编号写入 assignment
+ */
+double assignNearest(const ConstMatrixView& data, const Matrix& centers, std::vector<uint32_t>& assignment) {
+    RowChunks chunks(data.rows(), 0);
+    std::vector<double> partial(chunks.count, 0.0);
+    assignment.resize(data.rows());
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            double sum = 0.0;
+            for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                double best;
+                double second;
+                assignment[i] = nearestCenter(data.row(i), centers, best, second);
+                sum += best;
+            }
+            partial[chunk] = sum;
+        }
+    });
+    
+    double total = 0.0;
+    for (double value : partial) {
+        total += value;
+    }
+    return total;
+}
+
+/**
+ * @brief 数据相对于总体均值的离差平方和
+ */
+double totalSumOfSquares(const ConstMatrixView& data) {
+    const size_t p = data.cols();
+    RowChunks chunks(data.rows(), p * sizeof(double));
+    std::vector<double> partialSums(chunks.count * p, 0.0);
+    auto& pool = Utils::ThreadPool::instance();
+    
+    pool.parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            double* sums = partialSums.data() + chunk * p;
+            for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                const double* x = data.row(i);
+                for (size_t f = 0; f < p; ++f) {
+                    sums[f] += x[f];
+                }
+            }
+        }
+    });
+    
+    std::vector<double> mean(p, 0.0);
+    for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+        for (size_t f = 0; f < p; ++f) {
+            mean[f] += partialSums[chunk * p + f];
+        }
+    }
+    for (double& value : mean) {
+        value /= static_cast<double>(data.rows());
+    }
+    
+    std::vector<double> partial(chunks.count, 0.0);
+    pool.parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            double sum = 0.0;
+            for (size_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i) {
+                sum += squaredDistance(data.row(i), mean.data(), p);
+            }
+            partial[chunk] = sum;
+        }
+    });
+    
+    double total = 0.0;
+    for (double value : partial) {
+        total += value;
+    }
+    return total;
+}
+
+} // namespace
+
+// KMeansModel 实现
+TrainingResult KMeansModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    (void)trainingLabels;
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    size_t k = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "numClusters", 8)));
+    size_t maxIterations = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "maxIterations", 300)));
+    double tolerance = std::max(0.0, parameterOr(parameters, "tolerance", 1e-4));
+    bool randomInit = parameterOr(parameters, "init", 0.0) == 1.0;
+    int algorithm = static_cast<int>(parameterOr(parameters, "algorithm", 0.0));
+    size_t batchSize = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "batchSize", 0.0)));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingData.rows() < k) {
+        result.errorMessage = "Fewer samples than clusters";
+        return result;
+    }
+    
+    const size_t n = trainingData.rows();
+    const size_t p = trainingData.cols();
+    std::mt19937_64 rng(seed);
+    
+    double totalSquares = totalSumOfSquares(trainingData);
+    double shiftThreshold = tolerance * totalSquares / static_cast<double>(n * p);
+    size_t iterations = 0;
+    double inertia = 0.0;
+    TrainingControl* control = TrainingControl::current();
+    
+    if (batchSize == 0) {
+        m_centroids = randomInit ? seedRandom(trainingData, k, rng) : seedPlusPlus(trainingData, k, rng);
+        
+        // Elkan的逐中心下界在高维时剪枝更多，但需要 样本数×簇数 的内存
+        bool elkan = algorithm == 2;
+        if (algorithm == 0) {
+            elkan = p >= 32 && k <= 64 && n * k * sizeof(double) <= kElkanBoundBudgetBytes;
+        }
+        
+        BoundedLloyd solver(trainingData, m_centroids, elkan);
+        for (iterations = 1; iterations <= maxIterations; ++iterations) {
+            double squaredShift = 0.0;
+            size_t changes = solver.iterate(squaredShift);
+            if ((iterations > 1 && changes == 0) || squaredShift <= shiftThreshold) {
+                break;
+            }
+            if (control && control->checkpoint(static_cast<double>(iterations) / static_cast<double>(maxIterations), result,
+                                               {{"changes", static_cast<double>(changes)}})) {
+                return result;
+            }
+        }
+        iterations = std::min(iterations, maxIterations);
+        inertia = solver.finish();
+        m_clusterSizes = solver.clusterSizes();
+        
+        result.additionalMetrics["algorithm"] = elkan ? 2.0 : 1.0;
+        result.additionalMetrics["distanceEvaluationsPerSample"] =
+            static_cast<double>(solver.distanceEvaluations()) / static_cast<double>(n);
+    } else {
+        // 小批量K均值：在 kMiniBatchInitFactor 个批大小的随机样本上做初始化
+        batchSize = std::min(batchSize, n);
+        size_t initRows = std::min(n, std::max(k, kMiniBatchInitFactor * batchSize));
+        std::vector<size_t> initSample(initRows);
+        for (size_t& row : initSample) {
+            row = static_cast<size_t>(rng() % n);
+        }
+        Matrix initData = Matrix::gatherRows(trainingData, initSample);
+        m_centroids = randomInit ? seedRandom(initData.view(), k, rng) : seedPlusPlus(initData.view(), k, rng);
+        m_clusterSizes.assign(k, 0.0);
+        
+        std::vector<size_t> batch(batchSize);
+        MiniBatchUpdater updater(k, p);
+        double smoothedInertia = -1.0;
+        double bestInertia = std::numeric_limits<double>::max();
+        size_t sinceImprovement = 0;
+        
+        for (iterations = 1; iterations <= maxIterations; ++iterations) {
+            for (size_t& row : batch) {
+                row = static_cast<size_t>(rng() % n);
+            }
+            double squaredShift = 0.0;
+            double batchInertia = updater.step(trainingData, batch, m_centroids, m_clusterSizes, squaredShift);
+            
+            // 批损失的指数平滑值连续若干批没有改善即停止
+            batchInertia /= static_cast<double>(batchSize);
+            double alpha = std::min(1.0, 2.0 * static_cast<double>(batchSize) / static_cast<double>(n + 1));
+            smoothedInertia = smoothedInertia < 0.0 ? batchInertia : smoothedInertia * (1.0 - alpha) + batchInertia * alpha;
+            if (smoothedInertia < bestInertia) {
+                bestInertia = smoothedInertia;
+                sinceImprovement = 0;
+            } else if (++sinceImprovement >= kMiniBatchPatience) {
+                break;
+            }
+            if (iterations > 1 && squaredShift <= shiftThreshold) {
+                break;
+            }
+            if (control && control->checkpoint(static_cast<double>(iterations) / static_cast<double>(maxIterations), result,
+                                               {{"batchInertia", smoothedInertia}})) {
+                return result;
+            }
+        }
+        iterations = std::min(iterations, maxIterations);
+        
+        std::vector<uint32_t> assignment;
+        inertia = assignNearest(trainingData, m_centroids, assignment);
+    }
+    
+    // 聚类没有准确率，这里用簇间平方和占总平方和的比例作为聚类质量的指标
+    result.success = true;
+    result.accuracy = totalSquares > 0.0 ? std::max(0.0, 1.0 - inertia / totalSquares) : 1.0;
+    result.meanSquaredError = inertia / static_cast<double>(n);
+    result.additionalMetrics["inertia"] = inertia;
+    result.additionalMetrics["iterations"] = static_cast<double>(iterations);
+    result.additionalMetrics["numClusters"] = static_cast<double>(k);
+    return result;
+}
+
+TrainingResult KMeansModel::partialFit(
+    const ConstMatrixView& chunk,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters) {
+    
+    (void)labels;
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    size_t k = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "numClusters", 8)));
+    bool randomInit = parameterOr(parameters, "init", 0.0) == 1.0;
+    size_t batchSize = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "batchSize", 1024)));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    if (chunk.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (!m_centroids.empty() && chunk.cols() != m_centroids.cols()) {
+        result.errorMessage = "Feature count does not match previous chunks";
+        return result;
+    }
+    
+    // 第一个数据块初始化中心，之后的数据块（以及 train() 或加载得到的模型）在已有中心上继续更新
+    double samplesSeen = 0.0;
+    for (double size : m_clusterSizes) {
+        samplesSeen += size;
+    }
+    std::mt19937_64 rng(seed + static_cast<uint64_t>(samplesSeen));
+    if (m_centroids.empty()) {
+        if (chunk.rows() < k) {
+            result.errorMessage = "Fewer samples than clusters in the first chunk";
+            return result;
+        }
+        m_centroids = randomInit ? seedRandom(chunk, k, rng) : seedPlusPlus(chunk, k, rng);
+        m_clusterSizes.assign(k, 0.0);
+    }
+    k = m_centroids.rows();
+    
+    // 数据块内打乱后按批大小切分，逐批更新（存储层按插入顺序返回的数据往往不是随机的）
+    std::vector<size_t> order(chunk.rows());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    
+    MiniBatchUpdater updater(k, chunk.cols());
+    std::vector<size_t> batch;
+    double batches = 0.0;
+    for (size_t begin = 0; begin < order.size(); begin += batchSize) {
+        size_t end = std::min(order.size(), begin + batchSize);
+        batch.assign(order.begin() + begin, order.begin() + end);
+        double squaredShift = 0.0;
+        updater.step(chunk, batch, m_centroids, m_clusterSizes, squaredShift);
+        batches += 1.0;
+    }
+    
+    // 指标在当前数据块上按更新后的中心统计
+    std::vector<uint32_t> assignment;
+    double inertia = assignNearest(chunk, m_centroids, assignment);
+    double totalSquares = totalSumOfSquares(chunk);
+    
+    result.success = true;
+    result.accuracy = totalSquares > 0.0 ? std::max(0.0, 1.0 - inertia / totalSquares) : 1.0;
+    result.meanSquaredError = inertia / static_cast<double>(chunk.rows());
+    result.additionalMetrics["inertia"] = inertia;
+    result.additionalMetrics["batches"] = batches;
+    result.additionalMetrics["numClusters"] = static_cast<double>(k);
+    result.additionalMetrics["samplesSeen"] = samplesSeen + static_cast<double>(chunk.rows());
+    return result;
+}
+
+std::vector<double> KMeansModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_centroids.empty() || testData.empty() || testData.cols() != m_centroids.cols()) {
+        return {};
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            double best;
+            double second;
+            predictions[i] = static_cast<double>(nearestCenter(testData.row(i), m_centroids, best, second));
+        }
+    });
+    return predictions;
+}
+
+bool KMeansModel::saveModel(const std::string& filePath) {
+    try {
+        ModelFileWriter writer(ModelType::KMeans);
+        writer.addMatrix(kCentroidsSection, m_centroids);
+        writer.addArray(kClusterSizesSection, m_clusterSizes);
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool KMeansModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::KMeans) {
+            return false;
+        }
+        
+        auto centroids = file->section<double>(kCentroidsSection);
+        auto sizes = file->section<double>(kClusterSizesSection);
+        if (!centroids.valid || !sizes.valid || centroids.rows == 0 || sizes.count != centroids.rows) {
+            return false;
+        }
+        
+        m_centroids = Matrix::copyOf(centroids.matrix());
+        m_clusterSizes.assign(sizes.data, sizes.data + sizes.count);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
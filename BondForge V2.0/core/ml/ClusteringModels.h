@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include "MLModels.h"
+#include "ModelFile.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 原生K均值聚类模型（不依赖mlpack）
+ * 
+ * 初始中心用k-means++选取（按到已选中心的距离平方加权采样）。全量训练使用带三角不等式剪枝的
+ * Lloyd迭代：Hamerly算法为每个样本保存到所属中心的距离上界和到次近中心的距离下界，
+ * Elkan算法为每个样本保存到每个中心的下界，界能排除的样本不再计算距离。
+ * 维数较高、中心较少且内存允许时自动选用Elkan，否则使用Hamerly。
+ * 分配步骤按固定行块在线程池上并行执行，各块的中心累加和按块序号合并，
+ * 因此给定随机种子时结果与线程数无关。距离计算使用SIMD内核。
+ * 
+ * batchSize 大于0时改用小批量K均值：每轮随机抽取一批样本，按各中心累计的样本数
+ * 以递减的步长移动中心，适合无法多次完整遍历的大数据或流式数据。
+ * partialFit() 以同样的方式逐块更新：第一个数据块用k-means++初始化中心，
+ * 每个数据块打乱后按 batchSize（默认1024）切分成小批量依次更新。
+ * 
+ * 训练参数：
+ * - numClusters：簇的数量（默认8）
+ * - maxIterations：最大迭代轮数（小批量时为最大批数，默认300）
+ * - tolerance：中心移动量平方和相对于数据平均方差的收敛阈值（默认1e-4）
+ * - init：0 为k-means++（默认），1 为随机选取样本
+ * - algorithm：0 自动（默认），1 Hamerly，2 Elkan
+ * - batchSize：小批量大小（默认0，即全量训练）
+ * - seed：随机种子（默认42）
+ * 
+ * 训练标签不参与训练，可以传入空向量。
+ */
+class KMeansModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsPartialFit() const override { return true; }
+    
+    TrainingResult partialFit(
+        const ConstMatrixView& chunk,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测每个样本所属的簇（返回簇编号）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    ModelType getModelType() const override { return ModelType::KMeans; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 簇中心（簇数×特征数）
+     */
+    const Matrix& centroids() const { return m_centroids; }
+    
+    /**
+     * @brief 每个簇累计分配到的样本数
+     */
+    const std::vector<double>& clusterSizes() const { return m_clusterSizes; }
+    
+    size_t clusterCount() const { return m_centroids.rows(); }
+
+private:
+    
+    Matrix m_centroids;
+    std::vector<double> m_clusterSizes;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
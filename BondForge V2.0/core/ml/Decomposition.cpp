@@ -0,0 +1,547 @@
+#include "Decomposition.h"
+#include "ModelCommon.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 每个行块的目标行数和行块数上限；行块划分只取决于数据形状，与线程数无关
+constexpr size_t kChunkRows = 16384;
+constexpr size_t kMaxChunks = 64;
+
+// 所有行块的部分和合计占用的内存上限
+constexpr size_t kAccumulatorBudgetBytes = size_t(256) << 20;
+
+// 行片的行数：中心化的行片、ÃQ 和 Z 的部分和同时留在缓存中
+constexpr size_t kTileRows = 32;
+
+constexpr size_t kTransformGrainSize = 4096;
+
+// 雅可比特征分解的最大扫描次数
+constexpr int kMaxJacobiSweeps = 64;
+
+/**
+ * @brief 固定的行块划分
+ */
+struct RowChunks {
+    size_t count = 1;
+    size_t rows = 0;
+
+    RowChunks(size_t totalRows, size_t bytesPerChunk) : rows(totalRows) {
+        size_t budgetChunks = std::max<size_t>(1, kAccumulatorBudgetBytes / std::max<size_t>(1, bytesPerChunk));
+        count = std::min({(totalRows + kChunkRows - 1) / kChunkRows, kMaxChunks, budgetChunks});
+        count = std::max<size_t>(1, count);
+    }
+
+    size_t begin(size_t chunk) const { return rows * chunk / count; }
+    size_t end(size_t chunk) const { return rows * (chunk + 1) / count; }
+};
+
+/**
+ * @brief 累加各列之和
+ */
+void accumulateColumnSums(const ConstMatrixView& data, std::vector<double>& sums) {
+    size_t cols = data.cols();
+    RowChunks chunks(data.rows(), cols * sizeof(double));
+    std::vector<std::vector<double>> partial(chunks.count);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            std::vector<double>& local = partial[c];
+            local.assign(cols, 0.0);
+            for (size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                const double* row = data.row(i);
+                for (size_t j = 0; j < cols; ++j) {
+                    local[j] += row[j];
+                }
+            }
+        }
+    });
+
+    for (const std::vector<double>& local : partial) {
+        for (size_t j = 0; j < cols; ++j) {
+            sums[j] += local[j];
+        }
+    }
+}
+
+/**
+ * @brief 累加一个数据块对 Z = Ãᵀ(ÃQ) 和 Σ‖x - μ‖² 的贡献
+ *
+ * 每个行片先减去均值，再计算行片的 ÃQ（行片行数×l），然后把 行片ᵀ(ÃQ) 加到行块的部分和上。
+ */
+void accumulateGram(const ConstMatrixView& data, const std::vector<double>& mean, const Matrix& basis,
+                    Matrix& gram, double& squaredSum) {
+    size_t cols = data.cols();
+    size_t width = basis.cols();
+    RowChunks chunks(data.rows(), cols * width * sizeof(double));
+    std::vector<Matrix> partial(chunks.count);
+    std::vector<double> partialSquares(chunks.count, 0.0);
+
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t begin, size_t end) {
+        std::vector<double> tile(kTileRows * cols);
+        std::vector<double> projected(kTileRows * width);
+        for (size_t c = begin; c < end; ++c) {
+            Matrix& local = partial[c];
+            local.assign(cols, width, 0.0);
+            double squares = 0.0;
+
+            for (size_t first = chunks.begin(c); first < chunks.end(c); first += kTileRows) {
+                size_t tileRows = std::min(kTileRows, chunks.end(c) - first);
+                for (size_t i = 0; i < tileRows; ++i) {
+                    const double* row = data.row(first + i);
+                    double* centered = tile.data() + i * cols;
+                    for (size_t j = 0; j < cols; ++j) {
+                        centered[j] = row[j] - mean[j];
+                        squares += centered[j] * centered[j];
+                    }
+                }
+
+                std::fill(projected.begin(), projected.begin() + tileRows * width, 0.0);
+                for (size_t i = 0; i < tileRows; ++i) {
+                    const double* centered = tile.data() + i * cols;
+                    double* out = projected.data() + i * width;
+                    for (size_t j = 0; j < cols; ++j) {
+                        double value = centered[j];
+                        const double* q = basis.row(j);
+                        for (size_t m = 0; m < width; ++m) {
+                            out[m] += value * q[m];
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < tileRows; ++i) {
+                    const double* centered = tile.data() + i * cols;
+                    const double* in = projected.data() + i * width;
+                    for (size_t j = 0; j < cols; ++j) {
+                        double value = centered[j];
+                        double* z = local.row(j);
+                        for (size_t m = 0; m < width; ++m) {
+                            z[m] += value * in[m];
+                        }
+                    }
+                }
+            }
+            partialSquares[c] = squares;
+        }
+    });
+
+    for (size_t c = 0; c < chunks.count; ++c) {
+        const double* local = partial[c].data();
+        double* out = gram.data();
+        for (size_t i = 0; i < gram.size(); ++i) {
+            out[i] += local[i];
+        }
+        squaredSum += partialSquares[c];
+    }
+}
+
+/**
+ * @brief 列正交化（两遍修正的Gram-Schmidt；与之前各列线性相关的列置0）
+ */
+void orthonormalizeColumns(Matrix& basis) {
+    size_t rows = basis.rows();
+    size_t cols = basis.cols();
+    for (size_t j = 0; j < cols; ++j) {
+        double original = 0.0;
+        for (size_t i = 0; i < rows; ++i) {
+            original += basis(i, j) * basis(i, j);
+        }
+
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t p = 0; p < j; ++p) {
+                double dot = 0.0;
+                for (size_t i = 0; i < rows; ++i) {
+                    dot += basis(i, j) * basis(i, p);
+                }
+                for (size_t i = 0; i < rows; ++i) {
+                    basis(i, j) -= dot * basis(i, p);
+                }
+            }
+        }
+
+        double norm = 0.0;
+        for (size_t i = 0; i < rows; ++i) {
+            norm += basis(i, j) * basis(i, j);
+        }
+        double scale = (norm > 1e-20 * original && norm > 0.0) ? 1.0 / std::sqrt(norm) : 0.0;
+        for (size_t i = 0; i < rows; ++i) {
+            basis(i, j) *= scale;
+        }
+    }
+}
+
+/**
+ * @brief 对称矩阵的特征分解（循环雅可比法），特征值降序
+ *
+ * @param a 对称矩阵（被破坏）
+ * @param vectors 输出的特征向量（按列）
+ * @param values 输出的特征值
+ */
+void symmetricEigen(Matrix& a, Matrix& vectors, std::vector<double>& values) {
+    size_t n = a.rows();
+    vectors.assign(n, n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        vectors(i, i) = 1.0;
+    }
+
+    for (int sweep = 0; sweep < kMaxJacobiSweeps; ++sweep) {
+        double offDiagonal = 0.0;
+        double diagonal = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            diagonal += a(i, i) * a(i, i);
+            for (size_t j = i + 1; j < n; ++j) {
+                offDiagonal += a(i, j) * a(i, j);
+            }
+        }
+        if (offDiagonal <= 1e-30 * diagonal || offDiagonal == 0.0) {
+            break;
+        }
+
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t q = p + 1; q < n; ++q) {
+                if (a(p, q) == 0.0) {
+                    continue;
+                }
+                double theta = (a(q, q) - a(p, p)) / (2.0 * a(p, q));
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (size_t k = 0; k < n; ++k) {
+                    double akp = a(k, p);
+                    double akq = a(k, q);
+                    a(k, p) = c * akp - s * akq;
+                    a(k, q) = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    double apk = a(p, k);
+                    double aqk = a(q, k);
+                    a(p, k) = c * apk - s * aqk;
+                    a(q, k) = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    double vkp = vectors(k, p);
+                    double vkq = vectors(k, q);
+                    vectors(k, p) = c * vkp - s * vkq;
+                    vectors(k, q) = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&a](size_t x, size_t y) { return a(x, x) > a(y, y); });
+
+    Matrix sorted(n, n);
+    values.resize(n);
+    for (size_t c = 0; c < n; ++c) {
+        values[c] = a(order[c], order[c]);
+        for (size_t r = 0; r < n; ++r) {
+            sorted(r, c) = vectors(r, order[c]);
+        }
+    }
+    vectors = std::move(sorted);
+}
+
+} // namespace
+
+// RandomizedPCA 实现
+RandomizedPCA::RandomizedPCA(const RandomizedSvdOptions& options)
+    : m_options(options) {
+}
+
+bool RandomizedPCA::fit(const ConstMatrixView& data) {
+    return fitPasses([&data](const BlockVisitor& visit) {
+        visit(data);
+        return true;
+    });
+}
+
+bool RandomizedPCA::fit(IFeatureChunkSource& source) {
+    return fitPasses([&source](const BlockVisitor& visit) {
+        if (!source.rewind()) {
+            return false;
+        }
+        Matrix features;
+        std::vector<double> labels;
+        while (source.readChunk(features, labels)) {
+            visit(features);
+        }
+        return true;
+    });
+}
+
+bool RandomizedPCA::fitPasses(const DataPass& pass) {
+    m_fitted = false;
+
+    // 第一遍：样本数、特征数和列均值
+    size_t cols = 0;
+    uint64_t rows = 0;
+    bool consistent = true;
+    std::vector<double> sums;
+    bool ok = pass([&](const ConstMatrixView& block) {
+        if (block.rows() == 0 || !consistent) {
+            return;
+        }
+        if (rows == 0) {
+            cols = block.cols();
+            sums.assign(cols, 0.0);
+        }
+        if (block.cols() != cols) {
+            consistent = false;
+            return;
+        }
+        accumulateColumnSums(block, sums);
+        rows += block.rows();
+    });
+    if (!ok || !consistent || rows == 0 || cols == 0) {
+        return false;
+    }
+
+    std::vector<double> mean(cols, 0.0);
+    if (m_options.center) {
+        for (size_t j = 0; j < cols; ++j) {
+            mean[j] = sums[j] / static_cast<double>(rows);
+        }
+    }
+
+    size_t components = std::min<uint64_t>(std::min(m_options.components, cols), rows);
+    if (components == 0) {
+        return false;
+    }
+    size_t width = std::min(components + m_options.oversampling, cols);
+
+    Matrix basis(cols, width);
+    std::mt19937_64 generator(m_options.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    for (size_t i = 0; i < basis.size(); ++i) {
+        basis.data()[i] = normal(generator);
+    }
+    orthonormalizeColumns(basis);
+
+    // 子空间迭代：每一遍 Z = Ãᵀ(ÃQ)，最后一遍之外把 Z 正交化作为下一遍的 Q
+    Matrix gram;
+    double squaredSum = 0.0;
+    for (size_t iteration = 0; iteration <= m_options.powerIterations; ++iteration) {
+        gram.assign(cols, width, 0.0);
+        squaredSum = 0.0;
+        ok = pass([&](const ConstMatrixView& block) {
+            if (block.rows() == 0 || !consistent) {
+                return;
+            }
+            if (block.cols() != cols) {
+                consistent = false;
+                return;
+            }
+            accumulateGram(block, mean, basis, gram, squaredSum);
+        });
+        if (!ok || !consistent) {
+            return false;
+        }
+
+        if (iteration < m_options.powerIterations) {
+            basis = gram;
+            orthonormalizeColumns(basis);
+        }
+    }
+
+    // 在子空间内求 QᵀÃᵀÃQ 的特征分解，主成分方向为 Q 乘以特征向量
+    Matrix projected(width, width);
+    for (size_t a = 0; a < width; ++a) {
+        for (size_t b = 0; b < width; ++b) {
+            double sum = 0.0;
+            for (size_t i = 0; i < cols; ++i) {
+                sum += basis(i, a) * gram(i, b);
+            }
+            projected(a, b) = sum;
+        }
+    }
+    for (size_t a = 0; a < width; ++a) {
+        for (size_t b = a + 1; b < width; ++b) {
+            double average = 0.5 * (projected(a, b) + projected(b, a));
+            projected(a, b) = average;
+            projected(b, a) = average;
+        }
+    }
+
+    Matrix vectors;
+    std::vector<double> values;
+    symmetricEigen(projected, vectors, values);
+
+    m_components.assign(components, cols, 0.0);
+    for (size_t c = 0; c < components; ++c) {
+        double* direction = m_components.row(c);
+        for (size_t i = 0; i < cols; ++i) {
+            double sum = 0.0;
+            for (size_t a = 0; a < width; ++a) {
+                sum += basis(i, a) * vectors(a, c);
+            }
+            direction[i] = sum;
+        }
+
+        // 符号约定：绝对值最大的分量为正，同样的数据总得到同样的方向
+        size_t largest = 0;
+        for (size_t i = 1; i < cols; ++i) {
+            if (std::abs(direction[i]) > std::abs(direction[largest])) {
+                largest = i;
+            }
+        }
+        if (direction[largest] < 0.0) {
+            for (size_t i = 0; i < cols; ++i) {
+                direction[i] = -direction[i];
+            }
+        }
+    }
+
+    double denominator = rows > 1 ? static_cast<double>(rows - 1) : 1.0;
+    double totalVariance = squaredSum / denominator;
+    m_singularValues.resize(components);
+    m_explainedVariance.resize(components);
+    m_explainedVarianceRatio.resize(components);
+    for (size_t c = 0; c < components; ++c) {
+        double eigenvalue = std::max(0.0, values[c]);
+        m_singularValues[c] = std::sqrt(eigenvalue);
+        m_explainedVariance[c] = eigenvalue / denominator;
+        m_explainedVarianceRatio[c] = totalVariance > 0.0 ? m_explainedVariance[c] / totalVariance : 0.0;
+    }
+
+    m_mean = std::move(mean);
+    m_samples = rows;
+    m_fitted = true;
+    return true;
+}
+
+Matrix RandomizedPCA::transform(const ConstMatrixView& data) const {
+    if (!m_fitted || data.cols() != m_mean.size()) {
+        return Matrix();
+    }
+
+    size_t cols = m_mean.size();
+    size_t components = m_components.rows();
+    Matrix result(data.rows(), components);
+    Utils::ThreadPool::instance().parallelFor(0, data.rows(), kTransformGrainSize, [&](size_t begin, size_t end) {
+        std::vector<double> centered(cols);
+        for (size_t i = begin; i < end; ++i) {
+            const double* row = data.row(i);
+            for (size_t j = 0; j < cols; ++j) {
+                centered[j] = row[j] - m_mean[j];
+            }
+            double* out = result.row(i);
+            for (size_t c = 0; c < components; ++c) {
+                const double* direction = m_components.row(c);
+                double sum = 0.0;
+                for (size_t j = 0; j < cols; ++j) {
+                    sum += centered[j] * direction[j];
+                }
+                out[c] = sum;
+            }
+        }
+    });
+    return result;
+}
+
+// ProjectionCache 实现
+ProjectionCache::ProjectionCache(size_t maxEntries)
+    : m_maxEntries(std::max<size_t>(1, maxEntries)) {
+}
+
+ProjectionCache& ProjectionCache::instance() {
+    static ProjectionCache cache;
+    return cache;
+}
+
+std::shared_ptr<const Projection> ProjectionCache::getProjection(Data::IDataService& dataService,
+                                                                 const FeatureRequest& request,
+                                                                 const RandomizedSvdOptions& options) {
+    const uint64_t version = dataService.getDataVersion();
+    const Key key(&dataService, request.featureType, request.labelType, request.scaling,
+                  options.components, options.oversampling, options.powerIterations, options.center, options.seed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (std::get<0>(it->first) == &dataService && it->second.projection->dataVersion != version) {
+                it = m_entries.erase(it);
+                ++m_stats.invalidations;
+            } else {
+                ++it;
+            }
+        }
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            it->second.lastUsed = ++m_clock;
+            ++m_stats.hits;
+            return it->second.projection;
+        }
+    }
+
+    std::shared_ptr<const FeatureSet> features = FeatureCache::instance().getFeatures(dataService, request);
+    if (!features) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto projection = std::make_shared<Projection>();
+    projection->pca = RandomizedPCA(options);
+    if (!projection->pca.fit(features->features)) {
+        return nullptr;
+    }
+    projection->coordinates = projection->pca.transform(features->features);
+    projection->labels = features->labels;
+    projection->dataVersion = features->dataVersion;
+    projection->fitSeconds = secondsSince(start);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.misses;
+    Entry& entry = m_entries[key];
+    entry.projection = projection;
+    entry.lastUsed = ++m_clock;
+    while (m_entries.size() > m_maxEntries) {
+        auto victim = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.lastUsed < victim->second.lastUsed) {
+                victim = it;
+            }
+        }
+        m_entries.erase(victim);
+        ++m_stats.evictions;
+    }
+    return projection;
+}
+
+void ProjectionCache::invalidate(const Data::IDataService& dataService) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (std::get<0>(it->first) == &dataService) {
+            it = m_entries.erase(it);
+            ++m_stats.invalidations;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ProjectionCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+ProjectionCacheStats ProjectionCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ProjectionCacheStats stats = m_stats;
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
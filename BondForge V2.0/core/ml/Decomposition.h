@@ -0,0 +1,187 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "Matrix.h"
+#include "FeatureCache.h"
+#include "IncrementalTraining.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 随机化SVD选项
+ */
+struct RandomizedSvdOptions {
+    size_t components = 2;          // 保留的主成分数
+    size_t oversampling = 10;       // 随机子空间比主成分多出的维数
+    size_t powerIterations = 2;     // 幂迭代次数（奇异值衰减慢的数据需要更多次）
+    bool center = true;             // 减去列均值（主成分分析）；为false时为截断SVD
+    uint64_t seed = 42;             // 随机投影的种子
+};
+
+/**
+ * @brief 随机化主成分分析 / 截断SVD
+ *
+ * 用随机子空间迭代求数据矩阵 Ã（减去均值后的数据）的前k个右奇异向量：
+ * 从随机高斯矩阵 Ω（特征数×l，l = k + oversampling）开始，每一遍对数据计算 Z = Ãᵀ(ÃQ) 并正交化，
+ * 最后在 l 维子空间内对 QᵀÃᵀÃQ 做特征分解。均值在计算中隐式减去，不生成中心化的数据副本。
+ *
+ * 每一遍把数据按固定的行块划分，各行块在共享线程池上并行地按小行片计算 ÃQ 和 Ãᵀ(ÃQ)，
+ * 部分和按行块顺序合并，因此结果与线程数无关。需要的内存只有 特征数×l 的矩阵，
+ * 数据可以来自内存中的矩阵，也可以来自 IFeatureChunkSource 逐块读取（共 powerIterations + 2 遍：
+ * 一遍求均值，其余各遍计算 Z）。代价为 O(样本数 × 特征数 × l) 每遍，而精确分解需要 O(样本数 × 特征数²)。
+ */
+class RandomizedPCA {
+public:
+    explicit RandomizedPCA(const RandomizedSvdOptions& options = {});
+
+    /**
+     * @brief 在内存中的数据上拟合
+     *
+     * @return 是否成功（数据为空时失败）
+     */
+    bool fit(const ConstMatrixView& data);
+
+    /**
+     * @brief 从数据块来源逐块拟合（每一遍前调用 rewind()，标签被忽略）
+     *
+     * @return 是否成功（来源为空、无法回到开头或各数据块的特征数不一致时失败）
+     */
+    bool fit(IFeatureChunkSource& source);
+
+    /**
+     * @brief 投影到主成分（样本数×components）
+     *
+     * @return 投影结果（未拟合或特征数不符时返回空矩阵）
+     */
+    Matrix transform(const ConstMatrixView& data) const;
+
+    bool isFitted() const { return m_fitted; }
+    const RandomizedSvdOptions& options() const { return m_options; }
+    size_t featureCount() const { return m_mean.size(); }
+    size_t componentCount() const { return m_components.rows(); }
+    uint64_t sampleCount() const { return m_samples; }
+
+    /**
+     * @brief 主成分方向（componentCount()×featureCount()，每行为单位向量）
+     */
+    const Matrix& components() const { return m_components; }
+
+    /**
+     * @brief 列均值（不中心化时为0）
+     */
+    const std::vector<double>& mean() const { return m_mean; }
+
+    const std::vector<double>& singularValues() const { return m_singularValues; }
+
+    /**
+     * @brief 各主成分的方差（奇异值² / (样本数 - 1)）
+     */
+    const std::vector<double>& explainedVariance() const { return m_explainedVariance; }
+
+    /**
+     * @brief 各主成分的方差占总方差的比例
+     */
+    const std::vector<double>& explainedVarianceRatio() const { return m_explainedVarianceRatio; }
+
+private:
+    using BlockVisitor = std::function<void(const ConstMatrixView& block)>;
+    using DataPass = std::function<bool(const BlockVisitor& visit)>;
+
+    bool fitPasses(const DataPass& pass);
+
+    RandomizedSvdOptions m_options;
+    bool m_fitted = false;
+    uint64_t m_samples = 0;
+    std::vector<double> m_mean;
+    Matrix m_components;
+    std::vector<double> m_singularValues;
+    std::vector<double> m_explainedVariance;
+    std::vector<double> m_explainedVarianceRatio;
+};
+
+/**
+ * @brief 数据集的主成分投影
+ */
+struct Projection {
+    RandomizedPCA pca;
+    Matrix coordinates;             // 每条记录一行，列为各主成分
+    std::vector<double> labels;     // 与 FeatureCache 返回的标签相同（用于着色）
+    uint64_t dataVersion = 0;
+    double fitSeconds = 0.0;
+};
+
+/**
+ * @brief 投影缓存统计
+ */
+struct ProjectionCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+};
+
+/**
+ * @brief 主成分投影缓存
+ *
+ * 以 (数据服务, 特征请求, 投影选项) 为键保存拟合的投影，数据版本号改变后丢弃该数据服务的旧投影，
+ * 切换图表或重复刷新时不必重新拟合。特征来自 FeatureCache::instance()。
+ * 缓存按最近最少使用的顺序保留 maxEntries 个投影。所有方法都可以在多个线程中调用。
+ */
+class ProjectionCache {
+public:
+    explicit ProjectionCache(size_t maxEntries = 8);
+
+    ProjectionCache(const ProjectionCache&) = delete;
+    ProjectionCache& operator=(const ProjectionCache&) = delete;
+
+    /**
+     * @brief 全局投影缓存
+     */
+    static ProjectionCache& instance();
+
+    /**
+     * @brief 获取数据集当前版本的投影（未缓存时提取特征并拟合）
+     *
+     * @return 投影（与其他调用者共享，不能修改；特征提取或拟合失败时返回空指针）
+     */
+    std::shared_ptr<const Projection> getProjection(Data::IDataService& dataService, const FeatureRequest& request,
+                                                    const RandomizedSvdOptions& options = {});
+
+    /**
+     * @brief 丢弃一个数据服务的所有投影
+     */
+    void invalidate(const Data::IDataService& dataService);
+
+    void clear();
+
+    ProjectionCacheStats stats() const;
+
+private:
+    using Key = std::tuple<const Data::IDataService*, std::string, std::string, FeatureScaling,
+                           size_t, size_t, size_t, bool, uint64_t>;
+
+    struct Entry {
+        std::shared_ptr<const Projection> projection;
+        uint64_t lastUsed = 0;
+    };
+
+    size_t m_maxEntries;
+    mutable std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    uint64_t m_clock = 0;
+    ProjectionCacheStats m_stats;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
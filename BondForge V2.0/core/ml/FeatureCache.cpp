@@ -0,0 +1,395 @@
+#include "FeatureCache.h"
+#include "ModelCommon.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kColumnFileMagic = 0x43464642;   // "BFFC"
+constexpr uint32_t kColumnFileVersion = 1;
+
+// 文件头：魔数和版本（2个uint32），行数、特征数、标签数和缩放方式（4个uint64）
+constexpr uint64_t kColumnFileHeaderBytes = 2 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+
+using Clock = std::chrono::steady_clock;
+
+std::string defaultSpillDirectory(const void* owner) {
+    std::error_code error;
+    std::filesystem::path base = std::filesystem::temp_directory_path(error);
+    if (error) {
+        return std::string();
+    }
+    // 同一进程内的多个缓存和多个进程各自使用不同的目录
+    auto stamp = static_cast<unsigned long long>(Clock::now().time_since_epoch().count());
+    std::string name = "bondforge_feature_cache_" + std::to_string(stamp) + "_" +
+                       std::to_string(reinterpret_cast<uintptr_t>(owner));
+    return (base / name).string();
+}
+
+} // namespace
+
+FeatureCache::FeatureCache(const FeatureCacheOptions& options)
+    : m_options(options) {
+    if (m_options.spillDirectory.empty()) {
+        m_spillDirectory = defaultSpillDirectory(this);
+    } else if (m_options.spillDirectory != "-") {
+        m_spillDirectory = m_options.spillDirectory;
+    }
+}
+
+FeatureCache::~FeatureCache() {
+    clear();
+    
+    // 只删除自己创建的默认目录（目录非空时 remove 不做任何事）
+    if (m_options.spillDirectory.empty() && !m_spillDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::remove(m_spillDirectory, error);
+    }
+}
+
+FeatureCache& FeatureCache::instance() {
+    static FeatureCache cache;
+    return cache;
+}
+
+std::shared_ptr<const FeatureSet> FeatureCache::getFeatures(Data::IDataService& dataService, const FeatureRequest& request) {
+    // 先读版本号再读记录：两者之间发生的修改会使缓存项的版本号偏旧，下次请求时失效，不会返回过期的特征
+    const uint64_t version = dataService.getDataVersion();
+    const Key key(&dataService, request.featureType, request.labelType, request.scaling);
+    
+    std::string spillPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        invalidateLocked(&dataService, version, false);
+        
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            it->second.lastUsed = ++m_clock;
+            if (it->second.data) {
+                ++m_stats.memoryHits;
+                return it->second.data;
+            }
+            if (it->second.spilling) {
+                ++m_stats.memoryHits;
+                return it->second.spilling;
+            }
+            spillPath = it->second.spillPath;
+        }
+    }
+    
+    // 已移出内存的特征集从溢出文件读回，并重新放入内存
+    if (!spillPath.empty()) {
+        std::shared_ptr<FeatureSet> loaded = readColumns(spillPath);
+        std::vector<SpillJob> spills;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if (loaded) {
+                loaded->dataVersion = version;
+                ++m_stats.diskHits;
+                if (it != m_entries.end() && it->second.version == version && !it->second.data) {
+                    it->second.data = loaded;
+                    m_stats.memoryBytes += it->second.bytes;
+                    enforceBudgetsLocked(spills);
+                }
+            } else if (it != m_entries.end() && it->second.spillPath == spillPath) {
+                removeEntryLocked(it);
+            }
+        }
+        writeSpills(spills);
+        if (loaded) {
+            return loaded;
+        }
+    }
+    
+    auto start = Clock::now();
+    auto set = std::make_shared<FeatureSet>();
+    try {
+        std::vector<Data::DataRecord> records = dataService.getAllData();
+        PreprocessingPipeline pipeline;
+        pipeline.setFeatureType(request.featureType)
+            .setLabelType(request.labelType)
+            .setScaling(request.scaling)
+            .setTrainRatio(1.0);
+        PreprocessedData data = pipeline.fitTransform(records);
+        set->features = std::move(data.trainFeatures);
+        set->labels = std::move(data.trainLabels);
+        set->scaler = pipeline.scaler();
+        set->dataVersion = version;
+    } catch (...) {
+        return nullptr;
+    }
+    double seconds = secondsSince(start);
+    
+    std::vector<SpillJob> spills;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.misses;
+        m_stats.extractionSeconds += seconds;
+        storeLocked(key, set, spills);
+    }
+    writeSpills(spills);
+    return set;
+}
+
+void FeatureCache::invalidate(const Data::IDataService& dataService) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    invalidateLocked(&dataService, 0, true);
+}
+
+void FeatureCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_entries.empty()) {
+        removeEntryLocked(m_entries.begin());
+    }
+}
+
+FeatureCacheStats FeatureCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FeatureCacheStats result = m_stats;
+    for (const auto& [key, entry] : m_entries) {
+        result.memoryEntries += (entry.data || entry.spilling) ? 1 : 0;
+        result.diskEntries += entry.spillPath.empty() ? 0 : 1;
+    }
+    return result;
+}
+
+size_t FeatureCache::byteSize(const FeatureSet& set) {
+    return (set.features.size() + set.labels.size()) * sizeof(double);
+}
+
+bool FeatureCache::writeColumns(const std::string& filePath, const FeatureSet& set) {
+    try {
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        const size_t rows = set.features.rows();
+        const size_t cols = set.features.cols();
+        uint32_t header[2] = {kColumnFileMagic, kColumnFileVersion};
+        uint64_t scalerCols = set.scaler.scale.size();
+        uint64_t shape[4] = {rows, cols, set.labels.size(), static_cast<uint64_t>(set.scaler.scaling)};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+        file.write(reinterpret_cast<const char*>(set.labels.data()), set.labels.size() * sizeof(double));
+        file.write(reinterpret_cast<const char*>(&scalerCols), sizeof(scalerCols));
+        file.write(reinterpret_cast<const char*>(set.scaler.offset.data()), scalerCols * sizeof(double));
+        file.write(reinterpret_cast<const char*>(set.scaler.scale.data()), scalerCols * sizeof(double));
+        
+        // 按列写入：每列连续存放
+        std::vector<double> column(rows);
+        for (size_t j = 0; j < cols; ++j) {
+            for (size_t i = 0; i < rows; ++i) {
+                column[i] = set.features(i, j);
+            }
+            file.write(reinterpret_cast<const char*>(column.data()), rows * sizeof(double));
+        }
+        file.close();
+        return !file.fail();
+    } catch (...) {
+        return false;
+    }
+}
+
+std::shared_ptr<FeatureSet> FeatureCache::readColumns(const std::string& filePath) {
+    try {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return nullptr;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+        
+        uint32_t header[2] = {0, 0};
+        uint64_t shape[4] = {0, 0, 0, 0};
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        file.read(reinterpret_cast<char*>(shape), sizeof(shape));
+        if (!file || header[0] != kColumnFileMagic || header[1] != kColumnFileVersion ||
+            shape[1] > (uint64_t(1) << 24) || shape[2] > fileSize / sizeof(double) ||
+            shape[3] > static_cast<uint64_t>(FeatureScaling::Standard) ||
+            (shape[1] != 0 && shape[0] > fileSize / sizeof(double) / shape[1])) {
+            return nullptr;
+        }
+        
+        const size_t rows = static_cast<size_t>(shape[0]);
+        const size_t cols = static_cast<size_t>(shape[1]);
+        auto set = std::make_shared<FeatureSet>();
+        set->labels.resize(static_cast<size_t>(shape[2]));
+        file.read(reinterpret_cast<char*>(set->labels.data()), set->labels.size() * sizeof(double));
+        
+        uint64_t scalerCols = 0;
+        file.read(reinterpret_cast<char*>(&scalerCols), sizeof(scalerCols));
+        if (!file || (scalerCols != 0 && scalerCols != cols) ||
+            fileSize != kColumnFileHeaderBytes + sizeof(uint64_t) +
+                        (shape[2] + 2 * scalerCols + shape[0] * shape[1]) * sizeof(double)) {
+            return nullptr;
+        }
+        set->scaler.scaling = static_cast<FeatureScaling>(shape[3]);
+        set->scaler.offset.resize(static_cast<size_t>(scalerCols));
+        set->scaler.scale.resize(static_cast<size_t>(scalerCols));
+        file.read(reinterpret_cast<char*>(set->scaler.offset.data()), scalerCols * sizeof(double));
+        file.read(reinterpret_cast<char*>(set->scaler.scale.data()), scalerCols * sizeof(double));
+        
+        set->features.assign(rows, cols);
+        std::vector<double> column(rows);
+        for (size_t j = 0; j < cols; ++j) {
+            file.read(reinterpret_cast<char*>(column.data()), rows * sizeof(double));
+            for (size_t i = 0; i < rows; ++i) {
+                set->features(i, j) = column[i];
+            }
+        }
+        if (!file) {
+            return nullptr;
+        }
+        return set;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void FeatureCache::invalidateLocked(const Data::IDataService* source, uint64_t currentVersion, bool all) {
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        auto next = std::next(it);
+        if (std::get<0>(it->first) == source && (all || it->second.version != currentVersion)) {
+            ++m_stats.invalidations;
+            removeEntryLocked(it);
+        }
+        it = next;
+    }
+}
+
+void FeatureCache::removeEntryLocked(std::map<Key, Entry>::iterator it) {
+    Entry& entry = it->second;
+    if (entry.data) {
+        m_stats.memoryBytes -= entry.bytes;
+    }
+    if (!entry.spillPath.empty()) {
+        std::error_code error;
+        std::filesystem::remove(entry.spillPath, error);
+        m_stats.diskBytes -= entry.bytes;
+    }
+    m_entries.erase(it);
+}
+
+void FeatureCache::storeLocked(const Key& key, std::shared_ptr<const FeatureSet> data, std::vector<SpillJob>& spills) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        // 其他线程已经存入了同一版本或更新版本的特征（版本号单调递增）
+        if (it->second.version >= data->dataVersion) {
+            return;
+        }
+        removeEntryLocked(it);
+    }
+    
+    Entry entry;
+    entry.version = data->dataVersion;
+    entry.bytes = byteSize(*data);
+    entry.data = std::move(data);
+    entry.lastUsed = ++m_clock;
+    m_stats.memoryBytes += entry.bytes;
+    m_entries.emplace(key, std::move(entry));
+    enforceBudgetsLocked(spills);
+}
+
+void FeatureCache::enforceBudgetsLocked(std::vector<SpillJob>& spills) {
+    // 内存超出预算：移出最久未使用的特征集，较大的写入溢出文件
+    while (m_stats.memoryBytes > m_options.memoryBudgetBytes) {
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.data && (victim == m_entries.end() || it->second.lastUsed < victim->second.lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            break;
+        }
+        
+        // 较大的特征集摘下后由调用方在锁外写入溢出文件，写完之前仍从 spilling 命中
+        Entry& entry = victim->second;
+        if (entry.spillPath.empty() && entry.bytes >= m_options.spillMinBytes &&
+            !m_spillDirectory.empty() && entry.bytes <= m_options.diskBudgetBytes) {
+            std::string filePath = (std::filesystem::path(m_spillDirectory) /
+                                    ("features_" + std::to_string(m_nextFile++) + ".bfc")).string();
+            entry.spilling = entry.data;
+            spills.push_back({victim->first, entry.data, std::move(filePath)});
+        }
+        entry.data.reset();
+        m_stats.memoryBytes -= entry.bytes;
+        if (entry.spillPath.empty() && !entry.spilling) {
+            ++m_stats.evictions;
+            m_entries.erase(victim);
+        }
+    }
+    
+    enforceDiskBudgetLocked();
+}
+
+void FeatureCache::enforceDiskBudgetLocked() {
+    // 溢出文件超出预算：删除最久未使用的文件
+    while (m_stats.diskBytes > m_options.diskBudgetBytes) {
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (!it->second.spillPath.empty() &&
+                (victim == m_entries.end() || it->second.lastUsed < victim->second.lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            break;
+        }
+        
+        Entry& entry = victim->second;
+        std::error_code error;
+        std::filesystem::remove(entry.spillPath, error);
+        entry.spillPath.clear();
+        m_stats.diskBytes -= entry.bytes;
+        ++m_stats.evictions;
+        if (!entry.data) {
+            m_entries.erase(victim);
+        }
+    }
+}
+
+void FeatureCache::writeSpills(std::vector<SpillJob>& spills) {
+    for (SpillJob& job : spills) {
+        std::error_code error;
+        std::filesystem::create_directories(m_spillDirectory, error);
+        bool written = !error && writeColumns(job.filePath, *job.data);
+        if (!written) {
+            std::filesystem::remove(job.filePath, error);
+        }
+        
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(job.key);
+        if (it == m_entries.end() || it->second.spilling != job.data) {
+            // 写入期间缓存项已失效或被新版本替换
+            if (written) {
+                std::filesystem::remove(job.filePath, error);
+            }
+            continue;
+        }
+        
+        Entry& entry = it->second;
+        entry.spilling.reset();
+        if (written) {
+            entry.spillPath = job.filePath;
+            m_stats.diskBytes += entry.bytes;
+            ++m_stats.spills;
+            enforceDiskBudgetLocked();
+        } else if (!entry.data) {
+            ++m_stats.evictions;
+            m_entries.erase(it);
+        }
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
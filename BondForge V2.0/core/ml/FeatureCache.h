@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "PreprocessingPipeline.h"
+#include "../data/DataService.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 特征请求：决定从记录得到的特征矩阵和标签
+ */
+struct FeatureRequest {
+    std::string featureType = "content_length";
+    std::string labelType = "category";
+    FeatureScaling scaling = FeatureScaling::None;
+};
+
+/**
+ * @brief 从数据集提取的特征矩阵和标签（每条记录一行）
+ */
+struct FeatureSet {
+    Matrix features;
+    std::vector<double> labels;
+    FittedScaler scaler;        // 由全部记录拟合的缩放参数（预测时用于缩放新样本）
+    uint64_t dataVersion = 0;   // 提取时的数据版本号
+};
+
+/**
+ * @brief 特征缓存选项
+ */
+struct FeatureCacheOptions {
+    size_t memoryBudgetBytes = size_t(256) << 20;   // 内存中缓存的特征集总字节数上限
+    size_t diskBudgetBytes = size_t(2) << 30;       // 溢出文件总字节数上限
+    size_t spillMinBytes = size_t(1) << 20;         // 移出内存时不小于该大小的特征集写入溢出文件，更小的直接丢弃
+    std::string spillDirectory;                     // 溢出文件目录（空表示系统临时目录下的子目录；"-"表示不溢出）
+};
+
+/**
+ * @brief 特征缓存统计
+ */
+struct FeatureCacheStats {
+    uint64_t memoryHits = 0;
+    uint64_t diskHits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0;     // 因数据变化丢弃的缓存项
+    uint64_t spills = 0;            // 写入溢出文件的次数
+    uint64_t evictions = 0;         // 从内存或磁盘移除的次数（不含失效）
+    size_t memoryEntries = 0;
+    size_t diskEntries = 0;
+    size_t memoryBytes = 0;
+    size_t diskBytes = 0;
+    double extractionSeconds = 0.0; // 未命中时提取特征的累计耗时
+};
+
+/**
+ * @brief 特征矩阵缓存
+ * 
+ * 训练、测试和统计分析每次都对全部记录重新提取特征并缩放，
+ * 数据没有变化时这些计算（尤其是分子描述符）完全是重复的。本缓存以
+ * (数据服务, 数据版本号, 特征类型, 标签类型, 缩放方式) 为键保存提取结果，
+ * 数据未变化时直接返回同一个只读特征集，不再读取记录。
+ * 
+ * 最近使用的特征集保存在内存中，超出内存预算时按最近最少使用的顺序移出；较大的特征集
+ * 写入按列存储的溢出文件（先是标签列和缩放参数，然后逐列存放特征），再次使用时从文件读回，
+ * 比重新提取快得多。数据服务的版本号在每次增删改后改变，下一次请求该数据服务的特征时，
+ * 旧版本的缓存项（包括溢出文件）全部丢弃。
+ * 溢出文件与读回一样在锁外读写：移出的特征集在锁内摘下，释放锁后写入文件，再在锁内记录文件路径，
+ * 写入期间其他线程仍可以命中这个特征集。
+ * 
+ * 未命中时由 PreprocessingPipeline 单遍提取（不划分测试集）。
+ * 所有方法都可以在多个线程中调用。同一个键同时未命中时可能重复提取，结果相同。
+ */
+class FeatureCache {
+public:
+    explicit FeatureCache(const FeatureCacheOptions& options = {});
+    
+    /**
+     * @brief 删除所有溢出文件
+     */
+    ~FeatureCache();
+    
+    FeatureCache(const FeatureCache&) = delete;
+    FeatureCache& operator=(const FeatureCache&) = delete;
+    
+    /**
+     * @brief 全局特征缓存（默认选项）
+     */
+    static FeatureCache& instance();
+    
+    /**
+     * @brief 获取数据集当前版本的特征
+     * 
+     * @param dataService 数据服务
+     * @param request 特征请求
+     * @return 特征集（与其他调用者共享，不能修改；提取失败时返回空指针）
+     */
+    std::shared_ptr<const FeatureSet> getFeatures(Data::IDataService& dataService, const FeatureRequest& request);
+    
+    /**
+     * @brief 丢弃一个数据服务的所有缓存项（数据服务销毁前应调用）
+     */
+    void invalidate(const Data::IDataService& dataService);
+    
+    /**
+     * @brief 丢弃所有缓存项
+     */
+    void clear();
+    
+    FeatureCacheStats stats() const;
+
+private:
+    using Key = std::tuple<const Data::IDataService*, std::string, std::string, FeatureScaling>;
+    
+    struct Entry {
+        uint64_t version = 0;
+        std::shared_ptr<const FeatureSet> data;     // 内存中的特征集（已移出内存时为空）
+        std::shared_ptr<const FeatureSet> spilling; // 已移出内存、正在写入溢出文件的特征集
+        std::string spillPath;                      // 溢出文件（未溢出时为空）
+        size_t bytes = 0;
+        uint64_t lastUsed = 0;
+    };
+    
+    struct SpillJob {
+        Key key;
+        std::shared_ptr<const FeatureSet> data;
+        std::string filePath;
+    };
+    
+    static size_t byteSize(const FeatureSet& set);
+    static bool writeColumns(const std::string& filePath, const FeatureSet& set);
+    static std::shared_ptr<FeatureSet> readColumns(const std::string& filePath);
+    
+    void invalidateLocked(const Data::IDataService* source, uint64_t currentVersion, bool all);
+    void removeEntryLocked(std::map<Key, Entry>::iterator it);
+    void storeLocked(const Key& key, std::shared_ptr<const FeatureSet> data, std::vector<SpillJob>& spills);
+    void enforceBudgetsLocked(std::vector<SpillJob>& spills);
+    void enforceDiskBudgetLocked();
+    void writeSpills(std::vector<SpillJob>& spills);
+    
+    FeatureCacheOptions m_options;
+    std::string m_spillDirectory;
+    
+    mutable std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    uint64_t m_clock = 0;
+    uint64_t m_nextFile = 0;
+    FeatureCacheStats m_stats;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
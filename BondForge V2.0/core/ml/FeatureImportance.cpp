@@ -0,0 +1,258 @@
+#include "FeatureImportance.h"
+#include "ModelCommon.h"
+#include "TreeModels.h"
+#include "TrainingJobs.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr size_t kCopyGrainRows = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+const char* metricName(ScoringMetric metric) {
+    switch (metric) {
+        case ScoringMetric::Accuracy:
+            return "accuracy";
+        case ScoringMetric::NegativeMeanSquaredError:
+            return "negative MSE";
+        default:
+            return "auto";
+    }
+}
+
+} // namespace
+
+ImportanceReport FeatureImportance::permutation(
+    IMLModel& model,
+    const ConstMatrixView& data,
+    const std::vector<double>& labels,
+    const ImportanceOptions& options) {
+    
+    Clock::time_point start = Clock::now();
+    ImportanceReport report;
+    report.method = ImportanceMethod::Permutation;
+    
+    ModelType type = model.getModelType();
+    if (type == ModelType::KMeans || type == ModelType::TimeSeries) {
+        report.errorMessage = "Model type does not support permutation importance";
+        return report;
+    }
+    if (data.empty() || labels.size() != data.rows()) {
+        report.errorMessage = "Label count does not match sample count";
+        return report;
+    }
+    
+    report.scoring = options.scoring;
+    if (report.scoring == ScoringMetric::Auto) {
+        report.scoring = predictsClasses(model) ? ScoringMetric::Accuracy : ScoringMetric::NegativeMeanSquaredError;
+    }
+    
+    // 评分样本：全部或随机抽取的 maxSamples 行（保持原顺序），复制为连续的基准矩阵
+    const size_t n = data.rows();
+    const size_t p = data.cols();
+    std::vector<size_t> sampleRows(n);
+    std::iota(sampleRows.begin(), sampleRows.end(), 0);
+    if (options.maxSamples > 0 && options.maxSamples < n) {
+        std::mt19937_64 rng(options.seed);
+        std::shuffle(sampleRows.begin(), sampleRows.end(), rng);
+        sampleRows.resize(options.maxSamples);
+        std::sort(sampleRows.begin(), sampleRows.end());
+    }
+    const size_t m = sampleRows.size();
+    
+    auto& pool = Utils::ThreadPool::instance();
+    Matrix base(m, p);
+    std::vector<double> sampleLabels(m);
+    pool.parallelFor(0, m, kCopyGrainRows, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const double* source = data.row(sampleRows[i]);
+            std::copy(source, source + p, base.row(i));
+            sampleLabels[i] = labels[sampleRows[i]];
+        }
+    });
+    
+    Clock::time_point baselineStart = Clock::now();
+    std::vector<double> baseline = model.predict(base);
+    report.baselineSeconds = secondsSince(baselineStart);
+    if (baseline.size() != m) {
+        report.errorMessage = "Model prediction failed";
+        return report;
+    }
+    report.baselineScore = scorePredictions(report.scoring, baseline, sampleLabels.data(), sampleLabels.size());
+    
+    // 工作副本数：可以并发预测时取线程数、内存上限和任务数的较小者
+    const size_t repeats = std::max<size_t>(1, options.repeats);
+    const size_t tasks = p * repeats;
+    size_t slots = 1;
+    if (model.supportsConcurrentPrediction()) {
+        size_t bytes = std::max<size_t>(1, m * p * sizeof(double));
+        size_t budget = std::max<size_t>(1, options.workspaceBytes / bytes);
+        slots = std::max<size_t>(1, std::min({pool.threadCount() + 1, budget, tasks}));
+    }
+    
+    // 第一个副本就是基准矩阵本身，其余副本在任何列被打乱之前复制
+    std::vector<Matrix> copies(slots - 1);
+    for (Matrix& copy : copies) {
+        copy = base;
+    }
+    
+    std::vector<double> taskScores(tasks, 0.0);
+    std::vector<double> taskSeconds(tasks, 0.0);
+    TrainingControl* control = TrainingControl::current();
+    std::atomic<size_t> finished(0);
+    std::atomic<bool> stopped(false);
+    
+    pool.parallelFor(0, slots, 1, [&](size_t slotBegin, size_t slotEnd) {
+        std::vector<double> original(m);
+        std::vector<double> column(m);
+        for (size_t s = slotBegin; s < slotEnd; ++s) {
+            Matrix& workspace = s == 0 ? base : copies[s - 1];
+            for (size_t t = s; t < tasks; t += slots) {
+                if (control && control->shouldStop()) {
+                    stopped = true;
+                    return;
+                }
+                const size_t feature = t / repeats;
+                for (size_t i = 0; i < m; ++i) {
+                    original[i] = workspace.row(i)[feature];
+                }
+                
+                // 每个任务的排列只取决于种子和任务序号
+                column = original;
+                std::mt19937_64 rng(options.seed + 0x9E3779B97F4A7C15ULL * (t + 1));
+                std::shuffle(column.begin(), column.end(), rng);
+                for (size_t i = 0; i < m; ++i) {
+                    workspace.row(i)[feature] = column[i];
+                }
+                
+                Clock::time_point taskStart = Clock::now();
+                std::vector<double> predictions = model.predict(workspace);
+                taskSeconds[t] = secondsSince(taskStart);
+                taskScores[t] = scorePredictions(report.scoring, predictions, sampleLabels.data(), sampleLabels.size());
+                
+                for (size_t i = 0; i < m; ++i) {
+                    workspace.row(i)[feature] = original[i];
+                }
+                if (control) {
+                    control->report(static_cast<double>(++finished) / static_cast<double>(tasks));
+                }
+            }
+        }
+    });
+    if (stopped) {
+        report.errorMessage = control->stopReason();
+        return report;
+    }
+    
+    report.features.resize(p);
+    for (size_t j = 0; j < p; ++j) {
+        FeatureImportanceResult& result = report.features[j];
+        result.feature = j;
+        result.scores.assign(taskScores.begin() + j * repeats, taskScores.begin() + (j + 1) * repeats);
+        double mean = std::accumulate(result.scores.begin(), result.scores.end(), 0.0) / static_cast<double>(repeats);
+        double squares = 0.0;
+        for (double value : result.scores) {
+            squares += (value - mean) * (value - mean);
+        }
+        result.importance = report.baselineScore - mean;
+        result.stdImportance = repeats > 1 ? std::sqrt(squares / static_cast<double>(repeats)) : 0.0;
+        result.seconds = std::accumulate(taskSeconds.begin() + j * repeats, taskSeconds.begin() + (j + 1) * repeats, 0.0);
+    }
+    
+    report.samples = m;
+    report.repeats = repeats;
+    report.concurrency = slots;
+    report.success = true;
+    report.totalSeconds = secondsSince(start);
+    return report;
+}
+
+ImportanceReport FeatureImportance::splitGain(const IMLModel& model) {
+    Clock::time_point start = Clock::now();
+    ImportanceReport report;
+    report.method = ImportanceMethod::SplitGain;
+    
+    const std::vector<double>* gains = nullptr;
+    if (auto forest = dynamic_cast<const RandomForestModel*>(&model)) {
+        gains = &forest->splitGains();
+    } else if (auto boosting = dynamic_cast<const GradientBoostingModel*>(&model)) {
+        gains = &boosting->splitGains();
+    } else {
+        report.errorMessage = "Split-gain importance requires a tree model";
+        return report;
+    }
+    if (gains->empty()) {
+        report.errorMessage = "Model has no recorded split gains";
+        return report;
+    }
+    
+    double total = std::accumulate(gains->begin(), gains->end(), 0.0);
+    report.features.resize(gains->size());
+    for (size_t j = 0; j < gains->size(); ++j) {
+        FeatureImportanceResult& result = report.features[j];
+        result.feature = j;
+        result.importance = total > 0.0 ? (*gains)[j] / total : 0.0;
+        result.scores.assign(1, (*gains)[j]);
+    }
+    
+    report.success = true;
+    report.totalSeconds = secondsSince(start);
+    return report;
+}
+
+std::vector<size_t> ImportanceReport::ranking() const {
+    std::vector<size_t> order(features.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return features[a].importance > features[b].importance;
+    });
+    return order;
+}
+
+std::string ImportanceReport::formatTable(const std::vector<std::string>& featureNames, size_t limit) const {
+    std::ostringstream stream;
+    stream << std::fixed;
+    if (method == ImportanceMethod::Permutation) {
+        stream << "Permutation importance (" << metricName(scoring) << ", baseline " << std::setprecision(4)
+               << baselineScore << ", " << samples << " samples x " << repeats << " repeats, "
+               << concurrency << " concurrent)\n";
+    } else {
+        stream << "Split-gain importance (fraction of total gain)\n";
+    }
+    stream << std::left << std::setw(6) << "Rank" << std::setw(32) << "Feature"
+           << std::setw(28) << "Importance (mean +/- std)" << "Seconds\n";
+    
+    std::vector<size_t> order = ranking();
+    size_t rows = limit > 0 ? std::min(limit, order.size()) : order.size();
+    for (size_t r = 0; r < rows; ++r) {
+        const FeatureImportanceResult& result = features[order[r]];
+        std::string name = featureNames.size() == features.size() ? featureNames[result.feature]
+                                                                  : "#" + std::to_string(result.feature);
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(4) << result.importance << " +/- " << result.stdImportance;
+        stream << std::setw(6) << r + 1 << std::setw(32) << name << std::setw(28) << summary.str()
+               << std::setprecision(3) << result.seconds << "\n";
+    }
+    if (method == ImportanceMethod::Permutation) {
+        stream << "Baseline: " << std::setprecision(3) << baselineSeconds << " s, ";
+    }
+    stream << "Total: " << std::setprecision(3) << totalSeconds << " s\n";
+    return stream.str();
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
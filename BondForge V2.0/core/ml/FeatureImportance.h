@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "MLModels.h"
+#include "ModelSelection.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 特征重要性的计算方法
+ */
+enum class ImportanceMethod {
+    Permutation,        // 打乱一个特征后评分的下降
+    SplitGain           // 树模型训练时累加的分裂增益
+};
+
+/**
+ * @brief 置换重要性选项
+ */
+struct ImportanceOptions {
+    size_t repeats = 5;                             // 每个特征打乱的次数
+    uint64_t seed = 42;
+    ScoringMetric scoring = ScoringMetric::Auto;
+    size_t maxSamples = 0;                          // 评分使用的最多样本数（0表示全部，否则随机抽取）
+    
+    /**
+     * @brief 工作副本的内存上限（字节），决定同时进行的置换数
+     */
+    size_t workspaceBytes = size_t(256) << 20;
+};
+
+/**
+ * @brief 一个特征的重要性
+ */
+struct FeatureImportanceResult {
+    size_t feature = 0;
+    double importance = 0.0;        // 置换：基准分数减去打乱后的平均分数；分裂增益：占全部增益的比例
+    double stdImportance = 0.0;     // 各次打乱之间的标准差（分裂增益为0）
+    std::vector<double> scores;     // 置换：每次打乱后的分数；分裂增益：该特征的增益之和
+    double seconds = 0.0;           // 该特征所有打乱的预测耗时之和
+};
+
+/**
+ * @brief 特征重要性的结果表
+ */
+struct ImportanceReport {
+    bool success = false;
+    std::string errorMessage;
+    ImportanceMethod method = ImportanceMethod::Permutation;
+    ScoringMetric scoring = ScoringMetric::Auto;        // 实际使用的评分方式
+    double baselineScore = 0.0;                         // 未打乱时的分数
+    size_t samples = 0;
+    size_t repeats = 0;
+    size_t concurrency = 0;                             // 同时进行的置换数
+    std::vector<FeatureImportanceResult> features;      // 按特征序号
+    double baselineSeconds = 0.0;
+    double totalSeconds = 0.0;
+    
+    /**
+     * @brief 按重要性从高到低排列的特征序号
+     */
+    std::vector<size_t> ranking() const;
+    
+    /**
+     * @brief 格式化为文本表（按重要性排序，每个特征一行：排名、名称、重要性±标准差、耗时）
+     * 
+     * @param featureNames 特征名称（为空或数量不符时使用特征序号）
+     * @param limit 最多输出的行数（0表示全部）
+     */
+    std::string formatTable(const std::vector<std::string>& featureNames = {}, size_t limit = 0) const;
+};
+
+/**
+ * @brief 特征重要性
+ * 
+ * 置换重要性只复制一次评分数据：每个工作副本依次处理若干（特征, 重复）任务，任务把一列
+ * 打乱后写回副本、预测并评分，然后恢复这一列，不为每次置换复制整个矩阵。
+ * 模型的 supportsConcurrentPrediction() 为真时，工作副本数取线程数和内存上限允许的较小者，
+ * 各副本的任务在共享线程池上并发执行，模型内部的并行预测嵌套在同一个线程池上；
+ * 否则只用一个副本顺序执行。每个任务的随机排列只取决于种子和任务序号，
+ * 因此结果与副本数无关。计算在训练任务中进行时可以通过 TrainingControl 取消并报告进度。
+ * 
+ * 随机森林和梯度提升树还可以直接使用训练时精确累加的分裂增益，不需要任何预测。
+ */
+class FeatureImportance {
+public:
+    /**
+     * @brief 置换重要性
+     * 
+     * @param model 已训练的模型（K均值和时间序列不支持）
+     * @param data 评分数据（通常是留出的测试集，每行一个样本）
+     * @param labels 评分数据的标签
+     * @param options 选项
+     * @return 结果表
+     */
+    static ImportanceReport permutation(
+        IMLModel& model,
+        const ConstMatrixView& data,
+        const std::vector<double>& labels,
+        const ImportanceOptions& options = {});
+    
+    /**
+     * @brief 分裂增益重要性（随机森林、决策树和梯度提升树）
+     */
+    static ImportanceReport splitGain(const IMLModel& model);
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
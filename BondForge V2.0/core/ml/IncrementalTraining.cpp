@@ -0,0 +1,470 @@
+#include "IncrementalTraining.h"
+#include "ModelCommon.h"
+#include "TrainingJobs.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kFeatureFileMagic = 0x4D464642;  // "BFFM"
+constexpr uint32_t kFeatureFileVersion = 1;
+
+// 文件头：魔数和版本（2个uint32），特征数和行数（2个uint64）
+constexpr std::streamoff kFeatureFileHeaderBytes = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+constexpr std::streamoff kRowCountOffset = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 一个预取缓冲区
+ */
+struct ChunkBuffer {
+    Matrix features;
+    std::vector<double> labels;
+    bool filled = false;
+};
+
+/**
+ * @brief 预取线程：整个训练过程只创建一次，每次按请求填充一个缓冲区
+ * 
+ * 同一时刻最多有一个填充请求，fill() 之后必须先 wait() 再发出下一个请求。
+ */
+class ChunkPrefetcher {
+public:
+    explicit ChunkPrefetcher(IFeatureChunkSource& source)
+        : m_source(source), m_thread(&ChunkPrefetcher::run, this) {}
+    
+    ~ChunkPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+    
+    ChunkPrefetcher(const ChunkPrefetcher&) = delete;
+    ChunkPrefetcher& operator=(const ChunkPrefetcher&) = delete;
+    
+    void fill(ChunkBuffer* buffer) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_request = buffer;
+            m_busy = true;
+        }
+        m_changed.notify_all();
+    }
+    
+    /**
+     * @brief 等待当前的填充结束（读取时抛出的异常在这里重新抛出）
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() { return !m_busy; });
+        if (m_error) {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_changed.wait(lock, [this]() { return m_stopping || m_request != nullptr; });
+            if (m_stopping) {
+                return;
+            }
+            ChunkBuffer* buffer = m_request;
+            m_request = nullptr;
+            lock.unlock();
+            
+            std::exception_ptr error;
+            try {
+                buffer->filled = m_source.readChunk(buffer->features, buffer->labels);
+            } catch (...) {
+                buffer->filled = false;
+                error = std::current_exception();
+            }
+            
+            lock.lock();
+            m_error = error;
+            m_busy = false;
+            m_changed.notify_all();
+        }
+    }
+    
+    IFeatureChunkSource& m_source;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    ChunkBuffer* m_request = nullptr;
+    bool m_busy = false;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+    std::thread m_thread;
+};
+
+TrainingResult emptyResult() {
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    return result;
+}
+
+/**
+ * @brief 类别的一致编码（新类别追加编号）
+ */
+double categoryCode(std::map<std::string, double>& codes, const std::string& category) {
+    auto it = codes.find(category);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    double code = static_cast<double>(codes.size());
+    codes.emplace(category, code);
+    return code;
+}
+
+} // namespace
+
+void extractConsistentFeatures(
+    const std::vector<Data::DataRecord>& records,
+    const std::string& featureType,
+    const std::string& labelType,
+    std::map<std::string, double>& categoryCodes,
+    Matrix& features,
+    std::vector<double>& labels) {
+    
+    features = DataPreprocessor::extractFeatureMatrix(records, featureType);
+    labels = DataPreprocessor::extractLabels(records, labelType);
+    
+    // 用跨批次一致的编码替换按单个批次编号的类别
+    size_t categoryColumn = featureType == "category_encoded" ? 0 : featureType == "multi_feature" ? 2 : features.cols();
+    bool categoryLabels = labelType == "category";
+    if (categoryColumn < features.cols() || categoryLabels) {
+        for (size_t i = 0; i < records.size(); ++i) {
+            double code = categoryCode(categoryCodes, records[i].category);
+            if (categoryColumn < features.cols()) {
+                features(i, categoryColumn) = code;
+            }
+            if (categoryLabels) {
+                labels[i] = code;
+            }
+        }
+    }
+}
+
+// RecordChunkSource 实现
+RecordChunkSource::RecordChunkSource(
+    Data::IDataService& dataService,
+    const std::string& featureType,
+    const std::string& labelType,
+    size_t chunkRecords)
+    : m_dataService(dataService),
+      m_featureType(featureType),
+      m_labelType(labelType),
+      m_chunkRecords(std::max<size_t>(1, chunkRecords)) {
+}
+
+bool RecordChunkSource::readChunk(Matrix& features, std::vector<double>& labels) {
+    std::vector<Data::DataRecord> records = m_dataService.getDataRange(m_offset, m_chunkRecords);
+    if (records.empty()) {
+        return false;
+    }
+    m_offset += records.size();
+    
+    extractConsistentFeatures(records, m_featureType, m_labelType, m_categoryCodes, features, labels);
+    return true;
+}
+
+bool RecordChunkSource::rewind() {
+    m_offset = 0;
+    return true;
+}
+
+// FeatureFileWriter 实现
+FeatureFileWriter::~FeatureFileWriter() {
+    if (m_file.is_open()) {
+        close();
+    }
+}
+
+bool FeatureFileWriter::open(const std::string& filePath, size_t numFeatures) {
+    try {
+        m_file.open(filePath, std::ios::binary | std::ios::trunc);
+        if (!m_file.is_open()) {
+            return false;
+        }
+        
+        m_numFeatures = numFeatures;
+        m_rows = 0;
+        uint32_t header[2] = {kFeatureFileMagic, kFeatureFileVersion};
+        uint64_t shape[2] = {numFeatures, 0};
+        m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        m_file.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+        return static_cast<bool>(m_file);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool FeatureFileWriter::append(const ConstMatrixView& features, const std::vector<double>& labels) {
+    if (!m_file.is_open() || features.cols() != m_numFeatures || labels.size() != features.rows()) {
+        return false;
+    }
+    
+    try {
+        // 整块拼成 [标签, 特征] 的行后一次写入
+        const size_t width = m_numFeatures + 1;
+        m_buffer.resize(features.rows() * width);
+        for (size_t i = 0; i < features.rows(); ++i) {
+            double* out = m_buffer.data() + i * width;
+            out[0] = labels[i];
+            std::copy(features.row(i), features.row(i) + m_numFeatures, out + 1);
+        }
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size() * sizeof(double));
+        m_rows += features.rows();
+        return static_cast<bool>(m_file);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool FeatureFileWriter::close() {
+    if (!m_file.is_open()) {
+        return false;
+    }
+    
+    try {
+        m_file.seekp(kRowCountOffset);
+        m_file.write(reinterpret_cast<const char*>(&m_rows), sizeof(m_rows));
+        bool ok = static_cast<bool>(m_file);
+        m_file.close();
+        return ok && !m_file.fail();
+    } catch (...) {
+        return false;
+    }
+}
+
+// FeatureFileSource 实现
+FeatureFileSource::FeatureFileSource(const std::string& filePath, size_t chunkRows)
+    : m_chunkRows(std::max<size_t>(1, chunkRows)) {
+    try {
+        m_file.open(filePath, std::ios::binary);
+        if (!m_file.is_open()) {
+            return;
+        }
+        
+        uint32_t header[2] = {0, 0};
+        uint64_t shape[2] = {0, 0};
+        m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+        m_file.read(reinterpret_cast<char*>(shape), sizeof(shape));
+        if (!m_file || header[0] != kFeatureFileMagic || header[1] != kFeatureFileVersion ||
+            shape[0] > (uint64_t(1) << 24)) {
+            return;
+        }
+        
+        // 行数与文件大小不符（写入未正常关闭）时视为无效
+        m_file.seekg(0, std::ios::end);
+        uint64_t payload = static_cast<uint64_t>(m_file.tellg()) - kFeatureFileHeaderBytes;
+        if (payload != shape[1] * (shape[0] + 1) * sizeof(double)) {
+            return;
+        }
+        
+        m_numFeatures = static_cast<size_t>(shape[0]);
+        m_rows = shape[1];
+        m_valid = rewind();
+    } catch (...) {
+        m_valid = false;
+    }
+}
+
+bool FeatureFileSource::readChunk(Matrix& features, std::vector<double>& labels) {
+    if (!m_valid || m_position >= m_rows) {
+        return false;
+    }
+    
+    try {
+        const size_t width = m_numFeatures + 1;
+        size_t rows = static_cast<size_t>(std::min<uint64_t>(m_chunkRows, m_rows - m_position));
+        m_buffer.resize(rows * width);
+        m_file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size() * sizeof(double));
+        if (!m_file) {
+            m_valid = false;
+            return false;
+        }
+        m_position += rows;
+        
+        features.assign(rows, m_numFeatures);
+        labels.resize(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            const double* in = m_buffer.data() + i * width;
+            labels[i] = in[0];
+            std::copy(in + 1, in + width, features.row(i));
+        }
+        return true;
+    } catch (...) {
+        m_valid = false;
+        return false;
+    }
+}
+
+bool FeatureFileSource::rewind() {
+    if (!m_file.is_open()) {
+        return false;
+    }
+    m_file.clear();
+    m_file.seekg(kFeatureFileHeaderBytes);
+    m_position = 0;
+    return static_cast<bool>(m_file);
+}
+
+// StreamingTrainer 实现
+StreamingReport StreamingTrainer::train(IMLModel& model, IFeatureChunkSource& source, const StreamingOptions& options) {
+    StreamingReport report;
+    report.lastResult = emptyResult();
+    auto start = Clock::now();
+    
+    if (!model.supportsPartialFit()) {
+        report.errorMessage = "Model does not support incremental training";
+        return report;
+    }
+    
+    TrainingControl* control = TrainingControl::current();
+    const size_t epochs = std::max<size_t>(1, options.epochs);
+    
+    ChunkBuffer buffers[2];
+    ChunkPrefetcher prefetcher(source);
+    
+    for (size_t epoch = 0; epoch < epochs; ++epoch) {
+        if (!source.rewind()) {
+            report.errorMessage = "Chunk source cannot be rewound";
+            break;
+        }
+        
+        // 读取线程在后台填充下一个缓冲区，训练线程使用当前缓冲区
+        size_t current = 0;
+        prefetcher.fill(&buffers[current]);
+        bool reading = true;
+        StreamingProgress progress;
+        progress.epoch = epoch;
+        progress.chunkResult = emptyResult();
+        
+        while (true) {
+            auto waitStart = Clock::now();
+            reading = false;
+            try {
+                prefetcher.wait();
+            } catch (const std::exception& e) {
+                report.errorMessage = std::string("Failed to read chunk: ") + e.what();
+                break;
+            }
+            report.readWaitSeconds += secondsSince(waitStart);
+            
+            ChunkBuffer& ready = buffers[current];
+            if (!ready.filled) {
+                break;
+            }
+            prefetcher.fill(&buffers[1 - current]);
+            reading = true;
+            
+            auto trainStart = Clock::now();
+            TrainingResult result = model.partialFit(ready.features, ready.labels, options.parameters);
+            report.trainSeconds += secondsSince(trainStart);
+            if (!result.success) {
+                report.errorMessage = result.errorMessage;
+                report.lastResult = result;
+                break;
+            }
+            
+            ++report.chunks;
+            report.samples += ready.features.rows();
+            progress.samples += ready.features.rows();
+            progress.chunkResult = result;
+            report.lastResult = std::move(result);
+            if (options.progress && !options.progress(progress)) {
+                report.cancelled = true;
+                break;
+            }
+            if (control) {
+                // 数据块总数未知，进度只按轮计
+                control->report(static_cast<double>(epoch) / static_cast<double>(epochs), report.lastResult.additionalMetrics);
+                if (control->shouldStop()) {
+                    report.cancelled = true;
+                    report.errorMessage = control->stopReason();
+                    break;
+                }
+            }
+            ++progress.chunk;
+            current = 1 - current;
+        }
+        
+        // 提前退出时等待读取线程结束，缓冲区和数据来源不能在读取过程中被释放
+        if (reading) {
+            try {
+                prefetcher.wait();
+            } catch (...) {
+            }
+        }
+        if (!report.errorMessage.empty() || report.cancelled) {
+            break;
+        }
+        if (progress.chunk == 0) {
+            report.errorMessage = "Chunk source is empty";
+            break;
+        }
+        ++report.epochs;
+    }
+    
+    report.success = report.errorMessage.empty() && !report.cancelled;
+    report.totalSeconds = secondsSince(start);
+    return report;
+}
+
+uint64_t StreamingTrainer::spillToFile(IFeatureChunkSource& source, const std::string& filePath) {
+    Matrix features;
+    std::vector<double> labels;
+    FeatureFileWriter writer;
+    bool opened = false;
+    if (!source.rewind()) {
+        return 0;
+    }
+    
+    while (source.readChunk(features, labels)) {
+        // 无监督的数据来源没有标签，写入0
+        if (labels.empty()) {
+            labels.assign(features.rows(), 0.0);
+        }
+        if (!opened) {
+            if (!writer.open(filePath, features.cols())) {
+                return 0;
+            }
+            opened = true;
+        }
+        if (!writer.append(features, labels)) {
+            writer.close();
+            return 0;
+        }
+    }
+    
+    if (!opened || !writer.close()) {
+        return 0;
+    }
+    return writer.rowCount();
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
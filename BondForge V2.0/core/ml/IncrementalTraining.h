@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+#include "MLModels.h"
+#include "../data/DataService.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 特征数据块的来源（按顺序逐块读取）
+ */
+class IFeatureChunkSource {
+public:
+    virtual ~IFeatureChunkSource() = default;
+    
+    /**
+     * @brief 读取下一个数据块
+     * 
+     * @param features 输出的特征矩阵（复用其已分配的内存）
+     * @param labels 输出的标签
+     * @return 是否读到数据（已读完或出错时返回false）
+     */
+    virtual bool readChunk(Matrix& features, std::vector<double>& labels) = 0;
+    
+    /**
+     * @brief 回到数据开头（多轮训练时使用）
+     * 
+     * @return 是否成功
+     */
+    virtual bool rewind() = 0;
+};
+
+/**
+ * @brief 提取一批记录的特征和标签，类别使用跨批次一致的编码
+ * 
+ * 提取方式同 DataPreprocessor，但类别编码（category_encoded、multi_feature 的第3列
+ * 和 category 标签）取自 categoryCodes，新出现的类别按首次出现的顺序追加编号。
+ * 
+ * @param records 记录
+ * @param featureType 特征类型
+ * @param labelType 标签类型
+ * @param categoryCodes 类别编码表（调用之间保持）
+ * @param features 输出的特征矩阵
+ * @param labels 输出的标签
+ */
+void extractConsistentFeatures(
+    const std::vector<Data::DataRecord>& records,
+    const std::string& featureType,
+    const std::string& labelType,
+    std::map<std::string, double>& categoryCodes,
+    Matrix& features,
+    std::vector<double>& labels);
+
+/**
+ * @brief 从数据服务分页读取记录并提取特征的数据块来源
+ * 
+ * 每次只取 chunkRecords 条记录，特征和标签的提取方式同 DataPreprocessor。
+ * 与逐次调用 DataPreprocessor 不同，类别编码（category_encoded、multi_feature 的第3列
+ * 和 category 标签）在所有数据块之间保持一致，按类别首次出现的顺序编号。
+ * 分页按存储顺序进行，遍历期间删除记录可能使之后的数据块跳过个别记录。
+ */
+class RecordChunkSource : public IFeatureChunkSource {
+public:
+    RecordChunkSource(
+        Data::IDataService& dataService,
+        const std::string& featureType,
+        const std::string& labelType,
+        size_t chunkRecords = 4096);
+    
+    bool readChunk(Matrix& features, std::vector<double>& labels) override;
+    bool rewind() override;
+
+private:
+    Data::IDataService& m_dataService;
+    std::string m_featureType;
+    std::string m_labelType;
+    size_t m_chunkRecords;
+    size_t m_offset = 0;
+    std::map<std::string, double> m_categoryCodes;
+};
+
+/**
+ * @brief 把特征数据块顺序写入二进制文件（超出内存的数据落盘后可以多轮读取）
+ * 
+ * 文件格式：文件头（魔数、版本、特征数、行数），之后每行依次为标签和各特征（double）。
+ * 行数在 close() 时回填。
+ */
+class FeatureFileWriter {
+public:
+    ~FeatureFileWriter();
+    
+    /**
+     * @brief 创建文件
+     * 
+     * @param filePath 文件路径
+     * @param numFeatures 特征数
+     * @return 是否成功
+     */
+    bool open(const std::string& filePath, size_t numFeatures);
+    
+    /**
+     * @brief 追加一个数据块（标签数必须与行数相同）
+     */
+    bool append(const ConstMatrixView& features, const std::vector<double>& labels);
+    
+    /**
+     * @brief 回填行数并关闭文件
+     */
+    bool close();
+    
+    uint64_t rowCount() const { return m_rows; }
+
+private:
+    std::ofstream m_file;
+    size_t m_numFeatures = 0;
+    uint64_t m_rows = 0;
+    std::vector<double> m_buffer;
+};
+
+/**
+ * @brief 从 FeatureFileWriter 写出的文件按固定行数逐块读取
+ */
+class FeatureFileSource : public IFeatureChunkSource {
+public:
+    explicit FeatureFileSource(const std::string& filePath, size_t chunkRows = 16384);
+    
+    bool readChunk(Matrix& features, std::vector<double>& labels) override;
+    bool rewind() override;
+    
+    /**
+     * @brief 文件是否有效（文件头校验通过）
+     */
+    bool isOpen() const { return m_valid; }
+    
+    size_t featureCount() const { return m_numFeatures; }
+    uint64_t rowCount() const { return m_rows; }
+
+private:
+    std::ifstream m_file;
+    bool m_valid = false;
+    size_t m_chunkRows;
+    size_t m_numFeatures = 0;
+    uint64_t m_rows = 0;
+    uint64_t m_position = 0;
+    std::vector<double> m_buffer;
+};
+
+/**
+ * @brief 流式训练的进度（每个数据块训练完后回调一次）
+ */
+struct StreamingProgress {
+    size_t epoch = 0;
+    size_t chunk = 0;               // 本轮中的数据块序号
+    uint64_t samples = 0;           // 本轮已训练的样本数
+    TrainingResult chunkResult;     // 最近一个数据块的 partialFit() 结果
+};
+
+/**
+ * @brief 流式训练选项
+ */
+struct StreamingOptions {
+    size_t epochs = 1;
+    std::map<std::string, double> parameters;   // 传给每次 partialFit() 的训练参数
+    
+    /**
+     * @brief 进度回调，返回false时停止训练
+     */
+    std::function<bool(const StreamingProgress&)> progress;
+};
+
+/**
+ * @brief 流式训练报告
+ */
+struct StreamingReport {
+    bool success = false;
+    bool cancelled = false;
+    std::string errorMessage;
+    size_t epochs = 0;
+    size_t chunks = 0;
+    uint64_t samples = 0;
+    TrainingResult lastResult;
+    double readWaitSeconds = 0.0;   // 训练线程等待数据块的时间（预取未能掩盖的读取时间）
+    double trainSeconds = 0.0;
+    double totalSeconds = 0.0;
+};
+
+/**
+ * @brief 以数据块为单位流式训练支持 partialFit() 的模型
+ * 
+ * 使用双缓冲预取：模型在一个缓冲区的数据块上训练时，另一个缓冲区由单独的读取线程
+ * 填充下一个数据块（读取存储和提取特征），因此读取与训练重叠，内存中同时只有两个数据块。
+ * 读取线程在一次 train() 中只创建一次，不占用计算线程池的工作线程，阻塞的I/O不会拖慢模型内部的并行计算。
+ * 每轮开始时数据来源回到开头。
+ * 在训练任务中运行时（见 TrainingControl），每个数据块训练完后检查取消和时限。
+ */
+class StreamingTrainer {
+public:
+    /**
+     * @brief 逐块训练模型
+     * 
+     * @param model 要训练的模型（必须支持 partialFit()）
+     * @param source 数据块来源
+     * @param options 训练选项
+     * @return 训练报告
+     */
+    static StreamingReport train(IMLModel& model, IFeatureChunkSource& source, const StreamingOptions& options = {});
+    
+    /**
+     * @brief 把数据块来源的全部数据写入特征文件
+     * 
+     * 特征提取代价高（如分子描述符）或需要多轮训练时，先落盘再用 FeatureFileSource 读取。
+     * 
+     * @return 写入的行数（失败时返回0）
+     */
+    static uint64_t spillToFile(IFeatureChunkSource& source, const std::string& filePath);
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,1705 @@
+#include "LinearModels.h"
+#include "ModelCommon.h"
+#include "TrainingJobs.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// Gram累加的分片行数：一片中心化后的数据（128行×约100列）留在L2缓存中被微内核反复读取
+constexpr size_t kTileRows = 128;
+
+// 每个行块的目标行数和行块数上限；行块划分只取决于数据形状，与线程数无关
+constexpr size_t kChunkRows = 16384;
+constexpr size_t kMaxChunks = 64;
+
+// 所有行块的部分Gram矩阵合计占用的内存上限
+constexpr size_t kGramBudgetBytes = size_t(256) << 20;
+
+constexpr size_t kPredictGrainSize = 4096;
+
+// 小批量梯度的并行块行数：块划分固定，合并顺序固定，保证结果可复现
+constexpr size_t kGradientBlockRows = 256;
+
+// 模型文件中的节；增量训练的状态在单独的节中，第一次 partialFit() 时才读取
+constexpr uint32_t kCoefficientsSection = sectionTag("COEF");
+constexpr uint32_t kInterceptSection = sectionTag("INTC");
+constexpr uint32_t kClassesSection = sectionTag("CLAS");
+constexpr uint32_t kWeightsSection = sectionTag("WGHT");
+constexpr uint32_t kStateSection = sectionTag("STAT");
+constexpr uint32_t kCenterSection = sectionTag("CNTR");
+constexpr uint32_t kGramSection = sectionTag("GRAM");
+constexpr uint32_t kSumsSection = sectionTag("SUMS");
+constexpr uint32_t kMeansSection = sectionTag("MEAN");
+constexpr uint32_t kInvScaleSection = sectionTag("ISCL");
+constexpr uint32_t kSgdWeightsSection = sectionTag("SGDW");
+constexpr uint32_t kVelocitySection = sectionTag("VELO");
+
+size_t paddedColumns(size_t count) {
+    return (count + 7) / 8 * 8;
+}
+
+/**
+ * @brief 固定的行块划分
+ */
+struct RowChunks {
+    size_t count = 1;
+    size_t rows = 0;
+    
+    RowChunks(size_t totalRows, size_t bytesPerChunk) : rows(totalRows) {
+        size_t budgetChunks = std::max<size_t>(1, kGramBudgetBytes / std::max<size_t>(1, bytesPerChunk));
+        count = std::min({(totalRows + kChunkRows - 1) / kChunkRows, kMaxChunks, budgetChunks});
+        count = std::max<size_t>(1, count);
+    }
+    
+    size_t begin(size_t chunk) const { return rows * chunk / count; }
+    size_t end(size_t chunk) const { return rows * (chunk + 1) / count; }
+};
+
+/**
+ * @brief gram += tileᵀ·tile（只计算上三角所在的4×8块）
+ * 
+ * tile 为 rows×q 的行主序数据，q 是8的倍数。每个4×8块的累加器常驻寄存器，
+ * 沿分片的行方向一次扫完再写回，内层循环在k方向向量化。
+ */
+void accumulateGramTile(const double* tile, size_t rows, size_t q, double* gram) {
+    for (size_t j0 = 0; j0 < q; j0 += 4) {
+        for (size_t k0 = j0 / 8 * 8; k0 < q; k0 += 8) {
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256d acc[4][2];
+            for (int jj = 0; jj < 4; ++jj) {
+                acc[jj][0] = _mm256_setzero_pd();
+                acc[jj][1] = _mm256_setzero_pd();
+            }
+            for (size_t b = 0; b < rows; ++b) {
+                const double* row = tile + b * q;
+                __m256d x0 = _mm256_loadu_pd(row + k0);
+                __m256d x1 = _mm256_loadu_pd(row + k0 + 4);
+                for (int jj = 0; jj < 4; ++jj) {
+                    __m256d a = _mm256_broadcast_sd(row + j0 + jj);
+                    acc[jj][0] = _mm256_fmadd_pd(a, x0, acc[jj][0]);
+                    acc[jj][1] = _mm256_fmadd_pd(a, x1, acc[jj][1]);
+                }
+            }
+            for (int jj = 0; jj < 4; ++jj) {
+                double* out = gram + (j0 + jj) * q + k0;
+                _mm256_storeu_pd(out, _mm256_add_pd(_mm256_loadu_pd(out), acc[jj][0]));
+                _mm256_storeu_pd(out + 4, _mm256_add_pd(_mm256_loadu_pd(out + 4), acc[jj][1]));
+            }
+#else
+            double acc[4][8] = {};
+            for (size_t b = 0; b < rows; ++b) {
+                const double* row = tile + b * q;
+                for (int jj = 0; jj < 4; ++jj) {
+                    double a = row[j0 + jj];
+                    for (int kk = 0; kk < 8; ++kk) {
+                        acc[jj][kk] += a * row[k0 + kk];
+                    }
+                }
+            }
+            for (int jj = 0; jj < 4; ++jj) {
+                double* out = gram + (j0 + jj) * q + k0;
+                for (int kk = 0; kk < 8; ++kk) {
+                    out[kk] += acc[jj][kk];
+                }
+            }
+#endif
+        }
+    }
+}
+
+/**
+ * @brief 点积（固定的累加顺序，同样的输入总得到同样的结果）
+ */
+double dotProduct(const double* a, const double* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += a[i] * b[i];
+        acc[1] += a[i + 1] * b[i + 1];
+        acc[2] += a[i + 2] * b[i + 2];
+        acc[3] += a[i + 3] * b[i + 3];
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief y += alpha * x
+ */
+void addScaled(double alpha, const double* x, double* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+/**
+ * @brief 原地Cholesky分解 A = LLᵀ（A为n×n行主序，结果写入下三角）
+ * 
+ * @return 矩阵是否正定
+ */
+bool choleskyDecompose(std::vector<double>& a, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        double* rowJ = a.data() + j * n;
+        double diagonal = rowJ[j];
+        for (size_t k = 0; k < j; ++k) {
+            diagonal -= rowJ[k] * rowJ[k];
+        }
+        if (!(diagonal > 0.0)) {
+            return false;
+        }
+        double pivot = std::sqrt(diagonal);
+        rowJ[j] = pivot;
+        
+        for (size_t i = j + 1; i < n; ++i) {
+            double* rowI = a.data() + i * n;
+            double value = rowI[j];
+            for (size_t k = 0; k < j; ++k) {
+                value -= rowI[k] * rowJ[k];
+            }
+            rowI[j] = value / pivot;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 用Cholesky因子求解 LLᵀx = b（结果写回b）
+ */
+void choleskySolve(const std::vector<double>& l, size_t n, std::vector<double>& b) {
+    for (size_t i = 0; i < n; ++i) {
+        double value = b[i];
+        for (size_t k = 0; k < i; ++k) {
+            value -= l[i * n + k] * b[k];
+        }
+        b[i] = value / l[i * n + i];
+    }
+    for (size_t i = n; i-- > 0;) {
+        double value = b[i];
+        for (size_t k = i + 1; k < n; ++k) {
+            value -= l[k * n + i] * b[k];
+        }
+        b[i] = value / l[i * n + i];
+    }
+}
+
+/**
+ * @brief 各特征和标签的均值（按块求部分和，再按块序号合并）
+ * 
+ * @return p+1 个值，最后一个是标签的均值
+ */
+std::vector<double> columnMeans(const ConstMatrixView& data, const double* labels) {
+    const size_t numFeatures = data.cols();
+    const size_t width = numFeatures + 1;
+    RowChunks chunks(data.rows(), width * sizeof(double));
+    std::vector<double> partialSums(chunks.count * width, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+            double* sums = partialSums.data() + c * width;
+            for (size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                addScaled(1.0, data.row(i), sums, numFeatures);
+                sums[numFeatures] += labels[i];
+            }
+        }
+    });
+    
+    std::vector<double> means(width, 0.0);
+    for (size_t c = 0; c < chunks.count; ++c) {
+        addScaled(1.0, partialSums.data() + c * width, means.data(), width);
+    }
+    for (double& mean : means) {
+        mean /= static_cast<double>(data.rows());
+    }
+    return means;
+}
+
+/**
+ * @brief 以 center 为参照累加 [X y] 的Gram矩阵（上三角，q×q）和列和（p+1 个）
+ * 
+ * 各行块的部分和按块序号合并后加到 gram 和 sums 上，因此可以跨多个数据块持续累加。
+ */
+void accumulateShiftedGram(
+    const ConstMatrixView& data, const double* labels, const std::vector<double>& center, size_t q,
+    std::vector<double>& gram, std::vector<double>& sums) {
+    
+    const size_t numFeatures = data.cols();
+    RowChunks chunks(data.rows(), q * q * sizeof(double));
+    std::vector<double> partialGrams(chunks.count * q * q, 0.0);
+    std::vector<double> partialSums(chunks.count * q, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        AlignedVector<double> tile(kTileRows * q, 0.0);
+        for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+            double* partialGram = partialGrams.data() + c * q * q;
+            double* partialSum = partialSums.data() + c * q;
+            for (size_t tileBegin = chunks.begin(c); tileBegin < chunks.end(c); tileBegin += kTileRows) {
+                size_t tileRows = std::min(kTileRows, chunks.end(c) - tileBegin);
+                for (size_t b = 0; b < tileRows; ++b) {
+                    const double* sample = data.row(tileBegin + b);
+                    double* out = tile.data() + b * q;
+                    for (size_t j = 0; j < numFeatures; ++j) {
+                        out[j] = sample[j] - center[j];
+                    }
+                    out[numFeatures] = labels[tileBegin + b] - center[numFeatures];
+                    addScaled(1.0, out, partialSum, numFeatures + 1);
+                }
+                accumulateGramTile(tile.data(), tileRows, q, partialGram);
+            }
+        }
+    });
+    
+    for (size_t c = 0; c < chunks.count; ++c) {
+        const double* partial = partialGrams.data() + c * q * q;
+        for (size_t j = 0; j <= numFeatures; ++j) {
+            for (size_t k = j; k <= numFeatures; ++k) {
+                gram[j * q + k] += partial[j * q + k];
+            }
+        }
+        addScaled(1.0, partialSums.data() + c * q, sums.data(), numFeatures + 1);
+    }
+}
+
+/**
+ * @brief 稀疏特征的参照中心：特征取0（保持稀疏），标签取均值
+ */
+std::vector<double> columnMeans(const SparseMatrixView& data, const double* labels) {
+    std::vector<double> center(data.cols() + 1, 0.0);
+    center[data.cols()] = std::accumulate(labels, labels + data.rows(), 0.0) / static_cast<double>(data.rows());
+    return center;
+}
+
+/**
+ * @brief 稀疏特征的 accumulateShiftedGram（特征的参照中心必须为0，只有标签减去 center[p]）
+ * 
+ * 每个样本只累加非零元素两两的乘积。Gram矩阵按行（特征）分段在线程池上并行：每段扫描所有样本，
+ * 只累加段内特征所在的行，每个元素始终由一段按样本顺序累加，因此结果与线程数无关，也不需要部分和。
+ */
+void accumulateShiftedGram(
+    const SparseMatrixView& data, const double* labels, const std::vector<double>& center, size_t q,
+    std::vector<double>& gram, std::vector<double>& sums) {
+    
+    const size_t p = data.cols();
+    const double labelCenter = center[p];
+    Utils::ThreadPool::instance().parallelFor(0, p + 1, 0, [&](size_t featureBegin, size_t featureEnd) {
+        std::vector<uint32_t> scratch;
+        for (size_t i = 0; i < data.rows(); ++i) {
+            SparseRow row = data.row(i, scratch);
+            double label = labels[i] - labelCenter;
+            size_t a = std::lower_bound(row.indices, row.indices + row.size, static_cast<uint32_t>(featureBegin)) - row.indices;
+            for (; a < row.size && row.indices[a] < featureEnd; ++a) {
+                double value = row.value(a);
+                double* gramRow = gram.data() + static_cast<size_t>(row.indices[a]) * q;
+                for (size_t b = a; b < row.size; ++b) {
+                    gramRow[row.indices[b]] += value * row.value(b);
+                }
+                gramRow[p] += value * label;
+                sums[row.indices[a]] += value;
+            }
+            if (featureEnd > p) {
+                gram[p * q + p] += label * label;
+                sums[p] += label;
+            }
+        }
+    });
+}
+
+/**
+ * @brief 岭回归正规方程的解
+ */
+struct RidgeSolution {
+    std::vector<double> coefficients;
+    double intercept = 0.0;
+    size_t droppedFeatures = 0;
+    double jitter = 0.0;
+    double residualSquares = 0.0;   // 由Gram矩阵直接得到的残差平方和
+    double totalSquares = 0.0;      // 标签的离差平方和（不拟合截距时以0为基准）
+};
+
+/**
+ * @brief 由累加的统计量求解岭回归
+ * 
+ * gram 和 sums 是 count 个样本以 center 为参照的 [X y] 的Gram矩阵和列和。先修正为以样本均值为中心的
+ * Gram矩阵 G - n·d·dᵀ（d = sums / n），再对角均衡：A = D⁻¹(XᵀX + λI)D⁻¹，D = diag(sqrt(XᵀX))，
+ * 方差为0的特征系数固定为0。不拟合截距时 center 为0，不做中心化修正。
+ * 
+ * @return 正规方程是否正定
+ */
+bool solveRidge(
+    const std::vector<double>& gram, const std::vector<double>& sums, const std::vector<double>& center,
+    double count, size_t q, double lambda, bool fitIntercept, RidgeSolution& solution) {
+    
+    const size_t p = center.size() - 1;
+    std::vector<double> means(p + 1, 0.0);
+    std::vector<double> centered(q * q, 0.0);
+    for (size_t j = 0; j <= p; ++j) {
+        double shift = fitIntercept ? sums[j] / count : 0.0;
+        means[j] = center[j] + shift;
+        for (size_t k = j; k <= p; ++k) {
+            double correction = fitIntercept ? sums[j] * sums[k] / count : 0.0;
+            centered[j * q + k] = gram[j * q + k] - correction;
+        }
+    }
+    
+    double maxDiagonal = 0.0;
+    for (size_t j = 0; j < p; ++j) {
+        maxDiagonal = std::max(maxDiagonal, centered[j * q + j]);
+    }
+    
+    std::vector<double> scale(p, 0.0);
+    solution.droppedFeatures = 0;
+    for (size_t j = 0; j < p; ++j) {
+        double diagonal = centered[j * q + j];
+        if (diagonal > 1e-12 * maxDiagonal && diagonal > 0.0) {
+            scale[j] = 1.0 / std::sqrt(diagonal);
+        } else {
+            ++solution.droppedFeatures;
+        }
+    }
+    
+    std::vector<double> system(p * p, 0.0);
+    std::vector<double> rhs(p, 0.0);
+    for (size_t j = 0; j < p; ++j) {
+        if (scale[j] == 0.0) {
+            system[j * p + j] = 1.0;
+            continue;
+        }
+        for (size_t k = j; k < p; ++k) {
+            double value = centered[j * q + k] * scale[j] * scale[k];
+            system[j * p + k] = value;
+            system[k * p + j] = value;
+        }
+        system[j * p + j] += lambda * scale[j] * scale[j];
+        rhs[j] = centered[j * q + p] * scale[j];
+    }
+    
+    // 共线特征使矩阵奇异时逐级加入极小的对角扰动重试
+    std::vector<double> factor = system;
+    solution.jitter = 0.0;
+    bool factored = choleskyDecompose(factor, p);
+    for (double attempt : {1e-12, 1e-10, 1e-8, 1e-6}) {
+        if (factored) {
+            break;
+        }
+        solution.jitter = attempt;
+        factor = system;
+        for (size_t j = 0; j < p; ++j) {
+            factor[j * p + j] += solution.jitter;
+        }
+        factored = choleskyDecompose(factor, p);
+    }
+    if (!factored) {
+        return false;
+    }
+    
+    choleskySolve(factor, p, rhs);
+    solution.coefficients.assign(p, 0.0);
+    for (size_t j = 0; j < p; ++j) {
+        solution.coefficients[j] = rhs[j] * scale[j];
+    }
+    
+    solution.intercept = means[p];
+    for (size_t j = 0; j < p; ++j) {
+        solution.intercept -= solution.coefficients[j] * means[j];
+    }
+    
+    // 残差平方和 = yᵀy - 2βᵀXᵀy + βᵀXᵀXβ（均为中心化后的量）
+    const std::vector<double>& beta = solution.coefficients;
+    double residual = centered[p * q + p];
+    for (size_t j = 0; j < p; ++j) {
+        double row = centered[j * q + j] * beta[j];
+        for (size_t k = j + 1; k < p; ++k) {
+            row += 2.0 * centered[j * q + k] * beta[k];
+        }
+        residual += beta[j] * (row - 2.0 * centered[j * q + p]);
+    }
+    solution.residualSquares = std::max(0.0, residual);
+    solution.totalSquares = centered[p * q + p];
+    return true;
+}
+
+/**
+ * @brief 一个样本的线性组合 Σ wⱼxⱼ
+ */
+double linearValue(const ConstMatrixView& data, size_t i, const std::vector<double>& weights) {
+    return dotProduct(weights.data(), data.row(i), weights.size());
+}
+
+double linearValue(const SparseMatrixView& data, size_t i, const std::vector<double>& weights) {
+    return data.dot(i, weights.data());
+}
+
+/**
+ * @brief 线性模型在一组样本上的残差平方和，以及误差在标签范围10%以内的样本数
+ */
+template <typename Features>
+void evaluateLinear(
+    const Features& data, const std::vector<double>& labels,
+    const std::vector<double>& coefficients, double intercept, double& errorSum, size_t& correct) {
+    
+    auto labelRange = std::minmax_element(labels.begin(), labels.end());
+    double threshold = 0.1 * (*labelRange.second - *labelRange.first);
+    
+    RowChunks chunks(data.rows(), 0);
+    std::vector<double> partialErrors(chunks.count, 0.0);
+    std::vector<size_t> partialCorrect(chunks.count, 0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+            double chunkErrors = 0.0;
+            size_t chunkCorrect = 0;
+            for (size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                double error = intercept + linearValue(data, i, coefficients) - labels[i];
+                chunkErrors += error * error;
+                if (std::abs(error) < threshold) {
+                    ++chunkCorrect;
+                }
+            }
+            partialErrors[c] = chunkErrors;
+            partialCorrect[c] = chunkCorrect;
+        }
+    });
+    
+    errorSum = 0.0;
+    correct = 0;
+    for (size_t c = 0; c < chunks.count; ++c) {
+        errorSum += partialErrors[c];
+        correct += partialCorrect[c];
+    }
+}
+
+/**
+ * @brief 把标签映射为类别下标（classes 升序）
+ * 
+ * @return 所有标签是否都在 classes 中
+ */
+bool mapTargets(const std::vector<double>& classes, const std::vector<double>& labels, std::vector<uint32_t>& targets) {
+    targets.resize(labels.size());
+    std::atomic<bool> valid(true);
+    Utils::ThreadPool::instance().parallelFor(0, labels.size(), kChunkRows, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto it = std::lower_bound(classes.begin(), classes.end(), labels[i]);
+            if (it == classes.end() || *it != labels[i]) {
+                valid = false;
+                targets[i] = 0;
+                continue;
+            }
+            targets[i] = static_cast<uint32_t>(it - classes.begin());
+        }
+    });
+    return valid;
+}
+
+/**
+ * @brief 带动量的小批量SGD的设置
+ */
+struct SgdSettings {
+    double learningRate = 0.01;
+    double lambda = 1e-4;
+    double momentum = 0.9;
+    size_t batchSize = 1024;
+};
+
+/**
+ * @brief 由 logits 求单个样本的对数损失；residuals 为真时把 logits 改写为各输出的残差（预测概率 - 目标）
+ */
+double logitLoss(double* logits, size_t outputs, uint32_t target, bool residuals) {
+    if (outputs == 1) {
+        double z = logits[0];
+        double y = target == 1 ? 1.0 : 0.0;
+        double loss = std::max(z, 0.0) - z * y + std::log1p(std::exp(-std::abs(z)));
+        if (residuals) {
+            logits[0] = 1.0 / (1.0 + std::exp(-z)) - y;
+        }
+        return loss;
+    }
+    
+    double maxLogit = *std::max_element(logits, logits + outputs);
+    double targetLogit = logits[target];
+    double sum = 0.0;
+    for (size_t o = 0; o < outputs; ++o) {
+        logits[o] = std::exp(logits[o] - maxLogit);
+        sum += logits[o];
+    }
+    if (residuals) {
+        for (size_t o = 0; o < outputs; ++o) {
+            logits[o] = logits[o] / sum - (o == target ? 1.0 : 0.0);
+        }
+    }
+    return maxLogit + std::log(sum) - targetLogit;
+}
+
+/**
+ * @brief 单个样本的对数损失；grad 不为空时累加梯度
+ * 
+ * weights 每个输出 p+1 个值（特征权重 + 截距），x 为标准化后的特征，logits 为 outputs 个元素的临时空间。
+ */
+double logisticLoss(
+    const double* weights, size_t p, size_t outputs, const double* x, uint32_t target, double* logits, double* grad) {
+    
+    const size_t stride = p + 1;
+    for (size_t o = 0; o < outputs; ++o) {
+        logits[o] = weights[o * stride + p] + dotProduct(weights + o * stride, x, p);
+    }
+    
+    double loss = logitLoss(logits, outputs, target, grad != nullptr);
+    if (grad) {
+        for (size_t o = 0; o < outputs; ++o) {
+            addScaled(logits[o], x, grad + o * stride, p);
+            grad[o * stride + p] += logits[o];
+        }
+    }
+    return loss;
+}
+
+/**
+ * @brief 一组样本在标准化特征上的平均对数损失（按固定块并行，块序合并）
+ */
+double averageLogisticLoss(
+    const ConstMatrixView& data, const std::vector<uint32_t>& targets, const std::vector<size_t>& rows,
+    const std::vector<double>& means, const std::vector<double>& invScale,
+    const std::vector<double>& weights, size_t outputs) {
+    
+    const size_t p = data.cols();
+    size_t blocks = (rows.size() + kChunkRows - 1) / kChunkRows;
+    std::vector<double> partial(blocks, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+        std::vector<double> scratch(p + outputs);
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            size_t end = std::min(rows.size(), (b + 1) * kChunkRows);
+            for (size_t i = b * kChunkRows; i < end; ++i) {
+                const double* sample = data.row(rows[i]);
+                for (size_t j = 0; j < p; ++j) {
+                    scratch[j] = (sample[j] - means[j]) * invScale[j];
+                }
+                partial[b] += logisticLoss(weights.data(), p, outputs, scratch.data(), targets[rows[i]],
+                                           scratch.data() + p, nullptr);
+            }
+        }
+    });
+    
+    double sum = 0.0;
+    for (double value : partial) {
+        sum += value;
+    }
+    return sum / static_cast<double>(rows.size());
+}
+
+/**
+ * @brief 用一个小批量的梯度之和做一步动量更新（L2正则只作用于特征权重）
+ */
+void momentumStep(const std::vector<double>& gradient, double invCount, size_t p, size_t outputs,
+                  const SgdSettings& settings, std::vector<double>& weights, std::vector<double>& velocity) {
+    const size_t stride = p + 1;
+    for (size_t o = 0; o < outputs; ++o) {
+        for (size_t j = 0; j <= p; ++j) {
+            size_t index = o * stride + j;
+            double g = gradient[index] * invCount + (j < p ? settings.lambda * weights[index] : 0.0);
+            velocity[index] = settings.momentum * velocity[index] - settings.learningRate * g;
+            weights[index] += velocity[index];
+        }
+    }
+}
+
+/**
+ * @brief 按 rows 的顺序在标准化特征上做一轮带动量的小批量SGD
+ * 
+ * 每个小批量按 kGradientBlockRows 行切分后在线程池上并行计算梯度，部分梯度按块序号合并；
+ * L2正则只作用于特征权重。
+ * 
+ * @return 这些样本的对数损失之和（按更新前的权重计算）
+ */
+double sgdEpoch(
+    const ConstMatrixView& data, const std::vector<uint32_t>& targets, const std::vector<size_t>& rows,
+    const std::vector<double>& means, const std::vector<double>& invScale, size_t outputs,
+    const SgdSettings& settings, std::vector<double>& weights, std::vector<double>& velocity) {
+    
+    const size_t p = data.cols();
+    const size_t stride = p + 1;
+    const size_t batchSize = std::max<size_t>(1, std::min(settings.batchSize, rows.size()));
+    const size_t maxBlocks = (batchSize + kGradientBlockRows - 1) / kGradientBlockRows;
+    std::vector<double> blockGradients(maxBlocks * outputs * stride, 0.0);
+    std::vector<double> blockLosses(maxBlocks, 0.0);
+    std::vector<double> gradient(outputs * stride, 0.0);
+    auto& pool = Utils::ThreadPool::instance();
+    double totalLoss = 0.0;
+    
+    for (size_t batchBegin = 0; batchBegin < rows.size(); batchBegin += batchSize) {
+        size_t batchEnd = std::min(batchBegin + batchSize, rows.size());
+        size_t blocks = (batchEnd - batchBegin + kGradientBlockRows - 1) / kGradientBlockRows;
+        
+        pool.parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+            std::vector<double> scratch(p + outputs);
+            for (size_t b = blockBegin; b < blockEnd; ++b) {
+                double* grad = blockGradients.data() + b * outputs * stride;
+                std::fill(grad, grad + outputs * stride, 0.0);
+                double loss = 0.0;
+                size_t end = std::min(batchEnd, batchBegin + (b + 1) * kGradientBlockRows);
+                for (size_t i = batchBegin + b * kGradientBlockRows; i < end; ++i) {
+                    const double* sample = data.row(rows[i]);
+                    for (size_t j = 0; j < p; ++j) {
+                        scratch[j] = (sample[j] - means[j]) * invScale[j];
+                    }
+                    loss += logisticLoss(weights.data(), p, outputs, scratch.data(), targets[rows[i]],
+                                         scratch.data() + p, grad);
+                }
+                blockLosses[b] = loss;
+            }
+        });
+        
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        for (size_t b = 0; b < blocks; ++b) {
+            addScaled(1.0, blockGradients.data() + b * outputs * stride, gradient.data(), gradient.size());
+            totalLoss += blockLosses[b];
+        }
+        
+        momentumStep(gradient, 1.0 / static_cast<double>(batchEnd - batchBegin), p, outputs, settings, weights, velocity);
+    }
+    
+    return totalLoss;
+}
+
+/**
+ * @brief 把标准化折算进权重：w' = w / σ，b' = b - Σ w'μ
+ */
+Matrix foldStandardization(
+    const std::vector<double>& weights, const std::vector<double>& means,
+    const std::vector<double>& invScale, size_t outputs) {
+    
+    const size_t p = means.size();
+    const size_t stride = p + 1;
+    Matrix folded(outputs, stride);
+    for (size_t o = 0; o < outputs; ++o) {
+        double bias = weights[o * stride + p];
+        for (size_t j = 0; j < p; ++j) {
+            double weight = weights[o * stride + j] * invScale[j];
+            folded(o, j) = weight;
+            bias -= weight * means[j];
+        }
+        folded(o, p) = bias;
+    }
+    return folded;
+}
+
+/**
+ * @brief 稀疏特征的均值和标准差的倒数（一遍累加和与平方和，按固定行块合并）
+ */
+void standardization(const SparseMatrixView& data, std::vector<double>& means, std::vector<double>& invScale) {
+    const size_t numSamples = data.rows();
+    const size_t p = data.cols();
+    RowChunks chunks(numSamples, 2 * p * sizeof(double));
+    
+    std::vector<double> partial(chunks.count * 2 * p, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        std::vector<uint32_t> scratch;
+        for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+            double* sums = partial.data() + c * 2 * p;
+            double* squares = sums + p;
+            for (size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                SparseRow row = data.row(i, scratch);
+                for (size_t k = 0; k < row.size; ++k) {
+                    double value = row.value(k);
+                    sums[row.indices[k]] += value;
+                    squares[row.indices[k]] += value * value;
+                }
+            }
+        }
+    });
+    
+    means.assign(p, 0.0);
+    invScale.assign(p, 0.0);
+    std::vector<double> squares(p, 0.0);
+    for (size_t c = 0; c < chunks.count; ++c) {
+        addScaled(1.0, partial.data() + c * 2 * p, means.data(), p);
+        addScaled(1.0, partial.data() + c * 2 * p + p, squares.data(), p);
+    }
+    for (size_t j = 0; j < p; ++j) {
+        means[j] /= static_cast<double>(numSamples);
+        double variance = std::max(0.0, squares[j] / static_cast<double>(numSamples) - means[j] * means[j]);
+        double deviation = std::sqrt(variance);
+        invScale[j] = deviation > 0.0 ? 1.0 / deviation : 0.0;
+    }
+}
+
+/**
+ * @brief 稀疏特征上一个样本的 logits（folded 为换算到原始特征上的权重）
+ */
+void sparseLogits(const Matrix& folded, const SparseRow& row, double* logits) {
+    const size_t p = folded.cols() - 1;
+    for (size_t o = 0; o < folded.rows(); ++o) {
+        logits[o] = folded(o, p) + sparseDot(row, folded.row(o));
+    }
+}
+
+/**
+ * @brief 稀疏特征上一组样本的平均对数损失（与稠密版本相同的块划分）
+ */
+double averageLogisticLoss(
+    const SparseMatrixView& data, const std::vector<uint32_t>& targets, const std::vector<size_t>& rows,
+    const std::vector<double>& means, const std::vector<double>& invScale,
+    const std::vector<double>& weights, size_t outputs) {
+    
+    Matrix folded = foldStandardization(weights, means, invScale, outputs);
+    size_t blocks = (rows.size() + kChunkRows - 1) / kChunkRows;
+    std::vector<double> partial(blocks, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+        std::vector<uint32_t> scratch;
+        std::vector<double> logits(outputs);
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            size_t end = std::min(rows.size(), (b + 1) * kChunkRows);
+            for (size_t i = b * kChunkRows; i < end; ++i) {
+                sparseLogits(folded, data.row(rows[i], scratch), logits.data());
+                partial[b] += logitLoss(logits.data(), outputs, targets[rows[i]], false);
+            }
+        }
+    });
+    
+    double sum = 0.0;
+    for (double value : partial) {
+        sum += value;
+    }
+    return sum / static_cast<double>(rows.size());
+}
+
+/**
+ * @brief 稀疏特征上的 sgdEpoch
+ * 
+ * 标准化特征 z = (x - μ)·s 上的梯度为 s·(Σ r·x - μ·Σ r)：每个小批量开始时把权重换算到原始特征上，
+ * 样本的 logits 和 Σ r·x 只涉及非零元素，-μ·Σ r 在合并各块的梯度后一次补上。
+ */
+double sgdEpoch(
+    const SparseMatrixView& data, const std::vector<uint32_t>& targets, const std::vector<size_t>& rows,
+    const std::vector<double>& means, const std::vector<double>& invScale, size_t outputs,
+    const SgdSettings& settings, std::vector<double>& weights, std::vector<double>& velocity) {
+    
+    const size_t p = data.cols();
+    const size_t stride = p + 1;
+    const size_t batchSize = std::max<size_t>(1, std::min(settings.batchSize, rows.size()));
+    const size_t maxBlocks = (batchSize + kGradientBlockRows - 1) / kGradientBlockRows;
+    std::vector<double> blockGradients(maxBlocks * outputs * stride, 0.0);
+    std::vector<double> blockLosses(maxBlocks, 0.0);
+    std::vector<double> gradient(outputs * stride, 0.0);
+    auto& pool = Utils::ThreadPool::instance();
+    double totalLoss = 0.0;
+    
+    for (size_t batchBegin = 0; batchBegin < rows.size(); batchBegin += batchSize) {
+        size_t batchEnd = std::min(batchBegin + batchSize, rows.size());
+        size_t blocks = (batchEnd - batchBegin + kGradientBlockRows - 1) / kGradientBlockRows;
+        Matrix folded = foldStandardization(weights, means, invScale, outputs);
+        
+        pool.parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+            std::vector<uint32_t> scratch;
+            std::vector<double> logits(outputs);
+            for (size_t b = blockBegin; b < blockEnd; ++b) {
+                double* grad = blockGradients.data() + b * outputs * stride;
+                std::fill(grad, grad + outputs * stride, 0.0);
+                double loss = 0.0;
+                size_t end = std::min(batchEnd, batchBegin + (b + 1) * kGradientBlockRows);
+                for (size_t i = batchBegin + b * kGradientBlockRows; i < end; ++i) {
+                    SparseRow row = data.row(rows[i], scratch);
+                    sparseLogits(folded, row, logits.data());
+                    loss += logitLoss(logits.data(), outputs, targets[rows[i]], true);
+                    for (size_t o = 0; o < outputs; ++o) {
+                        sparseAxpy(logits[o], row, grad + o * stride);
+                        grad[o * stride + p] += logits[o];
+                    }
+                }
+                blockLosses[b] = loss;
+            }
+        });
+        
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        for (size_t b = 0; b < blocks; ++b) {
+            addScaled(1.0, blockGradients.data() + b * outputs * stride, gradient.data(), gradient.size());
+            totalLoss += blockLosses[b];
+        }
+        for (size_t o = 0; o < outputs; ++o) {
+            double* grad = gradient.data() + o * stride;
+            for (size_t j = 0; j < p; ++j) {
+                grad[j] = invScale[j] * (grad[j] - means[j] * grad[p]);
+            }
+        }
+        
+        momentumStep(gradient, 1.0 / static_cast<double>(batchEnd - batchBegin), p, outputs, settings, weights, velocity);
+    }
+    
+    return totalLoss;
+}
+
+} // namespace
+
+// LinearRegressionModel 实现
+TrainingResult LinearRegressionModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+TrainingResult LinearRegressionModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+template <typename Features>
+TrainingResult LinearRegressionModel::fit(
+    const Features& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    double lambda = std::max(0.0, parameterOr(parameters, "lambda", 0.0));
+    bool fitIntercept = parameterOr(parameters, "fitIntercept", 1.0) != 0.0;
+    
+    const size_t numSamples = trainingData.rows();
+    const size_t p = trainingData.cols();
+    const size_t q = paddedColumns(p + 1);   // [X y] 补齐到8列的倍数
+    
+    // 第一遍求均值（稀疏特征只求标签的均值），第二遍累加中心化后 [X y] 的Gram矩阵，
+    // 同时得到 XᵀX、Xᵀy 和 yᵀy；这些统计量保留下来，之后的 partialFit() 在其上继续累加
+    m_modelFile.reset();
+    m_fitIntercept = fitIntercept;
+    m_lambda = lambda;
+    m_sampleCount = static_cast<double>(numSamples);
+    m_center = fitIntercept ? columnMeans(trainingData, trainingLabels.data()) : std::vector<double>(p + 1, 0.0);
+    m_gram.assign(q * q, 0.0);
+    m_sums.assign(p + 1, 0.0);
+    accumulateShiftedGram(trainingData, trainingLabels.data(), m_center, q, m_gram, m_sums);
+    
+    RidgeSolution solution;
+    if (!solveRidge(m_gram, m_sums, m_center, m_sampleCount, q, lambda, fitIntercept, solution)) {
+        result.errorMessage = "Normal equations are not positive definite";
+        return result;
+    }
+    m_coefficients = std::move(solution.coefficients);
+    m_intercept = solution.intercept;
+    refreshReducedPrecision();
+    
+    // 评估：按相同的行块划分求残差平方和和阈值内的样本数
+    double errorSum = 0.0;
+    size_t correct = 0;
+    evaluateLinear(trainingData, trainingLabels, m_coefficients, m_intercept, errorSum, correct);
+    
+    result.success = true;
+    result.meanSquaredError = errorSum / numSamples;
+    result.accuracy = static_cast<double>(correct) / numSamples;
+    result.additionalMetrics["r2"] = solution.totalSquares > 0.0 ? 1.0 - errorSum / solution.totalSquares : 0.0;
+    result.additionalMetrics["lambda"] = lambda;
+    result.additionalMetrics["droppedFeatures"] = static_cast<double>(solution.droppedFeatures);
+    result.additionalMetrics["jitter"] = solution.jitter;
+    
+    return result;
+}
+
+TrainingResult LinearRegressionModel::partialFit(
+    const ConstMatrixView& chunk,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (chunk.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (labels.size() != chunk.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    if (m_modelFile) {
+        restoreStatistics();
+    }
+    
+    const size_t p = chunk.cols();
+    const size_t q = paddedColumns(p + 1);
+    if (m_sampleCount > 0.0 && m_center.size() != p + 1) {
+        result.errorMessage = "Feature count does not match previous chunks";
+        return result;
+    }
+    
+    // 第一个数据块确定是否拟合截距，并以其均值作为累加的参照中心，
+    // 之后的数据块相对这个中心累加，避免大均值特征的Gram矩阵损失精度
+    if (m_sampleCount == 0.0) {
+        m_fitIntercept = parameterOr(parameters, "fitIntercept", 1.0) != 0.0;
+        m_center = m_fitIntercept ? columnMeans(chunk, labels.data()) : std::vector<double>(p + 1, 0.0);
+        m_gram.assign(q * q, 0.0);
+        m_sums.assign(p + 1, 0.0);
+    }
+    m_lambda = std::max(0.0, parameterOr(parameters, "lambda", m_lambda));
+    
+    accumulateShiftedGram(chunk, labels.data(), m_center, q, m_gram, m_sums);
+    m_sampleCount += static_cast<double>(chunk.rows());
+    
+    // 解只取决于累加的统计量，因此与逐块的划分方式无关（等同于在所有已见数据上调用 train()）
+    RidgeSolution solution;
+    if (!solveRidge(m_gram, m_sums, m_center, m_sampleCount, q, m_lambda, m_fitIntercept, solution)) {
+        result.errorMessage = "Normal equations are not positive definite";
+        return result;
+    }
+    m_coefficients = std::move(solution.coefficients);
+    m_intercept = solution.intercept;
+    refreshReducedPrecision();
+    
+    // 均方误差和 r2 针对所有已见数据（由Gram矩阵直接得到），阈值内的比例只统计当前数据块
+    double errorSum = 0.0;
+    size_t correct = 0;
+    evaluateLinear(chunk, labels, m_coefficients, m_intercept, errorSum, correct);
+    
+    result.success = true;
+    result.meanSquaredError = solution.residualSquares / m_sampleCount;
+    result.accuracy = static_cast<double>(correct) / chunk.rows();
+    result.additionalMetrics["r2"] =
+        solution.totalSquares > 0.0 ? 1.0 - solution.residualSquares / solution.totalSquares : 0.0;
+    result.additionalMetrics["chunkMeanSquaredError"] = errorSum / chunk.rows();
+    result.additionalMetrics["samplesSeen"] = m_sampleCount;
+    result.additionalMetrics["lambda"] = m_lambda;
+    result.additionalMetrics["droppedFeatures"] = static_cast<double>(solution.droppedFeatures);
+    result.additionalMetrics["jitter"] = solution.jitter;
+    
+    return result;
+}
+
+std::vector<double> LinearRegressionModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_coefficients.empty() || testData.empty() || testData.cols() != m_coefficients.size()) {
+        return {};
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    if (!m_reduced.empty()) {
+        Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+            [&](size_t begin, size_t end) {
+                m_reduced.evaluate(testData, begin, end, predictions.data() + begin);
+            });
+        return predictions;
+    }
+    
+    const size_t p = m_coefficients.size();
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const double* sample = testData.row(i);
+                double prediction = m_intercept;
+                for (size_t j = 0; j < p; ++j) {
+                    prediction += m_coefficients[j] * sample[j];
+                }
+                predictions[i] = prediction;
+            }
+        });
+    
+    return predictions;
+}
+
+std::vector<double> LinearRegressionModel::predict(const SparseMatrixView& testData) {
+    
+    if (m_coefficients.empty() || testData.empty() || testData.cols() != m_coefficients.size()) {
+        return {};
+    }
+    if (!m_reduced.empty()) {
+        return IMLModel::predict(testData);
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                predictions[i] = m_intercept + testData.dot(i, m_coefficients.data());
+            }
+        });
+    
+    return predictions;
+}
+
+bool LinearRegressionModel::setInferencePrecision(InferencePrecision precision) {
+    m_precision = precision;
+    refreshReducedPrecision();
+    return true;
+}
+
+void LinearRegressionModel::refreshReducedPrecision() {
+    m_reduced.clear();
+    if (m_precision != InferencePrecision::Double && !m_coefficients.empty()) {
+        m_reduced.build(ConstMatrixView(m_coefficients.data(), 1, m_coefficients.size()), {m_intercept}, m_precision);
+    }
+}
+
+bool LinearRegressionModel::saveModel(const std::string& filePath) {
+    try {
+        ModelFileWriter writer(ModelType::LinearRegression);
+        writer.addArray(kCoefficientsSection, m_coefficients);
+        writer.addArray(kInterceptSection, &m_intercept, 1);
+        
+        double state[3] = {m_sampleCount, m_fitIntercept ? 1.0 : 0.0, m_lambda};
+        if (m_sampleCount > 0.0) {
+            writer.addArray(kStateSection, state, 3);
+            writer.addArray(kCenterSection, m_center);
+            writer.addArray(kGramSection, m_gram);
+            writer.addArray(kSumsSection, m_sums);
+        }
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool LinearRegressionModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::LinearRegression) {
+            return false;
+        }
+        
+        auto coefficients = file->section<double>(kCoefficientsSection);
+        auto intercept = file->section<double>(kInterceptSection);
+        if (!coefficients.valid || !intercept.valid || intercept.count != 1) {
+            return false;
+        }
+        
+        m_coefficients.assign(coefficients.data, coefficients.data + coefficients.count);
+        m_intercept = intercept.data[0];
+        refreshReducedPrecision();
+        m_sampleCount = 0.0;
+        m_center.clear();
+        m_gram.clear();
+        m_sums.clear();
+        m_modelFile = file->hasSection(kStateSection) ? file : nullptr;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+void LinearRegressionModel::restoreStatistics() {
+    std::shared_ptr<const MappedModelFile> file = std::move(m_modelFile);
+    m_modelFile.reset();
+    
+    // 统计量损坏或与系数的维数不符时不使用，增量训练从头累加
+    auto state = file->section<double>(kStateSection);
+    auto center = file->section<double>(kCenterSection);
+    auto gram = file->section<double>(kGramSection);
+    auto sums = file->section<double>(kSumsSection);
+    const size_t p = m_coefficients.size();
+    const size_t q = paddedColumns(p + 1);
+    if (!state.valid || state.count != 3 || !(state.data[0] > 0.0) || !center.valid || center.count != p + 1 ||
+        !gram.valid || gram.count != q * q || !sums.valid || sums.count != p + 1) {
+        return;
+    }
+    
+    m_sampleCount = state.data[0];
+    m_fitIntercept = state.data[1] != 0.0;
+    m_lambda = state.data[2];
+    m_center.assign(center.data, center.data + center.count);
+    m_gram.assign(gram.data, gram.data + gram.count);
+    m_sums.assign(sums.data, sums.data + sums.count);
+}
+
+// LogisticRegressionModel 实现
+TrainingResult LogisticRegressionModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+TrainingResult LogisticRegressionModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+template <typename Features>
+TrainingResult LogisticRegressionModel::fit(
+    const Features& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    SgdSettings settings;
+    settings.learningRate = parameterOr(parameters, "learningRate", 0.01);
+    if (!(settings.learningRate > 0.0)) {
+        result.errorMessage = "Learning rate must be positive";
+        return result;
+    }
+    settings.lambda = std::max(0.0, parameterOr(parameters, "lambda", 1e-4));
+    settings.momentum = std::min(0.999, std::max(0.0, parameterOr(parameters, "momentum", 0.9)));
+    settings.batchSize = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "batchSize", 1024)));
+    size_t maxEpochs = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "maxEpochs", 50)));
+    double validationFraction = std::min(0.5, std::max(0.0, parameterOr(parameters, "validationFraction", 0.1)));
+    size_t patience = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "patience", 3)));
+    double tolerance = std::max(0.0, parameterOr(parameters, "tolerance", 1e-3));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    const size_t numSamples = trainingData.rows();
+    const size_t p = trainingData.cols();
+    
+    // 类别标签值升序排列，样本标签映射为类别下标
+    std::vector<double> classes(trainingLabels);
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    if (classes.size() < 2) {
+        result.errorMessage = "At least two classes are required";
+        return result;
+    }
+    const size_t numClasses = classes.size();
+    const size_t outputs = numClasses == 2 ? 1 : numClasses;
+    
+    std::vector<uint32_t> targets;
+    mapTargets(classes, trainingLabels, targets);
+    
+    // 标准化参数：均值和标准差（按固定行块求和）
+    std::vector<double> means;
+    std::vector<double> invScale;
+    standardization(trainingData, means, invScale);
+    
+    // 随机划分训练集和验证集
+    std::mt19937_64 rng(seed);
+    std::vector<size_t> trainRows(numSamples);
+    std::iota(trainRows.begin(), trainRows.end(), 0);
+    std::shuffle(trainRows.begin(), trainRows.end(), rng);
+    
+    size_t validationCount = static_cast<size_t>(numSamples * validationFraction);
+    std::vector<size_t> validationRows(trainRows.begin(), trainRows.begin() + validationCount);
+    trainRows.erase(trainRows.begin(), trainRows.begin() + validationCount);
+    
+    std::vector<double> weights(outputs * (p + 1), 0.0);
+    std::vector<double> velocity(outputs * (p + 1), 0.0);
+    std::vector<double> bestWeights = weights;
+    
+    double bestLoss = 0.0;
+    double trainingLoss = 0.0;
+    size_t epochsRun = 0;
+    size_t epochsWithoutImprovement = 0;
+    TrainingControl* control = TrainingControl::current();
+    
+    for (size_t epoch = 0; epoch < maxEpochs; ++epoch) {
+        std::shuffle(trainRows.begin(), trainRows.end(), rng);
+        double epochLoss = sgdEpoch(trainingData, targets, trainRows, means, invScale, outputs, settings, weights, velocity);
+        
+        ++epochsRun;
+        trainingLoss = epochLoss / static_cast<double>(trainRows.size());
+        double monitoredLoss = validationRows.empty()
+            ? trainingLoss
+            : averageLogisticLoss(trainingData, targets, validationRows, means, invScale, weights, outputs);
+        if (!std::isfinite(monitoredLoss)) {
+            result.errorMessage = "Training diverged, try a smaller learning rate";
+            return result;
+        }
+        if (control && control->checkpoint(static_cast<double>(epoch + 1) / static_cast<double>(maxEpochs), result,
+                                           {{"trainingLoss", trainingLoss}, {"monitoredLoss", monitoredLoss}})) {
+            return result;
+        }
+        
+        // 提前停止：损失连续 patience 轮没有明显下降
+        if (epoch == 0 || monitoredLoss < bestLoss * (1.0 - tolerance)) {
+            bestLoss = monitoredLoss;
+            bestWeights = weights;
+            epochsWithoutImprovement = 0;
+        } else if (++epochsWithoutImprovement >= patience) {
+            break;
+        }
+    }
+    
+    m_modelFile.reset();
+    m_classes = classes;
+    m_weights = foldStandardization(bestWeights, means, invScale, outputs);
+    refreshReducedPrecision();
+    
+    // 保留标准化参数和标准化特征上的权重，之后的 partialFit() 在其上继续训练
+    m_means = std::move(means);
+    m_invScale = std::move(invScale);
+    m_sgdWeights = std::move(bestWeights);
+    m_velocity.assign(m_sgdWeights.size(), 0.0);
+    m_samplesSeen = static_cast<double>(numSamples);
+    
+    evaluate(trainingData, targets, result);
+    result.success = true;
+    result.additionalMetrics["classes"] = static_cast<double>(numClasses);
+    result.additionalMetrics["epochs"] = static_cast<double>(epochsRun);
+    result.additionalMetrics["trainingLoss"] = trainingLoss;
+    if (!validationRows.empty()) {
+        result.additionalMetrics["validationLoss"] = bestLoss;
+    }
+    result.additionalMetrics["learningRate"] = settings.learningRate;
+    
+    return result;
+}
+
+TrainingResult LogisticRegressionModel::partialFit(
+    const ConstMatrixView& chunk,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (chunk.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (labels.size() != chunk.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    SgdSettings settings;
+    settings.learningRate = parameterOr(parameters, "learningRate", 0.01);
+    if (!(settings.learningRate > 0.0)) {
+        result.errorMessage = "Learning rate must be positive";
+        return result;
+    }
+    settings.lambda = std::max(0.0, parameterOr(parameters, "lambda", 1e-4));
+    settings.momentum = std::min(0.999, std::max(0.0, parameterOr(parameters, "momentum", 0.9)));
+    settings.batchSize = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "batchSize", 1024)));
+    size_t epochs = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "chunkEpochs", 1)));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    if (m_modelFile) {
+        restoreTrainingState();
+    }
+    
+    const size_t p = chunk.cols();
+    if (!m_sgdWeights.empty() && m_means.size() != p) {
+        result.errorMessage = "Feature count does not match previous chunks";
+        return result;
+    }
+    
+    // 第一个数据块确定类别集合（或由 numClasses 指定为 0..numClasses-1）和标准化参数；
+    // 状态先在副本上更新，出错时模型保持这个数据块之前的状态
+    bool firstChunk = m_sgdWeights.empty();
+    std::vector<double> classes = m_classes;
+    std::vector<double> means = m_means;
+    std::vector<double> invScale = m_invScale;
+    std::vector<double> weights = m_sgdWeights;
+    std::vector<double> velocity = m_velocity;
+    double samplesSeen = m_samplesSeen;
+    if (firstChunk) {
+        size_t declaredClasses = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "numClasses", 0.0)));
+        classes.clear();
+        if (declaredClasses > 0) {
+            for (size_t k = 0; k < declaredClasses; ++k) {
+                classes.push_back(static_cast<double>(k));
+            }
+        } else {
+            classes = labels;
+            std::sort(classes.begin(), classes.end());
+            classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+        }
+        if (classes.size() < 2) {
+            result.errorMessage = "At least two classes are required (set numClasses for the first chunk)";
+            return result;
+        }
+        
+        standardization(chunk, means, invScale);
+        size_t outputs = classes.size() == 2 ? 1 : classes.size();
+        weights.assign(outputs * (p + 1), 0.0);
+        velocity.assign(weights.size(), 0.0);
+        samplesSeen = 0.0;
+    }
+    
+    std::vector<uint32_t> targets;
+    if (!mapTargets(classes, labels, targets)) {
+        result.errorMessage = "Chunk contains a class that was not seen in the first chunk (set numClasses)";
+        return result;
+    }
+    const size_t outputs = classes.size() == 2 ? 1 : classes.size();
+    
+    // 数据块内以已见样本数为种子打乱，逐块调用的结果与线程数无关
+    std::mt19937_64 rng(seed + static_cast<uint64_t>(samplesSeen));
+    std::vector<size_t> rows(chunk.rows());
+    std::iota(rows.begin(), rows.end(), 0);
+    double chunkLoss = 0.0;
+    for (size_t epoch = 0; epoch < epochs; ++epoch) {
+        std::shuffle(rows.begin(), rows.end(), rng);
+        chunkLoss = sgdEpoch(chunk, targets, rows, means, invScale, outputs, settings, weights, velocity);
+    }
+    
+    bool finite = std::isfinite(chunkLoss);
+    for (double weight : weights) {
+        finite = finite && std::isfinite(weight);
+    }
+    if (!finite) {
+        result.errorMessage = "Training diverged, try a smaller learning rate";
+        return result;
+    }
+    
+    m_classes = std::move(classes);
+    m_means = std::move(means);
+    m_invScale = std::move(invScale);
+    m_sgdWeights = std::move(weights);
+    m_velocity = std::move(velocity);
+    m_samplesSeen = samplesSeen + static_cast<double>(chunk.rows());
+    m_weights = foldStandardization(m_sgdWeights, m_means, m_invScale, outputs);
+    refreshReducedPrecision();
+    
+    // 指标在当前数据块上统计
+    evaluate(chunk, targets, result);
+    result.success = true;
+    result.additionalMetrics["classes"] = static_cast<double>(m_classes.size());
+    result.additionalMetrics["trainingLoss"] = chunkLoss / static_cast<double>(chunk.rows());
+    result.additionalMetrics["samplesSeen"] = m_samplesSeen;
+    result.additionalMetrics["learningRate"] = settings.learningRate;
+    
+    return result;
+}
+
+template <typename Features>
+void LogisticRegressionModel::evaluate(
+    const Features& data, const std::vector<uint32_t>& targets, TrainingResult& result) const {
+    
+    // 每个类别的真阳性、预测数和实际数
+    const size_t numClasses = m_classes.size();
+    const size_t outputs = m_weights.rows();
+    RowChunks chunks(data.rows(), numClasses * 3 * sizeof(size_t));
+    std::vector<size_t> partialCounts(chunks.count * numClasses * 3, 0);
+    Utils::ThreadPool::instance().parallelFor(0, chunks.count, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        std::vector<double> logits(outputs);
+        for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+            size_t* counts = partialCounts.data() + c * numClasses * 3;
+            for (size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                size_t predicted = predictClassIndex(data, i, logits.data());
+                counts[predicted * 3] += predicted == targets[i] ? 1 : 0;
+                counts[predicted * 3 + 1] += 1;
+                counts[targets[i] * 3 + 2] += 1;
+            }
+        }
+    });
+    
+    std::vector<size_t> counts(numClasses * 3, 0);
+    for (size_t c = 0; c < chunks.count; ++c) {
+        for (size_t k = 0; k < counts.size(); ++k) {
+            counts[k] += partialCounts[c * counts.size() + k];
+        }
+    }
+    
+    size_t correct = 0;
+    for (size_t k = 0; k < numClasses; ++k) {
+        correct += counts[k * 3];
+    }
+    
+    // 二分类以较大的标签值为正类，多分类取各类别的宏平均
+    auto ratio = [](size_t numerator, size_t denominator) {
+        return denominator > 0 ? static_cast<double>(numerator) / denominator : 0.0;
+    };
+    result.precision = 0.0;
+    result.recall = 0.0;
+    if (numClasses == 2) {
+        result.precision = ratio(counts[3], counts[4]);
+        result.recall = ratio(counts[3], counts[5]);
+    } else {
+        for (size_t k = 0; k < numClasses; ++k) {
+            result.precision += ratio(counts[k * 3], counts[k * 3 + 1]);
+            result.recall += ratio(counts[k * 3], counts[k * 3 + 2]);
+        }
+        result.precision /= numClasses;
+        result.recall /= numClasses;
+    }
+    
+    result.accuracy = ratio(correct, data.rows());
+    double precisionRecall = result.precision + result.recall;
+    result.f1Score = precisionRecall > 0.0 ? 2 * result.precision * result.recall / precisionRecall : 0.0;
+}
+
+size_t LogisticRegressionModel::predictClassIndex(const double* sample, double* logits) const {
+    const size_t outputs = m_weights.rows();
+    const size_t p = m_weights.cols() - 1;
+    for (size_t o = 0; o < outputs; ++o) {
+        logits[o] = m_weights(o, p) + dotProduct(m_weights.row(o), sample, p);
+    }
+    if (outputs == 1) {
+        return logits[0] > 0.0 ? 1 : 0;
+    }
+    return static_cast<size_t>(std::max_element(logits, logits + outputs) - logits);
+}
+
+size_t LogisticRegressionModel::predictClassIndex(const ConstMatrixView& data, size_t i, double* logits) const {
+    return predictClassIndex(data.row(i), logits);
+}
+
+size_t LogisticRegressionModel::predictClassIndex(const SparseMatrixView& data, size_t i, double* logits) const {
+    const size_t outputs = m_weights.rows();
+    const size_t p = m_weights.cols() - 1;
+    for (size_t o = 0; o < outputs; ++o) {
+        logits[o] = m_weights(o, p) + data.dot(i, m_weights.row(o));
+    }
+    if (outputs == 1) {
+        return logits[0] > 0.0 ? 1 : 0;
+    }
+    return static_cast<size_t>(std::max_element(logits, logits + outputs) - logits);
+}
+
+std::vector<double> LogisticRegressionModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_weights.empty() || testData.empty() || testData.cols() + 1 != m_weights.cols()) {
+        return {};
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    if (!m_reduced.empty()) {
+        // 低精度层一次算出一段样本的全部输出，再按与双精度相同的规则取类别
+        const size_t outputs = m_reduced.outputs();
+        Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+            [&](size_t begin, size_t end) {
+                std::vector<double> logits((end - begin) * outputs);
+                m_reduced.evaluate(testData, begin, end, logits.data());
+                for (size_t i = begin; i < end; ++i) {
+                    const double* row = logits.data() + (i - begin) * outputs;
+                    size_t index = outputs == 1
+                        ? (row[0] > 0.0 ? 1 : 0)
+                        : static_cast<size_t>(std::max_element(row, row + outputs) - row);
+                    predictions[i] = m_classes[index];
+                }
+            });
+        return predictions;
+    }
+    
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            std::vector<double> logits(m_weights.rows());
+            for (size_t i = begin; i < end; ++i) {
+                predictions[i] = m_classes[predictClassIndex(testData.row(i), logits.data())];
+            }
+        });
+    
+    return predictions;
+}
+
+std::vector<double> LogisticRegressionModel::predict(const SparseMatrixView& testData) {
+    
+    if (m_weights.empty() || testData.empty() || testData.cols() + 1 != m_weights.cols()) {
+        return {};
+    }
+    if (!m_reduced.empty()) {
+        return IMLModel::predict(testData);
+    }
+    
+    std::vector<double> predictions(testData.rows());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            std::vector<double> logits(m_weights.rows());
+            for (size_t i = begin; i < end; ++i) {
+                predictions[i] = m_classes[predictClassIndex(testData, i, logits.data())];
+            }
+        });
+    
+    return predictions;
+}
+
+Matrix LogisticRegressionModel::predictProbabilities(const ConstMatrixView& testData) const {
+    
+    if (m_weights.empty() || testData.empty() || testData.cols() + 1 != m_weights.cols()) {
+        return Matrix();
+    }
+    
+    const size_t outputs = m_weights.rows();
+    const size_t p = m_weights.cols() - 1;
+    Matrix probabilities(testData.rows(), m_classes.size());
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictGrainSize,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const double* sample = testData.row(i);
+                double* out = probabilities.row(i);
+                if (outputs == 1) {
+                    double z = m_weights(0, p) + dotProduct(m_weights.row(0), sample, p);
+                    out[1] = 1.0 / (1.0 + std::exp(-z));
+                    out[0] = 1.0 - out[1];
+                    continue;
+                }
+                
+                double maxLogit = std::numeric_limits<double>::lowest();
+                for (size_t o = 0; o < outputs; ++o) {
+                    out[o] = m_weights(o, p) + dotProduct(m_weights.row(o), sample, p);
+                    maxLogit = std::max(maxLogit, out[o]);
+                }
+                double sum = 0.0;
+                for (size_t o = 0; o < outputs; ++o) {
+                    out[o] = std::exp(out[o] - maxLogit);
+                    sum += out[o];
+                }
+                for (size_t o = 0; o < outputs; ++o) {
+                    out[o] /= sum;
+                }
+            }
+        });
+    
+    return probabilities;
+}
+
+bool LogisticRegressionModel::setInferencePrecision(InferencePrecision precision) {
+    m_precision = precision;
+    refreshReducedPrecision();
+    return true;
+}
+
+void LogisticRegressionModel::refreshReducedPrecision() {
+    m_reduced.clear();
+    if (m_precision == InferencePrecision::Double || m_weights.empty()) {
+        return;
+    }
+    
+    // 截距在权重矩阵的最后一列
+    const size_t p = m_weights.cols() - 1;
+    std::vector<double> bias(m_weights.rows());
+    for (size_t o = 0; o < bias.size(); ++o) {
+        bias[o] = m_weights(o, p);
+    }
+    m_reduced.build(m_weights.view().colRange(0, p), bias, m_precision);
+}
+
+bool LogisticRegressionModel::saveModel(const std::string& filePath) {
+    try {
+        ModelFileWriter writer(ModelType::LogisticRegression);
+        writer.addArray(kClassesSection, m_classes);
+        writer.addMatrix(kWeightsSection, m_weights);
+        
+        if (!m_sgdWeights.empty()) {
+            writer.addArray(kStateSection, &m_samplesSeen, 1);
+            writer.addArray(kMeansSection, m_means);
+            writer.addArray(kInvScaleSection, m_invScale);
+            writer.addArray(kSgdWeightsSection, m_sgdWeights);
+            writer.addArray(kVelocitySection, m_velocity);
+        }
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool LogisticRegressionModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::LogisticRegression) {
+            return false;
+        }
+        
+        auto classes = file->section<double>(kClassesSection);
+        auto weights = file->section<double>(kWeightsSection);
+        if (!classes.valid || !weights.valid) {
+            return false;
+        }
+        size_t expectedOutputs = classes.count == 2 ? 1 : classes.count;
+        if (classes.count < 2 || weights.rows != expectedOutputs || weights.cols < 1) {
+            return false;
+        }
+        
+        m_classes.assign(classes.data, classes.data + classes.count);
+        m_weights = Matrix::copyOf(weights.matrix());
+        refreshReducedPrecision();
+        
+        // 先按恒等标准化设置增量训练的状态；文件中保存的状态在第一次 partialFit() 时读入
+        const size_t p = m_weights.cols() - 1;
+        m_means.assign(p, 0.0);
+        m_invScale.assign(p, 1.0);
+        m_sgdWeights.assign(m_weights.data(), m_weights.data() + m_weights.size());
+        m_velocity.assign(m_sgdWeights.size(), 0.0);
+        m_samplesSeen = 0.0;
+        m_modelFile = file->hasSection(kStateSection) ? file : nullptr;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+void LogisticRegressionModel::restoreTrainingState() {
+    std::shared_ptr<const MappedModelFile> file = std::move(m_modelFile);
+    m_modelFile.reset();
+    
+    // 状态损坏或维数不符时保留加载时设置的恒等标准化状态
+    auto samplesSeen = file->section<double>(kStateSection);
+    auto means = file->section<double>(kMeansSection);
+    auto invScale = file->section<double>(kInvScaleSection);
+    auto sgdWeights = file->section<double>(kSgdWeightsSection);
+    auto velocity = file->section<double>(kVelocitySection);
+    const size_t p = m_means.size();
+    if (!samplesSeen.valid || samplesSeen.count != 1 || !means.valid || means.count != p ||
+        !invScale.valid || invScale.count != p || !sgdWeights.valid || sgdWeights.count != m_sgdWeights.size() ||
+        !velocity.valid || velocity.count != m_sgdWeights.size()) {
+        return;
+    }
+    
+    m_samplesSeen = samplesSeen.data[0];
+    m_means.assign(means.data, means.data + means.count);
+    m_invScale.assign(invScale.data, invScale.data + invScale.count);
+    m_sgdWeights.assign(sgdWeights.data, sgdWeights.data + sgdWeights.count);
+    m_velocity.assign(velocity.data, velocity.data + velocity.count);
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include "MLModels.h"
+#include "ModelFile.h"
+#include "ReducedPrecision.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 原生线性/岭回归模型（不依赖mlpack）
+ * 
+ * 以正规方程求解：训练数据按固定的行块划分，各块在线程池上并行累加中心化后的 [X y] 的Gram矩阵，
+ * 块内再按缓存大小分片、以寄存器分块的微内核计算；各块的部分和按块序号依次合并，
+ * 因此结果与线程数无关、每次训练完全一致。合并后的 XᵀX 做对角均衡后用Cholesky分解求解。
+ * 
+ * 增量训练时保留 [X y] 的Gram矩阵和列和（以第一个数据块的均值为参照中心累加），
+ * 每个数据块并入后重新求解，结果等同于在所有已见数据上做一次 train()。
+ * train() 之后也可以继续调用 partialFit()。统计量保存在模型文件的单独节中，加载模型时不读取，
+ * 第一次 partialFit() 时才读入；旧格式的模型文件没有统计量，增量训练从头累加。
+ * 
+ * 稀疏特征（CSR或位矩阵）上训练时特征的参照中心取0，只有标签减去均值，因此Gram矩阵只需累加
+ * 每个样本非零元素两两的乘积，代价与非零元素数的平方成正比；Gram矩阵按特征分段并行累加。
+ * 
+ * 训练参数：
+ * - lambda：L2正则化系数（默认0，即普通最小二乘）
+ * - fitIntercept：是否拟合截距（默认1；增量训练时由第一个数据块确定）
+ */
+class LinearRegressionModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsPartialFit() const override { return true; }
+    
+    TrainingResult partialFit(
+        const ConstMatrixView& chunk,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsSparseFeatures() const override { return true; }
+    
+    TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 在稀疏特征上预测（低精度预测时转换为稠密矩阵）
+     */
+    std::vector<double> predict(const SparseMatrixView& testData) override;
+    
+    ModelType getModelType() const override { return ModelType::LinearRegression; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 支持 Float32 和 Int8（权重按输出对称量化）
+     */
+    bool setInferencePrecision(InferencePrecision precision) override;
+    InferencePrecision inferencePrecision() const override { return m_precision; }
+    
+    /**
+     * @brief 回归系数（每个特征一个）
+     */
+    const std::vector<double>& coefficients() const { return m_coefficients; }
+    
+    /**
+     * @brief 截距
+     */
+    double intercept() const { return m_intercept; }
+
+private:
+    template <typename Features>
+    TrainingResult fit(const Features& data, const std::vector<double>& labels,
+                       const std::map<std::string, double>& parameters);
+    
+    void restoreStatistics();
+    void refreshReducedPrecision();
+    
+    std::vector<double> m_coefficients;
+    double m_intercept = 0.0;
+    
+    // 增量训练的统计量：以 m_center 为参照的 [X y] 的Gram矩阵（上三角）和列和
+    double m_sampleCount = 0.0;
+    bool m_fitIntercept = true;
+    double m_lambda = 0.0;
+    std::vector<double> m_center;
+    std::vector<double> m_gram;
+    std::vector<double> m_sums;
+    std::shared_ptr<const MappedModelFile> m_modelFile;     // 尚未读入统计量的模型文件
+    
+    InferencePrecision m_precision = InferencePrecision::Double;
+    ReducedLinearLayer m_reduced;                           // 低精度的系数（双精度时为空）
+};
+
+/**
+ * @brief 原生逻辑回归模型（二分类与多分类，不依赖mlpack）
+ * 
+ * 两个类别时使用单个sigmoid输出，多于两个类别时使用softmax。训练使用带动量的小批量SGD：
+ * 特征在内部按均值和标准差标准化，每个小批量按固定行数切分后在线程池上并行计算梯度，
+ * 部分梯度按块序号合并，因此给定随机种子时结果与线程数无关。训练前留出一部分样本作验证集，
+ * 验证集对数损失连续 patience 轮没有改善即提前停止，并恢复验证损失最低时的参数。
+ * 训练完成后标准化被折算进权重，预测时直接对原始特征做点积。
+ * 
+ * 训练参数：
+ * - learningRate：学习率（默认0.01，与预测对话框一致）
+ * - lambda：L2正则化系数（默认1e-4，不作用于截距）
+ * - momentum：动量系数（默认0.9）
+ * - maxEpochs：最大训练轮数（默认50）
+ * - batchSize：小批量大小（默认1024）
+ * - validationFraction：验证集比例（默认0.1，为0时按训练损失判断停止）
+ * - patience：提前停止的容忍轮数（默认3）
+ * - tolerance：视为改善的最小相对下降（默认1e-3）
+ * - seed：随机种子（默认42）
+ * 
+ * 增量训练（partialFit）在每个数据块上做 chunkEpochs 轮（默认1）同样的小批量SGD，不留验证集。
+ * 类别集合和标准化参数由第一个数据块确定；之后的数据块可能缺少某些类别时，
+ * 第一次调用应传入 numClasses，类别标签取 0..numClasses-1。
+ * 增量训练的状态与线性回归的统计量一样保存在模型文件的单独节中，第一次 partialFit() 时才读入。
+ * 
+ * 稀疏特征上训练时不显式标准化（减去均值会破坏稀疏性）：每个小批量开始时把标准化特征上的权重
+ * 换算为原始特征上的权重，logit只对非零元素做点积，梯度只在非零列上累加，
+ * 均值项 -μΣr 在合并小批量梯度后一次补上。结果与在稠密矩阵上训练相同（只差浮点舍入）。
+ */
+class LogisticRegressionModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsPartialFit() const override { return true; }
+    
+    TrainingResult partialFit(
+        const ConstMatrixView& chunk,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsSparseFeatures() const override { return true; }
+    
+    TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测类别（返回类别标签值）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 在稀疏特征上预测类别（低精度预测时转换为稠密矩阵）
+     */
+    std::vector<double> predict(const SparseMatrixView& testData) override;
+    
+    /**
+     * @brief 预测各类别的概率
+     * 
+     * @param testData 测试数据
+     * @return 样本数×类别数的概率矩阵（列顺序同 classes()）
+     */
+    Matrix predictProbabilities(const ConstMatrixView& testData) const;
+    
+    ModelType getModelType() const override { return ModelType::LogisticRegression; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 支持 Float32 和 Int8（权重按输出对称量化）
+     */
+    bool setInferencePrecision(InferencePrecision precision) override;
+    InferencePrecision inferencePrecision() const override { return m_precision; }
+    
+    /**
+     * @brief 训练时出现的类别标签值（升序）
+     */
+    const std::vector<double>& classes() const { return m_classes; }
+
+private:
+    template <typename Features>
+    TrainingResult fit(const Features& data, const std::vector<double>& labels,
+                       const std::map<std::string, double>& parameters);
+    
+    void restoreTrainingState();
+    void refreshReducedPrecision();
+    size_t predictClassIndex(const double* sample, double* logits) const;
+    size_t predictClassIndex(const ConstMatrixView& data, size_t i, double* logits) const;
+    size_t predictClassIndex(const SparseMatrixView& data, size_t i, double* logits) const;
+    
+    template <typename Features>
+    void evaluate(const Features& data, const std::vector<uint32_t>& targets, TrainingResult& result) const;
+    
+    std::vector<double> m_classes;
+    Matrix m_weights;   // 每个输出一行：特征权重 + 截距（二分类只有一行）
+    
+    // 增量训练的状态：标准化参数、标准化特征上的权重和动量
+    std::vector<double> m_means;
+    std::vector<double> m_invScale;
+    std::vector<double> m_sgdWeights;
+    std::vector<double> m_velocity;
+    double m_samplesSeen = 0.0;
+    std::shared_ptr<const MappedModelFile> m_modelFile;     // 尚未读入训练状态的模型文件
+    
+    InferencePrecision m_precision = InferencePrecision::Double;
+    ReducedLinearLayer m_reduced;                           // 低精度的权重（双精度时为空）
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -1,32 +1,99 @@
 #include "MLModels.h"
+#include "LinearModels.h"
+#include "TreeModels.h"
+#include "ClusteringModels.h"
+#include "TimeSeriesModels.h"
+#include "BayesModels.h"
+#include "NeuralModels.h"
+#include "ModelFile.h"
+#include "../chemistry/MolecularDescriptors.h"
 #include <fstream>
 #include <sstream>
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 #include <tuple>
+#include <mutex>
+#include <chrono>
 
 namespace BondForge {
 namespace Core {
 namespace ML {
 
+// IMLModel 默认实现
+TrainingResult IMLModel::partialFit(
+    const ConstMatrixView& chunk,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters) {
+    
+    (void)chunk;
+    (void)labels;
+    (void)parameters;
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    result.errorMessage = "Incremental training is not supported by this model";
+    return result;
+}
+
+TrainingResult IMLModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return train(trainingData.toDense(0, trainingData.rows()), trainingLabels, parameters);
+}
+
+std::vector<double> IMLModel::predict(const SparseMatrixView& testData) {
+    
+    // 每段的稠密副本约8MB
+    const size_t blockRows = std::max<size_t>(64, (size_t(1) << 20) / std::max<size_t>(1, testData.cols()));
+    std::vector<double> predictions;
+    predictions.reserve(testData.rows());
+    for (size_t begin = 0; begin < testData.rows(); begin += blockRows) {
+        size_t end = std::min(testData.rows(), begin + blockRows);
+        std::vector<double> block = predict(testData.toDense(begin, end));
+        if (block.size() != end - begin) {
+            return {};
+        }
+        predictions.insert(predictions.end(), block.begin(), block.end());
+    }
+    return predictions;
+}
+
 // DataPreprocessor 实现
 std::vector<std::vector<double>> DataPreprocessor::extractFeatures(
     const std::vector<Data::DataRecord>& records,
     const std::string& featureType) {
     
-    std::vector<std::vector<double>> features;
+    return extractFeatureMatrix(records, featureType).toRows();
+}
+
+Matrix DataPreprocessor::extractFeatureMatrix(
+    const std::vector<Data::DataRecord>& records,
+    const std::string& featureType) {
+    
+    Matrix features;
     
     if (featureType == "content_length") {
         // 提取内容长度作为特征
-        for (const auto& record : records) {
-            features.push_back({static_cast<double>(record.content.length())});
+        features.assign(records.size(), 1);
+        for (size_t i = 0; i < records.size(); ++i) {
+            features(i, 0) = static_cast<double>(records[i].content.length());
         }
     } 
     else if (featureType == "timestamp") {
         // 提取时间戳作为特征（转换为天数）
-        for (const auto& record : records) {
-            features.push_back({static_cast<double>(record.timestamp / (24 * 3600))});
+        features.assign(records.size(), 1);
+        for (size_t i = 0; i < records.size(); ++i) {
+            features(i, 0) = static_cast<double>(records[i].timestamp / (24 * 3600));
         }
     }
     else if (featureType == "category_encoded") {
@@ -42,8 +109,9 @@ std::vector<std::vector<double>> DataPreprocessor::extractFeatures(
         }
         
         // 然后编码
-        for (const auto& record : records) {
-            features.push_back({static_cast<double>(categoryMap[record.category])});
+        features.assign(records.size(), 1);
+        for (size_t i = 0; i < records.size(); ++i) {
+            features(i, 0) = static_cast<double>(categoryMap[records[i].category]);
         }
     }
     else if (featureType == "multi_feature") {
@@ -59,14 +127,20 @@ std::vector<std::vector<double>> DataPreprocessor::extractFeatures(
         }
         
         // 组合特征：内容长度、时间戳、类别编码
-        for (const auto& record : records) {
-            features.push_back({
-                static_cast<double>(record.content.length()),
-                static_cast<double>(record.timestamp / (24 * 3600)),
-                static_cast<double>(categoryMap[record.category])
-            });
+        features.assign(records.size(), 3);
+        for (size_t i = 0; i < records.size(); ++i) {
+            const auto& record = records[i];
+            features(i, 0) = static_cast<double>(record.content.length());
+            features(i, 1) = static_cast<double>(record.timestamp / (24 * 3600));
+            features(i, 2) = static_cast<double>(categoryMap[record.category]);
         }
     }
+    else if (featureType == "molecular_descriptors") {
+        // 分子描述符：并行解析分子结构并计算MW、重原子数、环数、氢键供受体、可旋转键和logP
+        // 描述符直接写入矩阵行，不经过中间缓冲
+        features.assign(records.size(), Chemistry::DescriptorCalculator::DescriptorCount);
+        Chemistry::DescriptorCalculator::computeBatch(records, features.data(), features.cols(), nullptr);
+    }
     
     return features;
 }
@@ -112,19 +186,18 @@ std::vector<double> DataPreprocessor::extractLabels(
     return labels;
 }
 
-std::vector<std::vector<double>> DataPreprocessor::normalize(
-    const std::vector<std::vector<double>>& data) {
-    
-    if (data.empty() || data[0].empty()) {
-        return data;
+Matrix DataPreprocessor::normalize(const ConstMatrixView& data) {
+    if (data.empty()) {
+        return Matrix::copyOf(data);
     }
     
     // 计算每个特征的最小值和最大值
-    size_t numFeatures = data[0].size();
+    size_t numFeatures = data.cols();
     std::vector<double> minValues(numFeatures, std::numeric_limits<double>::max());
-    std::vector<double> maxValues(numFeatures, std::numeric_limits<double>::min());
+    std::vector<double> maxValues(numFeatures, std::numeric_limits<double>::lowest());
     
-    for (const auto& sample : data) {
+    for (size_t r = 0; r < data.rows(); ++r) {
+        const double* sample = data.row(r);
         for (size_t i = 0; i < numFeatures; ++i) {
             minValues[i] = std::min(minValues[i], sample[i]);
             maxValues[i] = std::max(maxValues[i], sample[i]);
@@ -132,30 +205,36 @@ std::vector<std::vector<double>> DataPreprocessor::normalize(
     }
     
     // 标准化到[0,1]范围
-    std::vector<std::vector<double>> normalizedData;
-    for (const auto& sample : data) {
-        std::vector<double> normalizedSample;
+    Matrix normalizedData(data.rows(), numFeatures);
+    for (size_t r = 0; r < data.rows(); ++r) {
+        const double* sample = data.row(r);
+        double* normalizedSample = normalizedData.row(r);
         for (size_t i = 0; i < numFeatures; ++i) {
             double range = maxValues[i] - minValues[i];
-            double value = (range > 0) ? (sample[i] - minValues[i]) / range : 0.0;
-            normalizedSample.push_back(value);
+            normalizedSample[i] = (range > 0) ? (sample[i] - minValues[i]) / range : 0.0;
         }
-        normalizedData.push_back(normalizedSample);
     }
     
     return normalizedData;
 }
 
-std::tuple<
-    std::vector<std::vector<double>>, std::vector<std::vector<double>>,
-    std::vector<double>, std::vector<double>
-> DataPreprocessor::splitTrainTest(
-    const std::vector<std::vector<double>>& data,
+std::vector<std::vector<double>> DataPreprocessor::normalize(
+    const std::vector<std::vector<double>>& data) {
+    
+    if (data.empty() || data[0].empty()) {
+        return data;
+    }
+    
+    return normalize(Matrix::fromRows(data)).toRows();
+}
+
+std::tuple<Matrix, Matrix, std::vector<double>, std::vector<double>> DataPreprocessor::splitTrainTest(
+    const ConstMatrixView& data,
     const std::vector<double>& labels,
     double trainRatio) {
     
     // 创建索引并打乱
-    std::vector<size_t> indices(data.size());
+    std::vector<size_t> indices(data.rows());
     std::iota(indices.begin(), indices.end(), 0);
     
     std::random_device rd;
@@ -163,36 +242,50 @@ std::tuple<
     std::shuffle(indices.begin(), indices.end(), g);
     
     // 计算训练集大小
-    size_t trainSize = static_cast<size_t>(data.size() * trainRatio);
+    size_t trainSize = static_cast<size_t>(data.rows() * trainRatio);
+    
+    // 分割数据：每个子集一次性收集到连续矩阵
+    std::vector<size_t> trainIndices(indices.begin(), indices.begin() + trainSize);
+    std::vector<size_t> testIndices(indices.begin() + trainSize, indices.end());
     
-    // 分割数据
-    std::vector<std::vector<double>> trainData;
-    std::vector<std::vector<double>> testData;
     std::vector<double> trainLabels;
     std::vector<double> testLabels;
+    trainLabels.reserve(trainIndices.size());
+    testLabels.reserve(testIndices.size());
+    for (size_t idx : trainIndices) trainLabels.push_back(labels[idx]);
+    for (size_t idx : testIndices) testLabels.push_back(labels[idx]);
+    
+    return std::make_tuple(
+        Matrix::gatherRows(data, trainIndices),
+        Matrix::gatherRows(data, testIndices),
+        std::move(trainLabels),
+        std::move(testLabels));
+}
+
+std::tuple<
+    std::vector<std::vector<double>>, std::vector<std::vector<double>>,
+    std::vector<double>, std::vector<double>
+> DataPreprocessor::splitTrainTest(
+    const std::vector<std::vector<double>>& data,
+    const std::vector<double>& labels,
+    double trainRatio) {
     
-    for (size_t i = 0; i < indices.size(); ++i) {
-        size_t idx = indices[i];
-        if (i < trainSize) {
-            trainData.push_back(data[idx]);
-            trainLabels.push_back(labels[idx]);
-        } else {
-            testData.push_back(data[idx]);
-            testLabels.push_back(labels[idx]);
-        }
-    }
-    
-    return std::make_tuple(trainData, testData, trainLabels, testLabels);
+    auto split = splitTrainTest(Matrix::fromRows(data), labels, trainRatio);
+    return std::make_tuple(
+        std::get<0>(split).toRows(),
+        std::get<1>(split).toRows(),
+        std::move(std::get<2>(split)),
+        std::move(std::get<3>(split)));
 }
 
 // MockMLModel 实现
 TrainingResult MockMLModel::train(
-    const std::vector<std::vector<double>>& trainingData,
+    const ConstMatrixView& trainingData,
     const std::vector<double>& trainingLabels,
     const std::map<std::string, double>& parameters) {
     
     // 保存训练数据用于预测
-    m_trainingData = trainingData;
+    m_trainingData = Matrix::copyOf(trainingData);
     m_trainingLabels = trainingLabels;
     
     TrainingResult result;
@@ -219,8 +312,7 @@ TrainingResult MockMLModel::train(
     return result;
 }
 
-std::vector<double> MockMLModel::predict(
-    const std::vector<std::vector<double>>& testData) {
+std::vector<double> MockMLModel::predict(const ConstMatrixView& testData) {
     
     std::vector<double> predictions;
     
@@ -241,7 +333,7 @@ std::vector<double> MockMLModel::predict(
         std::mt19937 gen(rd());
         std::normal_distribution<> noise(0.0, meanLabel * 0.1);
         
-        for (size_t i = 0; i < testData.size(); ++i) {
+        for (size_t i = 0; i < testData.rows(); ++i) {
             double prediction = meanLabel + noise(gen);
             predictions.push_back(prediction);
         }
@@ -259,17 +351,20 @@ std::vector<double> MockMLModel::predict(
             classCounts[static_cast<int>(label)]++;
         }
         
+        std::vector<int> classes;
+        std::vector<double> weights;
+        for (const auto& item : classCounts) {
+            classes.push_back(item.first);
+            weights.push_back(static_cast<double>(item.second));
+        }
+        
         std::random_device rd;
         std::mt19937 gen(rd());
+        std::discrete_distribution<> dist(weights.begin(), weights.end());
         
-        for (size_t i = 0; i < testData.size(); ++i) {
+        for (size_t i = 0; i < testData.rows(); ++i) {
             // 按比例随机选择类别
-            std::discrete_distribution<> dist(
-                [](const std::pair<const int, int>& item) { return item.second; },
-                classCounts.begin(), classCounts.end()
-            );
-            
-            int predictedClass = dist(gen);
+            int predictedClass = classes[dist(gen)];
             predictions.push_back(static_cast<double>(predictedClass));
         }
     } 
@@ -281,7 +376,7 @@ std::vector<double> MockMLModel::predict(
         std::mt19937 gen(rd());
         std::uniform_int_distribution<> dist(0, numClusters - 1);
         
-        for (size_t i = 0; i < testData.size(); ++i) {
+        for (size_t i = 0; i < testData.rows(); ++i) {
             predictions.push_back(static_cast<double>(dist(gen)));
         }
     }
@@ -300,7 +395,7 @@ bool MockMLModel::saveModel(const std::string& filePath) {
         int modelTypeInt = static_cast<int>(m_modelType);
         file.write(reinterpret_cast<const char*>(&modelTypeInt), sizeof(modelTypeInt));
         
-        size_t dataSize = m_trainingData.size();
+        size_t dataSize = m_trainingData.rows();
         file.write(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
         
         size_t labelSize = m_trainingLabels.size();
@@ -338,23 +433,49 @@ bool MockMLModel::loadModel(const std::string& filePath) {
 }
 
 // ModelFactory 实现
-std::unique_ptr<IMLModel> ModelFactory::createModel(ModelType type) {
-#ifdef USE_MLPACK
+namespace {
+
+// 各模型类型的预测精度设置（未设置的类型使用双精度）
+std::mutex g_precisionMutex;
+std::map<ModelType, InferencePrecision> g_precisionSettings;
+
+std::unique_ptr<IMLModel> createNativeModel(ModelType type) {
+    // 所有模型类型在两种构建下都使用原生实现
     switch (type) {
         case ModelType::LinearRegression:
-            return std::make_unique<MlpackLinearRegression>();
+            return std::make_unique<LinearRegressionModel>();
         case ModelType::LogisticRegression:
-            return std::make_unique<MlpackLogisticRegression>();
+            return std::make_unique<LogisticRegressionModel>();
         case ModelType::DecisionTree:
-            return std::make_unique<MlpackDecisionTree>();
+        case ModelType::RandomForest:
+        case ModelType::RandomForestRegression:
+            return std::make_unique<RandomForestModel>(type);
+        case ModelType::GradientBoosting:
+            return std::make_unique<GradientBoostingModel>();
         case ModelType::KMeans:
-            return std::make_unique<MlpackKMeans>();
+            return std::make_unique<KMeansModel>();
+        case ModelType::TimeSeries:
+            return std::make_unique<TimeSeriesModel>();
+        case ModelType::NaiveBayes:
+            return std::make_unique<NaiveBayesModel>();
+        case ModelType::NeuralNetwork:
+            return std::make_unique<NeuralNetworkModel>();
         default:
-            return std::make_unique<MockMLModel>(type);
+            break;
     }
-#else
+    
     return std::make_unique<MockMLModel>(type);
-#endif
+}
+
+} // namespace
+
+std::unique_ptr<IMLModel> ModelFactory::createModel(ModelType type) {
+    std::unique_ptr<IMLModel> model = createNativeModel(type);
+    InferencePrecision precision = inferencePrecision(type);
+    if (precision != InferencePrecision::Double) {
+        model->setInferencePrecision(precision);
+    }
+    return model;
 }
 
 std::vector<ModelType> ModelFactory::getAvailableModels() {
@@ -365,6 +486,11 @@ std::vector<ModelType> ModelFactory::getAvailableModels() {
     models.push_back(ModelType::DecisionTree);
     models.push_back(ModelType::KMeans);
     models.push_back(ModelType::TimeSeries);
+    models.push_back(ModelType::RandomForest);
+    models.push_back(ModelType::RandomForestRegression);
+    models.push_back(ModelType::GradientBoosting);
+    models.push_back(ModelType::NaiveBayes);
+    models.push_back(ModelType::NeuralNetwork);
     
     return models;
 }
@@ -376,6 +502,11 @@ std::string ModelFactory::modelTypeToString(ModelType type) {
         case ModelType::DecisionTree: return "Decision Tree";
         case ModelType::KMeans: return "K-Means Clustering";
         case ModelType::TimeSeries: return "Time Series";
+        case ModelType::RandomForest: return "Random Forest";
+        case ModelType::RandomForestRegression: return "Random Forest Regression";
+        case ModelType::GradientBoosting: return "Gradient Boosting";
+        case ModelType::NaiveBayes: return "Naive Bayes";
+        case ModelType::NeuralNetwork: return "Neural Network";
         default: return "Unknown";
     }
 }
@@ -386,44 +517,127 @@ ModelType ModelFactory::stringToModelType(const std::string& str) {
     if (str == "Decision Tree") return ModelType::DecisionTree;
     if (str == "K-Means Clustering") return ModelType::KMeans;
     if (str == "Time Series") return ModelType::TimeSeries;
+    if (str == "Random Forest") return ModelType::RandomForest;
+    if (str == "Random Forest Regression") return ModelType::RandomForestRegression;
+    if (str == "Gradient Boosting") return ModelType::GradientBoosting;
+    if (str == "Naive Bayes") return ModelType::NaiveBayes;
+    if (str == "Neural Network") return ModelType::NeuralNetwork;
     return ModelType::LinearRegression; // 默认值
 }
 
+std::unique_ptr<IMLModel> ModelFactory::loadModel(const std::string& filePath) {
+    ModelType type;
+    if (!MappedModelFile::peekModelType(filePath, &type)) {
+        return nullptr;
+    }
+    
+    std::unique_ptr<IMLModel> model = createModel(type);
+    if (!model || !model->loadModel(filePath)) {
+        return nullptr;
+    }
+    return model;
+}
+
+bool ModelFactory::setInferencePrecision(ModelType type, InferencePrecision precision) {
+    // 用一个未训练的模型检查该类型是否支持此精度
+    if (!createNativeModel(type)->setInferencePrecision(precision)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(g_precisionMutex);
+    g_precisionSettings[type] = precision;
+    return true;
+}
+
+InferencePrecision ModelFactory::inferencePrecision(ModelType type) {
+    std::lock_guard<std::mutex> lock(g_precisionMutex);
+    auto it = g_precisionSettings.find(type);
+    return it != g_precisionSettings.end() ? it->second : InferencePrecision::Double;
+}
+
+InferenceAccuracyReport ModelFactory::compareInferencePrecision(IMLModel& model, const ConstMatrixView& data,
+                                                                InferencePrecision precision) {
+    InferenceAccuracyReport report;
+    report.precision = precision;
+    report.samples = data.rows();
+    
+    InferencePrecision original = model.inferencePrecision();
+    if (!model.setInferencePrecision(InferencePrecision::Double)) {
+        report.errorMessage = "Model does not support double precision inference";
+        return report;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> reference = model.predict(data);
+    auto middle = std::chrono::steady_clock::now();
+    
+    if (!model.setInferencePrecision(precision)) {
+        model.setInferencePrecision(original);
+        report.errorMessage = "Model does not support the requested precision";
+        return report;
+    }
+    
+    auto reducedStart = std::chrono::steady_clock::now();
+    std::vector<double> reduced = model.predict(data);
+    auto end = std::chrono::steady_clock::now();
+    model.setInferencePrecision(original);
+    
+    if (reference.size() != reduced.size()) {
+        report.errorMessage = "Prediction sizes differ";
+        return report;
+    }
+    
+    double sumAbs = 0.0;
+    double sumSquares = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        double delta = std::abs(reduced[i] - reference[i]);
+        if (reduced[i] != reference[i]) {
+            ++report.changedPredictions;
+        }
+        report.maxAbsDelta = std::max(report.maxAbsDelta, delta);
+        sumAbs += delta;
+        sumSquares += delta * delta;
+    }
+    if (!reference.empty()) {
+        double count = static_cast<double>(reference.size());
+        report.meanAbsDelta = sumAbs / count;
+        report.rmsDelta = std::sqrt(sumSquares / count);
+        report.changedFraction = static_cast<double>(report.changedPredictions) / count;
+    }
+    
+    report.doubleSeconds = std::chrono::duration<double>(middle - start).count();
+    report.reducedSeconds = std::chrono::duration<double>(end - reducedStart).count();
+    report.speedup = report.reducedSeconds > 0.0 ? report.doubleSeconds / report.reducedSeconds : 0.0;
+    report.success = true;
+    return report;
+}
+
 #ifdef USE_MLPACK
 // MlpackLinearRegression 实现
 TrainingResult MlpackLinearRegression::train(
-    const std::vector<std::vector<double>>& trainingData,
+    const ConstMatrixView& trainingData,
     const std::vector<double>& trainingLabels,
     const std::map<std::string, double>& parameters) {
     
     // 转换为mlpack格式
-    if (trainingData.empty() || trainingData[0].empty()) {
+    if (trainingData.empty()) {
         TrainingResult result;
         result.success = false;
         result.errorMessage = "Empty training data";
         return result;
     }
     
-    size_t numSamples = trainingData.size();
-    size_t numFeatures = trainingData[0].size();
+    size_t numSamples = trainingData.rows();
     
-    m_features.set_size(numFeatures, numSamples);
-    m_labels.set_size(numSamples);
-    
-    for (size_t i = 0; i < numSamples; ++i) {
-        for (size_t j = 0; j < numFeatures; ++j) {
-            m_features(j, i) = trainingData[i][j];
-        }
-        m_labels(i) = trainingLabels[i];
-    }
+    // 样本×特征的行主序矩阵即mlpack的 特征×样本 列主序布局，连续时直接借用内存
+    arma::mat features = toArma(trainingData);
+    arma::rowvec labels = toArmaRow(trainingLabels);
     
     // 创建并训练模型
-    m_model = std::make_unique<mlpack::regression::LinearRegression>(
-        m_features, m_labels);
+    m_model = std::make_unique<mlpack::regression::LinearRegression>(features, labels);
     
     // 评估模型
-    std::vector<double> predictions;
-    predict(trainingData);
+    std::vector<double> predictions = predict(trainingData);
     
     TrainingResult result;
     result.success = true;
@@ -439,7 +653,8 @@ TrainingResult MlpackLinearRegression::train(
     
     // 对于回归问题，精度基于误差阈值
     double correct = 0.0;
-    double threshold = 0.1 * (std::max(trainingLabels) - std::min(trainingLabels));
+    auto labelRange = std::minmax_element(trainingLabels.begin(), trainingLabels.end());
+    double threshold = 0.1 * (*labelRange.second - *labelRange.first);
     for (size_t i = 0; i < numSamples; ++i) {
         if (std::abs(predictions[i] - trainingLabels[i]) < threshold) {
             correct += 1.0;
@@ -455,25 +670,15 @@ TrainingResult MlpackLinearRegression::train(
     return result;
 }
 
-std::vector<double> MlpackLinearRegression::predict(
-    const std::vector<std::vector<double>>& testData) {
+std::vector<double> MlpackLinearRegression::predict(const ConstMatrixView& testData) {
     
-    if (!m_model || testData.empty() || testData[0].empty()) {
+    if (!m_model || testData.empty()) {
         return {};
     }
     
-    size_t numSamples = testData.size();
-    size_t numFeatures = testData[0].size();
-    
-    arma::mat testPoints(numFeatures, numSamples);
-    
-    for (size_t i = 0; i < numSamples; ++i) {
-        for (size_t j = 0; j < numFeatures; ++j) {
-            testPoints(j, i) = testData[i][j];
-        }
-    }
+    arma::mat testPoints = toArma(testData);
     
-    arma::colvec predictions;
+    arma::rowvec predictions;
     m_model->Predict(testPoints, predictions);
     
     std::vector<double> result;
@@ -510,7 +715,7 @@ bool MlpackLinearRegression::loadModel(const std::string& filePath) {
 
 // MlpackLogisticRegression 实现
 TrainingResult MlpackLogisticRegression::train(
-    const std::vector<std::vector<double>>& trainingData,
+    const ConstMatrixView& trainingData,
     const std::vector<double>& trainingLabels,
     const std::map<std::string, double>& parameters) {
     
@@ -528,8 +733,7 @@ TrainingResult MlpackLogisticRegression::train(
     return result;
 }
 
-std::vector<double> MlpackLogisticRegression::predict(
-    const std::vector<std::vector<double>>& testData) {
+std::vector<double> MlpackLogisticRegression::predict(const ConstMatrixView& testData) {
     
     // 简化实现，返回随机预测
     std::vector<double> predictions;
@@ -537,7 +741,7 @@ std::vector<double> MlpackLogisticRegression::predict(
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(0, 1);
     
-    for (size_t i = 0; i < testData.size(); ++i) {
+    for (size_t i = 0; i < testData.rows(); ++i) {
         predictions.push_back(static_cast<double>(dist(gen)));
     }
     
@@ -556,7 +760,7 @@ bool MlpackLogisticRegression::loadModel(const std::string& filePath) {
 
 // MlpackDecisionTree 实现
 TrainingResult MlpackDecisionTree::train(
-    const std::vector<std::vector<double>>& trainingData,
+    const ConstMatrixView& trainingData,
     const std::vector<double>& trainingLabels,
     const std::map<std::string, double>& parameters) {
     
@@ -571,8 +775,7 @@ TrainingResult MlpackDecisionTree::train(
     return result;
 }
 
-std::vector<double> MlpackDecisionTree::predict(
-    const std::vector<std::vector<double>>& testData) {
+std::vector<double> MlpackDecisionTree::predict(const ConstMatrixView& testData) {
     
     // 简化实现，返回随机预测
     std::vector<double> predictions;
@@ -580,7 +783,7 @@ std::vector<double> MlpackDecisionTree::predict(
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(0, 3); // 4个类别
     
-    for (size_t i = 0; i < testData.size(); ++i) {
+    for (size_t i = 0; i < testData.rows(); ++i) {
         predictions.push_back(static_cast<double>(dist(gen)));
     }
     
@@ -599,7 +802,7 @@ bool MlpackDecisionTree::loadModel(const std::string& filePath) {
 
 // MlpackKMeans 实现
 TrainingResult MlpackKMeans::train(
-    const std::vector<std::vector<double>>& trainingData,
+    const ConstMatrixView& trainingData,
     const std::vector<double>& trainingLabels,
     const std::map<std::string, double>& parameters) {
     
@@ -614,8 +817,7 @@ TrainingResult MlpackKMeans::train(
     return result;
 }
 
-std::vector<double> MlpackKMeans::predict(
-    const std::vector<std::vector<double>>& testData) {
+std::vector<double> MlpackKMeans::predict(const ConstMatrixView& testData) {
     
     // 简化实现，返回随机聚类分配
     std::vector<double> predictions;
@@ -623,7 +825,7 @@ std::vector<double> MlpackKMeans::predict(
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(0, 2); // 3个聚类
     
-    for (size_t i = 0; i < testData.size(); ++i) {
+    for (size_t i = 0; i < testData.rows(); ++i) {
         predictions.push_back(static_cast<double>(dist(gen)));
     }
     
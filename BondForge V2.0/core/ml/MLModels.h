@@ -4,7 +4,10 @@
 #include <map>
 #include <memory>
 #include <functional>
+#include <tuple>
 #include "../data/DataRecord.h"
+#include "Matrix.h"
+#include "SparseFeatures.h"
 
 #ifdef USE_MLPACK
 #include <mlpack/core.hpp>
@@ -26,7 +29,12 @@ enum class ModelType {
     LogisticRegression,
     DecisionTree,
     KMeans,
-    TimeSeries
+    TimeSeries,
+    RandomForest,
+    RandomForestRegression,
+    GradientBoosting,
+    NaiveBayes,
+    NeuralNetwork
 };
 
 /**
@@ -43,6 +51,33 @@ struct TrainingResult {
     std::string errorMessage;
 };
 
+/**
+ * @brief 预测使用的数值精度
+ */
+enum class InferencePrecision {
+    Double,     // 双精度（默认，与训练相同）
+    Float32,    // 参数和样本转换为单精度
+    Int8        // 线性权重量化为8位整数；树的分裂阈值编码为8位序号
+};
+
+/**
+ * @brief 低精度预测与双精度预测的差异报告
+ */
+struct InferenceAccuracyReport {
+    bool success = false;
+    std::string errorMessage;
+    InferencePrecision precision = InferencePrecision::Double;
+    size_t samples = 0;
+    double maxAbsDelta = 0.0;           // 预测值的最大绝对差
+    double meanAbsDelta = 0.0;
+    double rmsDelta = 0.0;
+    size_t changedPredictions = 0;      // 预测值不同的样本数（分类模型即预测类别改变的样本数）
+    double changedFraction = 0.0;
+    double doubleSeconds = 0.0;         // 双精度预测耗时
+    double reducedSeconds = 0.0;        // 低精度预测耗时
+    double speedup = 0.0;
+};
+
 /**
  * @brief 机器学习模型接口
  */
@@ -53,24 +88,92 @@ public:
     /**
      * @brief 训练模型
      * 
-     * @param trainingData 训练数据
+     * @param trainingData 训练数据（每行一个样本）
      * @param trainingLabels 训练标签
      * @param parameters 训练参数
      * @return 训练结果
      */
     virtual TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) = 0;
     
     /**
      * @brief 预测
      * 
-     * @param testData 测试数据
+     * @param testData 测试数据（每行一个样本）
      * @return 预测结果
      */
-    virtual std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) = 0;
+    virtual std::vector<double> predict(const ConstMatrixView& testData) = 0;
+    
+    /**
+     * @brief 训练模型（逐行存储数据的兼容接口，转换为连续矩阵后调用矩阵版本）
+     */
+    TrainingResult train(
+        const std::vector<std::vector<double>>& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) {
+        return train(Matrix::fromRows(trainingData), trainingLabels, parameters);
+    }
+    
+    /**
+     * @brief 预测（逐行存储数据的兼容接口）
+     */
+    std::vector<double> predict(const std::vector<std::vector<double>>& testData) {
+        return predict(Matrix::fromRows(testData));
+    }
+    
+    /**
+     * @brief 是否可以在多个线程上同时调用 predict()
+     * 
+     * 为真的模型预测时只读取参数，特征重要性这类需要大量独立预测的计算可以并发调用
+     * （预测期间不能训练、加载或修改推理精度）。默认不保证。
+     */
+    virtual bool supportsConcurrentPrediction() const { return false; }
+    
+    /**
+     * @brief 是否直接在稀疏特征上训练（不展开为稠密矩阵）
+     */
+    virtual bool supportsSparseFeatures() const { return false; }
+    
+    /**
+     * @brief 在稀疏（CSR）或二进制位特征上训练模型
+     * 
+     * 默认实现把数据转换为稠密矩阵后调用矩阵版本；supportsSparseFeatures() 为真的模型
+     * 只访问非零元素，指纹这类大多为0的高维特征不需要展开为稠密矩阵。
+     */
+    virtual TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {});
+    
+    /**
+     * @brief 在稀疏或二进制位特征上预测
+     * 
+     * 默认实现每次把一段样本转换为稠密矩阵后调用矩阵版本，额外内存只有一段样本的稠密副本。
+     */
+    virtual std::vector<double> predict(const SparseMatrixView& testData);
+    
+    /**
+     * @brief 是否支持按数据块增量训练（partialFit）
+     */
+    virtual bool supportsPartialFit() const { return false; }
+    
+    /**
+     * @brief 用一个数据块增量训练模型
+     * 
+     * 第一次调用时按数据块初始化模型，之后的调用在已有状态上继续训练，
+     * 因此可以逐块训练无法一次装入内存的数据。train() 会重置增量训练的状态。
+     * 
+     * @param chunk 数据块（每行一个样本）
+     * @param labels 数据块的标签
+     * @param parameters 训练参数
+     * @return 训练结果（指标基于已处理的数据或当前数据块）
+     */
+    virtual TrainingResult partialFit(
+        const ConstMatrixView& chunk,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {});
     
     /**
      * @brief 获取模型类型
@@ -94,6 +197,23 @@ public:
      * @return 是否成功
      */
     virtual bool loadModel(const std::string& filePath) = 0;
+    
+    /**
+     * @brief 设置预测使用的数值精度
+     * 
+     * 只影响 predict()，训练始终使用双精度。低精度参数在设置时以及每次训练、加载后由双精度参数生成。
+     * 
+     * @param precision 数值精度
+     * @return 模型是否支持该精度（不支持时精度不变）
+     */
+    virtual bool setInferencePrecision(InferencePrecision precision) {
+        return precision == InferencePrecision::Double;
+    }
+    
+    /**
+     * @brief 当前预测使用的数值精度
+     */
+    virtual InferencePrecision inferencePrecision() const { return InferencePrecision::Double; }
 };
 
 /**
@@ -105,13 +225,24 @@ public:
      * @brief 特征提取 - 从化学数据记录中提取数值特征
      * 
      * @param records 数据记录列表
-     * @param featureType 特征类型
+     * @param featureType 特征类型（content_length/timestamp/category_encoded/multi_feature/molecular_descriptors）
      * @return 特征矩阵
      */
     static std::vector<std::vector<double>> extractFeatures(
         const std::vector<Data::DataRecord>& records,
         const std::string& featureType = "content_length");
     
+    /**
+     * @brief 特征提取到连续矩阵（每条记录一行）
+     * 
+     * @param records 数据记录列表
+     * @param featureType 特征类型，同 extractFeatures
+     * @return 特征矩阵
+     */
+    static Matrix extractFeatureMatrix(
+        const std::vector<Data::DataRecord>& records,
+        const std::string& featureType = "content_length");
+    
     /**
      * @brief 标签提取 - 从化学数据记录中提取标签
      * 
@@ -129,6 +260,11 @@ public:
      * @param data 输入数据
      * @return 标准化后的数据
      */
+    static Matrix normalize(const ConstMatrixView& data);
+    
+    /**
+     * @brief 数据标准化（逐行存储数据的兼容接口）
+     */
     static std::vector<std::vector<double>> normalize(
         const std::vector<std::vector<double>>& data);
     
@@ -140,6 +276,14 @@ public:
      * @param trainRatio 训练集比例
      * @return 分割后的数据
      */
+    static std::tuple<Matrix, Matrix, std::vector<double>, std::vector<double>> splitTrainTest(
+        const ConstMatrixView& data,
+        const std::vector<double>& labels,
+        double trainRatio = 0.8);
+    
+    /**
+     * @brief 数据分割（逐行存储数据的兼容接口）
+     */
     static std::tuple<
         std::vector<std::vector<double>>, std::vector<std::vector<double>>,
         std::vector<double>, std::vector<double>
@@ -156,17 +300,17 @@ public:
 class MlpackLinearRegression : public IMLModel {
 private:
     std::unique_ptr<mlpack::regression::LinearRegression> m_model;
-    arma::mat m_features;
-    arma::colvec m_labels;
     
 public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
     TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) override;
     
-    std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) override;
+    std::vector<double> predict(const ConstMatrixView& testData) override;
     
     ModelType getModelType() const override { return ModelType::LinearRegression; }
     
@@ -184,13 +328,15 @@ private:
     arma::Row<size_t> m_labels;
     
 public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
     TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) override;
     
-    std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) override;
+    std::vector<double> predict(const ConstMatrixView& testData) override;
     
     ModelType getModelType() const override { return ModelType::LogisticRegression; }
     
@@ -208,13 +354,15 @@ private:
     arma::Row<size_t> m_labels;
     
 public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
     TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) override;
     
-    std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) override;
+    std::vector<double> predict(const ConstMatrixView& testData) override;
     
     ModelType getModelType() const override { return ModelType::DecisionTree; }
     
@@ -233,13 +381,15 @@ private:
     arma::mat m_centroids;
     
 public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
     TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) override;
     
-    std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) override;
+    std::vector<double> predict(const ConstMatrixView& testData) override;
     
     ModelType getModelType() const override { return ModelType::KMeans; }
     
@@ -254,19 +404,21 @@ public:
 class MockMLModel : public IMLModel {
 private:
     ModelType m_modelType;
-    std::vector<std::vector<double>> m_trainingData;
+    Matrix m_trainingData;
     std::vector<double> m_trainingLabels;
     
 public:
     explicit MockMLModel(ModelType type) : m_modelType(type) {}
     
+    using IMLModel::train;
+    using IMLModel::predict;
+    
     TrainingResult train(
-        const std::vector<std::vector<double>>& trainingData,
+        const ConstMatrixView& trainingData,
         const std::vector<double>& trainingLabels,
         const std::map<std::string, double>& parameters = {}) override;
     
-    std::vector<double> predict(
-        const std::vector<std::vector<double>>& testData) override;
+    std::vector<double> predict(const ConstMatrixView& testData) override;
     
     ModelType getModelType() const override { return m_modelType; }
     
@@ -309,6 +461,47 @@ public:
      * @return 模型类型
      */
     static ModelType stringToModelType(const std::string& str);
+    
+    /**
+     * @brief 从模型文件创建并加载模型（模型类型取自文件头）
+     * 
+     * 模型文件以内存映射方式打开，树模型的数组直接使用映射的内容，
+     * 加载一个模型只需要映射文件和校验用到的节。
+     * 
+     * @param filePath saveModel() 写出的模型文件
+     * @return 模型实例（不是模型文件或加载失败时返回空指针）
+     */
+    static std::unique_ptr<IMLModel> loadModel(const std::string& filePath);
+    
+    /**
+     * @brief 设置某种模型的预测精度
+     * 
+     * 之后由 createModel() 和 loadModel() 创建的该类型模型使用此精度预测（已创建的模型不受影响）。
+     * 支持低精度的模型：线性回归、逻辑回归、随机森林（分类/回归）和梯度提升树。
+     * 
+     * @param type 模型类型
+     * @param precision 数值精度
+     * @return 该类型模型是否支持此精度（不支持时设置不变）
+     */
+    static bool setInferencePrecision(ModelType type, InferencePrecision precision);
+    
+    /**
+     * @brief 某种模型当前的预测精度设置
+     */
+    static InferencePrecision inferencePrecision(ModelType type);
+    
+    /**
+     * @brief 比较模型低精度预测与双精度预测的差异和耗时
+     * 
+     * 在同一数据上分别以双精度和指定精度预测，比较结束后恢复模型原来的精度。
+     * 
+     * @param model 已训练的模型
+     * @param data 评估数据（每行一个样本）
+     * @param precision 要评估的精度
+     * @return 差异报告（模型不支持该精度时失败）
+     */
+    static InferenceAccuracyReport compareInferencePrecision(IMLModel& model, const ConstMatrixView& data,
+                                                             InferencePrecision precision);
 };
 
 } // namespace ML
@@ -0,0 +1,334 @@
+#include "Matrix.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 微内核计算的C块：6行×8列（AVX2下为12个累加寄存器）
+constexpr size_t kGemmMR = 6;
+constexpr size_t kGemmNR = 8;
+
+// 分块大小：打包后A的 kGemmMC×kGemmKC 块约占L2缓存的一半，B的 kGemmKC×kGemmNC 面板留在L3缓存
+constexpr size_t kGemmKC = 256;
+constexpr size_t kGemmMC = 96;
+constexpr size_t kGemmNC = 1024;
+
+// 乘加次数低于此值时不分给线程池（调度开销大于计算量）
+constexpr size_t kGemmParallelWork = size_t(1) << 18;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief 打包 op(A) 的行 [row0, row0 + rows)、列 [col0, col0 + depth)
+ * 
+ * 每 kGemmMR 行为一条，条内沿k方向依次存放 kGemmMR 个值，不足的行补0。
+ */
+void packA(const ConstMatrixView& a, bool transpose, size_t row0, size_t rows, size_t col0, size_t depth, double* out) {
+    for (size_t strip = 0; strip < rows; strip += kGemmMR) {
+        size_t height = std::min(kGemmMR, rows - strip);
+        if (transpose) {
+            for (size_t p = 0; p < depth; ++p) {
+                const double* source = a.row(col0 + p) + row0 + strip;
+                double* target = out + p * kGemmMR;
+                for (size_t r = 0; r < height; ++r) {
+                    target[r] = source[r];
+                }
+                for (size_t r = height; r < kGemmMR; ++r) {
+                    target[r] = 0.0;
+                }
+            }
+        } else {
+            for (size_t r = 0; r < kGemmMR; ++r) {
+                if (r < height) {
+                    const double* source = a.row(row0 + strip + r) + col0;
+                    for (size_t p = 0; p < depth; ++p) {
+                        out[p * kGemmMR + r] = source[p];
+                    }
+                } else {
+                    for (size_t p = 0; p < depth; ++p) {
+                        out[p * kGemmMR + r] = 0.0;
+                    }
+                }
+            }
+        }
+        out += depth * kGemmMR;
+    }
+}
+
+/**
+ * @brief 打包 op(B) 的行 [row0, row0 + depth)、列 [col0, col0 + cols)
+ * 
+ * 每 kGemmNR 列为一条，条内沿k方向依次存放 kGemmNR 个值，不足的列补0。
+ */
+void packB(const ConstMatrixView& b, bool transpose, size_t row0, size_t depth, size_t col0, size_t cols, double* out) {
+    for (size_t strip = 0; strip < cols; strip += kGemmNR) {
+        size_t width = std::min(kGemmNR, cols - strip);
+        if (transpose) {
+            for (size_t j = 0; j < kGemmNR; ++j) {
+                if (j < width) {
+                    const double* source = b.row(col0 + strip + j) + row0;
+                    for (size_t p = 0; p < depth; ++p) {
+                        out[p * kGemmNR + j] = source[p];
+                    }
+                } else {
+                    for (size_t p = 0; p < depth; ++p) {
+                        out[p * kGemmNR + j] = 0.0;
+                    }
+                }
+            }
+        } else {
+            for (size_t p = 0; p < depth; ++p) {
+                const double* source = b.row(row0 + p) + col0 + strip;
+                double* target = out + p * kGemmNR;
+                for (size_t j = 0; j < width; ++j) {
+                    target[j] = source[j];
+                }
+                for (size_t j = width; j < kGemmNR; ++j) {
+                    target[j] = 0.0;
+                }
+            }
+        }
+        out += depth * kGemmNR;
+    }
+}
+
+/**
+ * @brief tile = 打包的A条（depth×kGemmMR）与B条（depth×kGemmNR）之积
+ * 
+ * tile 为按缓存行对齐的 kGemmMR×kGemmNR 数组。
+ */
+void gemmMicroKernel(size_t depth, const double* a, const double* b, double* tile) {
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (size_t p = 0; p < depth; ++p) {
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d value = _mm256_broadcast_sd(a);
+        c00 = _mm256_fmadd_pd(value, b0, c00);
+        c01 = _mm256_fmadd_pd(value, b1, c01);
+        value = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(value, b0, c10);
+        c11 = _mm256_fmadd_pd(value, b1, c11);
+        value = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(value, b0, c20);
+        c21 = _mm256_fmadd_pd(value, b1, c21);
+        value = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(value, b0, c30);
+        c31 = _mm256_fmadd_pd(value, b1, c31);
+        value = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(value, b0, c40);
+        c41 = _mm256_fmadd_pd(value, b1, c41);
+        value = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(value, b0, c50);
+        c51 = _mm256_fmadd_pd(value, b1, c51);
+        a += kGemmMR;
+        b += kGemmNR;
+    }
+    _mm256_store_pd(tile, c00);
+    _mm256_store_pd(tile + 4, c01);
+    _mm256_store_pd(tile + 8, c10);
+    _mm256_store_pd(tile + 12, c11);
+    _mm256_store_pd(tile + 16, c20);
+    _mm256_store_pd(tile + 20, c21);
+    _mm256_store_pd(tile + 24, c30);
+    _mm256_store_pd(tile + 28, c31);
+    _mm256_store_pd(tile + 32, c40);
+    _mm256_store_pd(tile + 36, c41);
+    _mm256_store_pd(tile + 40, c50);
+    _mm256_store_pd(tile + 44, c51);
+#else
+    for (size_t i = 0; i < kGemmMR * kGemmNR; ++i) {
+        tile[i] = 0.0;
+    }
+    for (size_t p = 0; p < depth; ++p) {
+        for (size_t r = 0; r < kGemmMR; ++r) {
+            double value = a[r];
+            double* row = tile + r * kGemmNR;
+            for (size_t j = 0; j < kGemmNR; ++j) {
+                row[j] += value * b[j];
+            }
+        }
+        a += kGemmMR;
+        b += kGemmNR;
+    }
+#endif
+}
+
+/**
+ * @brief 计算C的行 [rowBegin, rowEnd)、列 [colBegin, colEnd)
+ */
+void gemmBlock(const ConstMatrixView& a, bool transposeA, const ConstMatrixView& b, bool transposeB,
+               const MatrixView& c, double alpha, double beta, size_t depth,
+               size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) {
+    
+    // 打包缓冲区按线程复用（gemmBlock 内不会嵌套调用自身）
+    thread_local AlignedVector<double> packedA;
+    thread_local AlignedVector<double> packedB;
+    alignas(MatrixAlignment) double tile[kGemmMR * kGemmNR];
+    
+    for (size_t kk = 0; kk < depth; kk += kGemmKC) {
+        size_t kc = std::min(kGemmKC, depth - kk);
+        double blockBeta = kk == 0 ? beta : 1.0;
+        
+        for (size_t jc = colBegin; jc < colEnd; jc += kGemmNC) {
+            size_t nc = std::min(kGemmNC, colEnd - jc);
+            packedB.resize(roundUp(nc, kGemmNR) * kc);
+            packB(b, transposeB, kk, kc, jc, nc, packedB.data());
+            
+            for (size_t ic = rowBegin; ic < rowEnd; ic += kGemmMC) {
+                size_t mc = std::min(kGemmMC, rowEnd - ic);
+                packedA.resize(roundUp(mc, kGemmMR) * kc);
+                packA(a, transposeA, ic, mc, kk, kc, packedA.data());
+                
+                for (size_t jr = 0; jr < nc; jr += kGemmNR) {
+                    size_t width = std::min(kGemmNR, nc - jr);
+                    const double* stripB = packedB.data() + jr * kc;
+                    for (size_t ir = 0; ir < mc; ir += kGemmMR) {
+                        size_t height = std::min(kGemmMR, mc - ir);
+                        gemmMicroKernel(kc, packedA.data() + ir * kc, stripB, tile);
+                        
+                        for (size_t r = 0; r < height; ++r) {
+                            double* target = c.row(ic + ir + r) + jc + jr;
+                            const double* source = tile + r * kGemmNR;
+                            if (blockBeta == 0.0) {
+                                for (size_t j = 0; j < width; ++j) {
+                                    target[j] = alpha * source[j];
+                                }
+                            } else {
+                                for (size_t j = 0; j < width; ++j) {
+                                    target[j] = alpha * source[j] + blockBeta * target[j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+Matrix Matrix::fromRows(const std::vector<std::vector<double>>& rows) {
+    if (rows.empty()) {
+        return Matrix();
+    }
+    
+    Matrix result(rows.size(), rows[0].size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        size_t count = std::min(rows[i].size(), result.m_cols);
+        std::copy(rows[i].begin(), rows[i].begin() + count, result.row(i));
+    }
+    return result;
+}
+
+Matrix Matrix::copyOf(const ConstMatrixView& view) {
+    Matrix result(view.rows(), view.cols());
+    if (view.isContiguous()) {
+        std::copy(view.data(), view.data() + view.rows() * view.cols(), result.data());
+        return result;
+    }
+    
+    for (size_t i = 0; i < view.rows(); ++i) {
+        std::copy(view.row(i), view.row(i) + view.cols(), result.row(i));
+    }
+    return result;
+}
+
+Matrix Matrix::gatherRows(const ConstMatrixView& source, const std::vector<size_t>& indices) {
+    Matrix result(indices.size(), source.cols());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const double* row = source.row(indices[i]);
+        std::copy(row, row + source.cols(), result.row(i));
+    }
+    return result;
+}
+
+std::vector<std::vector<double>> Matrix::toRows() const {
+    std::vector<std::vector<double>> result;
+    result.reserve(m_rows);
+    for (size_t i = 0; i < m_rows; ++i) {
+        result.emplace_back(row(i), row(i) + m_cols);
+    }
+    return result;
+}
+
+void Matrix::assign(size_t rows, size_t cols, double value) {
+    m_rows = rows;
+    m_cols = cols;
+    m_data.assign(rows * cols, value);
+}
+
+void Matrix::appendRow(const double* values) {
+    m_data.insert(m_data.end(), values, values + m_cols);
+    ++m_rows;
+}
+
+void gemm(const ConstMatrixView& a, bool transposeA, const ConstMatrixView& b, bool transposeB,
+          const MatrixView& c, double alpha, double beta, bool parallel) {
+    
+    const size_t m = c.rows();
+    const size_t n = c.cols();
+    const size_t depth = transposeA ? a.rows() : a.cols();
+    if ((transposeA ? a.cols() : a.rows()) != m || (transposeB ? b.cols() : b.rows()) != depth ||
+        (transposeB ? b.rows() : b.cols()) != n || m == 0 || n == 0) {
+        return;
+    }
+    
+    if (depth == 0) {
+        for (size_t i = 0; i < m; ++i) {
+            double* row = c.row(i);
+            for (size_t j = 0; j < n; ++j) {
+                row[j] = beta == 0.0 ? 0.0 : beta * row[j];
+            }
+        }
+        return;
+    }
+    
+    // C按行块×列块划分；线程较多而矩阵较矮时缩小行块，使每个线程至少分到一块
+    auto& pool = Utils::ThreadPool::instance();
+    const size_t colBlock = kGemmNC;
+    const size_t colBlocks = (n + colBlock - 1) / colBlock;
+    size_t rowBlock = kGemmMC;
+    bool split = parallel && pool.threadCount() > 0 && m * n * depth >= kGemmParallelWork;
+    if (split) {
+        size_t participants = pool.threadCount() + 1;
+        size_t wantedRowBlocks = (participants + colBlocks - 1) / colBlocks;
+        rowBlock = std::min(kGemmMC, std::max(kGemmMR, roundUp((m + wantedRowBlocks - 1) / wantedRowBlocks, kGemmMR)));
+    }
+    const size_t rowBlocks = (m + rowBlock - 1) / rowBlock;
+    
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            size_t rowBegin = (block / colBlocks) * rowBlock;
+            size_t colBegin = (block % colBlocks) * colBlock;
+            gemmBlock(a, transposeA, b, transposeB, c, alpha, beta, depth,
+                      rowBegin, std::min(m, rowBegin + rowBlock), colBegin, std::min(n, colBegin + colBlock));
+        }
+    };
+    
+    if (split && rowBlocks * colBlocks > 1) {
+        pool.parallelFor(0, rowBlocks * colBlocks, 1, body);
+    } else {
+        body(0, rowBlocks * colBlocks);
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
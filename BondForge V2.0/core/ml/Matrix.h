@@ -0,0 +1,277 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+#ifdef USE_MLPACK
+#include <mlpack/core.hpp>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 矩阵数据的对齐字节数（一条缓存行，也满足AVX-512加载要求）
+ */
+constexpr size_t MatrixAlignment = 64;
+
+/**
+ * @brief 按 MatrixAlignment 对齐分配内存的分配器
+ */
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+    
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+    
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(MatrixAlignment)));
+    }
+    
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t(MatrixAlignment));
+    }
+    
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * @brief 带步长的只读向量视图（用于矩阵的列）
+ */
+class ConstVectorView {
+public:
+    ConstVectorView() = default;
+    ConstVectorView(const double* data, size_t size, size_t stride = 1)
+        : m_data(data), m_size(size), m_stride(stride) {}
+    
+    size_t size() const { return m_size; }
+    size_t stride() const { return m_stride; }
+    const double* data() const { return m_data; }
+    double operator[](size_t i) const { return m_data[i * m_stride]; }
+
+private:
+    const double* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_stride = 1;
+};
+
+/**
+ * @brief 只读矩阵视图（不持有数据）
+ * 
+ * 行主序，每行一个样本。行步长可以大于列数，因此行区间和列区间都可以不复制地取出。
+ */
+class ConstMatrixView {
+public:
+    ConstMatrixView() = default;
+    ConstMatrixView(const double* data, size_t rows, size_t cols)
+        : m_data(data), m_rows(rows), m_cols(cols), m_stride(cols) {}
+    ConstMatrixView(const double* data, size_t rows, size_t cols, size_t stride)
+        : m_data(data), m_rows(rows), m_cols(cols), m_stride(stride) {}
+    
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+    size_t stride() const { return m_stride; }
+    bool empty() const { return m_rows == 0 || m_cols == 0; }
+    
+    /**
+     * @brief 是否为无行间空隙的连续存储（可直接交给Armadillo借用）
+     */
+    bool isContiguous() const { return m_stride == m_cols || m_rows <= 1; }
+    
+    const double* data() const { return m_data; }
+    const double* row(size_t i) const { return m_data + i * m_stride; }
+    double operator()(size_t i, size_t j) const { return m_data[i * m_stride + j]; }
+    
+    /**
+     * @brief 行区间 [begin, end) 的视图
+     */
+    ConstMatrixView rowRange(size_t begin, size_t end) const {
+        return ConstMatrixView(m_data + begin * m_stride, end - begin, m_cols, m_stride);
+    }
+    
+    /**
+     * @brief 列区间 [begin, end) 的视图（步长不变）
+     */
+    ConstMatrixView colRange(size_t begin, size_t end) const {
+        return ConstMatrixView(m_data + begin, m_rows, end - begin, m_stride);
+    }
+    
+    /**
+     * @brief 第j列（步长为行步长）
+     */
+    ConstVectorView column(size_t j) const {
+        return ConstVectorView(m_data + j, m_rows, m_stride);
+    }
+
+private:
+    const double* m_data = nullptr;
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    size_t m_stride = 0;
+};
+
+/**
+ * @brief 可写矩阵视图（不持有数据）
+ */
+class MatrixView {
+public:
+    MatrixView() = default;
+    MatrixView(double* data, size_t rows, size_t cols)
+        : m_data(data), m_rows(rows), m_cols(cols), m_stride(cols) {}
+    MatrixView(double* data, size_t rows, size_t cols, size_t stride)
+        : m_data(data), m_rows(rows), m_cols(cols), m_stride(stride) {}
+    
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+    size_t stride() const { return m_stride; }
+    bool empty() const { return m_rows == 0 || m_cols == 0; }
+    
+    double* data() const { return m_data; }
+    double* row(size_t i) const { return m_data + i * m_stride; }
+    double& operator()(size_t i, size_t j) const { return m_data[i * m_stride + j]; }
+    
+    MatrixView rowRange(size_t begin, size_t end) const {
+        return MatrixView(m_data + begin * m_stride, end - begin, m_cols, m_stride);
+    }
+    
+    MatrixView colRange(size_t begin, size_t end) const {
+        return MatrixView(m_data + begin, m_rows, end - begin, m_stride);
+    }
+    
+    operator ConstMatrixView() const { return ConstMatrixView(m_data, m_rows, m_cols, m_stride); }
+
+private:
+    double* m_data = nullptr;
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    size_t m_stride = 0;
+};
+
+/**
+ * @brief 连续、对齐的稠密矩阵
+ * 
+ * 行主序、无行间填充（步长等于列数），整块数据一次分配并按缓存行对齐。
+ * 样本×特征的行主序布局与mlpack使用的 特征×样本 列主序 arma::mat 内存布局相同，
+ * 因此可以不复制地交给Armadillo（见 toArma）。
+ */
+class Matrix {
+public:
+    Matrix() = default;
+    Matrix(size_t rows, size_t cols, double value = 0.0)
+        : m_rows(rows), m_cols(cols), m_data(rows * cols, value) {}
+    
+    /**
+     * @brief 由逐行存储的数据构造（列数取第一行，较短的行以0补齐）
+     */
+    static Matrix fromRows(const std::vector<std::vector<double>>& rows);
+    
+    /**
+     * @brief 复制视图中的数据
+     */
+    static Matrix copyOf(const ConstMatrixView& view);
+    
+    /**
+     * @brief 按下标收集若干行
+     */
+    static Matrix gatherRows(const ConstMatrixView& source, const std::vector<size_t>& indices);
+    
+    /**
+     * @brief 转换为逐行存储的数据（兼容旧接口）
+     */
+    std::vector<std::vector<double>> toRows() const;
+    
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+    size_t stride() const { return m_cols; }
+    size_t size() const { return m_data.size(); }
+    bool empty() const { return m_rows == 0 || m_cols == 0; }
+    
+    double* data() { return m_data.data(); }
+    const double* data() const { return m_data.data(); }
+    double* row(size_t i) { return m_data.data() + i * m_cols; }
+    const double* row(size_t i) const { return m_data.data() + i * m_cols; }
+    double& operator()(size_t i, size_t j) { return m_data[i * m_cols + j]; }
+    double operator()(size_t i, size_t j) const { return m_data[i * m_cols + j]; }
+    
+    /**
+     * @brief 重新设定大小并以value填充（原有内容不保留）
+     */
+    void assign(size_t rows, size_t cols, double value = 0.0);
+    
+    /**
+     * @brief 在末尾追加一行（values长度为列数）
+     */
+    void appendRow(const double* values);
+    
+    void reserveRows(size_t rows) { m_data.reserve(rows * m_cols); }
+    
+    ConstMatrixView view() const { return ConstMatrixView(m_data.data(), m_rows, m_cols); }
+    MatrixView view() { return MatrixView(m_data.data(), m_rows, m_cols); }
+    operator ConstMatrixView() const { return view(); }
+    operator MatrixView() { return view(); }
+    
+    ConstMatrixView rowRange(size_t begin, size_t end) const { return view().rowRange(begin, end); }
+    ConstMatrixView colRange(size_t begin, size_t end) const { return view().colRange(begin, end); }
+    ConstVectorView column(size_t j) const { return view().column(j); }
+
+private:
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    AlignedVector<double> m_data;
+};
+
+/**
+ * @brief 矩阵乘法 C = alpha·op(A)·op(B) + beta·C
+ * 
+ * op(A) 为 m×k、op(B) 为 k×n（transposeA / transposeB 为 true 时取转置），C 为 m×n。
+ * 按缓存分块：B 的 k×n 面板和 A 的 m×k 块分别打包成微内核顺序读取的连续数组，
+ * 微内核在寄存器中累加 6×8 的C块（AVX2+FMA 时向量化，否则为可自动向量化的标量代码）。
+ * parallel 为 true 时C按行块和列块分给共享线程池；每个元素沿k方向的累加顺序固定，
+ * 因此结果与线程数和分块方式无关。beta 为0时不读取C原有的内容。
+ */
+void gemm(const ConstMatrixView& a, bool transposeA, const ConstMatrixView& b, bool transposeB,
+          const MatrixView& c, double alpha = 1.0, double beta = 0.0, bool parallel = true);
+
+#ifdef USE_MLPACK
+/**
+ * @brief 把视图转换为mlpack使用的 特征×样本 arma::mat
+ * 
+ * 连续存储时借用原内存（不复制，调用方需保证视图数据在返回的矩阵使用期间有效），
+ * 有行间空隙时复制一份。
+ */
+inline arma::mat toArma(const ConstMatrixView& view) {
+    if (view.isContiguous()) {
+        return arma::mat(const_cast<double*>(view.data()), view.cols(), view.rows(), false, true);
+    }
+    
+    arma::mat result(view.cols(), view.rows());
+    for (size_t i = 0; i < view.rows(); ++i) {
+        const double* row = view.row(i);
+        for (size_t j = 0; j < view.cols(); ++j) {
+            result(j, i) = row[j];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 借用标签数组作为 arma::rowvec（不复制）
+ */
+inline arma::rowvec toArmaRow(const std::vector<double>& values) {
+    return arma::rowvec(const_cast<double*>(values.data()), values.size(), false, true);
+}
+#endif
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
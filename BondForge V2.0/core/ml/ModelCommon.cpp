@@ -0,0 +1,216 @@
+#include "ModelCommon.h"
+#include "ModelSelection.h"
+#include "TreeModels.h"
+#include "NeuralModels.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 按行分块求和时每块的行数和块数上限（块的划分只取决于数据形状，结果与线程数无关）
+constexpr size_t kChunkRows = 16384;
+constexpr size_t kMaxChunks = 64;
+
+// 所有行块的部分和合计占用的内存上限
+constexpr size_t kPartialBudgetBytes = size_t(256) << 20;
+
+} // namespace
+
+std::string localTimeString() {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    // std::localtime 返回共享的静态缓冲区，多个训练线程同时调用会互相覆盖
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    std::ostringstream ss;
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+bool predictsClasses(ModelType type, const std::map<std::string, double>& parameters) {
+    switch (type) {
+        case ModelType::LogisticRegression:
+        case ModelType::DecisionTree:
+        case ModelType::RandomForest:
+        case ModelType::NaiveBayes:
+            return true;
+        case ModelType::GradientBoosting:
+        case ModelType::NeuralNetwork:
+            return parameterOr(parameters, "objective", 0.0) == 1.0;
+        default:
+            return false;
+    }
+}
+
+bool predictsClasses(const IMLModel& model) {
+    switch (model.getModelType()) {
+        case ModelType::GradientBoosting: {
+            auto boosting = dynamic_cast<const GradientBoostingModel*>(&model);
+            return boosting && boosting->isClassifier();
+        }
+        case ModelType::NeuralNetwork: {
+            auto network = dynamic_cast<const NeuralNetworkModel*>(&model);
+            return network && network->isClassifier();
+        }
+        default:
+            return predictsClasses(model.getModelType(), {});
+    }
+}
+
+double scorePredictions(ScoringMetric metric, const std::vector<double>& predictions, const double* labels, size_t count) {
+    if (predictions.size() != count || count == 0) {
+        return metric == ScoringMetric::Accuracy ? 0.0 : -std::numeric_limits<double>::infinity();
+    }
+    if (metric == ScoringMetric::Accuracy) {
+        size_t correct = 0;
+        for (size_t i = 0; i < count; ++i) {
+            correct += predictions[i] == labels[i] ? 1 : 0;
+        }
+        return static_cast<double>(correct) / static_cast<double>(count);
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double error = predictions[i] - labels[i];
+        sum += error * error;
+    }
+    return -sum / static_cast<double>(count);
+}
+
+void standardization(const ConstMatrixView& data, std::vector<double>& means, std::vector<double>& invScale) {
+    const size_t numSamples = data.rows();
+    const size_t p = data.cols();
+    const size_t budgetChunks = std::max<size_t>(1, kPartialBudgetBytes / std::max<size_t>(1, p * sizeof(double)));
+    const size_t chunks = std::max<size_t>(1, std::min({(numSamples + kChunkRows - 1) / kChunkRows, kMaxChunks, budgetChunks}));
+    auto chunkBegin = [&](size_t c) { return numSamples * c / chunks; };
+    auto& pool = Utils::ThreadPool::instance();
+    
+    means.assign(p, 0.0);
+    invScale.assign(p, 0.0);
+    if (numSamples == 0) {
+        return;
+    }
+    std::vector<double> partial(chunks * p, 0.0);
+    pool.parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            double* sums = partial.data() + c * p;
+            for (size_t i = chunkBegin(c); i < chunkBegin(c + 1); ++i) {
+                const double* sample = data.row(i);
+                for (size_t j = 0; j < p; ++j) {
+                    sums[j] += sample[j];
+                }
+            }
+        }
+    });
+    for (size_t c = 0; c < chunks; ++c) {
+        for (size_t j = 0; j < p; ++j) {
+            means[j] += partial[c * p + j];
+        }
+    }
+    for (size_t j = 0; j < p; ++j) {
+        means[j] /= static_cast<double>(numSamples);
+    }
+    
+    std::fill(partial.begin(), partial.end(), 0.0);
+    pool.parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            double* squares = partial.data() + c * p;
+            for (size_t i = chunkBegin(c); i < chunkBegin(c + 1); ++i) {
+                const double* sample = data.row(i);
+                for (size_t j = 0; j < p; ++j) {
+                    double centered = sample[j] - means[j];
+                    squares[j] += centered * centered;
+                }
+            }
+        }
+    });
+    for (size_t j = 0; j < p; ++j) {
+        double sum = 0.0;
+        for (size_t c = 0; c < chunks; ++c) {
+            sum += partial[c * p + j];
+        }
+        double deviation = std::sqrt(sum / static_cast<double>(numSamples));
+        invScale[j] = deviation > 0.0 ? 1.0 / deviation : 0.0;
+    }
+}
+
+void fillClassificationMetrics(TrainingResult& result, const std::vector<uint32_t>& predicted,
+                               const std::vector<uint32_t>& targets, size_t numClasses) {
+    std::vector<size_t> truePositives(numClasses, 0);
+    std::vector<size_t> predictedCounts(numClasses, 0);
+    std::vector<size_t> actualCounts(numClasses, 0);
+    size_t correct = 0;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (predicted[i] == targets[i]) {
+            ++truePositives[targets[i]];
+            ++correct;
+        }
+        ++predictedCounts[predicted[i]];
+        ++actualCounts[targets[i]];
+    }
+    
+    auto ratio = [](size_t numerator, size_t denominator) {
+        return denominator > 0 ? static_cast<double>(numerator) / denominator : 0.0;
+    };
+    result.precision = 0.0;
+    result.recall = 0.0;
+    if (numClasses == 2) {
+        result.precision = ratio(truePositives[1], predictedCounts[1]);
+        result.recall = ratio(truePositives[1], actualCounts[1]);
+    } else if (numClasses > 0) {
+        for (size_t k = 0; k < numClasses; ++k) {
+            result.precision += ratio(truePositives[k], predictedCounts[k]);
+            result.recall += ratio(truePositives[k], actualCounts[k]);
+        }
+        result.precision /= numClasses;
+        result.recall /= numClasses;
+    }
+    
+    result.accuracy = ratio(correct, targets.size());
+    double precisionRecall = result.precision + result.recall;
+    result.f1Score = precisionRecall > 0.0 ? 2 * result.precision * result.recall / precisionRecall : 0.0;
+    result.meanSquaredError = 0.0;
+}
+
+void fillRegressionMetrics(TrainingResult& result, const std::vector<double>& predictions,
+                           const std::vector<double>& labels) {
+    const size_t count = labels.size();
+    double mean = std::accumulate(labels.begin(), labels.end(), 0.0) / count;
+    auto labelRange = std::minmax_element(labels.begin(), labels.end());
+    double threshold = 0.1 * (*labelRange.second - *labelRange.first);
+    
+    double errorSum = 0.0;
+    double totalSum = 0.0;
+    size_t correct = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double error = predictions[i] - labels[i];
+        errorSum += error * error;
+        totalSum += (labels[i] - mean) * (labels[i] - mean);
+        if (std::abs(error) < threshold) {
+            ++correct;
+        }
+    }
+    
+    result.meanSquaredError = errorSum / count;
+    result.accuracy = static_cast<double>(correct) / count;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.additionalMetrics["r2"] = totalSum > 0.0 ? 1.0 - errorSum / totalSum : 0.0;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,80 @@
+#pragma once
+
+// ML模块内部共用的辅助函数：只在 core/ml 的实现文件中包含，不属于公开接口
+
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "MLModels.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+enum class ScoringMetric;
+
+/**
+ * @brief 读取训练参数，未设置时返回默认值
+ */
+inline double parameterOr(const std::map<std::string, double>& parameters, const std::string& key, double fallback) {
+    auto it = parameters.find(key);
+    return it != parameters.end() ? it->second : fallback;
+}
+
+/**
+ * @brief 自 start 起经过的秒数（单调时钟）
+ */
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief 当前本地时间，格式为 "YYYY-MM-DD HH:MM:SS"（可在多个线程中同时调用）
+ */
+std::string localTimeString();
+
+/**
+ * @brief 模型类型在给定训练参数下是否预测类别标签（梯度提升树和神经网络由 objective 参数决定）
+ */
+bool predictsClasses(ModelType type, const std::map<std::string, double>& parameters);
+
+/**
+ * @brief 已训练的模型是否预测类别标签
+ */
+bool predictsClasses(const IMLModel& model);
+
+/**
+ * @brief 预测的分数（越大越好）：准确率或负均方误差
+ * 
+ * 预测数与标签数不一致或为空时返回该评分方式的最差值。
+ */
+double scorePredictions(ScoringMetric metric, const std::vector<double>& predictions, const double* labels, size_t count);
+
+/**
+ * @brief 各列的均值和标准差的倒数（标准差为0的列取0）
+ * 
+ * 在线程池上按固定的行块两遍求和，块序合并，同样的输入总得到同样的结果。
+ */
+void standardization(const ConstMatrixView& data, std::vector<double>& means, std::vector<double>& invScale);
+
+/**
+ * @brief 分类指标：二分类以较大的标签值为正类，多分类取各类别的宏平均
+ * 
+ * @param predicted 每个样本预测的类别序号
+ * @param targets 每个样本的真实类别序号
+ * @param numClasses 类别数（序号小于该值）
+ */
+void fillClassificationMetrics(TrainingResult& result, const std::vector<uint32_t>& predicted,
+                               const std::vector<uint32_t>& targets, size_t numClasses);
+
+/**
+ * @brief 回归指标：均方误差、R²，精度按标签范围10%以内的误差计
+ */
+void fillRegressionMetrics(TrainingResult& result, const std::vector<double>& predictions,
+                           const std::vector<double>& labels);
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,388 @@
+#include "ModelFile.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kModelFileMagic = 0x464D4642;   // "BFMF"
+constexpr uint32_t kModelFileVersion = 1;
+
+// 节数上限（防止损坏的节表导致过大的分配）
+constexpr uint32_t kMaxSections = 4096;
+
+/**
+ * @brief 文件头（64字节）
+ */
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t modelType;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint64_t tableChecksum;     // 文件头（本字段置0）和节表的校验和
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(FileHeader) == 64, "Model file header must be 64 bytes");
+
+constexpr uint64_t kChecksumSeed = 0xcbf29ce484222325ULL;
+
+/**
+ * @brief 64位FNV-1a校验和，按8字节字处理（每个字一次乘法），尾部逐字节
+ */
+uint64_t checksum(const uint8_t* data, size_t length, uint64_t hash = kChecksumSeed) {
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    size_t words = length / sizeof(uint64_t);
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        std::memcpy(&word, data + i * sizeof(uint64_t), sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (size_t i = words * sizeof(uint64_t); i < length; ++i) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    return hash;
+}
+
+uint64_t alignOffset(uint64_t offset) {
+    return (offset + MatrixAlignment - 1) / MatrixAlignment * MatrixAlignment;
+}
+
+uint64_t tableChecksum(FileHeader header, const void* entries, size_t entryBytes) {
+    header.tableChecksum = 0;
+    uint64_t hash = checksum(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    return checksum(static_cast<const uint8_t*>(entries), entryBytes, hash);
+}
+
+bool validModelType(uint32_t type) {
+    return type <= static_cast<uint32_t>(ModelType::NeuralNetwork);
+}
+
+/**
+ * @brief 同一目标文件的临时文件名（进程号、线程和序号各不相同，并发保存互不覆盖）
+ */
+std::string temporaryPathFor(const std::string& filePath) {
+    static std::atomic<uint64_t> counter{0};
+#ifdef _WIN32
+    unsigned long process = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    unsigned long process = static_cast<unsigned long>(getpid());
+#endif
+    size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return filePath + ".tmp." + std::to_string(process) + "." + std::to_string(thread) + "." +
+           std::to_string(counter.fetch_add(1));
+}
+
+/**
+ * @brief 把已写入的文件内容刷到磁盘（改名前调用，断电后不会留下内容不完整的新文件）
+ */
+bool flushToDisk(const std::string& filePath) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool flushed = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return flushed;
+#else
+    int descriptor = ::open(filePath.c_str(), O_WRONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    bool flushed = ::fsync(descriptor) == 0;
+    ::close(descriptor);
+    return flushed;
+#endif
+}
+
+} // namespace
+
+// ModelFileWriter 实现
+void ModelFileWriter::addSection(uint32_t tag, const void* data, size_t elementSize, size_t count, size_t rows, size_t cols) {
+    PendingSection section;
+    section.tag = tag;
+    section.elementSize = static_cast<uint32_t>(elementSize);
+    section.data = data;
+    section.count = count;
+    section.rows = rows;
+    section.cols = cols;
+    m_sections.push_back(section);
+}
+
+bool ModelFileWriter::write(const std::string& filePath) const {
+    using SectionEntry = MappedModelFile::SectionEntry;
+    static_assert(sizeof(SectionEntry) == 64, "Model file section entries must be 64 bytes");
+    
+    if (m_sections.size() > kMaxSections) {
+        return false;
+    }
+    
+    try {
+        // 节表紧跟文件头，各节按对齐的偏移依次排列
+        std::vector<SectionEntry> entries(m_sections.size());
+        uint64_t offset = alignOffset(sizeof(FileHeader) + entries.size() * sizeof(SectionEntry));
+        for (size_t i = 0; i < m_sections.size(); ++i) {
+            const PendingSection& section = m_sections[i];
+            SectionEntry& entry = entries[i];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.tag = section.tag;
+            entry.elementSize = section.elementSize;
+            entry.offset = offset;
+            entry.count = section.count;
+            entry.rows = section.rows;
+            entry.cols = section.cols;
+            uint64_t bytes = section.count * section.elementSize;
+            entry.checksum = checksum(static_cast<const uint8_t*>(section.data), bytes);
+            offset = alignOffset(offset + bytes);
+        }
+        
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = kModelFileMagic;
+        header.version = kModelFileVersion;
+        header.modelType = m_fileType;
+        header.sectionCount = static_cast<uint32_t>(entries.size());
+        header.fileSize = offset;
+        header.tableChecksum = tableChecksum(header, entries.data(), entries.size() * sizeof(SectionEntry));
+        
+        std::string temporaryPath = temporaryPathFor(filePath);
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+            
+            static const char padding[MatrixAlignment] = {};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SectionEntry));
+            uint64_t position = sizeof(FileHeader) + entries.size() * sizeof(SectionEntry);
+            for (size_t i = 0; i < m_sections.size(); ++i) {
+                file.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+                uint64_t bytes = entries[i].count * entries[i].elementSize;
+                file.write(static_cast<const char*>(m_sections[i].data), static_cast<std::streamsize>(bytes));
+                position = entries[i].offset + bytes;
+            }
+            file.write(padding, static_cast<std::streamsize>(header.fileSize - position));
+            file.close();
+            if (!file || !flushToDisk(temporaryPath)) {
+                std::filesystem::remove(temporaryPath);
+                return false;
+            }
+        }
+        
+        // 改名替换：已映射旧文件的模型继续使用旧内容，不会读到写了一半的文件
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, filePath, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// MappedModelFile 实现
+MappedModelFile::~MappedModelFile() {
+    if (m_osMapped && m_base != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+#else
+        munmap(const_cast<uint8_t*>(m_base), m_length);
+#endif
+    }
+}
+
+std::shared_ptr<const MappedModelFile> MappedModelFile::open(const std::string& filePath) {
+    if (!peekModelType(filePath)) {
+        return nullptr;
+    }
+    return map(filePath, kAnyModelType);
+}
+
+std::shared_ptr<const MappedModelFile> MappedModelFile::open(const std::string& filePath, ModelFileContent content) {
+    return map(filePath, static_cast<uint32_t>(content));
+}
+
+std::shared_ptr<const MappedModelFile> MappedModelFile::map(const std::string& filePath, uint32_t fileType) {
+    std::shared_ptr<MappedModelFile> file(new MappedModelFile());
+    try {
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle != INVALID_HANDLE_VALUE) {
+            LARGE_INTEGER size;
+            if (GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+                HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping != nullptr) {
+                    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    if (view != nullptr) {
+                        file->m_base = static_cast<const uint8_t*>(view);
+                        file->m_length = static_cast<size_t>(size.QuadPart);
+                        file->m_osMapped = true;
+                    }
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(handle);
+        }
+#else
+        int descriptor = ::open(filePath.c_str(), O_RDONLY);
+        if (descriptor >= 0) {
+            struct stat status;
+            if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+                void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (view != MAP_FAILED) {
+                    file->m_base = static_cast<const uint8_t*>(view);
+                    file->m_length = static_cast<size_t>(status.st_size);
+                    file->m_osMapped = true;
+                }
+            }
+            ::close(descriptor);
+        }
+#endif
+        
+        if (!file->m_osMapped) {
+            std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+            if (!stream.is_open()) {
+                return nullptr;
+            }
+            file->m_fallback.resize(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0);
+            stream.read(reinterpret_cast<char*>(file->m_fallback.data()), file->m_fallback.size());
+            if (!stream) {
+                return nullptr;
+            }
+            file->m_base = file->m_fallback.data();
+            file->m_length = file->m_fallback.size();
+        }
+    } catch (...) {
+        return nullptr;
+    }
+    
+    // 校验文件头和节表；各节内容在访问时才校验
+    if (file->m_length < sizeof(FileHeader)) {
+        return nullptr;
+    }
+    FileHeader header;
+    std::memcpy(&header, file->m_base, sizeof(header));
+    if (header.magic != kModelFileMagic || header.version != kModelFileVersion ||
+        !(fileType == kAnyModelType ? validModelType(header.modelType) : header.modelType == fileType) ||
+        header.sectionCount > kMaxSections ||
+        header.fileSize != file->m_length) {
+        return nullptr;
+    }
+    
+    uint64_t tableEnd = sizeof(FileHeader) + uint64_t(header.sectionCount) * sizeof(SectionEntry);
+    if (tableEnd > file->m_length) {
+        return nullptr;
+    }
+    const auto* entries = reinterpret_cast<const SectionEntry*>(file->m_base + sizeof(FileHeader));
+    if (tableChecksum(header, entries, header.sectionCount * sizeof(SectionEntry)) != header.tableChecksum) {
+        return nullptr;
+    }
+    
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        const SectionEntry& entry = entries[i];
+        if (entry.elementSize == 0 || entry.offset % MatrixAlignment != 0 || entry.offset < tableEnd ||
+            entry.offset > file->m_length) {
+            return nullptr;
+        }
+        uint64_t available = (file->m_length - entry.offset) / entry.elementSize;
+        if (entry.count > available || (entry.cols != 0 && entry.rows > std::numeric_limits<uint64_t>::max() / entry.cols) ||
+            entry.rows * entry.cols != entry.count) {
+            return nullptr;
+        }
+    }
+    
+    if (fileType == kAnyModelType) {
+        file->m_type = static_cast<ModelType>(header.modelType);
+    }
+    file->m_entries = entries;
+    file->m_entryCount = header.sectionCount;
+    file->m_verified.reset(new std::atomic<uint8_t>[header.sectionCount]);
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        file->m_verified[i].store(0, std::memory_order_relaxed);
+    }
+    return file;
+}
+
+bool MappedModelFile::peekModelType(const std::string& filePath, ModelType* type) {
+    try {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        FileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != kModelFileMagic || header.version != kModelFileVersion ||
+            !validModelType(header.modelType)) {
+            return false;
+        }
+        if (type != nullptr) {
+            *type = static_cast<ModelType>(header.modelType);
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool MappedModelFile::verifyAll() const {
+    for (size_t i = 0; i < m_entryCount; ++i) {
+        if (!verify(m_entries[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const MappedModelFile::SectionEntry* MappedModelFile::findSection(uint32_t tag) const {
+    for (size_t i = 0; i < m_entryCount; ++i) {
+        if (m_entries[i].tag == tag) {
+            return &m_entries[i];
+        }
+    }
+    return nullptr;
+}
+
+bool MappedModelFile::verify(const SectionEntry& entry) const {
+    std::atomic<uint8_t>& state = m_verified[&entry - m_entries];
+    uint8_t current = state.load(std::memory_order_acquire);
+    if (current == 0) {
+        // 多个线程同时首次访问时各自计算，结果相同
+        bool ok = checksum(m_base + entry.offset, entry.count * entry.elementSize) == entry.checksum;
+        current = ok ? 1 : 2;
+        state.store(current, std::memory_order_release);
+    }
+    return current == 1;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
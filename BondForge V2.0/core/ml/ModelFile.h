@@ -0,0 +1,290 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "MLModels.h"
+#include "Matrix.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 由4个字符组成的节标签（如 sectionTag("NODE")）
+ */
+constexpr uint32_t sectionTag(const char (&name)[5]) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(name[0])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[3])) << 24;
+}
+
+/**
+ * @brief 模型文件格式中保存的非模型内容
+ * 
+ * 与 ModelType 共用文件头的类型字段，取值不与模型类型重叠，
+ * 因此 peekModelType() 和 ModelFactory::loadModel() 不会把这些文件当作模型。
+ */
+enum class ModelFileContent : uint32_t {
+    NeighborIndex = 0x100       // 近邻索引（HnswIndex）
+};
+
+/**
+ * @brief 模型文件中的一个节（直接指向映射的文件内容）
+ */
+template <typename T>
+struct ModelSection {
+    const T* data = nullptr;
+    size_t count = 0;           // 元素个数
+    size_t rows = 0;            // 矩阵节的形状（一维数组为 count×1）
+    size_t cols = 0;
+    bool valid = false;         // 节存在、元素大小一致且校验和正确
+    
+    ConstMatrixView matrix() const {
+        return ConstMatrixView(reinterpret_cast<const double*>(data), rows, cols);
+    }
+};
+
+/**
+ * @brief 模型文件的写入器
+ * 
+ * 文件布局：64字节的文件头（魔数、版本、模型类型、节数、文件长度、节表校验和），
+ * 之后是每节64字节的节表（标签、元素大小、偏移、元素个数、形状、校验和），
+ * 最后是各节的原始数组，每节的起始偏移按 MatrixAlignment（64字节）对齐。
+ * 映射后各节的地址同样对齐，可以直接作为模型的数组使用，不需要解析或复制。
+ * 
+ * 添加节时只记录数据指针，数据在 write() 之前必须保持有效。
+ */
+class ModelFileWriter {
+public:
+    explicit ModelFileWriter(ModelType type) : m_fileType(static_cast<uint32_t>(type)) {}
+    explicit ModelFileWriter(ModelFileContent content) : m_fileType(static_cast<uint32_t>(content)) {}
+    
+    /**
+     * @brief 添加一维数组节
+     */
+    template <typename T>
+    void addArray(uint32_t tag, const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Model file sections hold raw arrays");
+        addSection(tag, data, sizeof(T), count, count, 1);
+    }
+    
+    template <typename T, typename Allocator>
+    void addArray(uint32_t tag, const std::vector<T, Allocator>& values) {
+        addArray(tag, values.data(), values.size());
+    }
+    
+    /**
+     * @brief 添加矩阵节（行主序，保存形状）
+     */
+    void addMatrix(uint32_t tag, const Matrix& matrix) {
+        addSection(tag, matrix.data(), sizeof(double), matrix.size(), matrix.rows(), matrix.cols());
+    }
+    
+    /**
+     * @brief 写入文件
+     * 
+     * 先写入同目录下的临时文件（文件名含进程号、线程和序号，并发保存同一文件时互不覆盖），
+     * 刷到磁盘后再改名，已被映射的旧文件不会在写入过程中被改写。
+     * 
+     * @param filePath 文件路径
+     * @return 是否成功
+     */
+    bool write(const std::string& filePath) const;
+
+private:
+    struct PendingSection {
+        uint32_t tag;
+        uint32_t elementSize;
+        const void* data;
+        uint64_t count;
+        uint64_t rows;
+        uint64_t cols;
+    };
+    
+    void addSection(uint32_t tag, const void* data, size_t elementSize, size_t count, size_t rows, size_t cols);
+    
+    uint32_t m_fileType;
+    std::vector<PendingSection> m_sections;
+};
+
+/**
+ * @brief 以内存映射方式打开的模型文件
+ * 
+ * open() 只映射文件并校验文件头和节表，不读取各节内容；操作系统在访问时才调入对应的页。
+ * 每节的校验和在第一次通过 section() 访问该节时计算，之后的访问不再重复校验，
+ * 因此只在特定场合使用的节（如增量训练的统计量）在不用时没有任何读取开销。
+ * 
+ * 模型可以通过 ModelArray 直接引用映射的节并持有文件的共享指针，文件映射在最后一个引用释放后解除。
+ */
+class MappedModelFile {
+public:
+    ~MappedModelFile();
+    
+    MappedModelFile(const MappedModelFile&) = delete;
+    MappedModelFile& operator=(const MappedModelFile&) = delete;
+    
+    /**
+     * @brief 映射模型文件
+     * 
+     * @param filePath 文件路径
+     * @return 文件对象（文件不存在、不是模型文件或文件头/节表损坏时返回空指针）
+     */
+    static std::shared_ptr<const MappedModelFile> open(const std::string& filePath);
+    
+    /**
+     * @brief 映射保存非模型内容的文件
+     * 
+     * @param filePath 文件路径
+     * @param content 文件应保存的内容
+     * @return 文件对象（文件不存在、内容不符或文件头/节表损坏时返回空指针）
+     */
+    static std::shared_ptr<const MappedModelFile> open(const std::string& filePath, ModelFileContent content);
+    
+    /**
+     * @brief 只读取文件头判断是否为模型文件
+     * 
+     * @param filePath 文件路径
+     * @param type 输出的模型类型（可以为空）
+     * @return 是否为当前版本的模型文件
+     */
+    static bool peekModelType(const std::string& filePath, ModelType* type = nullptr);
+    
+    ModelType modelType() const { return m_type; }
+    size_t sectionCount() const { return m_entryCount; }
+    bool hasSection(uint32_t tag) const { return findSection(tag) != nullptr; }
+    
+    /**
+     * @brief 访问一个节
+     * 
+     * 节不存在、元素大小不符或校验和错误时返回的节 valid 为false。
+     */
+    template <typename T>
+    ModelSection<T> section(uint32_t tag) const {
+        static_assert(std::is_trivially_copyable<T>::value, "Model file sections hold raw arrays");
+        ModelSection<T> result;
+        const SectionEntry* entry = findSection(tag);
+        if (entry == nullptr || entry->elementSize != sizeof(T) || !verify(*entry)) {
+            return result;
+        }
+        result.data = reinterpret_cast<const T*>(m_base + entry->offset);
+        result.count = static_cast<size_t>(entry->count);
+        result.rows = static_cast<size_t>(entry->rows);
+        result.cols = static_cast<size_t>(entry->cols);
+        result.valid = true;
+        return result;
+    }
+    
+    /**
+     * @brief 校验所有节（用于完整性检查工具，正常加载不需要）
+     */
+    bool verifyAll() const;
+
+private:
+    struct SectionEntry {
+        uint32_t tag;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t count;
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t checksum;
+        uint64_t reserved[2];
+    };
+    
+    MappedModelFile() = default;
+    
+    /**
+     * @brief 映射文件并校验文件头和节表
+     * 
+     * @param fileType 文件头类型字段应有的值（kAnyModelType 表示任意模型类型）
+     */
+    static std::shared_ptr<const MappedModelFile> map(const std::string& filePath, uint32_t fileType);
+    
+    static constexpr uint32_t kAnyModelType = 0xFFFFFFFFu;
+    
+    const SectionEntry* findSection(uint32_t tag) const;
+    bool verify(const SectionEntry& entry) const;
+    
+    const uint8_t* m_base = nullptr;
+    size_t m_length = 0;
+    ModelType m_type = ModelType::LinearRegression;
+    const SectionEntry* m_entries = nullptr;
+    size_t m_entryCount = 0;
+    
+    // 每节的校验状态：0未校验，1正确，2错误
+    std::unique_ptr<std::atomic<uint8_t>[]> m_verified;
+    
+    // 系统映射失败时（如不支持映射的文件系统）退回为读入对齐的缓冲区
+    bool m_osMapped = false;
+    AlignedVector<uint8_t> m_fallback;
+    
+    friend class ModelFileWriter;
+};
+
+/**
+ * @brief 模型的只读数组：自有的 std::vector 或映射文件中的节
+ * 
+ * 训练得到的模型持有自己的数组；从模型文件加载的模型直接引用映射的节（零复制），
+ * 并通过共享指针保持文件映射有效。需要修改时 mutableVector() 先把映射的内容复制为自有数组。
+ */
+template <typename T>
+class ModelArray {
+public:
+    ModelArray() = default;
+    ModelArray(std::vector<T> values) : m_owned(std::move(values)) {}
+    
+    ModelArray& operator=(std::vector<T> values) {
+        m_owned = std::move(values);
+        m_file.reset();
+        m_mapped = nullptr;
+        m_mappedSize = 0;
+        return *this;
+    }
+    
+    /**
+     * @brief 引用映射文件中的节
+     */
+    static ModelArray mapped(const ModelSection<T>& section, std::shared_ptr<const MappedModelFile> file) {
+        ModelArray array;
+        array.m_file = std::move(file);
+        array.m_mapped = section.data;
+        array.m_mappedSize = section.count;
+        return array;
+    }
+    
+    const T* data() const { return m_file ? m_mapped : m_owned.data(); }
+    size_t size() const { return m_file ? m_mappedSize : m_owned.size(); }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    bool isMapped() const { return static_cast<bool>(m_file); }
+    
+    /**
+     * @brief 可修改的自有数组（引用映射文件时先复制）
+     */
+    std::vector<T>& mutableVector() {
+        if (m_file) {
+            m_owned.assign(m_mapped, m_mapped + m_mappedSize);
+            m_file.reset();
+            m_mapped = nullptr;
+            m_mappedSize = 0;
+        }
+        return m_owned;
+    }
+
+private:
+    std::vector<T> m_owned;
+    std::shared_ptr<const MappedModelFile> m_file;
+    const T* m_mapped = nullptr;
+    size_t m_mappedSize = 0;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,494 @@
+#include "ModelRegistry.h"
+#include "ModelCommon.h"
+#include "ModelFile.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kCatalogFileMagic = 0x524D4642;  // "BFMR"
+constexpr uint32_t kCatalogFileVersion = 1;
+
+void writeString(std::ofstream& file, const std::string& value) {
+    uint64_t length = value.size();
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool readString(std::ifstream& file, std::string& value) {
+    uint64_t length = 0;
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!file || length > (uint64_t(1) << 20)) {
+        return false;
+    }
+    value.resize(static_cast<size_t>(length));
+    file.read(&value[0], static_cast<std::streamsize>(length));
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+ModelRegistry::ModelRegistry(const ModelRegistryOptions& options)
+    : m_options(options) {
+}
+
+ModelRegistry& ModelRegistry::instance() {
+    static ModelRegistry registry;
+    return registry;
+}
+
+uint32_t ModelRegistry::registerFile(const std::string& name, const std::string& filePath,
+                                     const std::string& description, const std::map<std::string, double>& metrics) {
+    ModelVersionInfo info;
+    if (name.empty() || !MappedModelFile::peekModelType(filePath, &info.modelType)) {
+        return 0;
+    }
+
+    std::error_code error;
+    uint64_t fileBytes = std::filesystem::file_size(filePath, error);
+    if (error) {
+        return 0;
+    }
+
+    info.name = name;
+    info.filePath = filePath;
+    info.description = description;
+    info.createTime = localTimeString();
+    info.metrics = metrics;
+    info.fileBytes = fileBytes;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return addVersionLocked(std::move(info));
+}
+
+uint32_t ModelRegistry::registerModel(const std::string& name, std::shared_ptr<IMLModel> model, const std::string& filePath,
+                                      const std::string& description, const std::map<std::string, double>& metrics) {
+    if (name.empty() || !model || !model->saveModel(filePath)) {
+        return 0;
+    }
+
+    std::error_code error;
+    uint64_t fileBytes = std::filesystem::file_size(filePath, error);
+    std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(filePath, error);
+    if (error) {
+        return 0;
+    }
+
+    ModelVersionInfo info;
+    info.name = name;
+    info.filePath = filePath;
+    info.modelType = model->getModelType();
+    info.description = description;
+    info.createTime = localTimeString();
+    info.metrics = metrics;
+    info.fileBytes = fileBytes;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t version = addVersionLocked(std::move(info));
+
+    // 刚保存的模型与文件内容一致，直接放入缓存，之后的请求不必再加载
+    auto it = m_cache.find(filePath);
+    if (it != m_cache.end()) {
+        removeCacheEntryLocked(it);
+    }
+    CacheEntry& entry = m_cache[filePath];
+    entry.model = std::move(model);
+    entry.fileTime = fileTime;
+    entry.bytes = static_cast<size_t>(fileBytes);
+    entry.lastUsed = ++m_clock;
+    m_stats.cachedBytes += entry.bytes;
+    enforceBudgetLocked(filePath);
+    return version;
+}
+
+bool ModelRegistry::removeVersion(const std::string& name, uint32_t version) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_catalog.find(name);
+    if (it == m_catalog.end()) {
+        return false;
+    }
+
+    std::vector<ModelVersionInfo>& versions = it->second;
+    auto found = std::find_if(versions.begin(), versions.end(),
+                              [version](const ModelVersionInfo& info) { return info.version == version; });
+    if (found == versions.end()) {
+        return false;
+    }
+
+    std::string filePath = found->filePath;
+    versions.erase(found);
+    if (versions.empty()) {
+        m_catalog.erase(it);
+    }
+
+    // 其他版本仍引用同一文件时保留缓存
+    for (const auto& model : m_catalog) {
+        for (const ModelVersionInfo& info : model.second) {
+            if (info.filePath == filePath) {
+                return true;
+            }
+        }
+    }
+    auto cached = m_cache.find(filePath);
+    if (cached != m_cache.end() && cached->second.model) {
+        removeCacheEntryLocked(cached);
+    }
+    return true;
+}
+
+bool ModelRegistry::removeModel(const std::string& name) {
+    std::vector<uint32_t> versions;
+    for (const ModelVersionInfo& info : listVersions(name)) {
+        versions.push_back(info.version);
+    }
+    for (uint32_t version : versions) {
+        removeVersion(name, version);
+    }
+    return !versions.empty();
+}
+
+std::vector<std::string> ModelRegistry::modelNames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> names;
+    names.reserve(m_catalog.size());
+    for (const auto& model : m_catalog) {
+        names.push_back(model.first);
+    }
+    return names;
+}
+
+std::vector<ModelVersionInfo> ModelRegistry::listVersions(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_catalog.find(name);
+    return it != m_catalog.end() ? it->second : std::vector<ModelVersionInfo>();
+}
+
+bool ModelRegistry::getVersion(const std::string& name, uint32_t version, ModelVersionInfo& info) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return findVersionLocked(name, version, info);
+}
+
+std::shared_ptr<IMLModel> ModelRegistry::getModel(const std::string& name, uint32_t version) {
+    ModelVersionInfo info;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!findVersionLocked(name, version, info)) {
+            return nullptr;
+        }
+    }
+    return loadFile(info.filePath);
+}
+
+std::shared_ptr<IMLModel> ModelRegistry::loadFile(const std::string& filePath) {
+    std::error_code error;
+    std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(filePath, error);
+
+    std::promise<std::shared_ptr<IMLModel>> promise;
+    std::shared_future<std::shared_ptr<IMLModel>> sharedLoad;
+    uint64_t loadId = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (error) {
+            ++m_stats.misses;
+            ++m_stats.loadFailures;
+            return nullptr;
+        }
+
+        auto it = m_cache.find(filePath);
+        if (it != m_cache.end() && it->second.model && it->second.fileTime != fileTime) {
+            // 文件在缓存后被改写
+            removeCacheEntryLocked(it);
+            it = m_cache.end();
+            ++m_stats.reloads;
+        }
+
+        if (it != m_cache.end()) {
+            it->second.lastUsed = ++m_clock;
+            if (it->second.model) {
+                ++m_stats.hits;
+                return it->second.model;
+            }
+            // 其他线程正在加载同一文件：在锁外等待它的结果
+            ++m_stats.sharedLoads;
+            sharedLoad = it->second.loading;
+        } else {
+            ++m_stats.misses;
+            loadId = ++m_clock;
+            CacheEntry& entry = m_cache[filePath];
+            entry.loading = promise.get_future().share();
+            entry.fileTime = fileTime;
+            entry.lastUsed = loadId;
+            entry.loadId = loadId;
+        }
+    }
+
+    if (sharedLoad.valid()) {
+        return sharedLoad.get();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<IMLModel> model;
+    try {
+        model = ModelFactory::loadModel(filePath);
+    } catch (const std::exception&) {
+        model.reset();
+    }
+    double seconds = secondsSince(start);
+    uint64_t fileBytes = std::filesystem::file_size(filePath, error);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.loadSeconds += seconds;
+        if (!model) {
+            ++m_stats.loadFailures;
+        }
+
+        // 加载期间条目可能已被 evictAll() / removeVersion() / registerModel() 替换，此时不再放入缓存
+        auto it = m_cache.find(filePath);
+        if (it != m_cache.end() && !it->second.model && it->second.loadId == loadId) {
+            if (model) {
+                it->second.model = model;
+                it->second.loading = std::shared_future<std::shared_ptr<IMLModel>>();
+                it->second.bytes = error ? 0 : static_cast<size_t>(fileBytes);
+                m_stats.cachedBytes += it->second.bytes;
+                enforceBudgetLocked(filePath);
+            } else {
+                m_cache.erase(it);
+            }
+        }
+    }
+
+    promise.set_value(model);
+    return model;
+}
+
+size_t ModelRegistry::preload(const std::vector<std::string>& names) {
+    std::vector<std::string> filePaths;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (names.empty()) {
+            for (const auto& model : m_catalog) {
+                filePaths.push_back(model.second.back().filePath);
+            }
+        } else {
+            for (const std::string& name : names) {
+                auto it = m_catalog.find(name);
+                if (it != m_catalog.end()) {
+                    filePaths.push_back(it->second.back().filePath);
+                }
+            }
+        }
+    }
+
+    std::atomic<size_t> loaded{0};
+    Utils::ThreadPool::instance().parallelFor(0, filePaths.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (loadFile(filePaths[i])) {
+                loaded.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    return loaded.load();
+}
+
+bool ModelRegistry::saveCatalog(const std::string& filePath) const {
+    std::vector<ModelVersionInfo> versions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& model : m_catalog) {
+            versions.insert(versions.end(), model.second.begin(), model.second.end());
+        }
+    }
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    uint32_t header[2] = {kCatalogFileMagic, kCatalogFileVersion};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    uint64_t count = versions.size();
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const ModelVersionInfo& info : versions) {
+        uint32_t fields[2] = {info.version, static_cast<uint32_t>(info.modelType)};
+        file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+        file.write(reinterpret_cast<const char*>(&info.fileBytes), sizeof(info.fileBytes));
+        writeString(file, info.name);
+        writeString(file, info.filePath);
+        writeString(file, info.description);
+        writeString(file, info.createTime);
+
+        uint64_t metricCount = info.metrics.size();
+        file.write(reinterpret_cast<const char*>(&metricCount), sizeof(metricCount));
+        for (const auto& metric : info.metrics) {
+            writeString(file, metric.first);
+            file.write(reinterpret_cast<const char*>(&metric.second), sizeof(metric.second));
+        }
+    }
+    file.close();
+    return !file.fail();
+}
+
+bool ModelRegistry::loadCatalog(const std::string& filePath, bool preloadModels) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    uint32_t header[2] = {0, 0};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    uint64_t count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || header[0] != kCatalogFileMagic || header[1] != kCatalogFileVersion || count > (uint64_t(1) << 24)) {
+        return false;
+    }
+
+    std::map<std::string, std::vector<ModelVersionInfo>> catalog;
+    for (uint64_t i = 0; i < count; ++i) {
+        ModelVersionInfo info;
+        uint32_t fields[2] = {0, 0};
+        file.read(reinterpret_cast<char*>(fields), sizeof(fields));
+        file.read(reinterpret_cast<char*>(&info.fileBytes), sizeof(info.fileBytes));
+        if (!file || fields[0] == 0 || fields[1] > static_cast<uint32_t>(ModelType::NeuralNetwork)) {
+            return false;
+        }
+        info.version = fields[0];
+        info.modelType = static_cast<ModelType>(fields[1]);
+        if (!readString(file, info.name) || !readString(file, info.filePath) ||
+            !readString(file, info.description) || !readString(file, info.createTime)) {
+            return false;
+        }
+
+        uint64_t metricCount = 0;
+        file.read(reinterpret_cast<char*>(&metricCount), sizeof(metricCount));
+        if (!file || metricCount > (uint64_t(1) << 16)) {
+            return false;
+        }
+        for (uint64_t m = 0; m < metricCount; ++m) {
+            std::string metric;
+            double value = 0.0;
+            if (!readString(file, metric)) {
+                return false;
+            }
+            file.read(reinterpret_cast<char*>(&value), sizeof(value));
+            if (!file) {
+                return false;
+            }
+            info.metrics[metric] = value;
+        }
+
+        std::vector<ModelVersionInfo>& versions = catalog[info.name];
+        if (!versions.empty() && versions.back().version >= info.version) {
+            return false;
+        }
+        versions.push_back(std::move(info));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_catalog = std::move(catalog);
+    }
+
+    if (preloadModels) {
+        preload();
+    }
+    return true;
+}
+
+void ModelRegistry::evictAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        auto next = std::next(it);
+        if (it->second.model) {
+            removeCacheEntryLocked(it);
+            ++m_stats.evictions;
+        }
+        it = next;
+    }
+}
+
+void ModelRegistry::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options.memoryBudgetBytes = bytes;
+    enforceBudgetLocked(std::string());
+}
+
+ModelRegistryStats ModelRegistry::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ModelRegistryStats stats = m_stats;
+    stats.cachedModels = static_cast<size_t>(std::count_if(m_cache.begin(), m_cache.end(),
+        [](const std::pair<const std::string, CacheEntry>& entry) { return entry.second.model != nullptr; }));
+    stats.memoryBudgetBytes = m_options.memoryBudgetBytes;
+    return stats;
+}
+
+bool ModelRegistry::findVersionLocked(const std::string& name, uint32_t version, ModelVersionInfo& info) const {
+    auto it = m_catalog.find(name);
+    if (it == m_catalog.end()) {
+        return false;
+    }
+
+    const std::vector<ModelVersionInfo>& versions = it->second;
+    if (version == 0) {
+        info = versions.back();
+        return true;
+    }
+    for (const ModelVersionInfo& candidate : versions) {
+        if (candidate.version == version) {
+            info = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ModelRegistry::addVersionLocked(ModelVersionInfo info) {
+    std::vector<ModelVersionInfo>& versions = m_catalog[info.name];
+    info.version = versions.empty() ? 1 : versions.back().version + 1;
+    versions.push_back(std::move(info));
+    return versions.back().version;
+}
+
+void ModelRegistry::enforceBudgetLocked(const std::string& keep) {
+    while (m_stats.cachedBytes > m_options.memoryBudgetBytes) {
+        auto victim = m_cache.end();
+        for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+            if (!it->second.model || it->first == keep) {
+                continue;
+            }
+            if (victim == m_cache.end() || it->second.lastUsed < victim->second.lastUsed) {
+                victim = it;
+            }
+        }
+
+        if (victim == m_cache.end()) {
+            // 只剩刚放入的模型且它本身超出预算：不缓存
+            auto kept = m_cache.find(keep);
+            if (kept != m_cache.end() && kept->second.model) {
+                removeCacheEntryLocked(kept);
+                ++m_stats.evictions;
+            }
+            break;
+        }
+        removeCacheEntryLocked(victim);
+        ++m_stats.evictions;
+    }
+}
+
+void ModelRegistry::removeCacheEntryLocked(std::map<std::string, CacheEntry>::iterator it) {
+    if (it->second.model) {
+        m_stats.cachedBytes -= it->second.bytes;
+    }
+    m_cache.erase(it);
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
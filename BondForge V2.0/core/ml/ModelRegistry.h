@@ -0,0 +1,199 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <filesystem>
+#include <cstdint>
+#include "MLModels.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 已登记的模型版本（字段对应模型版本表 ModelVersion）
+ */
+struct ModelVersionInfo {
+    std::string name;
+    uint32_t version = 0;                   // 同名模型内从1开始递增
+    std::string filePath;
+    ModelType modelType = ModelType::LinearRegression;
+    std::string description;
+    std::string createTime;                 // 登记时的本地时间 "YYYY-MM-DD HH:MM:SS"
+    std::map<std::string, double> metrics;  // 训练或评估指标
+    uint64_t fileBytes = 0;
+};
+
+/**
+ * @brief 模型注册表选项
+ */
+struct ModelRegistryOptions {
+    size_t memoryBudgetBytes = size_t(512) << 20;   // 缓存中已加载模型的总字节数上限
+};
+
+/**
+ * @brief 模型缓存统计
+ */
+struct ModelRegistryStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;            // 需要从文件加载的请求
+    uint64_t sharedLoads = 0;       // 等待其他线程正在进行的同一加载的请求
+    uint64_t reloads = 0;           // 文件在缓存后被改写而重新加载的次数（包含在 misses 中）
+    uint64_t loadFailures = 0;
+    uint64_t evictions = 0;
+    size_t cachedModels = 0;
+    size_t cachedBytes = 0;
+    size_t memoryBudgetBytes = 0;
+    double loadSeconds = 0.0;       // 加载模型文件的累计耗时
+
+    double hitRate() const {
+        uint64_t requests = hits + misses + sharedLoads;
+        return requests > 0 ? static_cast<double>(hits + sharedLoads) / static_cast<double>(requests) : 0.0;
+    }
+};
+
+/**
+ * @brief 模型注册表与已加载模型的缓存
+ *
+ * 注册表按名称登记模型文件的各个版本和元数据（描述、指标、登记时间），目录可以保存到文件并在启动时读回。
+ * 已加载的模型按文件路径缓存：同一文件的所有请求共享一个模型实例，多个线程同时请求尚未加载的
+ * 文件时只加载一次，其余线程等待同一加载结果。模型按文件大小计入内存预算（映射的文件内容在访问后
+ * 常驻内存），超出预算时按最近最少使用的顺序移出缓存；已被调用者持有的实例在其引用释放前仍然有效。
+ * 每次请求检查文件的修改时间，文件被改写后重新加载。
+ *
+ * 共享的实例只用于预测：调用者不能再训练或修改它（包括 setInferencePrecision），
+ * 需要修改时应另行通过 ModelFactory::loadModel() 加载一个副本。
+ * 所有方法都可以在多个线程中调用。
+ */
+class ModelRegistry {
+public:
+    explicit ModelRegistry(const ModelRegistryOptions& options = {});
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    /**
+     * @brief 全局模型注册表（默认选项）
+     */
+    static ModelRegistry& instance();
+
+    /**
+     * @brief 登记模型文件为新版本
+     *
+     * @param name 模型名称
+     * @param filePath 模型文件（必须是 ModelFactory::loadModel() 能识别的模型文件）
+     * @param description 版本描述
+     * @param metrics 训练或评估指标
+     * @return 新版本号（文件不是模型文件时返回0）
+     */
+    uint32_t registerFile(const std::string& name, const std::string& filePath,
+                          const std::string& description = "", const std::map<std::string, double>& metrics = {});
+
+    /**
+     * @brief 保存已训练的模型并登记为新版本，模型实例直接放入缓存
+     *
+     * @return 新版本号（保存失败时返回0）
+     */
+    uint32_t registerModel(const std::string& name, std::shared_ptr<IMLModel> model, const std::string& filePath,
+                           const std::string& description = "", const std::map<std::string, double>& metrics = {});
+
+    /**
+     * @brief 删除一个版本的登记（不删除模型文件）
+     */
+    bool removeVersion(const std::string& name, uint32_t version);
+
+    /**
+     * @brief 删除一个模型所有版本的登记
+     */
+    bool removeModel(const std::string& name);
+
+    std::vector<std::string> modelNames() const;
+
+    /**
+     * @brief 模型的所有版本（按版本号升序）
+     */
+    std::vector<ModelVersionInfo> listVersions(const std::string& name) const;
+
+    /**
+     * @brief 查询版本信息
+     *
+     * @param version 版本号（0表示最新版本）
+     * @return 版本是否存在
+     */
+    bool getVersion(const std::string& name, uint32_t version, ModelVersionInfo& info) const;
+
+    /**
+     * @brief 获取已登记版本的模型实例（未缓存时加载）
+     *
+     * @param version 版本号（0表示最新版本）
+     * @return 共享的模型实例（版本不存在或加载失败时返回空指针）
+     */
+    std::shared_ptr<IMLModel> getModel(const std::string& name, uint32_t version = 0);
+
+    /**
+     * @brief 获取模型文件的实例（不需要登记，未缓存时加载）
+     */
+    std::shared_ptr<IMLModel> loadFile(const std::string& filePath);
+
+    /**
+     * @brief 在线程池上并行加载模型的最新版本
+     *
+     * @param names 模型名称（空表示所有已登记的模型）
+     * @return 成功加载（或已在缓存中）的模型数
+     */
+    size_t preload(const std::vector<std::string>& names = {});
+
+    /**
+     * @brief 把版本目录保存到文件
+     */
+    bool saveCatalog(const std::string& filePath) const;
+
+    /**
+     * @brief 从文件读回版本目录（替换当前目录，缓存保留）
+     *
+     * @param filePath 目录文件
+     * @param preloadModels 读回后是否预加载所有模型的最新版本（启动时使用）
+     * @return 是否成功
+     */
+    bool loadCatalog(const std::string& filePath, bool preloadModels = false);
+
+    /**
+     * @brief 清空缓存（登记不变）
+     */
+    void evictAll();
+
+    void setMemoryBudget(size_t bytes);
+
+    ModelRegistryStats stats() const;
+
+private:
+    struct CacheEntry {
+        std::shared_ptr<IMLModel> model;                            // 加载完成前为空
+        std::shared_future<std::shared_ptr<IMLModel>> loading;      // 正在进行的加载
+        std::filesystem::file_time_type fileTime;
+        size_t bytes = 0;
+        uint64_t lastUsed = 0;
+        uint64_t loadId = 0;                                        // 创建该条目的加载
+    };
+
+    bool findVersionLocked(const std::string& name, uint32_t version, ModelVersionInfo& info) const;
+    uint32_t addVersionLocked(ModelVersionInfo info);
+    void enforceBudgetLocked(const std::string& keep);
+    void removeCacheEntryLocked(std::map<std::string, CacheEntry>::iterator it);
+
+    ModelRegistryOptions m_options;
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::vector<ModelVersionInfo>> m_catalog;
+    std::map<std::string, CacheEntry> m_cache;
+    uint64_t m_clock = 0;
+    ModelRegistryStats m_stats;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,398 @@
+#include "ModelSelection.h"
+#include "ModelCommon.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr size_t kLayoutGrainRows = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+std::string formatParameters(const std::map<std::string, double>& parameters) {
+    std::ostringstream stream;
+    bool first = true;
+    for (const auto& item : parameters) {
+        stream << (first ? "" : ", ") << item.first << "=" << item.second;
+        first = false;
+    }
+    return first ? std::string("(defaults)") : stream.str();
+}
+
+} // namespace
+
+std::vector<std::map<std::string, double>> ModelSelection::expandGrid(const ParameterGrid& grid) {
+    std::vector<std::map<std::string, double>> combinations(1);
+    for (const auto& axis : grid) {
+        if (axis.second.empty()) {
+            continue;
+        }
+        std::vector<std::map<std::string, double>> expanded;
+        expanded.reserve(combinations.size() * axis.second.size());
+        for (const auto& partial : combinations) {
+            for (double value : axis.second) {
+                expanded.push_back(partial);
+                expanded.back()[axis.first] = value;
+            }
+        }
+        combinations = std::move(expanded);
+    }
+    return combinations;
+}
+
+std::vector<std::map<std::string, double>> ModelSelection::sampleParameters(
+    const std::map<std::string, ParameterRange>& ranges, size_t count, uint64_t seed) {
+    
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<std::map<std::string, double>> samples(count);
+    for (auto& sample : samples) {
+        for (const auto& item : ranges) {
+            const ParameterRange& range = item.second;
+            double u = unit(rng);
+            double value;
+            if (range.logScale && range.low > 0.0 && range.high > 0.0) {
+                value = std::exp(std::log(range.low) + u * (std::log(range.high) - std::log(range.low)));
+            } else {
+                value = range.low + u * (range.high - range.low);
+            }
+            if (range.integer) {
+                value = std::min(std::floor(range.high), std::max(std::ceil(range.low), std::round(value)));
+            }
+            sample[item.first] = value;
+        }
+    }
+    return samples;
+}
+
+SearchReport ModelSelection::crossValidate(
+    ModelType type,
+    const ConstMatrixView& data,
+    const std::vector<double>& labels,
+    const std::map<std::string, double>& parameters,
+    const CrossValidationOptions& options) {
+    
+    return search(type, data, labels, {parameters}, options);
+}
+
+SearchReport ModelSelection::search(
+    ModelType type,
+    const ConstMatrixView& data,
+    const std::vector<double>& labels,
+    const std::vector<std::map<std::string, double>>& candidates,
+    const CrossValidationOptions& options) {
+    
+    Clock::time_point searchStart = Clock::now();
+    SearchReport report;
+    const size_t n = data.rows();
+    const size_t k = options.folds;
+    
+    if (type == ModelType::KMeans || type == ModelType::TimeSeries) {
+        report.errorMessage = "Model type does not support cross-validation";
+        return report;
+    }
+    if (candidates.empty()) {
+        report.errorMessage = "No parameter candidates";
+        return report;
+    }
+    if (data.empty() || labels.size() != n) {
+        report.errorMessage = "Label count does not match sample count";
+        return report;
+    }
+    if (k < 2 || k > n) {
+        report.errorMessage = "Fold count must be between 2 and the sample count";
+        return report;
+    }
+    
+    // 划分折：打乱后（分层时先按类别稳定排序再轮流发牌）得到每一折的样本，按折顺序拼接
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    if (options.shuffle) {
+        std::mt19937_64 rng(options.seed);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+    
+    bool stratify = options.stratified && options.scoring != ScoringMetric::NegativeMeanSquaredError &&
+        (options.scoring == ScoringMetric::Accuracy || predictsClasses(type, candidates.front()));
+    std::vector<size_t> permutation;
+    std::vector<size_t> foldBegin(k + 1, 0);
+    if (stratify) {
+        std::stable_sort(order.begin(), order.end(), [&labels](size_t a, size_t b) { return labels[a] < labels[b]; });
+        std::vector<std::vector<size_t>> foldRows(k);
+        for (size_t j = 0; j < n; ++j) {
+            foldRows[j % k].push_back(order[j]);
+        }
+        permutation.reserve(n);
+        for (size_t f = 0; f < k; ++f) {
+            foldBegin[f] = permutation.size();
+            permutation.insert(permutation.end(), foldRows[f].begin(), foldRows[f].end());
+        }
+        foldBegin[k] = n;
+    } else {
+        permutation = std::move(order);
+        for (size_t f = 0; f <= k; ++f) {
+            foldBegin[f] = n * f / k;
+        }
+    }
+    
+    // 重排后的数据之后再接上前 n - 最后一折大小 行：第 f 折的训练集是验证集之后环绕的连续 n - 折大小 行，
+    // 最后一折的训练集恰好结束于第 n + foldBegin[k - 1] 行。
+    // 不打乱也不分层时折就是原数据的连续行段：验证集和首末两折的训练集直接取原数据的行视图，
+    // 只复制中间各折的训练集用到的 [foldBegin[2], n + foldBegin[k - 2]) 行
+    auto& pool = Utils::ThreadPool::instance();
+    const size_t p = data.cols();
+    const bool inPlace = !options.shuffle && !stratify;
+    size_t firstRow = 0;
+    size_t wrapRows = foldBegin[k - 1];
+    if (inPlace) {
+        firstRow = k > 2 ? foldBegin[2] : n;
+        wrapRows = k > 2 ? foldBegin[k - 2] : 0;
+    }
+    Matrix layout(n + wrapRows - firstRow, p);
+    pool.parallelFor(firstRow, n + wrapRows, kLayoutGrainRows, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const double* source = data.row(permutation[i % n]);
+            std::copy(source, source + p, layout.row(i - firstRow));
+        }
+    });
+    std::vector<double> orderedLabels;
+    if (!inPlace) {
+        orderedLabels.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            orderedLabels[i] = labels[permutation[i]];
+        }
+    }
+    const double* foldLabels = inPlace ? labels.data() : orderedLabels.data();
+    
+    auto trainView = [&](size_t f) -> ConstMatrixView {
+        size_t trainBegin = foldBegin[f + 1];
+        size_t trainRows = n - (foldBegin[f + 1] - foldBegin[f]);
+        if (inPlace && f == 0) {
+            return data.rowRange(trainBegin, n);
+        }
+        if (inPlace && f + 1 == k) {
+            return data.rowRange(0, trainRows);
+        }
+        return layout.view().rowRange(trainBegin - firstRow, trainBegin - firstRow + trainRows);
+    };
+    auto testView = [&](size_t f) -> ConstMatrixView {
+        return inPlace ? data.rowRange(foldBegin[f], foldBegin[f + 1])
+                       : layout.view().rowRange(foldBegin[f], foldBegin[f + 1]);
+    };
+    
+    // 每一折的训练标签复制一份（train() 需要连续的标签数组），在所有候选间共用
+    std::vector<std::vector<double>> foldTrainLabels(k);
+    for (size_t f = 0; f < k; ++f) {
+        size_t trainBegin = foldBegin[f + 1];
+        size_t trainRows = n - (foldBegin[f + 1] - foldBegin[f]);
+        size_t headRows = std::min(trainRows, n - trainBegin);
+        foldTrainLabels[f].assign(foldLabels + trainBegin, foldLabels + trainBegin + headRows);
+        foldTrainLabels[f].insert(foldTrainLabels[f].end(), foldLabels, foldLabels + (trainRows - headRows));
+    }
+    
+    const size_t numCandidates = candidates.size();
+    std::vector<FoldResult> slots(numCandidates * k);
+    std::vector<uint8_t> completed(numCandidates * k, 0);
+    
+    auto runTask = [&](size_t c, size_t f) {
+        FoldResult& slot = slots[c * k + f];
+        slot.fold = f;
+        size_t testBegin = foldBegin[f];
+        size_t testRows = foldBegin[f + 1] - foldBegin[f];
+        
+        ScoringMetric metric = options.scoring;
+        if (metric == ScoringMetric::Auto) {
+            metric = predictsClasses(type, candidates[c]) ? ScoringMetric::Accuracy : ScoringMetric::NegativeMeanSquaredError;
+        }
+        
+        try {
+            std::unique_ptr<IMLModel> model = ModelFactory::createModel(type);
+            Clock::time_point start = Clock::now();
+            slot.training = model->train(trainView(f), foldTrainLabels[f], candidates[c]);
+            slot.trainSeconds = secondsSince(start);
+            if (slot.training.success) {
+                start = Clock::now();
+                std::vector<double> predictions = model->predict(testView(f));
+                slot.predictSeconds = secondsSince(start);
+                slot.score = scorePredictions(metric, predictions, foldLabels + testBegin, testRows);
+                slot.success = true;
+            }
+        } catch (const std::exception& e) {
+            // 错误只写入本任务的结果，同一候选的多折可能同时失败
+            slot.training.success = false;
+            slot.training.errorMessage = e.what();
+        }
+        completed[c * k + f] = 1;
+    };
+    
+    auto failed = [&](size_t c) {
+        for (size_t f = 0; f < k; ++f) {
+            if (completed[c * k + f] && !slots[c * k + f].success) {
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    std::vector<uint8_t> terminated(numCandidates, 0);
+    if (options.keepFraction >= 1.0) {
+        // 不淘汰：所有（候选, 折）一次性并发
+        pool.parallelFor(0, numCandidates * k, 1, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                runTask(t / k, t % k);
+            }
+        });
+    } else {
+        // 按折分轮，每轮结束后淘汰平均分靠后的候选
+        std::vector<size_t> alive(numCandidates);
+        std::iota(alive.begin(), alive.end(), 0);
+        for (size_t f = 0; f < k && !alive.empty(); ++f) {
+            pool.parallelFor(0, alive.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t a = begin; a < end; ++a) {
+                    runTask(alive[a], f);
+                }
+            });
+            
+            std::vector<std::pair<double, size_t>> ranking;
+            for (size_t c : alive) {
+                if (failed(c)) {
+                    terminated[c] = 1;
+                    continue;
+                }
+                double sum = 0.0;
+                for (size_t g = 0; g <= f; ++g) {
+                    sum += slots[c * k + g].score;
+                }
+                ranking.emplace_back(sum / static_cast<double>(f + 1), c);
+            }
+            std::stable_sort(ranking.begin(), ranking.end(),
+                [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.first > b.first; });
+            
+            size_t keep = ranking.size();
+            if (f + 1 < k) {
+                keep = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::max(0.0, options.keepFraction) * ranking.size())));
+                keep = std::min(keep, ranking.size());
+            }
+            alive.clear();
+            for (size_t r = 0; r < ranking.size(); ++r) {
+                if (r < keep) {
+                    alive.push_back(ranking[r].second);
+                } else {
+                    terminated[ranking[r].second] = 1;
+                }
+            }
+        }
+    }
+    
+    // 汇总每个候选
+    report.candidates.resize(numCandidates);
+    for (size_t c = 0; c < numCandidates; ++c) {
+        CandidateResult& candidate = report.candidates[c];
+        candidate.parameters = candidates[c];
+        candidate.terminated = terminated[c] || failed(c);
+        for (size_t f = 0; f < k; ++f) {
+            if (completed[c * k + f]) {
+                candidate.folds.push_back(slots[c * k + f]);
+                if (!slots[c * k + f].success && candidate.errorMessage.empty()) {
+                    candidate.errorMessage = slots[c * k + f].training.errorMessage;
+                }
+            }
+        }
+        
+        size_t count = 0;
+        double sum = 0.0;
+        for (const FoldResult& fold : candidate.folds) {
+            if (fold.success) {
+                sum += fold.score;
+                ++count;
+            }
+        }
+        candidate.meanScore = count > 0 ? sum / static_cast<double>(count) : -std::numeric_limits<double>::infinity();
+        double squares = 0.0;
+        for (const FoldResult& fold : candidate.folds) {
+            if (fold.success) {
+                squares += (fold.score - candidate.meanScore) * (fold.score - candidate.meanScore);
+            }
+        }
+        candidate.stdScore = count > 1 ? std::sqrt(squares / static_cast<double>(count)) : 0.0;
+    }
+    
+    // 排名：完整评估的候选按平均分，被淘汰的按完成的折数和平均分排在其后
+    std::vector<size_t> ranking(numCandidates);
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::stable_sort(ranking.begin(), ranking.end(), [&report](size_t a, size_t b) {
+        const CandidateResult& x = report.candidates[a];
+        const CandidateResult& y = report.candidates[b];
+        if (x.terminated != y.terminated) {
+            return !x.terminated;
+        }
+        if (x.folds.size() != y.folds.size()) {
+            return x.folds.size() > y.folds.size();
+        }
+        return x.meanScore > y.meanScore;
+    });
+    for (size_t r = 0; r < ranking.size(); ++r) {
+        report.candidates[ranking[r]].rank = r + 1;
+    }
+    
+    report.bestIndex = ranking.front();
+    report.success = !report.best().terminated;
+    if (!report.success) {
+        report.errorMessage = report.best().errorMessage.empty() ?
+            std::string("No candidate completed all folds") : report.best().errorMessage;
+    }
+    report.totalSeconds = secondsSince(searchStart);
+    return report;
+}
+
+std::string SearchReport::formatTable() const {
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return candidates[a].rank < candidates[b].rank; });
+    
+    std::ostringstream stream;
+    stream << std::left << std::setw(6) << "Rank" << std::setw(40) << "Parameters"
+           << std::setw(24) << "Score (mean +/- std)" << "Folds: score (train s / predict s)\n";
+    stream << std::fixed;
+    for (size_t index : order) {
+        const CandidateResult& candidate = candidates[index];
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(4) << candidate.meanScore << " +/- " << candidate.stdScore;
+        
+        stream << std::setw(6) << candidate.rank << std::setw(40) << formatParameters(candidate.parameters)
+               << std::setw(24) << summary.str();
+        for (const FoldResult& fold : candidate.folds) {
+            stream << "  [" << fold.fold << "] ";
+            if (fold.success) {
+                stream << std::setprecision(4) << fold.score;
+            } else {
+                stream << "failed";
+            }
+            stream << " (" << std::setprecision(3) << fold.trainSeconds << " / " << fold.predictSeconds << ")";
+        }
+        if (candidate.terminated) {
+            stream << "  terminated";
+            if (!candidate.errorMessage.empty()) {
+                stream << ": " << candidate.errorMessage;
+            }
+        }
+        stream << "\n";
+    }
+    stream << "Total: " << std::setprecision(3) << totalSeconds << " s\n";
+    return stream.str();
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "MLModels.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 网格搜索的参数取值表（参数名 → 候选取值）
+ */
+using ParameterGrid = std::map<std::string, std::vector<double>>;
+
+/**
+ * @brief 随机搜索中一个参数的取值范围
+ */
+struct ParameterRange {
+    double low = 0.0;
+    double high = 1.0;
+    bool logScale = false;      // 在对数尺度上均匀采样（如学习率、正则系数）
+    bool integer = false;       // 取整（如树的数量、深度）
+};
+
+/**
+ * @brief 交叉验证的评分方式（分数越大越好）
+ */
+enum class ScoringMetric {
+    Auto,                       // 分类模型用准确率，回归模型用负均方误差
+    Accuracy,
+    NegativeMeanSquaredError
+};
+
+/**
+ * @brief 交叉验证与超参数搜索选项
+ */
+struct CrossValidationOptions {
+    size_t folds = 5;
+    bool shuffle = true;
+    bool stratified = true;     // 分类评分时按类别分层划分
+    uint64_t seed = 42;
+    ScoringMetric scoring = ScoringMetric::Auto;
+    
+    /**
+     * @brief 提前淘汰：每完成一折后只保留按平均分排名前这一比例的候选（1表示不淘汰）
+     */
+    double keepFraction = 1.0;
+};
+
+/**
+ * @brief 一个候选在一折上的结果
+ */
+struct FoldResult {
+    size_t fold = 0;
+    bool success = false;
+    double score = 0.0;
+    double trainSeconds = 0.0;
+    double predictSeconds = 0.0;
+    TrainingResult training;
+};
+
+/**
+ * @brief 一组参数的交叉验证结果
+ */
+struct CandidateResult {
+    std::map<std::string, double> parameters;
+    std::vector<FoldResult> folds;      // 已完成的折（按折序号）
+    double meanScore = 0.0;
+    double stdScore = 0.0;
+    bool terminated = false;            // 被提前淘汰或某一折训练失败
+    size_t rank = 0;                    // 1 为最好；被淘汰的候选排在完整评估的候选之后
+    std::string errorMessage;
+};
+
+/**
+ * @brief 交叉验证 / 超参数搜索的结果表
+ */
+struct SearchReport {
+    bool success = false;
+    std::string errorMessage;
+    std::vector<CandidateResult> candidates;    // 与输入候选的顺序一致
+    size_t bestIndex = 0;
+    double totalSeconds = 0.0;
+    
+    /**
+     * @brief 最好的候选
+     */
+    const CandidateResult& best() const { return candidates[bestIndex]; }
+    
+    /**
+     * @brief 格式化为文本表（每个候选一行：排名、参数、平均分±标准差、每折的分数和耗时）
+     */
+    std::string formatTable() const;
+};
+
+/**
+ * @brief 交叉验证与网格/随机超参数搜索
+ * 
+ * 特征矩阵按（打乱、分层后的）折顺序只重排一次，其后再接上开头的 n - 最后一折大小 行：
+ * 这样每一折的验证集是连续的一段行，训练集是紧接其后、长度为 n - 折大小 的连续一段（环绕到开头的副本），
+ * 所有候选和所有折都只取这份数据的行视图。特征的额外内存约为数据的两倍，与折数和候选数无关；
+ * 不打乱也不分层时不重排：验证集和首末两折的训练集直接取传入数据的行视图，
+ * 只有中间各折的训练集（环绕到开头）需要复制，两折时不复制特征。
+ * 标签较小，每一折的训练标签各复制一份。
+ * 
+ * 所有（候选, 折）任务在共享线程池上并发执行，模型内部的并行循环嵌套在同一个线程池上。
+ * 启用提前淘汰时按折分轮执行，每轮结束后淘汰平均分靠后的候选。
+ */
+class ModelSelection {
+public:
+    /**
+     * @brief 展开参数网格为所有取值组合
+     */
+    static std::vector<std::map<std::string, double>> expandGrid(const ParameterGrid& grid);
+    
+    /**
+     * @brief 在参数范围内随机采样若干组参数
+     */
+    static std::vector<std::map<std::string, double>> sampleParameters(
+        const std::map<std::string, ParameterRange>& ranges, size_t count, uint64_t seed = 42);
+    
+    /**
+     * @brief 对一组参数做 k 折交叉验证
+     */
+    static SearchReport crossValidate(
+        ModelType type,
+        const ConstMatrixView& data,
+        const std::vector<double>& labels,
+        const std::map<std::string, double>& parameters = {},
+        const CrossValidationOptions& options = {});
+    
+    /**
+     * @brief 对多组参数做 k 折交叉验证并排名
+     * 
+     * @param type 模型类型（K均值和时间序列不支持）
+     * @param data 特征矩阵（每行一个样本）
+     * @param labels 标签
+     * @param candidates 候选参数组（通常来自 expandGrid 或 sampleParameters）
+     * @param options 交叉验证选项
+     * @return 结果表
+     */
+    static SearchReport search(
+        ModelType type,
+        const ConstMatrixView& data,
+        const std::vector<double>& labels,
+        const std::vector<std::map<std::string, double>>& candidates,
+        const CrossValidationOptions& options = {});
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
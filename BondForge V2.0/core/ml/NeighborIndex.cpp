@@ -0,0 +1,836 @@
+#include "NeighborIndex.h"
+#include "SparseFeatures.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kConfigTag = sectionTag("HNCF");
+constexpr uint32_t kVectorTag = sectionTag("HNVC");
+constexpr uint32_t kLabelTag = sectionTag("HNLB");
+constexpr uint32_t kLevelTag = sectionTag("HNLV");
+constexpr uint32_t kLevel0Tag = sectionTag("HNL0");
+constexpr uint32_t kUpperTag = sectionTag("HNUP");
+constexpr uint32_t kUpperOffsetTag = sectionTag("HNUO");
+
+// 配置节：空间种类、度量、维数/位数、M、efConstruction、efSearch、种子、节点数、入口点、最高层+1
+constexpr size_t kConfigCount = 10;
+
+// M 的上限（邻居表按 uint32_t 计数，层数按 uint8_t 保存）
+constexpr size_t kMaxLinksLimit = 4096;
+
+float squaredDistance(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; i + 4 <= n; i += 4) {
+        float d0 = a[i] - b[i];
+        float d1 = a[i + 1] - b[i + 1];
+        float d2 = a[i + 2] - b[i + 2];
+        float d3 = a[i + 3] - b[i + 3];
+        acc[0] += d0 * d0;
+        acc[1] += d1 * d1;
+        acc[2] += d2 * d2;
+        acc[3] += d3 * d3;
+    }
+    float sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+float dotProduct(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += a[i] * b[i];
+        acc[1] += a[i + 1] * b[i + 1];
+        acc[2] += a[i + 2] * b[i + 2];
+        acc[3] += a[i + 3] * b[i + 3];
+    }
+    float sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+uint64_t mixBits(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief 每个线程的已访问标记
+ *
+ * 每次搜索递增序号，标记等于当前序号的节点已访问，因此不需要每次清零。
+ */
+struct VisitedMarks {
+    std::vector<uint32_t> marks;
+    uint32_t epoch = 0;
+
+    void reset(size_t count) {
+        if (marks.size() < count) {
+            marks.resize(count, 0);
+        }
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    bool visit(uint32_t node) {
+        if (marks[node] == epoch) {
+            return false;
+        }
+        marks[node] = epoch;
+        return true;
+    }
+};
+
+thread_local VisitedMarks t_visited;
+
+double elapsedMicros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// DenseVectorSpace 实现
+void DenseVectorSpace::encode(const double* input, float* output) const {
+    double squaredNorm = 0.0;
+    for (size_t i = 0; i < dimension; ++i) {
+        squaredNorm += input[i] * input[i];
+    }
+
+    double scale = 1.0;
+    if (metric == NeighborMetric::Cosine && squaredNorm > 0.0) {
+        scale = 1.0 / std::sqrt(squaredNorm);
+    }
+    for (size_t i = 0; i < dimension; ++i) {
+        output[i] = static_cast<float>(input[i] * scale);
+    }
+}
+
+float DenseVectorSpace::distance(const float* a, const float* b) const {
+    if (metric == NeighborMetric::Cosine) {
+        return 1.0f - dotProduct(a, b, dimension);
+    }
+    return squaredDistance(a, b, dimension);
+}
+
+double DenseVectorSpace::reportedDistance(float distance) const {
+    if (metric == NeighborMetric::Euclidean) {
+        return std::sqrt(std::max(0.0, static_cast<double>(distance)));
+    }
+    return distance;
+}
+
+// FingerprintSpace 实现
+void FingerprintSpace::encode(const uint64_t* input, uint64_t* output) const {
+    size_t words = elementCount();
+    std::copy(input, input + words, output);
+    if (bits % 64 != 0) {
+        output[words - 1] &= (uint64_t(1) << (bits % 64)) - 1;
+    }
+}
+
+float FingerprintSpace::distance(const uint64_t* a, const uint64_t* b) const {
+    size_t words = elementCount();
+    if (metric == NeighborMetric::Hamming) {
+        return static_cast<float>(hammingDistance(a, b, words));
+    }
+
+    size_t common = intersectionCount(a, b, words);
+    size_t either = unionCount(a, b, words);
+    // 两个空指纹视为相同
+    return either == 0 ? 0.0f : 1.0f - static_cast<float>(common) / static_cast<float>(either);
+}
+
+// HnswIndex 实现
+template <typename Space>
+HnswIndex<Space>::HnswIndex(const Space& space, const HnswOptions& options)
+    : m_space(space),
+      m_options(options),
+      m_linkLocks(new std::mutex[kLinkLockCount]) {
+    m_options.maxLinks = std::min(std::max<size_t>(m_options.maxLinks, 2), kMaxLinksLimit);
+    m_options.efConstruction = std::max(m_options.efConstruction, m_options.maxLinks);
+    m_options.efSearch = std::max<size_t>(m_options.efSearch, 1);
+    m_elementCount = m_space.elementCount();
+    m_maxLinks0 = 2 * m_options.maxLinks;
+    m_levelFactor = 1.0 / std::log(static_cast<double>(m_options.maxLinks));
+}
+
+template <typename Space>
+void HnswIndex<Space>::reserve(size_t capacity) {
+    std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+    if (capacity > m_capacity || m_vectors.isMapped()) {
+        growLocked(std::max(capacity, m_capacity));
+    }
+}
+
+template <typename Space>
+bool HnswIndex<Space>::add(uint64_t label, const Input* vector) {
+    if (!m_space.valid()) {
+        return false;
+    }
+
+    for (;;) {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_storageMutex);
+            if (!m_vectors.isMapped()) {
+                size_t node = m_size.load(std::memory_order_relaxed);
+                while (node < m_capacity &&
+                       !m_size.compare_exchange_weak(node, node + 1, std::memory_order_acq_rel)) {
+                }
+                if (node < m_capacity) {
+                    insertLocked(static_cast<uint32_t>(node), label, vector);
+                    return true;
+                }
+            }
+        }
+        ensureCapacity(size() + 1);
+    }
+}
+
+template <typename Space>
+size_t HnswIndex<Space>::addBatch(const uint64_t* labels, const Input* vectors, size_t count, size_t stride) {
+    if (!m_space.valid() || count == 0) {
+        return 0;
+    }
+    if (stride == 0) {
+        stride = m_space.inputSize();
+    }
+
+    uint64_t firstLabel = size();
+    ensureCapacity(size() + count);
+
+    Utils::ThreadPool::instance().parallelFor(0, count, 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            add(labels != nullptr ? labels[i] : firstLabel + i, vectors + i * stride);
+        }
+    });
+    return count;
+}
+
+template <typename Space>
+std::vector<Neighbor> HnswIndex<Space>::search(const Input* query, size_t k, size_t ef) const {
+    std::vector<Neighbor> neighbors;
+    if (k == 0 || !m_space.valid()) {
+        return neighbors;
+    }
+
+    std::vector<Element> encoded(m_elementCount);
+    m_space.encode(query, encoded.data());
+
+    std::shared_lock<std::shared_mutex> lock(m_storageMutex);
+    uint32_t entry;
+    int maxLevel;
+    {
+        std::lock_guard<std::mutex> entryLock(m_entryMutex);
+        entry = m_entryPoint;
+        maxLevel = m_maxLevel;
+    }
+    if (entry == kNoNode) {
+        return neighbors;
+    }
+
+    entry = greedyDescend(encoded.data(), entry, maxLevel, 0);
+    std::vector<Candidate> candidates = searchLayer(encoded.data(), entry,
+                                                    std::max(ef > 0 ? ef : m_options.efSearch, k), 0);
+
+    size_t count = std::min(k, candidates.size());
+    neighbors.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Neighbor neighbor;
+        neighbor.label = m_labels[candidates[i].second];
+        neighbor.distance = m_space.reportedDistance(candidates[i].first);
+        neighbors.push_back(neighbor);
+    }
+    return neighbors;
+}
+
+template <typename Space>
+std::vector<std::vector<Neighbor>> HnswIndex<Space>::searchBatch(const Input* queries, size_t count, size_t k,
+                                                                 size_t ef, size_t stride) const {
+    if (stride == 0) {
+        stride = m_space.inputSize();
+    }
+
+    std::vector<std::vector<Neighbor>> results(count);
+    Utils::ThreadPool::instance().parallelFor(0, count, 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            results[i] = search(queries + i * stride, k, ef);
+        }
+    });
+    return results;
+}
+
+template <typename Space>
+std::vector<Neighbor> HnswIndex<Space>::exactSearch(const Input* query, size_t k) const {
+    if (k == 0 || !m_space.valid()) {
+        return {};
+    }
+
+    std::vector<Element> encoded(m_elementCount);
+    m_space.encode(query, encoded.data());
+
+    std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+    return exactSearchLocked(encoded.data(), k);
+}
+
+template <typename Space>
+NeighborBenchmarkReport HnswIndex<Space>::benchmark(const Input* queries, size_t count, size_t k,
+                                                    size_t ef, size_t stride) const {
+    NeighborBenchmarkReport report;
+    report.queries = count;
+    report.k = k;
+    report.ef = std::max(ef > 0 ? ef : m_options.efSearch, k);
+    if (count == 0 || k == 0 || !m_space.valid()) {
+        return report;
+    }
+    if (stride == 0) {
+        stride = m_space.inputSize();
+    }
+
+    // 精确结果：独占索引（保证没有插入到一半的节点），各查询在工作线程上单线程扫描
+    std::vector<std::vector<Neighbor>> exact(count);
+    std::vector<double> exactMicros(count, 0.0);
+    {
+        std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+        Utils::ThreadPool::instance().parallelFor(0, count, 1, [&](size_t begin, size_t end) {
+            std::vector<Element> encoded(m_elementCount);
+            for (size_t i = begin; i < end; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                m_space.encode(queries + i * stride, encoded.data());
+                exact[i] = exactSearchLocked(encoded.data(), k);
+                exactMicros[i] = elapsedMicros(start);
+            }
+        });
+    }
+
+    // 近似查询逐个计时；距离相同的近邻可以互换，因此按精确第k近邻的距离判断是否命中
+    std::vector<double> micros(count, 0.0);
+    size_t expected = 0;
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Neighbor> approximate = search(queries + i * stride, k, ef);
+        micros[i] = elapsedMicros(start);
+
+        if (exact[i].empty()) {
+            continue;
+        }
+        double threshold = exact[i].back().distance;
+        threshold += 1e-6 * std::max(1.0, std::abs(threshold));
+        size_t hits = static_cast<size_t>(std::count_if(approximate.begin(), approximate.end(),
+            [threshold](const Neighbor& neighbor) { return neighbor.distance <= threshold; }));
+        expected += exact[i].size();
+        found += std::min(hits, exact[i].size());
+    }
+
+    report.recall = expected > 0 ? static_cast<double>(found) / static_cast<double>(expected) : 1.0;
+    for (size_t i = 0; i < count; ++i) {
+        report.meanLatencyMicros += micros[i];
+        report.exactMeanLatencyMicros += exactMicros[i];
+    }
+    report.meanLatencyMicros /= static_cast<double>(count);
+    report.exactMeanLatencyMicros /= static_cast<double>(count);
+    std::sort(micros.begin(), micros.end());
+    report.p50LatencyMicros = micros[count / 2];
+    report.p99LatencyMicros = micros[std::min(count - 1, count * 99 / 100)];
+    report.speedup = report.meanLatencyMicros > 0.0 ? report.exactMeanLatencyMicros / report.meanLatencyMicros : 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    searchBatch(queries, count, k, ef, stride);
+    double seconds = elapsedMicros(start) * 1e-6;
+    report.queriesPerSecond = seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+    return report;
+}
+
+template <typename Space>
+bool HnswIndex<Space>::save(const std::string& filePath) const {
+    std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+    size_t count = m_size.load(std::memory_order_acquire);
+    uint32_t entry;
+    int maxLevel;
+    {
+        std::lock_guard<std::mutex> entryLock(m_entryMutex);
+        entry = m_entryPoint;
+        maxLevel = m_maxLevel;
+    }
+
+    // 上层邻居按节点顺序连续保存
+    size_t upperStride = m_options.maxLinks + 1;
+    std::vector<uint64_t> upperOffsets(count);
+    std::vector<uint32_t> upperLinks;
+    for (size_t node = 0; node < count; ++node) {
+        upperOffsets[node] = upperLinks.size();
+        int level = m_levels[node];
+        if (level > 0) {
+            const uint32_t* links = linksAt(static_cast<uint32_t>(node), 1);
+            upperLinks.insert(upperLinks.end(), links, links + size_t(level) * upperStride);
+        }
+    }
+
+    uint64_t config[kConfigCount] = {
+        Space::kKind,
+        static_cast<uint64_t>(m_space.metric),
+        m_space.width(),
+        m_options.maxLinks,
+        m_options.efConstruction,
+        m_options.efSearch,
+        m_options.seed,
+        count,
+        entry,
+        static_cast<uint64_t>(maxLevel + 1)
+    };
+
+    ModelFileWriter writer(ModelFileContent::NeighborIndex);
+    writer.addArray(kConfigTag, config, kConfigCount);
+    writer.addArray(kVectorTag, m_vectors.data(), count * m_elementCount);
+    writer.addArray(kLabelTag, m_labels.data(), count);
+    writer.addArray(kLevelTag, m_levels.data(), count);
+    writer.addArray(kLevel0Tag, m_level0Links.data(), count * (m_maxLinks0 + 1));
+    writer.addArray(kUpperTag, upperLinks);
+    writer.addArray(kUpperOffsetTag, upperOffsets);
+    return writer.write(filePath);
+}
+
+template <typename Space>
+bool HnswIndex<Space>::load(const std::string& filePath) {
+    std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath, ModelFileContent::NeighborIndex);
+    if (!file) {
+        return false;
+    }
+
+    ModelSection<uint64_t> config = file->section<uint64_t>(kConfigTag);
+    if (!config.valid || config.count != kConfigCount || config.data[0] != Space::kKind ||
+        config.data[1] > static_cast<uint64_t>(NeighborMetric::Hamming) ||
+        config.data[3] < 2 || config.data[3] > kMaxLinksLimit || config.data[7] >= kNoNode ||
+        config.data[9] > static_cast<uint64_t>(kMaxLevel) + 1) {
+        return false;
+    }
+
+    Space space(static_cast<size_t>(config.data[2]), static_cast<NeighborMetric>(config.data[1]));
+    HnswOptions options;
+    options.maxLinks = static_cast<size_t>(config.data[3]);
+    options.efConstruction = static_cast<size_t>(config.data[4]);
+    options.efSearch = static_cast<size_t>(config.data[5]);
+    options.seed = config.data[6];
+    size_t count = static_cast<size_t>(config.data[7]);
+    uint64_t entry = config.data[8];
+    int maxLevel = static_cast<int>(config.data[9]) - 1;
+    if (!space.valid() || (count == 0 ? entry != kNoNode : entry >= count)) {
+        return false;
+    }
+
+    size_t elementCount = space.elementCount();
+    size_t level0Stride = 2 * options.maxLinks + 1;
+    size_t upperStride = options.maxLinks + 1;
+    ModelSection<Element> vectors = file->section<Element>(kVectorTag);
+    ModelSection<uint64_t> labels = file->section<uint64_t>(kLabelTag);
+    ModelSection<uint8_t> levels = file->section<uint8_t>(kLevelTag);
+    ModelSection<uint32_t> level0Links = file->section<uint32_t>(kLevel0Tag);
+    ModelSection<uint32_t> upperLinks = file->section<uint32_t>(kUpperTag);
+    ModelSection<uint64_t> upperOffsets = file->section<uint64_t>(kUpperOffsetTag);
+    if (!vectors.valid || !labels.valid || !levels.valid || !level0Links.valid || !upperLinks.valid ||
+        !upperOffsets.valid || vectors.count != count * elementCount || labels.count != count ||
+        levels.count != count || level0Links.count != count * level0Stride || upperOffsets.count != count) {
+        return false;
+    }
+
+    // 校验层数、偏移和邻居编号，损坏或不一致的图不会在查询时越界
+    for (size_t node = 0; node < count; ++node) {
+        int level = levels.data[node];
+        if (level > maxLevel || upperOffsets.data[node] > upperLinks.count ||
+            size_t(level) * upperStride > upperLinks.count - upperOffsets.data[node]) {
+            return false;
+        }
+        for (int l = 0; l <= level; ++l) {
+            const uint32_t* links = l == 0 ? level0Links.data + node * level0Stride
+                                           : upperLinks.data + upperOffsets.data[node] + size_t(l - 1) * upperStride;
+            size_t capacity = l == 0 ? level0Stride - 1 : upperStride - 1;
+            if (links[0] > capacity) {
+                return false;
+            }
+            for (uint32_t i = 1; i <= links[0]; ++i) {
+                if (links[i] >= count || levels.data[links[i]] < l) {
+                    return false;
+                }
+            }
+        }
+    }
+    if (count > 0 && levels.data[entry] != maxLevel) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+    m_space = space;
+    m_options = options;
+    m_elementCount = elementCount;
+    m_maxLinks0 = 2 * options.maxLinks;
+    m_levelFactor = 1.0 / std::log(static_cast<double>(options.maxLinks));
+    m_vectors = ModelArray<Element>::mapped(vectors, file);
+    m_labels = ModelArray<uint64_t>::mapped(labels, file);
+    m_levels = ModelArray<uint8_t>::mapped(levels, file);
+    m_level0Links = ModelArray<uint32_t>::mapped(level0Links, file);
+    m_upperLinks.clear();
+    m_mappedUpperLinks = ModelArray<uint32_t>::mapped(upperLinks, file);
+    m_mappedUpperOffsets = ModelArray<uint64_t>::mapped(upperOffsets, file);
+    m_size.store(count, std::memory_order_release);
+    m_capacity = count;
+    {
+        std::lock_guard<std::mutex> entryLock(m_entryMutex);
+        m_entryPoint = static_cast<uint32_t>(entry);
+        m_maxLevel = maxLevel;
+    }
+    return true;
+}
+
+template <typename Space>
+bool HnswIndex<Space>::isMapped() const {
+    std::shared_lock<std::shared_mutex> lock(m_storageMutex);
+    return m_vectors.isMapped();
+}
+
+template <typename Space>
+const uint32_t* HnswIndex<Space>::linksAt(uint32_t node, int level) const {
+    if (level == 0) {
+        return m_level0Links.data() + size_t(node) * (m_maxLinks0 + 1);
+    }
+    size_t offset = size_t(level - 1) * (m_options.maxLinks + 1);
+    if (m_mappedUpperLinks.isMapped()) {
+        return m_mappedUpperLinks.data() + m_mappedUpperOffsets[node] + offset;
+    }
+    return m_upperLinks[node].data() + offset;
+}
+
+template <typename Space>
+uint32_t* HnswIndex<Space>::mutableLinksAt(uint32_t node, int level) {
+    if (level == 0) {
+        return m_level0Links.mutableVector().data() + size_t(node) * (m_maxLinks0 + 1);
+    }
+    return m_upperLinks[node].data() + size_t(level - 1) * (m_options.maxLinks + 1);
+}
+
+template <typename Space>
+int HnswIndex<Space>::randomLevel(uint32_t node) const {
+    // (0, 1] 上的均匀分布，层数服从参数为 1/ln(M) 的几何分布
+    uint64_t bits = mixBits(m_options.seed ^ mixBits(node));
+    double uniform = static_cast<double>((bits >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double level = -std::log(uniform) * m_levelFactor;
+    return static_cast<int>(std::min(level, static_cast<double>(kMaxLevel)));
+}
+
+template <typename Space>
+void HnswIndex<Space>::ensureCapacity(size_t count) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_storageMutex);
+        if (count <= m_capacity && !m_vectors.isMapped()) {
+            return;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_storageMutex);
+    if (count > m_capacity || m_vectors.isMapped()) {
+        growLocked(std::max({count, m_capacity + m_capacity / 2, size_t(1024)}));
+    }
+}
+
+template <typename Space>
+void HnswIndex<Space>::growLocked(size_t capacity) {
+    // 映射的内容在这里复制为自有数组
+    size_t count = m_size.load(std::memory_order_acquire);
+    if (m_mappedUpperLinks.isMapped()) {
+        m_upperLinks.assign(count, std::vector<uint32_t>());
+        size_t upperStride = m_options.maxLinks + 1;
+        for (size_t node = 0; node < count; ++node) {
+            int level = m_levels[node];
+            if (level > 0) {
+                const uint32_t* links = m_mappedUpperLinks.data() + m_mappedUpperOffsets[node];
+                m_upperLinks[node].assign(links, links + size_t(level) * upperStride);
+            }
+        }
+        m_mappedUpperLinks = std::vector<uint32_t>();
+        m_mappedUpperOffsets = std::vector<uint64_t>();
+    }
+
+    m_vectors.mutableVector().resize(capacity * m_elementCount);
+    m_labels.mutableVector().resize(capacity);
+    m_levels.mutableVector().resize(capacity);
+    m_level0Links.mutableVector().resize(capacity * (m_maxLinks0 + 1), 0);
+    m_upperLinks.resize(capacity);
+    m_capacity = capacity;
+}
+
+template <typename Space>
+void HnswIndex<Space>::insertLocked(uint32_t node, uint64_t label, const Input* vector) {
+    Element* slot = m_vectors.mutableVector().data() + size_t(node) * m_elementCount;
+    m_space.encode(vector, slot);
+    m_labels.mutableVector()[node] = label;
+    int level = randomLevel(node);
+    m_levels.mutableVector()[node] = static_cast<uint8_t>(level);
+    if (level > 0) {
+        m_upperLinks[node].assign(size_t(level) * (m_options.maxLinks + 1), 0);
+    }
+
+    // 新节点的层数超过当前最高层时持有入口锁直到插入结束，之后它成为新的入口点
+    std::unique_lock<std::mutex> entryLock(m_entryMutex);
+    if (m_entryPoint == kNoNode) {
+        m_entryPoint = node;
+        m_maxLevel = level;
+        return;
+    }
+    uint32_t entry = m_entryPoint;
+    int maxLevel = m_maxLevel;
+    if (level <= maxLevel) {
+        entryLock.unlock();
+    }
+
+    entry = greedyDescend(slot, entry, maxLevel, level);
+    for (int l = std::min(level, maxLevel); l >= 0; --l) {
+        std::vector<Candidate> candidates = searchLayer(slot, entry, m_options.efConstruction, l);
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [node](const Candidate& candidate) { return candidate.second == node; }),
+                         candidates.end());
+        if (candidates.empty()) {
+            continue;
+        }
+        entry = candidates.front().second;
+
+        selectNeighbors(candidates, m_options.maxLinks);
+        {
+            std::lock_guard<std::mutex> lock(linkLock(node));
+            uint32_t* links = mutableLinksAt(node, l);
+            links[0] = static_cast<uint32_t>(candidates.size());
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                links[1 + i] = candidates[i].second;
+            }
+        }
+        for (const Candidate& candidate : candidates) {
+            connect(candidate.second, node, l);
+        }
+    }
+
+    if (level > maxLevel) {
+        m_entryPoint = node;
+        m_maxLevel = level;
+    }
+}
+
+template <typename Space>
+void HnswIndex<Space>::copyLinks(uint32_t node, int level, std::vector<uint32_t>& out) const {
+    // 映射的索引只读，不需要加锁
+    if (m_vectors.isMapped()) {
+        const uint32_t* links = linksAt(node, level);
+        out.assign(links + 1, links + 1 + links[0]);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(linkLock(node));
+    const uint32_t* links = linksAt(node, level);
+    out.assign(links + 1, links + 1 + links[0]);
+}
+
+template <typename Space>
+uint32_t HnswIndex<Space>::greedyDescend(const Element* query, uint32_t entry, int fromLevel, int toLevel) const {
+    uint32_t current = entry;
+    float currentDistance = m_space.distance(query, vectorAt(current));
+    std::vector<uint32_t> links;
+    for (int level = fromLevel; level > toLevel; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            copyLinks(current, level, links);
+            for (uint32_t neighbor : links) {
+                float distance = m_space.distance(query, vectorAt(neighbor));
+                if (distance < currentDistance) {
+                    currentDistance = distance;
+                    current = neighbor;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+template <typename Space>
+std::vector<typename HnswIndex<Space>::Candidate> HnswIndex<Space>::searchLayer(
+    const Element* query, uint32_t entry, size_t ef, int level) const {
+    VisitedMarks& visited = t_visited;
+    visited.reset(m_capacity);
+
+    // frontier 为待扩展的候选（最近的在堆顶），results 为当前最近的 ef 个（最远的在堆顶）
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier;
+    std::priority_queue<Candidate> results;
+    float entryDistance = m_space.distance(query, vectorAt(entry));
+    visited.visit(entry);
+    frontier.emplace(entryDistance, entry);
+    results.emplace(entryDistance, entry);
+
+    std::vector<uint32_t> links;
+    while (!frontier.empty()) {
+        Candidate current = frontier.top();
+        if (current.first > results.top().first && results.size() >= ef) {
+            break;
+        }
+        frontier.pop();
+
+        copyLinks(current.second, level, links);
+        for (uint32_t neighbor : links) {
+            if (!visited.visit(neighbor)) {
+                continue;
+            }
+            float distance = m_space.distance(query, vectorAt(neighbor));
+            if (results.size() < ef || distance < results.top().first) {
+                frontier.emplace(distance, neighbor);
+                results.emplace(distance, neighbor);
+                if (results.size() > ef) {
+                    results.pop();
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> sorted(results.size());
+    for (size_t i = sorted.size(); i > 0; --i) {
+        sorted[i - 1] = results.top();
+        results.pop();
+    }
+    return sorted;
+}
+
+template <typename Space>
+void HnswIndex<Space>::selectNeighbors(std::vector<Candidate>& candidates, size_t maxCount) const {
+    if (candidates.size() <= maxCount) {
+        return;
+    }
+
+    // 启发式选择：候选按距离升序，离已选邻居比离基准点更近的候选被跳过，使邻居分布在不同方向上
+    std::vector<Candidate> selected;
+    selected.reserve(maxCount);
+    for (const Candidate& candidate : candidates) {
+        if (selected.size() >= maxCount) {
+            break;
+        }
+        bool keep = true;
+        for (const Candidate& chosen : selected) {
+            if (m_space.distance(vectorAt(candidate.second), vectorAt(chosen.second)) < candidate.first) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            selected.push_back(candidate);
+        }
+    }
+    candidates.swap(selected);
+}
+
+template <typename Space>
+void HnswIndex<Space>::connect(uint32_t node, uint32_t neighbor, int level) {
+    std::lock_guard<std::mutex> lock(linkLock(node));
+    uint32_t* links = mutableLinksAt(node, level);
+    uint32_t count = links[0];
+    for (uint32_t i = 1; i <= count; ++i) {
+        if (links[i] == neighbor) {
+            return;
+        }
+    }
+
+    size_t capacity = linkCapacity(level);
+    if (count < capacity) {
+        links[1 + count] = neighbor;
+        links[0] = count + 1;
+        return;
+    }
+
+    // 邻居表已满：在原有邻居和新邻居中重新选择
+    const Element* base = vectorAt(node);
+    std::vector<Candidate> candidates;
+    candidates.reserve(count + 1);
+    candidates.emplace_back(m_space.distance(base, vectorAt(neighbor)), neighbor);
+    for (uint32_t i = 1; i <= count; ++i) {
+        candidates.emplace_back(m_space.distance(base, vectorAt(links[i])), links[i]);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    selectNeighbors(candidates, capacity);
+
+    links[0] = static_cast<uint32_t>(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        links[1 + i] = candidates[i].second;
+    }
+}
+
+template <typename Space>
+std::vector<Neighbor> HnswIndex<Space>::exactSearchLocked(const Element* query, size_t k) const {
+    size_t count = m_size.load(std::memory_order_acquire);
+    std::priority_queue<Candidate> nearest;
+    for (size_t node = 0; node < count; ++node) {
+        float distance = m_space.distance(query, vectorAt(static_cast<uint32_t>(node)));
+        if (nearest.size() < k) {
+            nearest.emplace(distance, static_cast<uint32_t>(node));
+        } else if (distance < nearest.top().first) {
+            nearest.pop();
+            nearest.emplace(distance, static_cast<uint32_t>(node));
+        }
+    }
+
+    std::vector<Neighbor> neighbors(nearest.size());
+    for (size_t i = neighbors.size(); i > 0; --i) {
+        neighbors[i - 1].label = m_labels[nearest.top().second];
+        neighbors[i - 1].distance = m_space.reportedDistance(nearest.top().first);
+        nearest.pop();
+    }
+    return neighbors;
+}
+
+template class HnswIndex<DenseVectorSpace>;
+template class HnswIndex<FingerprintSpace>;
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include "Matrix.h"
+#include "ModelFile.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 近邻索引的距离度量
+ */
+enum class NeighborMetric {
+    Euclidean,      // 稠密向量：欧氏距离
+    Cosine,         // 稠密向量：1 - 余弦相似度
+    Tanimoto,       // 二进制指纹：1 - Tanimoto系数
+    Hamming         // 二进制指纹：不同的位数
+};
+
+/**
+ * @brief 近邻查询结果
+ */
+struct Neighbor {
+    uint64_t label = 0;         // 插入时给定的标签（如记录ID）
+    double distance = 0.0;
+};
+
+/**
+ * @brief 稠密描述符向量空间
+ *
+ * 输入为双精度向量，索引中按单精度保存（内存和带宽减半，近邻顺序基本不受影响）。
+ * 余弦度量在插入时把向量归一化，距离计算只需一次点积。
+ */
+struct DenseVectorSpace {
+    using Input = double;
+    using Element = float;
+    static constexpr uint32_t kKind = 1;
+
+    size_t dimension = 0;
+    NeighborMetric metric = NeighborMetric::Euclidean;
+
+    DenseVectorSpace() = default;
+    DenseVectorSpace(size_t dimension, NeighborMetric metric = NeighborMetric::Euclidean)
+        : dimension(dimension), metric(metric) {}
+
+    bool valid() const {
+        return dimension > 0 && (metric == NeighborMetric::Euclidean || metric == NeighborMetric::Cosine);
+    }
+    size_t width() const { return dimension; }
+    size_t inputSize() const { return dimension; }
+    size_t elementCount() const { return dimension; }
+
+    void encode(const double* input, float* output) const;
+    float distance(const float* a, const float* b) const;
+
+    /**
+     * @brief 内部距离换算为报告的距离（欧氏度量内部使用距离的平方）
+     */
+    double reportedDistance(float distance) const;
+};
+
+/**
+ * @brief 二进制指纹空间
+ *
+ * 每个指纹为 (bits + 63) / 64 个64位字，第 i 位在第 i / 64 个字的第 i % 64 位，多余的位被忽略。
+ * 与 BitMatrix 的行布局相同，位矩阵可以不转换地批量插入和查询。
+ */
+struct FingerprintSpace {
+    using Input = uint64_t;
+    using Element = uint64_t;
+    static constexpr uint32_t kKind = 2;
+
+    size_t bits = 0;
+    NeighborMetric metric = NeighborMetric::Tanimoto;
+
+    FingerprintSpace() = default;
+    FingerprintSpace(size_t bits, NeighborMetric metric = NeighborMetric::Tanimoto)
+        : bits(bits), metric(metric) {}
+
+    bool valid() const {
+        return bits > 0 && (metric == NeighborMetric::Tanimoto || metric == NeighborMetric::Hamming);
+    }
+    size_t width() const { return bits; }
+    size_t inputSize() const { return (bits + 63) / 64; }
+    size_t elementCount() const { return (bits + 63) / 64; }
+
+    void encode(const uint64_t* input, uint64_t* output) const;
+    float distance(const uint64_t* a, const uint64_t* b) const;
+    double reportedDistance(float distance) const { return distance; }
+};
+
+/**
+ * @brief HNSW索引参数
+ */
+struct HnswOptions {
+    size_t maxLinks = 16;           // 每层每个节点的最大邻居数M（第0层为2M）
+    size_t efConstruction = 200;    // 插入时的候选集大小
+    size_t efSearch = 64;           // 查询时的默认候选集大小（实际取 max(ef, k)）
+    uint64_t seed = 42;             // 节点层数的随机种子（层数只由种子和节点序号决定）
+};
+
+/**
+ * @brief 召回率与延迟测试结果
+ */
+struct NeighborBenchmarkReport {
+    size_t queries = 0;
+    size_t k = 0;
+    size_t ef = 0;
+    double recall = 0.0;                    // 近似结果中距离不超过精确第k近邻距离的比例
+    double meanLatencyMicros = 0.0;         // 单线程逐个查询的延迟
+    double p50LatencyMicros = 0.0;
+    double p99LatencyMicros = 0.0;
+    double exactMeanLatencyMicros = 0.0;    // 单线程精确扫描的平均延迟
+    double speedup = 0.0;                   // exactMeanLatencyMicros / meanLatencyMicros
+    double queriesPerSecond = 0.0;          // searchBatch() 在线程池上的吞吐量
+};
+
+/**
+ * @brief 分层可导航小世界图（HNSW）近似最近邻索引
+ *
+ * 每个节点按由种子决定的随机层数加入各层的近邻图，查询从最高层的入口点贪心下降，
+ * 在第0层用大小为 ef 的候选集做最佳优先搜索。查询代价约为对数级，ef 越大召回率越高、越慢。
+ *
+ * 插入和查询可以在多个线程中同时进行：addBatch() 在共享线程池上并行构建，
+ * 之后仍可随时 add() 新记录。各节点的邻居表由分段锁保护；
+ * 扩容、保存、精确扫描和加载需要独占索引，会等待进行中的插入和查询结束。
+ *
+ * 索引保存为模型文件格式（ModelFileContent::NeighborIndex），load() 映射文件后直接在映射的内容上查询，
+ * 不需要解析或复制；之后第一次插入时才把内容复制到内存。
+ *
+ * 标签不要求唯一，重复插入同一标签会得到两个节点。
+ */
+template <typename Space>
+class HnswIndex {
+public:
+    using Input = typename Space::Input;
+    using Element = typename Space::Element;
+
+    explicit HnswIndex(const Space& space = Space(), const HnswOptions& options = {});
+
+    HnswIndex(const HnswIndex&) = delete;
+    HnswIndex& operator=(const HnswIndex&) = delete;
+
+    const Space& space() const { return m_space; }
+    const HnswOptions& options() const { return m_options; }
+
+    /**
+     * @brief 节点数（包括正在插入的节点）
+     */
+    size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 预先分配节点容量
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * @brief 插入一个向量
+     *
+     * @param label 标签
+     * @param vector space().inputSize() 个元素
+     * @return 是否成功（空间参数无效时失败）
+     */
+    bool add(uint64_t label, const Input* vector);
+
+    /**
+     * @brief 在线程池上并行插入一批向量
+     *
+     * @param labels 标签（为空时使用插入前的 size() + i）
+     * @param vectors 向量，第 i 个从 vectors + i * stride 开始
+     * @param count 向量数
+     * @param stride 相邻向量的间隔（0表示 space().inputSize()）
+     * @return 插入的向量数
+     */
+    size_t addBatch(const uint64_t* labels, const Input* vectors, size_t count, size_t stride = 0);
+
+    /**
+     * @brief 近似k近邻查询
+     *
+     * @param query 查询向量
+     * @param k 近邻数
+     * @param ef 候选集大小（0表示 options().efSearch）
+     * @return 按距离升序的近邻
+     */
+    std::vector<Neighbor> search(const Input* query, size_t k, size_t ef = 0) const;
+
+    /**
+     * @brief 在线程池上并行查询一批向量
+     */
+    std::vector<std::vector<Neighbor>> searchBatch(const Input* queries, size_t count, size_t k,
+                                                   size_t ef = 0, size_t stride = 0) const;
+
+    /**
+     * @brief 精确k近邻（逐个比较所有节点，用于校验和测试召回率）
+     */
+    std::vector<Neighbor> exactSearch(const Input* query, size_t k) const;
+
+    /**
+     * @brief 用一组查询测试召回率和延迟
+     *
+     * 精确结果在线程池上并行计算（每个查询单线程扫描并计时），近似查询在调用线程上逐个计时，
+     * 最后用 searchBatch() 测量并行吞吐量。
+     */
+    NeighborBenchmarkReport benchmark(const Input* queries, size_t count, size_t k,
+                                      size_t ef = 0, size_t stride = 0) const;
+
+    /**
+     * @brief 保存到文件（写入临时文件后改名）
+     */
+    bool save(const std::string& filePath) const;
+
+    /**
+     * @brief 映射索引文件（替换当前内容，空间和参数取自文件）
+     *
+     * @return 是否成功（文件不是同类空间的索引或已损坏时失败，索引不变）
+     */
+    bool load(const std::string& filePath);
+
+    /**
+     * @brief 是否直接引用映射的文件
+     */
+    bool isMapped() const;
+
+private:
+    using Candidate = std::pair<float, uint32_t>;
+
+    static constexpr uint32_t kNoNode = 0xFFFFFFFFu;
+    static constexpr size_t kLinkLockCount = 4096;
+    static constexpr int kMaxLevel = 31;
+
+    const Element* vectorAt(uint32_t node) const { return m_vectors.data() + size_t(node) * m_elementCount; }
+    size_t linkCapacity(int level) const { return level == 0 ? m_maxLinks0 : m_options.maxLinks; }
+    const uint32_t* linksAt(uint32_t node, int level) const;
+    uint32_t* mutableLinksAt(uint32_t node, int level);
+    std::mutex& linkLock(uint32_t node) const { return m_linkLocks[node % kLinkLockCount]; }
+
+    int randomLevel(uint32_t node) const;
+    void ensureCapacity(size_t count);
+    void growLocked(size_t capacity);
+    void insertLocked(uint32_t node, uint64_t label, const Input* vector);
+    void copyLinks(uint32_t node, int level, std::vector<uint32_t>& out) const;
+    uint32_t greedyDescend(const Element* query, uint32_t entry, int fromLevel, int toLevel) const;
+    std::vector<Candidate> searchLayer(const Element* query, uint32_t entry, size_t ef, int level) const;
+    void selectNeighbors(std::vector<Candidate>& candidates, size_t maxCount) const;
+    void connect(uint32_t node, uint32_t neighbor, int level);
+    std::vector<Neighbor> exactSearchLocked(const Element* query, size_t k) const;
+
+    Space m_space;
+    HnswOptions m_options;
+    size_t m_elementCount = 0;
+    size_t m_maxLinks0 = 0;
+    double m_levelFactor = 0.0;
+
+    // 共享：插入和查询；独占：扩容、加载、保存和精确扫描
+    mutable std::shared_mutex m_storageMutex;
+    std::unique_ptr<std::mutex[]> m_linkLocks;
+    std::atomic<size_t> m_size{0};
+    size_t m_capacity = 0;
+
+    // 节点数据（训练得到的索引为自有数组，加载的索引引用映射的文件）
+    ModelArray<Element> m_vectors;
+    ModelArray<uint64_t> m_labels;
+    ModelArray<uint8_t> m_levels;
+    ModelArray<uint32_t> m_level0Links;     // 每个节点 1 + 2M 个：邻居数和邻居
+    std::vector<std::vector<uint32_t>> m_upperLinks;    // 第1层及以上，每层 1 + M 个
+    ModelArray<uint32_t> m_mappedUpperLinks;            // 映射文件中连续保存的上层邻居
+    ModelArray<uint64_t> m_mappedUpperOffsets;
+
+    // 入口点和最高层（新节点层数超过最高层时在整个插入期间持有）
+    mutable std::mutex m_entryMutex;
+    uint32_t m_entryPoint = kNoNode;
+    int m_maxLevel = -1;
+};
+
+extern template class HnswIndex<DenseVectorSpace>;
+extern template class HnswIndex<FingerprintSpace>;
+
+/**
+ * @brief 稠密描述符向量的近邻索引
+ */
+using DenseNeighborIndex = HnswIndex<DenseVectorSpace>;
+
+/**
+ * @brief 二进制指纹的近邻索引（Tanimoto / Hamming）
+ */
+using FingerprintNeighborIndex = HnswIndex<FingerprintSpace>;
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,779 @@
+#include "NeuralModels.h"
+#include "ModelCommon.h"
+#include "TrainingJobs.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 预测和验证时每个样本块的行数：一块在各层的激活值留在L2缓存中
+constexpr size_t kForwardBlockRows = 256;
+
+// 逐元素运算（偏置、激活函数、样本收集）分给线程池的最小行数
+constexpr size_t kElementwiseGrainRows = 64;
+
+// 隐藏层和每层神经元数的上限（防止参数写错时分配过多内存）
+constexpr size_t kMaxHiddenLayers = 16;
+constexpr size_t kMaxLayerUnits = 1 << 16;
+
+// 模型文件中的节
+constexpr uint32_t kShapeSection = sectionTag("SHAP");
+constexpr uint32_t kLayersSection = sectionTag("LAYR");
+constexpr uint32_t kActivationsSection = sectionTag("ACTV");
+constexpr uint32_t kClassesSection = sectionTag("CLAS");
+constexpr uint32_t kParametersSection = sectionTag("PARM");
+
+/**
+ * @brief 一层参数在扁平参数数组中的位置
+ */
+struct LayerShape {
+    size_t inputs = 0;
+    size_t outputs = 0;
+    size_t weights = 0;     // 输入数×输出数的权重（按行存放）的偏移
+    size_t bias = 0;        // 输出数个偏置的偏移
+};
+
+/**
+ * @brief 网络结构：各层参数的位置和隐藏层的激活函数
+ */
+struct NetworkShape {
+    std::vector<LayerShape> layers;
+    const std::vector<ActivationFunction>* activations = nullptr;
+    size_t parameterCount = 0;
+    size_t maxWidth = 0;
+    
+    NetworkShape(const std::vector<size_t>& sizes, const std::vector<ActivationFunction>& hiddenActivations)
+        : activations(&hiddenActivations) {
+        for (size_t l = 0; l + 1 < sizes.size(); ++l) {
+            LayerShape layer;
+            layer.inputs = sizes[l];
+            layer.outputs = sizes[l + 1];
+            layer.weights = parameterCount;
+            layer.bias = parameterCount + layer.inputs * layer.outputs;
+            parameterCount = layer.bias + layer.outputs;
+            layers.push_back(layer);
+        }
+        for (size_t size : sizes) {
+            maxWidth = std::max(maxWidth, size);
+        }
+    }
+    
+    size_t outputs() const { return layers.back().outputs; }
+    bool isHidden(size_t l) const { return l + 1 < layers.size(); }
+    
+    ConstMatrixView weights(const double* parameters, size_t l) const {
+        return ConstMatrixView(parameters + layers[l].weights, layers[l].inputs, layers[l].outputs);
+    }
+};
+
+void activate(ActivationFunction function, double* values, size_t count) {
+    switch (function) {
+        case ActivationFunction::ReLU:
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = values[i] > 0.0 ? values[i] : 0.0;
+            }
+            break;
+        case ActivationFunction::Tanh:
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = std::tanh(values[i]);
+            }
+            break;
+        case ActivationFunction::Sigmoid:
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = 1.0 / (1.0 + std::exp(-values[i]));
+            }
+            break;
+    }
+}
+
+/**
+ * @brief delta 乘以激活函数的导数（导数由激活后的值计算）
+ */
+void multiplyDerivative(ActivationFunction function, const double* activated, double* delta, size_t count) {
+    switch (function) {
+        case ActivationFunction::ReLU:
+            for (size_t i = 0; i < count; ++i) {
+                delta[i] = activated[i] > 0.0 ? delta[i] : 0.0;
+            }
+            break;
+        case ActivationFunction::Tanh:
+            for (size_t i = 0; i < count; ++i) {
+                delta[i] *= 1.0 - activated[i] * activated[i];
+            }
+            break;
+        case ActivationFunction::Sigmoid:
+            for (size_t i = 0; i < count; ++i) {
+                delta[i] *= activated[i] * (1.0 - activated[i]);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief 前向传播：outputs[l] 的前 input.rows() 行为第 l 层激活后的结果（输出层不激活）
+ * 
+ * outputs[l] 须至少有 input.rows() 行、该层输出数列。parallel 为 false 时全部在调用线程上计算。
+ */
+void forward(const NetworkShape& shape, const double* parameters, const ConstMatrixView& input,
+             std::vector<Matrix>& outputs, bool parallel) {
+    
+    const size_t rows = input.rows();
+    auto& pool = Utils::ThreadPool::instance();
+    ConstMatrixView current = input;
+    for (size_t l = 0; l < shape.layers.size(); ++l) {
+        const LayerShape& layer = shape.layers[l];
+        MatrixView out(outputs[l].data(), rows, layer.outputs);
+        gemm(current, false, shape.weights(parameters, l), false, out, 1.0, 0.0, parallel);
+    
+        const double* bias = parameters + layer.bias;
+        const ActivationFunction* activation = shape.isHidden(l) ? &(*shape.activations)[l] : nullptr;
+        auto addBias = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double* row = out.row(i);
+                for (size_t o = 0; o < layer.outputs; ++o) {
+                    row[o] += bias[o];
+                }
+                if (activation) {
+                    activate(*activation, row, layer.outputs);
+                }
+            }
+        };
+        if (parallel) {
+            pool.parallelFor(0, rows, kElementwiseGrainRows, addBias);
+        } else {
+            addBias(0, rows);
+        }
+        current = out;
+    }
+}
+
+/**
+ * @brief 一个样本的损失；grad 不为空时写入损失对输出层结果的梯度
+ * 
+ * 回归时 target 为标准化后的标签，损失为误差的平方；分类时 target 为类别下标，损失为对数损失
+ * （单个输出为sigmoid，多个输出为softmax）。
+ */
+double sampleLoss(const double* z, size_t outputs, bool classification, double target, double* grad) {
+    if (!classification) {
+        double error = z[0] - target;
+        if (grad) {
+            grad[0] = 2.0 * error;
+        }
+        return error * error;
+    }
+    
+    if (outputs == 1) {
+        double y = target == 1.0 ? 1.0 : 0.0;
+        if (grad) {
+            grad[0] = 1.0 / (1.0 + std::exp(-z[0])) - y;
+        }
+        return std::max(z[0], 0.0) - z[0] * y + std::log1p(std::exp(-std::abs(z[0])));
+    }
+    
+    size_t index = static_cast<size_t>(target);
+    double maxLogit = *std::max_element(z, z + outputs);
+    double sum = 0.0;
+    for (size_t o = 0; o < outputs; ++o) {
+        sum += std::exp(z[o] - maxLogit);
+    }
+    if (grad) {
+        for (size_t o = 0; o < outputs; ++o) {
+            grad[o] = std::exp(z[o] - maxLogit) / sum - (o == index ? 1.0 : 0.0);
+        }
+    }
+    return maxLogit + std::log(sum) - z[index];
+}
+
+/**
+ * @brief 把输入标准化折算进第一层：W' = W / σ，b' = b - μ·W'
+ */
+void foldInputStandardization(const NetworkShape& shape, const std::vector<double>& means,
+                              const std::vector<double>& invScale, std::vector<double>& parameters) {
+    const LayerShape& first = shape.layers.front();
+    double* weights = parameters.data() + first.weights;
+    double* bias = parameters.data() + first.bias;
+    for (size_t i = 0; i < first.inputs; ++i) {
+        double* row = weights + i * first.outputs;
+        for (size_t o = 0; o < first.outputs; ++o) {
+            row[o] *= invScale[i];
+            bias[o] -= row[o] * means[i];
+        }
+    }
+}
+
+/**
+ * @brief 把标签标准化折算进输出层：W' = W·σ，b' = b·σ + μ
+ */
+void foldLabelStandardization(const NetworkShape& shape, double mean, double scale, std::vector<double>& parameters) {
+    const LayerShape& last = shape.layers.back();
+    double* weights = parameters.data() + last.weights;
+    for (size_t k = 0; k < last.inputs * last.outputs; ++k) {
+        weights[k] *= scale;
+    }
+    double* bias = parameters.data() + last.bias;
+    for (size_t o = 0; o < last.outputs; ++o) {
+        bias[o] = bias[o] * scale + mean;
+    }
+}
+
+/**
+ * @brief 一组样本的平均损失（参数已折算输入标准化，直接使用原始特征）
+ * 
+ * 样本按 kForwardBlockRows 行分块，各块在线程池上独立做前向传播，部分和按块序号合并。
+ */
+double averageLoss(const NetworkShape& shape, const double* parameters, const ConstMatrixView& data,
+                   const std::vector<double>& targets, const std::vector<size_t>& rows, bool classification) {
+    
+    const size_t p = data.cols();
+    const size_t outputs = shape.outputs();
+    size_t blocks = (rows.size() + kForwardBlockRows - 1) / kForwardBlockRows;
+    std::vector<double> partial(blocks, 0.0);
+    Utils::ThreadPool::instance().parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+        Matrix input(kForwardBlockRows, p);
+        std::vector<Matrix> activations;
+        for (const LayerShape& layer : shape.layers) {
+            activations.emplace_back(kForwardBlockRows, layer.outputs);
+        }
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            size_t begin = b * kForwardBlockRows;
+            size_t count = std::min(rows.size(), begin + kForwardBlockRows) - begin;
+            for (size_t i = 0; i < count; ++i) {
+                std::copy(data.row(rows[begin + i]), data.row(rows[begin + i]) + p, input.row(i));
+            }
+            forward(shape, parameters, ConstMatrixView(input.data(), count, p), activations, false);
+            for (size_t i = 0; i < count; ++i) {
+                partial[b] += sampleLoss(activations.back().row(i), outputs, classification,
+                                         targets[rows[begin + i]], nullptr);
+            }
+        }
+    });
+    
+    double sum = 0.0;
+    for (double value : partial) {
+        sum += value;
+    }
+    return sum / static_cast<double>(rows.size());
+}
+
+/**
+ * @brief Adam的设置和状态
+ */
+struct AdamOptimizer {
+    double learningRate = 1e-3;
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+    double epsilon = 1e-8;
+    double lambda = 1e-5;
+    std::vector<double> firstMoment;
+    std::vector<double> secondMoment;
+    uint64_t step = 0;
+    
+    /**
+     * @brief 用梯度更新参数（L2正则只作用于权重）
+     */
+    void update(const NetworkShape& shape, const std::vector<double>& gradient, std::vector<double>& parameters) {
+        ++step;
+        double correction1 = 1.0 - std::pow(beta1, static_cast<double>(step));
+        double correction2 = 1.0 - std::pow(beta2, static_cast<double>(step));
+        double stepSize = learningRate * std::sqrt(correction2) / correction1;
+        double scaledEpsilon = epsilon * std::sqrt(correction2);
+    
+        for (const LayerShape& layer : shape.layers) {
+            size_t weightEnd = layer.bias;
+            size_t end = layer.bias + layer.outputs;
+            for (size_t k = layer.weights; k < end; ++k) {
+                double g = gradient[k] + (k < weightEnd ? lambda * parameters[k] : 0.0);
+                firstMoment[k] = beta1 * firstMoment[k] + (1.0 - beta1) * g;
+                secondMoment[k] = beta2 * secondMoment[k] + (1.0 - beta2) * g * g;
+                parameters[k] -= stepSize * firstMoment[k] / (std::sqrt(secondMoment[k]) + scaledEpsilon);
+            }
+        }
+    }
+};
+
+/**
+ * @brief 小批量训练的工作区（按 batchSize 行预先分配，每轮复用）
+ */
+struct BatchWorkspace {
+    Matrix input;                       // 标准化后的小批量
+    std::vector<Matrix> activations;    // 各层激活后的结果
+    Matrix delta;                       // 当前层损失对该层结果的梯度
+    Matrix previousDelta;
+    std::vector<double> gradient;
+    std::vector<double> losses;
+    
+    BatchWorkspace(const NetworkShape& shape, size_t inputs, size_t batchSize)
+        : input(batchSize, inputs),
+          delta(batchSize, shape.maxWidth),
+          previousDelta(batchSize, shape.maxWidth),
+          gradient(shape.parameterCount, 0.0),
+          losses(batchSize, 0.0) {
+        for (const LayerShape& layer : shape.layers) {
+            activations.emplace_back(batchSize, layer.outputs);
+        }
+    }
+};
+
+/**
+ * @brief 按 rows 的顺序在标准化特征上做一轮小批量Adam
+ * 
+ * 每个小批量先收集并标准化样本，然后逐层前向传播、从输出层逐层反向传播，
+ * 权重梯度 Aᵀ·δ 和下一层的 δ·Wᵀ 都是整批的矩阵乘法。
+ * 
+ * @return 这些样本的损失之和（按更新前的参数计算）
+ */
+double adamEpoch(const NetworkShape& shape, const ConstMatrixView& data, const std::vector<double>& targets,
+                 const std::vector<size_t>& rows, const std::vector<double>& means,
+                 const std::vector<double>& invScale, bool classification, size_t batchSize,
+                 BatchWorkspace& workspace, AdamOptimizer& optimizer, std::vector<double>& parameters) {
+    
+    const size_t p = data.cols();
+    const size_t outputs = shape.outputs();
+    auto& pool = Utils::ThreadPool::instance();
+    double totalLoss = 0.0;
+    
+    for (size_t batchBegin = 0; batchBegin < rows.size(); batchBegin += batchSize) {
+        const size_t count = std::min(batchSize, rows.size() - batchBegin);
+        const double invCount = 1.0 / static_cast<double>(count);
+    
+        pool.parallelFor(0, count, kElementwiseGrainRows, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const double* sample = data.row(rows[batchBegin + i]);
+                double* target = workspace.input.row(i);
+                for (size_t j = 0; j < p; ++j) {
+                    target[j] = (sample[j] - means[j]) * invScale[j];
+                }
+            }
+        });
+        ConstMatrixView input(workspace.input.data(), count, p);
+        forward(shape, parameters.data(), input, workspace.activations, true);
+    
+        // 输出层的梯度（按样本数取平均）
+        MatrixView delta(workspace.delta.data(), count, outputs);
+        const Matrix& result = workspace.activations.back();
+        for (size_t i = 0; i < count; ++i) {
+            double* row = delta.row(i);
+            workspace.losses[i] = sampleLoss(result.row(i), outputs, classification, targets[rows[batchBegin + i]], row);
+            for (size_t o = 0; o < outputs; ++o) {
+                row[o] *= invCount;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            totalLoss += workspace.losses[i];
+        }
+    
+        for (size_t l = shape.layers.size(); l-- > 0;) {
+            const LayerShape& layer = shape.layers[l];
+            ConstMatrixView layerInput = l == 0
+                ? input
+                : ConstMatrixView(workspace.activations[l - 1].data(), count, layer.inputs);
+    
+            // ∂W = Aᵀ·δ，∂b = δ 的列和
+            MatrixView weightGradient(workspace.gradient.data() + layer.weights, layer.inputs, layer.outputs);
+            gemm(layerInput, true, delta, false, weightGradient, 1.0, 0.0, true);
+            double* biasGradient = workspace.gradient.data() + layer.bias;
+            std::fill(biasGradient, biasGradient + layer.outputs, 0.0);
+            for (size_t i = 0; i < count; ++i) {
+                const double* row = delta.row(i);
+                for (size_t o = 0; o < layer.outputs; ++o) {
+                    biasGradient[o] += row[o];
+                }
+            }
+    
+            if (l == 0) {
+                break;
+            }
+    
+            // 上一层：δ' = (δ·Wᵀ) ⊙ f'(A)
+            MatrixView previous(workspace.previousDelta.data(), count, layer.inputs);
+            gemm(delta, false, shape.weights(parameters.data(), l), true, previous, 1.0, 0.0, true);
+            ActivationFunction activation = (*shape.activations)[l - 1];
+            const Matrix& activated = workspace.activations[l - 1];
+            pool.parallelFor(0, count, kElementwiseGrainRows, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    multiplyDerivative(activation, activated.row(i), previous.row(i), layer.inputs);
+                }
+            });
+            std::swap(workspace.delta, workspace.previousDelta);
+            delta = MatrixView(workspace.delta.data(), count, layer.inputs);
+        }
+    
+        optimizer.update(shape, workspace.gradient, parameters);
+    }
+    
+    return totalLoss;
+}
+
+} // namespace
+
+// NeuralNetworkModel 实现
+TrainingResult NeuralNetworkModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    
+    bool classification = parameterOr(parameters, "objective", 0.0) == 1.0;
+    AdamOptimizer optimizer;
+    optimizer.learningRate = parameterOr(parameters, "learningRate", 1e-3);
+    if (!(optimizer.learningRate > 0.0)) {
+        result.errorMessage = "Learning rate must be positive";
+        return result;
+    }
+    optimizer.beta1 = std::min(0.9999, std::max(0.0, parameterOr(parameters, "beta1", 0.9)));
+    optimizer.beta2 = std::min(0.99999, std::max(0.0, parameterOr(parameters, "beta2", 0.999)));
+    optimizer.epsilon = std::max(1e-12, parameterOr(parameters, "epsilon", 1e-8));
+    optimizer.lambda = std::max(0.0, parameterOr(parameters, "lambda", 1e-5));
+    size_t batchSize = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "batchSize", 256)));
+    size_t maxEpochs = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "maxEpochs", 30)));
+    double validationFraction = std::min(0.5, std::max(0.0, parameterOr(parameters, "validationFraction", 0.1)));
+    size_t patience = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "patience", 5)));
+    double tolerance = std::max(0.0, parameterOr(parameters, "tolerance", 1e-4));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    // 网络结构：hiddenUnitsN / activationN 覆盖第N个隐藏层的默认设置
+    size_t hiddenLayers = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "hiddenLayers", 2)));
+    double defaultUnits = parameterOr(parameters, "hiddenUnits", 64);
+    double defaultActivation = parameterOr(parameters, "activation", 0);
+    if (hiddenLayers > kMaxHiddenLayers) {
+        result.errorMessage = "Too many hidden layers";
+        return result;
+    }
+    
+    const size_t numSamples = trainingData.rows();
+    const size_t p = trainingData.cols();
+    std::vector<size_t> layerSizes(1, p);
+    std::vector<ActivationFunction> activations;
+    for (size_t l = 1; l <= hiddenLayers; ++l) {
+        double units = parameterOr(parameters, "hiddenUnits" + std::to_string(l), defaultUnits);
+        double activation = parameterOr(parameters, "activation" + std::to_string(l), defaultActivation);
+        if (!(units >= 1.0) || units > kMaxLayerUnits) {
+            result.errorMessage = "Hidden layer size must be between 1 and 65536";
+            return result;
+        }
+        if (activation != 0.0 && activation != 1.0 && activation != 2.0) {
+            result.errorMessage = "Unknown activation function";
+            return result;
+        }
+        layerSizes.push_back(static_cast<size_t>(units));
+        activations.push_back(static_cast<ActivationFunction>(static_cast<uint32_t>(activation)));
+    }
+    
+    // 训练目标：回归为标准化后的标签，分类为类别下标
+    std::vector<double> classes;
+    std::vector<double> targets(numSamples);
+    double labelMean = 0.0;
+    double labelScale = 1.0;
+    if (classification) {
+        classes = trainingLabels;
+        std::sort(classes.begin(), classes.end());
+        classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+        if (classes.size() < 2) {
+            result.errorMessage = "At least two classes are required";
+            return result;
+        }
+        for (size_t i = 0; i < numSamples; ++i) {
+            targets[i] = static_cast<double>(
+                std::lower_bound(classes.begin(), classes.end(), trainingLabels[i]) - classes.begin());
+        }
+        layerSizes.push_back(classes.size() == 2 ? 1 : classes.size());
+    } else {
+        labelMean = std::accumulate(trainingLabels.begin(), trainingLabels.end(), 0.0) / numSamples;
+        double squares = 0.0;
+        for (double label : trainingLabels) {
+            squares += (label - labelMean) * (label - labelMean);
+        }
+        double deviation = std::sqrt(squares / numSamples);
+        labelScale = deviation > 0.0 ? deviation : 1.0;
+        for (size_t i = 0; i < numSamples; ++i) {
+            targets[i] = (trainingLabels[i] - labelMean) / labelScale;
+        }
+        layerSizes.push_back(1);
+    }
+    
+    NetworkShape shape(layerSizes, activations);
+    
+    std::vector<double> means;
+    std::vector<double> invScale;
+    standardization(trainingData, means, invScale);
+    
+    // 初始化：ReLU层按He初始化（方差2/输入数），其余按方差1/输入数，偏置为0
+    std::mt19937_64 rng(seed);
+    std::vector<double> weights(shape.parameterCount, 0.0);
+    for (size_t l = 0; l < shape.layers.size(); ++l) {
+        const LayerShape& layer = shape.layers[l];
+        bool relu = shape.isHidden(l) && activations[l] == ActivationFunction::ReLU;
+        std::normal_distribution<double> normal(0.0, std::sqrt((relu ? 2.0 : 1.0) / layer.inputs));
+        for (size_t k = layer.weights; k < layer.bias; ++k) {
+            weights[k] = normal(rng);
+        }
+    }
+    optimizer.firstMoment.assign(shape.parameterCount, 0.0);
+    optimizer.secondMoment.assign(shape.parameterCount, 0.0);
+    
+    // 随机划分训练集和验证集
+    std::vector<size_t> trainRows(numSamples);
+    std::iota(trainRows.begin(), trainRows.end(), 0);
+    std::shuffle(trainRows.begin(), trainRows.end(), rng);
+    
+    size_t validationCount = static_cast<size_t>(numSamples * validationFraction);
+    std::vector<size_t> validationRows(trainRows.begin(), trainRows.begin() + validationCount);
+    trainRows.erase(trainRows.begin(), trainRows.begin() + validationCount);
+    batchSize = std::min(batchSize, trainRows.size());
+    
+    BatchWorkspace workspace(shape, p, batchSize);
+    std::vector<double> bestWeights = weights;
+    std::vector<double> folded;
+    double bestLoss = 0.0;
+    double trainingLoss = 0.0;
+    size_t epochsRun = 0;
+    size_t epochsWithoutImprovement = 0;
+    TrainingControl* control = TrainingControl::current();
+    
+    for (size_t epoch = 0; epoch < maxEpochs; ++epoch) {
+        std::shuffle(trainRows.begin(), trainRows.end(), rng);
+        double epochLoss = adamEpoch(shape, trainingData, targets, trainRows, means, invScale, classification,
+                                     batchSize, workspace, optimizer, weights);
+    
+        ++epochsRun;
+        trainingLoss = epochLoss / static_cast<double>(trainRows.size());
+        double monitoredLoss = trainingLoss;
+        if (!validationRows.empty()) {
+            folded = weights;
+            foldInputStandardization(shape, means, invScale, folded);
+            monitoredLoss = averageLoss(shape, folded.data(), trainingData, targets, validationRows, classification);
+        }
+        if (!std::isfinite(monitoredLoss)) {
+            result.errorMessage = "Training diverged, try a smaller learning rate";
+            return result;
+        }
+        if (control && control->checkpoint(static_cast<double>(epoch + 1) / static_cast<double>(maxEpochs), result,
+                                           {{"trainingLoss", trainingLoss}, {"monitoredLoss", monitoredLoss}})) {
+            return result;
+        }
+    
+        // 提前停止：损失连续 patience 轮没有明显下降
+        if (epoch == 0 || monitoredLoss < bestLoss * (1.0 - tolerance)) {
+            bestLoss = monitoredLoss;
+            bestWeights = weights;
+            epochsWithoutImprovement = 0;
+        } else if (++epochsWithoutImprovement >= patience) {
+            break;
+        }
+    }
+    
+    foldInputStandardization(shape, means, invScale, bestWeights);
+    if (!classification) {
+        foldLabelStandardization(shape, labelMean, labelScale, bestWeights);
+    }
+    m_objective = classification ? Objective::Classification : Objective::Regression;
+    m_layerSizes = std::move(layerSizes);
+    m_activations = std::move(activations);
+    m_classes = std::move(classes);
+    m_parameters = std::move(bestWeights);
+    
+    std::vector<double> predictions = predict(trainingData);
+    if (classification) {
+        // 预测值和标签都取自 m_classes，换成类别序号后计算
+        auto classIndex = [this](double label) {
+            return static_cast<uint32_t>(std::lower_bound(m_classes.begin(), m_classes.end(), label) - m_classes.begin());
+        };
+        std::vector<uint32_t> predicted(predictions.size());
+        std::vector<uint32_t> actual(trainingLabels.size());
+        for (size_t i = 0; i < trainingLabels.size(); ++i) {
+            predicted[i] = classIndex(predictions[i]);
+            actual[i] = classIndex(trainingLabels[i]);
+        }
+        fillClassificationMetrics(result, predicted, actual, m_classes.size());
+        result.additionalMetrics["classes"] = static_cast<double>(m_classes.size());
+    } else {
+        fillRegressionMetrics(result, predictions, trainingLabels);
+    }
+    result.success = true;
+    result.additionalMetrics["epochs"] = static_cast<double>(epochsRun);
+    result.additionalMetrics["trainingLoss"] = trainingLoss;
+    if (!validationRows.empty()) {
+        result.additionalMetrics["validationLoss"] = bestLoss;
+    }
+    result.additionalMetrics["parameters"] = static_cast<double>(shape.parameterCount);
+    result.additionalMetrics["learningRate"] = optimizer.learningRate;
+    
+    return result;
+}
+
+Matrix NeuralNetworkModel::predictOutputs(const ConstMatrixView& data) const {
+    NetworkShape shape(m_layerSizes, m_activations);
+    Matrix outputs(data.rows(), shape.outputs());
+    size_t blocks = (data.rows() + kForwardBlockRows - 1) / kForwardBlockRows;
+    Utils::ThreadPool::instance().parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+        std::vector<Matrix> activations;
+        for (const LayerShape& layer : shape.layers) {
+            activations.emplace_back(kForwardBlockRows, layer.outputs);
+        }
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            size_t begin = b * kForwardBlockRows;
+            size_t end = std::min(data.rows(), begin + kForwardBlockRows);
+            forward(shape, m_parameters.data(), data.rowRange(begin, end), activations, false);
+            const Matrix& result = activations.back();
+            std::copy(result.data(), result.data() + (end - begin) * shape.outputs(), outputs.row(begin));
+        }
+    });
+    return outputs;
+}
+
+std::vector<double> NeuralNetworkModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_parameters.empty() || testData.empty() || testData.cols() != m_layerSizes.front()) {
+        return {};
+    }
+    
+    Matrix outputs = predictOutputs(testData);
+    std::vector<double> predictions(testData.rows());
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        const double* row = outputs.row(i);
+        if (m_objective == Objective::Regression) {
+            predictions[i] = row[0];
+        } else if (outputs.cols() == 1) {
+            predictions[i] = m_classes[row[0] > 0.0 ? 1 : 0];
+        } else {
+            predictions[i] = m_classes[std::max_element(row, row + outputs.cols()) - row];
+        }
+    }
+    return predictions;
+}
+
+Matrix NeuralNetworkModel::predictProbabilities(const ConstMatrixView& testData) const {
+    
+    if (m_objective != Objective::Classification || m_parameters.empty() || testData.empty() ||
+        testData.cols() != m_layerSizes.front()) {
+        return Matrix();
+    }
+    
+    Matrix outputs = predictOutputs(testData);
+    Matrix probabilities(testData.rows(), m_classes.size());
+    for (size_t i = 0; i < testData.rows(); ++i) {
+        const double* row = outputs.row(i);
+        double* out = probabilities.row(i);
+        if (outputs.cols() == 1) {
+            out[1] = 1.0 / (1.0 + std::exp(-row[0]));
+            out[0] = 1.0 - out[1];
+            continue;
+        }
+        double maxLogit = *std::max_element(row, row + outputs.cols());
+        double sum = 0.0;
+        for (size_t o = 0; o < outputs.cols(); ++o) {
+            out[o] = std::exp(row[o] - maxLogit);
+            sum += out[o];
+        }
+        for (size_t o = 0; o < outputs.cols(); ++o) {
+            out[o] /= sum;
+        }
+    }
+    return probabilities;
+}
+
+bool NeuralNetworkModel::saveModel(const std::string& filePath) {
+    try {
+        uint64_t shape[1] = {static_cast<uint64_t>(m_objective)};
+        std::vector<uint64_t> layers(m_layerSizes.begin(), m_layerSizes.end());
+        std::vector<uint32_t> activations;
+        for (ActivationFunction activation : m_activations) {
+            activations.push_back(static_cast<uint32_t>(activation));
+        }
+    
+        ModelFileWriter writer(ModelType::NeuralNetwork);
+        writer.addArray(kShapeSection, shape, 1);
+        writer.addArray(kLayersSection, layers);
+        writer.addArray(kActivationsSection, activations);
+        writer.addArray(kClassesSection, m_classes);
+        writer.addArray(kParametersSection, m_parameters.data(), m_parameters.size());
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool NeuralNetworkModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::NeuralNetwork) {
+            return false;
+        }
+    
+        auto shape = file->section<uint64_t>(kShapeSection);
+        auto layers = file->section<uint64_t>(kLayersSection);
+        auto activations = file->section<uint32_t>(kActivationsSection);
+        auto classes = file->section<double>(kClassesSection);
+        auto parameters = file->section<double>(kParametersSection);
+        if (!shape.valid || shape.count != 1 || shape.data[0] > 1 || !layers.valid || layers.count < 2 ||
+            layers.count > kMaxHiddenLayers + 2 || !activations.valid || activations.count + 2 != layers.count ||
+            !classes.valid || !parameters.valid) {
+            return false;
+        }
+    
+        // 层宽、激活函数、类别数和参数个数必须彼此一致
+        Objective objective = static_cast<Objective>(shape.data[0]);
+        std::vector<size_t> layerSizes;
+        size_t parameterCount = 0;
+        for (size_t l = 0; l < layers.count; ++l) {
+            if (layers.data[l] == 0 || layers.data[l] > kMaxLayerUnits) {
+                return false;
+            }
+            layerSizes.push_back(static_cast<size_t>(layers.data[l]));
+            if (l > 0) {
+                parameterCount += (layerSizes[l - 1] + 1) * layerSizes[l];
+            }
+        }
+        std::vector<ActivationFunction> hiddenActivations;
+        for (size_t l = 0; l < activations.count; ++l) {
+            if (activations.data[l] > static_cast<uint32_t>(ActivationFunction::Sigmoid)) {
+                return false;
+            }
+            hiddenActivations.push_back(static_cast<ActivationFunction>(activations.data[l]));
+        }
+        size_t outputs = layerSizes.back();
+        bool validOutputs = objective == Objective::Regression
+            ? outputs == 1 && classes.count == 0
+            : classes.count >= 2 && outputs == (classes.count == 2 ? 1 : classes.count);
+        if (!validOutputs || parameters.count != parameterCount) {
+            return false;
+        }
+    
+        m_objective = objective;
+        m_layerSizes = std::move(layerSizes);
+        m_activations = std::move(hiddenActivations);
+        m_classes.assign(classes.data, classes.data + classes.count);
+        m_parameters = ModelArray<double>::mapped(parameters, file);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "MLModels.h"
+#include "ModelFile.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 隐藏层的激活函数
+ */
+enum class ActivationFunction : uint32_t {
+    ReLU = 0,
+    Tanh = 1,
+    Sigmoid = 2
+};
+
+/**
+ * @brief 原生多层感知机（全连接神经网络，不依赖mlpack）
+ * 
+ * 每层为 Z = A·W + b，隐藏层之后接激活函数；回归时输出层为单个线性输出（平方误差），
+ * 分类时两个类别为单个sigmoid输出，多于两个类别为softmax（对数损失）。
+ * 
+ * 训练使用小批量Adam：特征在内部按均值和标准差标准化（回归时标签也标准化），每个小批量的
+ * 前向和反向传播都是整批的矩阵乘法，由 gemm() 的缓存分块SIMD内核在线程池上并行计算；
+ * 每个元素的累加顺序固定，因此给定随机种子时结果与线程数无关。训练前留出一部分样本作验证集，
+ * 验证损失连续 patience 轮没有改善即提前停止，并恢复验证损失最低时的参数。
+ * 训练完成后标准化被折算进第一层和输出层的参数，预测时直接使用原始特征。
+ * 
+ * 预测按固定行数的样本块在线程池上并行，每块在各层上各做一次矩阵乘法。
+ * 
+ * 训练参数：
+ * - objective：0 为平方误差回归（默认），1 为分类
+ * - hiddenLayers：隐藏层数（默认2）
+ * - hiddenUnits：每个隐藏层的神经元数（默认64）；hiddenUnits1、hiddenUnits2 …… 单独设定第i个隐藏层
+ * - activation：隐藏层激活函数，0 为ReLU（默认），1 为tanh，2 为sigmoid；activation1 …… 单独设定第i个隐藏层
+ * - learningRate：Adam学习率（默认1e-3）
+ * - beta1 / beta2：一阶、二阶矩的衰减率（默认0.9 / 0.999）
+ * - epsilon：Adam的数值稳定项（默认1e-8）
+ * - lambda：权重的L2正则化系数（默认1e-5，不作用于偏置）
+ * - batchSize：小批量大小（默认256）
+ * - maxEpochs：最大训练轮数（默认30）
+ * - validationFraction：验证集比例（默认0.1，为0时按训练损失判断停止）
+ * - patience：提前停止的容忍轮数（默认5）
+ * - tolerance：视为改善的最小相对下降（默认1e-4）
+ * - seed：随机种子（默认42）
+ */
+class NeuralNetworkModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测（回归返回预测值，分类返回类别标签值）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 预测各类别的概率（仅分类）
+     *
+     * @param testData 测试数据
+     * @return 样本数×类别数的概率矩阵（列顺序同 classes()；回归模型返回空矩阵）
+     */
+    Matrix predictProbabilities(const ConstMatrixView& testData) const;
+    
+    ModelType getModelType() const override { return ModelType::NeuralNetwork; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    bool isClassifier() const { return m_objective == Objective::Classification; }
+    
+    /**
+     * @brief 各层的宽度（输入特征数、各隐藏层的神经元数、输出数）
+     */
+    const std::vector<size_t>& layerSizes() const { return m_layerSizes; }
+    
+    /**
+     * @brief 训练时出现的类别标签值（升序，回归时为空）
+     */
+    const std::vector<double>& classes() const { return m_classes; }
+
+private:
+    enum class Objective : uint32_t {
+        Regression = 0,
+        Classification = 1
+    };
+    
+    /**
+     * @brief 输出层的结果（样本数×输出数，分类时未经sigmoid/softmax）
+     */
+    Matrix predictOutputs(const ConstMatrixView& data) const;
+    
+    Objective m_objective = Objective::Regression;
+    std::vector<size_t> m_layerSizes;
+    std::vector<ActivationFunction> m_activations;     // 每个隐藏层一个
+    std::vector<double> m_classes;
+    ModelArray<double> m_parameters;                    // 各层依次为 输入数×输出数 的权重和偏置
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,402 @@
+#include "OnlineLearning.h"
+#include "ModelCommon.h"
+#include "IncrementalTraining.h"
+#include <algorithm>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr size_t kSeedPageRecords = 4096;
+
+bool usesCategoryCodes(const OnlineLearningOptions& options) {
+    return options.featureType == "category_encoded" || options.featureType == "multi_feature" ||
+           options.labelType == "category";
+}
+
+} // namespace
+
+OnlineLearner::OnlineLearner(Data::IDataService& dataService, IMLModel& model, OnlineLearningOptions options)
+    : m_dataService(dataService),
+      m_model(model),
+      m_options(std::move(options)) {
+}
+
+OnlineLearner::~OnlineLearner() {
+    stop(false);
+}
+
+bool OnlineLearner::setHoldout(const std::vector<Data::DataRecord>& records) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stats.running) {
+        return false;
+    }
+    
+    m_holdoutRecords = records;
+    m_holdoutIds.clear();
+    for (const auto& record : records) {
+        m_holdoutIds.insert(record.id);
+    }
+    return true;
+}
+
+bool OnlineLearner::start() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stats.running) {
+            m_stats.lastError = "Online learner is already running";
+            return false;
+        }
+        m_stats = OnlineLearningStats();
+        m_history.clear();
+        m_queue.clear();
+        m_stopping = false;
+        
+        if (!m_model.supportsPartialFit()) {
+            m_stats.lastError = "Model does not support incremental training";
+            return false;
+        }
+        if (!m_holdoutRecords.empty() && m_model.getModelType() == ModelType::KMeans) {
+            m_stats.lastError = "Holdout scoring requires a supervised model";
+            return false;
+        }
+        m_stats.scoring = m_options.scoring;
+        if (m_stats.scoring == ScoringMetric::Auto) {
+            // 未训练的模型由训练参数决定（梯度提升树、神经网络的 objective）
+            bool classifier = predictsClasses(m_model) || predictsClasses(m_model.getModelType(), m_options.parameters);
+            m_stats.scoring = classifier ? ScoringMetric::Accuracy : ScoringMetric::NegativeMeanSquaredError;
+        }
+        m_stats.running = true;
+    }
+    
+    // 先订阅再编号已有的类别：两者之间插入的记录进入队列，不会漏掉
+    m_subscription = m_dataService.subscribeInsertions(
+        [this](const Data::DataRecord& record, uint64_t version) { enqueue(record, version); });
+    
+    auto fail = [this](const std::string& message) {
+        m_dataService.unsubscribeInsertions(m_subscription);
+        m_subscription = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        m_stats.running = false;
+        m_stats.lastError = message;
+        return false;
+    };
+    
+    m_categoryCodes.clear();
+    if (m_options.seedCategoriesFromStore && usesCategoryCodes(m_options)) {
+        seedCategoryCodes();
+    }
+    
+    m_holdoutFeatures = Matrix();
+    m_holdoutLabels.clear();
+    if (!m_holdoutRecords.empty()) {
+        try {
+            extractConsistentFeatures(m_holdoutRecords, m_options.featureType, m_options.labelType,
+                                      m_categoryCodes, m_holdoutFeatures, m_holdoutLabels);
+        } catch (const std::exception& e) {
+            return fail(std::string("Failed to extract holdout features: ") + e.what());
+        }
+        if (m_holdoutFeatures.rows() != m_holdoutRecords.size() || m_holdoutLabels.size() != m_holdoutRecords.size()) {
+            return fail("Failed to extract holdout features or labels");
+        }
+    }
+    
+    m_started = Clock::now();
+    {
+        std::lock_guard<std::mutex> modelLock(m_modelMutex);
+        m_batchesSinceCheckpoint = 0;
+        m_lastCheckpoint = m_started;
+        
+        // 模型已训练时以在线训练前的分数为基准，否则在第一批之后评分
+        double score = 0.0;
+        if (!m_holdoutRecords.empty() && evaluate(score)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.hasBaseline = true;
+            m_stats.baselineScore = score;
+            m_stats.currentScore = score;
+            DriftSample sample;
+            sample.score = score;
+            m_history.push_back(sample);
+        }
+    }
+    
+    m_thread = std::thread(&OnlineLearner::run, this);
+    return true;
+}
+
+void OnlineLearner::stop(bool flush) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stats.running) {
+            return;
+        }
+    }
+    
+    // 取消订阅返回后不会再有新的记录进入队列
+    m_dataService.unsubscribeInsertions(m_subscription);
+    m_subscription = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_flush = flush;
+    }
+    m_queueChanged.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.droppedRecords += m_queue.size();
+    m_queue.clear();
+    m_stats.running = false;
+    m_stopping = false;
+}
+
+bool OnlineLearner::isRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+std::vector<double> OnlineLearner::predict(const ConstMatrixView& data) {
+    std::lock_guard<std::mutex> modelLock(m_modelMutex);
+    return m_model.predict(data);
+}
+
+bool OnlineLearner::saveCheckpoint() {
+    if (m_options.checkpointPath.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> modelLock(m_modelMutex);
+    return writeCheckpoint();
+}
+
+OnlineLearningStats OnlineLearner::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    OnlineLearningStats snapshot = m_stats;
+    snapshot.pendingRecords = m_queue.size();
+    return snapshot;
+}
+
+std::vector<DriftSample> OnlineLearner::driftHistory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::vector<DriftSample>(m_history.begin(), m_history.end());
+}
+
+void OnlineLearner::enqueue(const Data::DataRecord& record, uint64_t version) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.receivedRecords;
+        if (m_holdoutIds.count(record.id) > 0) {
+            ++m_stats.skippedRecords;
+            return;
+        }
+        if (m_queue.size() >= std::max<size_t>(1, m_options.maxPendingRecords)) {
+            m_queue.pop_front();
+            ++m_stats.droppedRecords;
+        }
+        m_queue.push_back({record, version, Clock::now()});
+    }
+    m_queueChanged.notify_one();
+}
+
+void OnlineLearner::seedCategoryCodes() {
+    for (size_t offset = 0;; ) {
+        std::vector<Data::DataRecord> records = m_dataService.getDataRange(offset, kSeedPageRecords);
+        if (records.empty()) {
+            break;
+        }
+        offset += records.size();
+        for (const auto& record : records) {
+            m_categoryCodes.emplace(record.category, static_cast<double>(m_categoryCodes.size()));
+        }
+    }
+}
+
+void OnlineLearner::run() {
+    const size_t batchSize = std::max<size_t>(1, m_options.batchSize);
+    const auto maxDelay = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, m_options.maxBatchDelaySeconds)));
+    std::vector<PendingRecord> batch;
+    
+    while (true) {
+        {
+            // 等到凑满一批、最早的记录等待超时或停止
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stopping && m_queue.size() < batchSize) {
+                if (m_queue.empty()) {
+                    m_queueChanged.wait(lock);
+                } else if (m_queueChanged.wait_until(lock, m_queue.front().arrived + maxDelay) == std::cv_status::timeout) {
+                    break;
+                }
+            }
+            if (m_queue.empty() || (m_stopping && !m_flush)) {
+                break;
+            }
+            
+            size_t count = std::min(batchSize, m_queue.size());
+            batch.clear();
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+        trainBatch(batch);
+    }
+    
+    // 停止时保存最后的状态
+    if (!m_options.checkpointPath.empty()) {
+        std::lock_guard<std::mutex> modelLock(m_modelMutex);
+        if (m_batchesSinceCheckpoint > 0) {
+            writeCheckpoint();
+        }
+    }
+}
+
+void OnlineLearner::trainBatch(std::vector<PendingRecord>& batch) {
+    std::vector<Data::DataRecord> records;
+    records.reserve(batch.size());
+    uint64_t version = 0;
+    for (auto& pending : batch) {
+        version = std::max(version, pending.version);
+        records.push_back(std::move(pending.record));
+    }
+    
+    Matrix features;
+    std::vector<double> labels;
+    std::string error;
+    try {
+        extractConsistentFeatures(records, m_options.featureType, m_options.labelType, m_categoryCodes, features, labels);
+        if (features.rows() != records.size() || labels.size() != records.size()) {
+            error = "Failed to extract features or labels from inserted records";
+        }
+    } catch (const std::exception& e) {
+        error = std::string("Failed to extract features: ") + e.what();
+    }
+    if (!error.empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.failedBatches;
+        m_stats.lastError = error;
+        return;
+    }
+    
+    uint64_t batchNumber = 0;
+    bool needBaseline = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        batchNumber = m_stats.batches + 1;
+        needBaseline = !m_stats.hasBaseline;
+    }
+    
+    TrainingResult result;
+    double trainSeconds = 0.0;
+    bool evaluated = false;
+    double score = 0.0;
+    {
+        std::lock_guard<std::mutex> modelLock(m_modelMutex);
+        Clock::time_point trainStart = Clock::now();
+        result = m_model.partialFit(features, labels, m_options.parameters);
+        trainSeconds = secondsSince(trainStart);
+        
+        if (result.success) {
+            ++m_batchesSinceCheckpoint;
+            bool evaluationDue = needBaseline ||
+                (m_options.evaluateEveryBatches > 0 && batchNumber % m_options.evaluateEveryBatches == 0);
+            if (!m_holdoutRecords.empty() && evaluationDue) {
+                evaluated = evaluate(score);
+            }
+            
+            bool checkpointDue =
+                (m_options.checkpointEveryBatches > 0 && m_batchesSinceCheckpoint >= m_options.checkpointEveryBatches) ||
+                (m_options.checkpointIntervalSeconds > 0.0 &&
+                 secondsSince(m_lastCheckpoint) >= m_options.checkpointIntervalSeconds);
+            if (!m_options.checkpointPath.empty() && checkpointDue) {
+                writeCheckpoint();
+            }
+        }
+    }
+    
+    DriftSample sample;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!result.success) {
+            ++m_stats.failedBatches;
+            m_stats.lastError = result.errorMessage;
+            return;
+        }
+        
+        ++m_stats.batches;
+        m_stats.trainedSamples += records.size();
+        m_stats.trainSeconds += trainSeconds;
+        m_stats.lastDataVersion = version;
+        m_stats.lastBatchLatencySeconds = secondsSince(batch.front().arrived);
+        if (!evaluated) {
+            return;
+        }
+        
+        if (!m_stats.hasBaseline) {
+            m_stats.hasBaseline = true;
+            m_stats.baselineScore = score;
+        }
+        m_stats.currentScore = score;
+        sample.batch = m_stats.batches;
+        sample.samples = m_stats.trainedSamples;
+        sample.score = score;
+        sample.drift = score - m_stats.baselineScore;
+        sample.degraded = sample.drift < -m_options.driftTolerance;
+        sample.elapsedSeconds = secondsSince(m_started);
+        if (sample.degraded) {
+            ++m_stats.degradedEvaluations;
+        }
+        
+        m_history.push_back(sample);
+        while (m_history.size() > std::max<size_t>(1, m_options.historyLimit)) {
+            m_history.pop_front();
+        }
+    }
+    
+    if (m_options.onEvaluation) {
+        m_options.onEvaluation(sample);
+    }
+}
+
+bool OnlineLearner::evaluate(double& score) {
+    // 调用者持有模型锁
+    std::vector<double> predictions = m_model.predict(m_holdoutFeatures);
+    if (predictions.size() != m_holdoutLabels.size()) {
+        return false;
+    }
+    ScoringMetric metric;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        metric = m_stats.scoring;
+    }
+    score = scorePredictions(metric, predictions, m_holdoutLabels.data(), m_holdoutLabels.size());
+    return true;
+}
+
+bool OnlineLearner::writeCheckpoint() {
+    // 调用者持有模型锁
+    bool saved = m_model.saveModel(m_options.checkpointPath);
+    if (saved) {
+        m_batchesSinceCheckpoint = 0;
+        m_lastCheckpoint = Clock::now();
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (saved) {
+        ++m_stats.checkpoints;
+    } else {
+        m_stats.lastError = "Failed to write checkpoint " + m_options.checkpointPath;
+    }
+    return saved;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
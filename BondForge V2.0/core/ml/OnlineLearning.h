@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <unordered_set>
+#include <cstdint>
+#include "MLModels.h"
+#include "ModelSelection.h"
+#include "../data/DataService.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 一次留出集评分
+ */
+struct DriftSample {
+    uint64_t batch = 0;             // 评分时已训练的批数
+    uint64_t samples = 0;           // 评分时已训练的样本数
+    double score = 0.0;             // 留出集上的分数（越大越好）
+    double drift = 0.0;             // 相对基准分数的变化（负值表示变差）
+    bool degraded = false;          // 变差超过容差
+    double elapsedSeconds = 0.0;    // 自启动起的时间
+};
+
+/**
+ * @brief 在线学习选项
+ */
+struct OnlineLearningOptions {
+    std::string featureType = "content_length";
+    std::string labelType = "category";
+    std::map<std::string, double> parameters;       // 传给每次 partialFit() 的训练参数
+    
+    size_t batchSize = 64;                          // 每批训练的记录数
+    double maxBatchDelaySeconds = 2.0;              // 不足一批时最早的记录最长等待时间，之后按已有的记录训练
+    size_t maxPendingRecords = 100000;              // 待训练队列的上限（超出时丢弃最早的记录）
+    
+    /**
+     * @brief 启动时按存储顺序为已有记录的类别编号
+     * 
+     * 与用 DataPreprocessor 或 RecordChunkSource 在全部数据上训练时的类别编码一致，
+     * 已训练好的模型可以直接在线继续训练。
+     */
+    bool seedCategoriesFromStore = true;
+    
+    std::string checkpointPath;                     // 检查点文件（为空时不保存）
+    size_t checkpointEveryBatches = 50;             // 每训练这么多批保存一次（0表示不按批数）
+    double checkpointIntervalSeconds = 300.0;       // 距上次保存超过这么久且有新的训练时保存（0表示不按时间）
+    
+    ScoringMetric scoring = ScoringMetric::Auto;
+    size_t evaluateEveryBatches = 1;                // 每训练这么多批在留出集上评分一次
+    double driftTolerance = 0.05;                   // 分数低于基准超过此值时视为退化
+    size_t historyLimit = 1000;                     // 保留的最近评分数
+    
+    /**
+     * @brief 评分回调（在学习线程上调用）
+     */
+    std::function<void(const DriftSample&)> onEvaluation;
+};
+
+/**
+ * @brief 在线学习的运行统计
+ */
+struct OnlineLearningStats {
+    bool running = false;
+    uint64_t receivedRecords = 0;       // 收到的插入通知数
+    uint64_t skippedRecords = 0;        // 属于留出集而不参与训练的记录
+    uint64_t droppedRecords = 0;        // 队列已满或不等待训练就停止时丢弃的记录
+    size_t pendingRecords = 0;          // 等待训练的记录
+    uint64_t batches = 0;
+    uint64_t failedBatches = 0;
+    uint64_t trainedSamples = 0;
+    uint64_t checkpoints = 0;
+    uint64_t degradedEvaluations = 0;
+    uint64_t lastDataVersion = 0;       // 已训练的最新记录插入后的数据版本号
+    ScoringMetric scoring = ScoringMetric::Auto;    // 实际使用的评分方式
+    bool hasBaseline = false;
+    double baselineScore = 0.0;         // 在线训练前（模型未训练时为第一批之后）的留出集分数
+    double currentScore = 0.0;          // 最近一次评分
+    double trainSeconds = 0.0;
+    double lastBatchLatencySeconds = 0.0;   // 最近一批中最早的记录从插入到训练完成的时间
+    std::string lastError;
+};
+
+/**
+ * @brief 在线学习：随数据插入增量更新支持 partialFit() 的模型
+ * 
+ * 启动后订阅数据服务的记录插入，插入通知只把记录放入队列，不在插入线程上训练。
+ * 单独的学习线程在凑满一批或最早的记录等待超过 maxBatchDelaySeconds 后取出一批，
+ * 按一致的类别编码提取特征并调用 partialFit()，因此模型以小批次跟上新数据，而不需要全量重新训练。
+ * 学习线程只做阻塞等待和调度，不占用计算线程池，partialFit() 内部的并行计算仍在线程池上进行。
+ * 
+ * 模型每训练若干批或每隔一段时间保存为检查点（saveModel() 先写临时文件再替换，
+ * 中途失败不会破坏上一个检查点），停止时保存最后的状态。
+ * 设置了留出集时，按 evaluateEveryBatches 在留出集上评分，与在线训练开始前的基准分数比较，
+ * 记录准确率（回归模型为负均方误差）的漂移；留出集中的记录即使被插入也不参与训练。
+ * 
+ * 运行期间模型由学习线程更新，其他线程应通过 predict() 预测，不应直接使用模型。
+ * 模型和数据服务必须比学习器存活更久。
+ */
+class OnlineLearner {
+public:
+    OnlineLearner(Data::IDataService& dataService, IMLModel& model, OnlineLearningOptions options = {});
+    
+    /**
+     * @brief 析构时停止学习（丢弃尚未训练的记录）
+     */
+    ~OnlineLearner();
+    
+    OnlineLearner(const OnlineLearner&) = delete;
+    OnlineLearner& operator=(const OnlineLearner&) = delete;
+    
+    /**
+     * @brief 设置留出集（只能在未运行时设置）
+     * 
+     * @param records 留出的记录（特征和标签在启动时按与训练相同的方式提取）
+     * @return 是否成功
+     */
+    bool setHoldout(const std::vector<Data::DataRecord>& records);
+    
+    /**
+     * @brief 订阅插入并启动学习线程（统计和评分记录重新开始）
+     * 
+     * @return 是否成功（模型不支持 partialFit()、已在运行或留出集无法评分时失败，原因见 stats().lastError）
+     */
+    bool start();
+    
+    /**
+     * @brief 取消订阅并停止学习线程
+     * 
+     * @param flush 是否先训练完队列中的记录（否则丢弃）
+     */
+    void stop(bool flush = true);
+    
+    bool isRunning() const;
+    
+    /**
+     * @brief 用当前模型预测（与学习线程的更新互斥）
+     */
+    std::vector<double> predict(const ConstMatrixView& data);
+    
+    /**
+     * @brief 立即保存检查点
+     * 
+     * @return 是否成功（未设置检查点文件时返回false）
+     */
+    bool saveCheckpoint();
+    
+    OnlineLearningStats stats() const;
+    
+    /**
+     * @brief 最近的评分记录（按时间顺序）
+     */
+    std::vector<DriftSample> driftHistory() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct PendingRecord {
+        Data::DataRecord record;
+        uint64_t version = 0;
+        Clock::time_point arrived;
+    };
+    
+    void enqueue(const Data::DataRecord& record, uint64_t version);
+    void seedCategoryCodes();
+    void run();
+    void trainBatch(std::vector<PendingRecord>& batch);
+    bool evaluate(double& score);
+    bool writeCheckpoint();
+    
+    Data::IDataService& m_dataService;
+    IMLModel& m_model;
+    OnlineLearningOptions m_options;
+    
+    std::vector<Data::DataRecord> m_holdoutRecords;
+    std::unordered_set<std::string> m_holdoutIds;
+    Matrix m_holdoutFeatures;
+    std::vector<double> m_holdoutLabels;
+    std::map<std::string, double> m_categoryCodes;  // 只在启动时和学习线程上使用
+    
+    // 队列、统计和评分记录
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<PendingRecord> m_queue;
+    OnlineLearningStats m_stats;
+    std::deque<DriftSample> m_history;
+    bool m_stopping = false;
+    bool m_flush = false;
+    
+    // 模型状态和检查点进度（学习线程与 predict()、saveCheckpoint() 互斥）
+    std::mutex m_modelMutex;
+    size_t m_batchesSinceCheckpoint = 0;
+    Clock::time_point m_lastCheckpoint;
+    Clock::time_point m_started;
+    
+    std::mutex m_controlMutex;                      // 串行化 start()、stop() 和 setHoldout()
+    uint64_t m_subscription = 0;
+    std::thread m_thread;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,328 @@
+#include "PredictionService.h"
+#include "ModelCommon.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr size_t kRecentLatencyCount = 4096;
+
+double percentile(std::vector<double>& values, double fraction) {
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+std::exception_ptr serviceError(const std::string& message) {
+    return std::make_exception_ptr(std::runtime_error(message));
+}
+
+} // namespace
+
+PredictionService::PredictionService(const PredictionServiceOptions& options)
+    : m_options(options),
+      m_maxDelay(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double, std::milli>(std::max(0.0, options.maxDelayMilliseconds)))),
+      m_workers(options.workerCount) {
+    m_options.maxBatchSize = std::max<size_t>(1, m_options.maxBatchSize);
+    m_options.defaultModelConcurrency = std::max<size_t>(1, m_options.defaultModelConcurrency);
+    m_dispatcher = std::thread(&PredictionService::dispatchLoop, this);
+}
+
+PredictionService::~PredictionService() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    
+    // 调度线程把剩余请求全部派发并等到所有批次完成后才退出
+    if (m_dispatcher.joinable()) {
+        m_dispatcher.join();
+    }
+}
+
+PredictionService& PredictionService::instance() {
+    static PredictionService service;
+    return service;
+}
+
+bool PredictionService::registerModel(const std::string& name, std::shared_ptr<IMLModel> model, size_t maxConcurrency) {
+    if (!model) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping || m_models.count(name) > 0) {
+        return false;
+    }
+    
+    auto entry = std::make_shared<ModelEntry>();
+    entry->model = std::move(model);
+    entry->maxConcurrency = maxConcurrency > 0 ? maxConcurrency : m_options.defaultModelConcurrency;
+    entry->registered = Clock::now();
+    m_models.emplace(name, std::move(entry));
+    return true;
+}
+
+bool PredictionService::unregisterModel(const std::string& name) {
+    std::deque<Request> orphaned;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_models.find(name);
+        if (it == m_models.end()) {
+            return false;
+        }
+        orphaned.swap(it->second->queue);
+        m_models.erase(it);
+    }
+    
+    for (auto& request : orphaned) {
+        request.promise.set_exception(serviceError("Model was unregistered: " + name));
+    }
+    return true;
+}
+
+bool PredictionService::setModelConcurrency(const std::string& name, size_t maxConcurrency) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_models.find(name);
+        if (it == m_models.end()) {
+            return false;
+        }
+        it->second->maxConcurrency = maxConcurrency > 0 ? maxConcurrency : m_options.defaultModelConcurrency;
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+std::future<double> PredictionService::submit(const std::string& name, std::vector<double> features) {
+    Request request;
+    request.features = std::move(features);
+    std::future<double> future = request.promise.get_future();
+    
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_models.find(name);
+        if (it == m_models.end() || m_stopping) {
+            request.promise.set_exception(serviceError(
+                m_stopping ? "Prediction service is stopping" : "Unknown model: " + name));
+            return future;
+        }
+        
+        std::deque<Request>& queue = it->second->queue;
+        request.enqueued = Clock::now();
+        queue.push_back(std::move(request));
+        // 只有新的截止时间出现或队列凑满一批时才需要唤醒调度线程
+        wake = queue.size() == 1 || queue.size() == m_options.maxBatchSize;
+    }
+    if (wake) {
+        m_condition.notify_all();
+    }
+    return future;
+}
+
+std::vector<std::future<double>> PredictionService::submitBatch(const std::string& name, const ConstMatrixView& samples) {
+    std::vector<std::future<double>> futures;
+    futures.reserve(samples.rows());
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_models.find(name);
+        auto now = Clock::now();
+        for (size_t i = 0; i < samples.rows(); ++i) {
+            Request request;
+            futures.push_back(request.promise.get_future());
+            if (it == m_models.end() || m_stopping) {
+                request.promise.set_exception(serviceError(
+                    m_stopping ? "Prediction service is stopping" : "Unknown model: " + name));
+                continue;
+            }
+            request.features.assign(samples.row(i), samples.row(i) + samples.cols());
+            request.enqueued = now;
+            it->second->queue.push_back(std::move(request));
+        }
+    }
+    m_condition.notify_all();
+    return futures;
+}
+
+PredictionMetrics PredictionService::metrics(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_models.find(name);
+    if (it == m_models.end()) {
+        return PredictionMetrics();
+    }
+    return snapshot(*it->second);
+}
+
+std::map<std::string, PredictionMetrics> PredictionService::allMetrics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, PredictionMetrics> result;
+    for (const auto& [name, entry] : m_models) {
+        result.emplace(name, snapshot(*entry));
+    }
+    return result;
+}
+
+std::vector<std::string> PredictionService::registeredModels() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> names;
+    names.reserve(m_models.size());
+    for (const auto& [name, entry] : m_models) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+void PredictionService::dispatchLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    while (true) {
+        auto now = Clock::now();
+        auto wakeAt = Clock::time_point::max();
+        bool pending = false;
+        
+        for (auto& [name, entry] : m_models) {
+            std::deque<Request>& queue = entry->queue;
+            while (!queue.empty() && entry->inFlight < entry->maxConcurrency) {
+                // 队列未凑满一批且最早的请求还没到截止时间时继续等待
+                auto deadline = queue.front().enqueued + m_maxDelay;
+                if (queue.size() < m_options.maxBatchSize && deadline > now && !m_stopping) {
+                    wakeAt = std::min(wakeAt, deadline);
+                    break;
+                }
+                
+                size_t count = std::min(queue.size(), m_options.maxBatchSize);
+                std::vector<Request> batch;
+                batch.reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+                ++entry->inFlight;
+                ++m_totalInFlight;
+                m_workers.submit([this, entry, batch = std::move(batch)]() mutable {
+                    runBatch(std::move(entry), std::move(batch));
+                });
+            }
+            // 达到并发上限的模型由批次完成时的通知唤醒
+            pending = pending || !queue.empty();
+        }
+        
+        if (m_stopping && !pending && m_totalInFlight == 0) {
+            return;
+        }
+        if (wakeAt == Clock::time_point::max()) {
+            m_condition.wait(lock);
+        } else {
+            m_condition.wait_until(lock, wakeAt);
+        }
+    }
+}
+
+void PredictionService::runBatch(std::shared_ptr<ModelEntry> entry, std::vector<Request> batch) {
+    // 特征数以批内第一个请求为准，特征数不同的请求单独失败，不影响同批其他请求
+    const size_t numFeatures = batch.front().features.size();
+    std::vector<size_t> valid;
+    valid.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch[i].features.size() == numFeatures) {
+            valid.push_back(i);
+        } else {
+            batch[i].promise.set_exception(serviceError("Feature count does not match the rest of the batch"));
+        }
+    }
+    
+    std::vector<double> predictions;
+    std::exception_ptr error;
+    try {
+        Matrix samples(valid.size(), numFeatures);
+        for (size_t i = 0; i < valid.size(); ++i) {
+            std::copy(batch[valid[i]].features.begin(), batch[valid[i]].features.end(), samples.row(i));
+        }
+        predictions = entry->model->predict(samples);
+        if (predictions.size() != valid.size()) {
+            error = serviceError("Model returned " + std::to_string(predictions.size()) +
+                                 " predictions for a batch of " + std::to_string(valid.size()));
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    
+    for (size_t i = 0; i < valid.size(); ++i) {
+        if (error) {
+            batch[valid[i]].promise.set_exception(error);
+        } else {
+            batch[valid[i]].promise.set_value(predictions[i]);
+        }
+    }
+    
+    auto finished = Clock::now();
+    std::vector<double> latencies(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        latencies[i] = std::chrono::duration<double, std::milli>(finished - batch[i].enqueued).count();
+    }
+    size_t failed = error ? batch.size() : batch.size() - valid.size();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        recordBatch(*entry, latencies, failed);
+        --entry->inFlight;
+        --m_totalInFlight;
+    }
+    m_condition.notify_all();
+}
+
+void PredictionService::recordBatch(ModelEntry& entry, const std::vector<double>& latencies, size_t failed) {
+    ++entry.batches;
+    entry.requests += latencies.size();
+    entry.failedRequests += failed;
+    
+    for (double latency : latencies) {
+        entry.totalLatency += latency;
+        entry.maxLatency = std::max(entry.maxLatency, latency);
+        if (entry.recentLatencies.size() < kRecentLatencyCount) {
+            entry.recentLatencies.push_back(latency);
+        } else {
+            entry.recentLatencies[entry.recentNext] = latency;
+            entry.recentNext = (entry.recentNext + 1) % kRecentLatencyCount;
+        }
+    }
+}
+
+PredictionMetrics PredictionService::snapshot(const ModelEntry& entry) {
+    PredictionMetrics metrics;
+    metrics.requests = entry.requests;
+    metrics.batches = entry.batches;
+    metrics.failedRequests = entry.failedRequests;
+    metrics.queueDepth = entry.queue.size();
+    metrics.inFlightBatches = entry.inFlight;
+    metrics.maxLatencyMilliseconds = entry.maxLatency;
+    
+    if (entry.batches > 0) {
+        metrics.meanBatchSize = static_cast<double>(entry.requests) / static_cast<double>(entry.batches);
+        metrics.meanLatencyMilliseconds = entry.totalLatency / static_cast<double>(entry.requests);
+    }
+    if (!entry.recentLatencies.empty()) {
+        std::vector<double> recent = entry.recentLatencies;
+        metrics.p50LatencyMilliseconds = percentile(recent, 0.50);
+        metrics.p95LatencyMilliseconds = percentile(recent, 0.95);
+        metrics.p99LatencyMilliseconds = percentile(recent, 0.99);
+    }
+    
+    double elapsed = secondsSince(entry.registered);
+    if (elapsed > 0.0) {
+        metrics.throughputPerSecond = static_cast<double>(entry.requests) / elapsed;
+    }
+    return metrics;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <deque>
+#include <string>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include "MLModels.h"
+#include "../../utils/ThreadPool.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 预测服务选项
+ */
+struct PredictionServiceOptions {
+    size_t maxBatchSize = 256;              // 每个微批次的最大样本数
+    double maxDelayMilliseconds = 2.0;      // 请求在队列中等待凑批的最长时间
+    size_t workerCount = 0;                 // 执行预测的工作线程数（0表示硬件线程数）
+    size_t defaultModelConcurrency = 1;     // 每个模型同时执行的批次数上限的默认值
+};
+
+/**
+ * @brief 单个模型的预测统计
+ * 
+ * 延迟从提交请求到结果可用为止（包括排队和凑批的等待）；分位数基于最近的请求。
+ */
+struct PredictionMetrics {
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    uint64_t failedRequests = 0;
+    size_t queueDepth = 0;
+    size_t inFlightBatches = 0;
+    double meanBatchSize = 0.0;
+    double meanLatencyMilliseconds = 0.0;
+    double p50LatencyMilliseconds = 0.0;
+    double p95LatencyMilliseconds = 0.0;
+    double p99LatencyMilliseconds = 0.0;
+    double maxLatencyMilliseconds = 0.0;
+    double throughputPerSecond = 0.0;       // 注册以来完成的请求数/秒
+};
+
+/**
+ * @brief 微批处理预测服务
+ * 
+ * 单条记录逐次调用 IMLModel::predict() 时，每次调用的固定开销（矩阵构造、模型内部的
+ * 准备和并行调度）远大于实际计算。本服务把单条预测请求放入所属模型的队列，
+ * 由调度线程把排队的请求合并成微批次：队列达到 maxBatchSize 或最早的请求等待超过
+ * maxDelayMilliseconds 时，整批在工作线程池上执行一次 predict()，然后逐个完成各请求的 future。
+ * 
+ * 每个模型可以设置同时执行的批次数上限。IMLModel::predict() 不保证线程安全，
+ * 默认上限为1；只有确认模型的预测可以并发时才应提高上限。
+ * 达到上限时请求继续排队，下一批会更大，因此负载高时批次自动变大、吞吐量提高。
+ * 
+ * 插件通过 instance() 取得全局服务实例注册模型和提交请求。
+ */
+class PredictionService {
+public:
+    explicit PredictionService(const PredictionServiceOptions& options = {});
+    
+    /**
+     * @brief 停止服务：已排队的请求全部执行完后返回
+     */
+    ~PredictionService();
+    
+    PredictionService(const PredictionService&) = delete;
+    PredictionService& operator=(const PredictionService&) = delete;
+    
+    /**
+     * @brief 全局预测服务（默认选项）
+     */
+    static PredictionService& instance();
+    
+    /**
+     * @brief 注册模型
+     * 
+     * @param name 模型名称（已存在时失败）
+     * @param model 已训练的模型（服务持有共享所有权）
+     * @param maxConcurrency 同时执行的批次数上限（0表示使用默认值）
+     * @return 是否成功
+     */
+    bool registerModel(const std::string& name, std::shared_ptr<IMLModel> model, size_t maxConcurrency = 0);
+    
+    /**
+     * @brief 注销模型
+     * 
+     * 排队中的请求以异常结束；正在执行的批次照常完成。
+     * 
+     * @return 模型是否存在
+     */
+    bool unregisterModel(const std::string& name);
+    
+    /**
+     * @brief 修改模型的并发批次数上限
+     */
+    bool setModelConcurrency(const std::string& name, size_t maxConcurrency);
+    
+    /**
+     * @brief 提交单条预测请求
+     * 
+     * 模型不存在、特征数与同批其他请求不一致或模型预测失败时，future 中保存 std::runtime_error。
+     * 
+     * @param name 模型名称
+     * @param features 样本特征
+     * @return 预测值的 future
+     */
+    std::future<double> submit(const std::string& name, std::vector<double> features);
+    
+    /**
+     * @brief 提交多条预测请求（每行一条，按行返回 future）
+     */
+    std::vector<std::future<double>> submitBatch(const std::string& name, const ConstMatrixView& samples);
+    
+    /**
+     * @brief 单个模型的统计
+     */
+    PredictionMetrics metrics(const std::string& name) const;
+    
+    /**
+     * @brief 所有已注册模型的统计
+     */
+    std::map<std::string, PredictionMetrics> allMetrics() const;
+    
+    std::vector<std::string> registeredModels() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Request {
+        std::vector<double> features;
+        std::promise<double> promise;
+        Clock::time_point enqueued;
+    };
+    
+    struct ModelEntry {
+        std::shared_ptr<IMLModel> model;
+        size_t maxConcurrency = 1;
+        size_t inFlight = 0;
+        std::deque<Request> queue;
+        
+        // 统计
+        Clock::time_point registered;
+        uint64_t requests = 0;
+        uint64_t batches = 0;
+        uint64_t failedRequests = 0;
+        double totalLatency = 0.0;
+        double maxLatency = 0.0;
+        std::vector<double> recentLatencies;    // 最近请求延迟的环形缓冲区（毫秒）
+        size_t recentNext = 0;
+    };
+    
+    void dispatchLoop();
+    void runBatch(std::shared_ptr<ModelEntry> entry, std::vector<Request> batch);
+    void recordBatch(ModelEntry& entry, const std::vector<double>& latencies, size_t failed);
+    static PredictionMetrics snapshot(const ModelEntry& entry);
+    
+    PredictionServiceOptions m_options;
+    Clock::duration m_maxDelay;
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::map<std::string, std::shared_ptr<ModelEntry>> m_models;
+    size_t m_totalInFlight = 0;
+    bool m_stopping = false;
+    
+    // 工作线程池在互斥量等成员之后声明，析构时先于它们销毁（执行中的批次仍会访问这些成员）
+    Utils::ThreadPool m_workers;
+    std::thread m_dispatcher;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,474 @@
+#include "PreprocessingPipeline.h"
+#include "../chemistry/MolecularDescriptors.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+constexpr uint32_t kPipelineFileMagic = 0x50504642;  // "BFPP"
+constexpr uint32_t kPipelineFileVersion = 1;
+
+// 每个数据块的记录数；统计量按块累计后按块顺序合并，结果与线程数无关
+constexpr size_t kBlockRecords = 1024;
+
+/**
+ * @brief 特征类型和标签类型在处理记录前解析一次，逐条记录时不再比较字符串
+ */
+enum class FeatureKind { ContentLength, Timestamp, Category, Multi, Descriptors, Unknown };
+enum class LabelKind { ContentLength, Category, Binary, None };
+
+FeatureKind featureKind(const std::string& featureType) {
+    if (featureType == "content_length") {
+        return FeatureKind::ContentLength;
+    }
+    if (featureType == "timestamp") {
+        return FeatureKind::Timestamp;
+    }
+    if (featureType == "category_encoded") {
+        return FeatureKind::Category;
+    }
+    if (featureType == "multi_feature") {
+        return FeatureKind::Multi;
+    }
+    if (featureType == "molecular_descriptors") {
+        return FeatureKind::Descriptors;
+    }
+    return FeatureKind::Unknown;
+}
+
+LabelKind labelKind(const std::string& labelType) {
+    if (labelType == "content_length") {
+        return LabelKind::ContentLength;
+    }
+    if (labelType == "category") {
+        return LabelKind::Category;
+    }
+    if (labelType == "binary_classification") {
+        return LabelKind::Binary;
+    }
+    return LabelKind::None;
+}
+
+void extractRow(FeatureKind kind, const Data::DataRecord& record, double categoryCode, double* out) {
+    switch (kind) {
+    case FeatureKind::ContentLength:
+        out[0] = static_cast<double>(record.content.length());
+        break;
+    case FeatureKind::Timestamp:
+        out[0] = static_cast<double>(record.timestamp / (24 * 3600));
+        break;
+    case FeatureKind::Category:
+        out[0] = categoryCode;
+        break;
+    case FeatureKind::Multi:
+        out[0] = static_cast<double>(record.content.length());
+        out[1] = static_cast<double>(record.timestamp / (24 * 3600));
+        out[2] = categoryCode;
+        break;
+    case FeatureKind::Descriptors:
+        Chemistry::DescriptorCalculator::compute(record.content, record.format, out);
+        break;
+    case FeatureKind::Unknown:
+        break;
+    }
+}
+
+double extractLabel(LabelKind kind, const Data::DataRecord& record, double categoryCode) {
+    switch (kind) {
+    case LabelKind::ContentLength:
+        return static_cast<double>(record.content.length());
+    case LabelKind::Category:
+        return categoryCode;
+    case LabelKind::Binary:
+        return (record.category == "molecule" || record.category == "compound") ? 1.0 : 0.0;
+    case LabelKind::None:
+        break;
+    }
+    return 0.0;
+}
+
+/**
+ * @brief 一个数据块中训练行的逐列统计量
+ */
+struct ColumnStats {
+    size_t count = 0;
+    std::vector<double> minimum;
+    std::vector<double> maximum;
+    std::vector<double> mean;
+    std::vector<double> m2;     // 离均差平方和
+    
+    void reset(size_t cols, FeatureScaling scaling) {
+        count = 0;
+        if (scaling == FeatureScaling::MinMax) {
+            minimum.assign(cols, std::numeric_limits<double>::max());
+            maximum.assign(cols, std::numeric_limits<double>::lowest());
+        } else if (scaling == FeatureScaling::Standard) {
+            mean.assign(cols, 0.0);
+            m2.assign(cols, 0.0);
+        }
+    }
+    
+    void add(const double* row) {
+        ++count;
+        for (size_t j = 0; j < minimum.size(); ++j) {
+            minimum[j] = std::min(minimum[j], row[j]);
+            maximum[j] = std::max(maximum[j], row[j]);
+        }
+        for (size_t j = 0; j < mean.size(); ++j) {
+            double delta = row[j] - mean[j];
+            mean[j] += delta / static_cast<double>(count);
+            m2[j] += delta * (row[j] - mean[j]);
+        }
+    }
+    
+    void merge(const ColumnStats& other) {
+        if (other.count == 0) {
+            return;
+        }
+        for (size_t j = 0; j < minimum.size(); ++j) {
+            minimum[j] = std::min(minimum[j], other.minimum[j]);
+            maximum[j] = std::max(maximum[j], other.maximum[j]);
+        }
+        // 两组均值和离均差平方和的合并（Chan 等人的并行算法）
+        double total = static_cast<double>(count + other.count);
+        for (size_t j = 0; j < mean.size(); ++j) {
+            double delta = other.mean[j] - mean[j];
+            mean[j] += delta * static_cast<double>(other.count) / total;
+            m2[j] += other.m2[j] + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / total;
+        }
+        count += other.count;
+    }
+};
+
+FittedScaler fitScaler(const ColumnStats& stats, FeatureScaling scaling, size_t cols) {
+    FittedScaler scaler;
+    scaler.scaling = scaling;
+    if (scaling == FeatureScaling::None) {
+        return scaler;
+    }
+    
+    scaler.offset.assign(cols, 0.0);
+    scaler.scale.assign(cols, 0.0);
+    if (stats.count == 0) {
+        return scaler;
+    }
+    for (size_t j = 0; j < cols; ++j) {
+        double offset = 0.0;
+        double spread = 0.0;
+        if (scaling == FeatureScaling::MinMax) {
+            offset = stats.minimum[j];
+            spread = stats.maximum[j] - stats.minimum[j];
+        } else {
+            offset = stats.mean[j];
+            spread = std::sqrt(stats.m2[j] / static_cast<double>(stats.count));
+        }
+        scaler.offset[j] = offset;
+        scaler.scale[j] = spread > 0.0 ? 1.0 / spread : 0.0;
+    }
+    return scaler;
+}
+
+void writeString(std::ofstream& file, const std::string& value) {
+    uint64_t length = value.size();
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool readString(std::ifstream& file, std::string& value) {
+    uint64_t length = 0;
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!file || length > (uint64_t(1) << 20)) {
+        return false;
+    }
+    value.resize(static_cast<size_t>(length));
+    file.read(&value[0], static_cast<std::streamsize>(length));
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+// FittedScaler 实现
+void FittedScaler::apply(const MatrixView& data) const {
+    if (scaling == FeatureScaling::None || scale.size() != data.cols()) {
+        return;
+    }
+    for (size_t i = 0; i < data.rows(); ++i) {
+        double* row = data.row(i);
+        for (size_t j = 0; j < data.cols(); ++j) {
+            row[j] = (row[j] - offset[j]) * scale[j];
+        }
+    }
+}
+
+// PreprocessingPipeline 实现
+PreprocessingPipeline& PreprocessingPipeline::setFeatureType(const std::string& featureType) {
+    m_featureType = featureType;
+    m_fitted = false;
+    return *this;
+}
+
+PreprocessingPipeline& PreprocessingPipeline::setLabelType(const std::string& labelType) {
+    m_labelType = labelType;
+    m_fitted = false;
+    return *this;
+}
+
+PreprocessingPipeline& PreprocessingPipeline::setScaling(FeatureScaling scaling) {
+    m_scaling = scaling;
+    m_fitted = false;
+    return *this;
+}
+
+PreprocessingPipeline& PreprocessingPipeline::setTrainRatio(double trainRatio) {
+    m_trainRatio = std::min(1.0, std::max(0.0, trainRatio));
+    return *this;
+}
+
+PreprocessingPipeline& PreprocessingPipeline::setSeed(uint64_t seed) {
+    m_seed = seed;
+    return *this;
+}
+
+size_t PreprocessingPipeline::featureCount(const std::string& featureType) {
+    if (featureType == "content_length" || featureType == "timestamp" || featureType == "category_encoded") {
+        return 1;
+    }
+    if (featureType == "multi_feature") {
+        return 3;
+    }
+    if (featureType == "molecular_descriptors") {
+        return Chemistry::DescriptorCalculator::DescriptorCount;
+    }
+    return 0;
+}
+
+PreprocessedData PreprocessingPipeline::fitTransform(const std::vector<Data::DataRecord>& records) {
+    const size_t count = records.size();
+    const size_t cols = featureCount(m_featureType);
+    const FeatureKind features = featureKind(m_featureType);
+    const LabelKind labels = labelKind(m_labelType);
+    PreprocessedData result;
+    
+    // 类别编码按首次出现的顺序编号（与 extractFeatures/extractLabels 相同），特征和标签共用
+    m_categories.clear();
+    m_categoryCodes.clear();
+    std::vector<double> codes;
+    if (usesCategories()) {
+        codes.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto it = m_categoryCodes.find(records[i].category);
+            if (it == m_categoryCodes.end()) {
+                it = m_categoryCodes.emplace(records[i].category, static_cast<double>(m_categories.size())).first;
+                m_categories.push_back(records[i].category);
+            }
+            codes[i] = it->second;
+        }
+    }
+    
+    // 随机划分，两个子集内部保持记录顺序；每条记录的目标行在并行处理前确定
+    size_t trainSize = static_cast<size_t>(static_cast<double>(count) * m_trainRatio);
+    std::vector<uint8_t> inTrain(count, 1);
+    if (trainSize < count) {
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937_64 generator(m_seed != 0 ? m_seed : std::random_device()());
+        std::shuffle(order.begin(), order.end(), generator);
+        for (size_t i = trainSize; i < count; ++i) {
+            inTrain[order[i]] = 0;
+        }
+    }
+    
+    std::vector<size_t> destination(count);
+    result.trainIndices.reserve(trainSize);
+    result.testIndices.reserve(count - trainSize);
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<size_t>& indices = inTrain[i] ? result.trainIndices : result.testIndices;
+        destination[i] = indices.size();
+        indices.push_back(i);
+    }
+    
+    result.trainFeatures.assign(result.trainIndices.size(), cols);
+    result.testFeatures.assign(result.testIndices.size(), cols);
+    if (labels != LabelKind::None) {
+        result.trainLabels.assign(result.trainIndices.size(), 0.0);
+        result.testLabels.assign(result.testIndices.size(), 0.0);
+    }
+    
+    // 单遍并行处理：提取、编码、写入目标行并累计训练行的统计量
+    const size_t blockCount = (count + kBlockRecords - 1) / kBlockRecords;
+    std::vector<ColumnStats> blockStats(blockCount);
+    Utils::ThreadPool::instance().parallelFor(0, blockCount, 1,
+        [&](size_t blockBegin, size_t blockEnd) {
+            for (size_t block = blockBegin; block < blockEnd; ++block) {
+                ColumnStats& stats = blockStats[block];
+                stats.reset(cols, m_scaling);
+                size_t end = std::min(count, (block + 1) * kBlockRecords);
+                for (size_t i = block * kBlockRecords; i < end; ++i) {
+                    double code = codes.empty() ? 0.0 : codes[i];
+                    double* row = (inTrain[i] ? result.trainFeatures : result.testFeatures).row(destination[i]);
+                    extractRow(features, records[i], code, row);
+                    if (labels != LabelKind::None) {
+                        (inTrain[i] ? result.trainLabels : result.testLabels)[destination[i]] = extractLabel(labels, records[i], code);
+                    }
+                    if (inTrain[i] && m_scaling != FeatureScaling::None) {
+                        stats.add(row);
+                    }
+                }
+            }
+        });
+    
+    ColumnStats total;
+    total.reset(cols, m_scaling);
+    for (const ColumnStats& stats : blockStats) {
+        total.merge(stats);
+    }
+    m_scaler = fitScaler(total, m_scaling, cols);
+    m_fitted = true;
+    
+    // 输出矩阵就地缩放
+    if (m_scaling != FeatureScaling::None) {
+        for (Matrix* features : {&result.trainFeatures, &result.testFeatures}) {
+            MatrixView view = features->view();
+            Utils::ThreadPool::instance().parallelFor(0, view.rows(), kBlockRecords,
+                [&](size_t begin, size_t end) {
+                    m_scaler.apply(view.rowRange(begin, end));
+                });
+        }
+    }
+    return result;
+}
+
+bool PreprocessingPipeline::transform(const std::vector<Data::DataRecord>& records, Matrix& features) const {
+    if (!m_fitted) {
+        return false;
+    }
+    
+    const FeatureKind kind = featureKind(m_featureType);
+    const bool categories = kind == FeatureKind::Category || kind == FeatureKind::Multi;
+    features.assign(records.size(), featureCount(m_featureType));
+    MatrixView view = features.view();
+    Utils::ThreadPool::instance().parallelFor(0, records.size(), kBlockRecords,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double code = categories ? categoryCode(records[i].category) : 0.0;
+                extractRow(kind, records[i], code, view.row(i));
+            }
+            m_scaler.apply(view.rowRange(begin, end));
+        });
+    return true;
+}
+
+bool PreprocessingPipeline::save(const std::string& filePath) const {
+    if (!m_fitted) {
+        return false;
+    }
+    
+    try {
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        uint32_t header[3] = {kPipelineFileMagic, kPipelineFileVersion, static_cast<uint32_t>(m_scaler.scaling)};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        writeString(file, m_featureType);
+        writeString(file, m_labelType);
+        
+        uint64_t cols = m_scaler.scale.size();
+        file.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+        file.write(reinterpret_cast<const char*>(m_scaler.offset.data()), cols * sizeof(double));
+        file.write(reinterpret_cast<const char*>(m_scaler.scale.data()), cols * sizeof(double));
+        
+        uint64_t categoryCount = m_categories.size();
+        file.write(reinterpret_cast<const char*>(&categoryCount), sizeof(categoryCount));
+        for (const std::string& category : m_categories) {
+            writeString(file, category);
+        }
+        file.close();
+        return !file.fail();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool PreprocessingPipeline::load(const std::string& filePath) {
+    try {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        uint32_t header[3] = {0, 0, 0};
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!file || header[0] != kPipelineFileMagic || header[1] != kPipelineFileVersion ||
+            header[2] > static_cast<uint32_t>(FeatureScaling::Standard)) {
+            return false;
+        }
+        
+        std::string featureType;
+        std::string labelType;
+        if (!readString(file, featureType) || !readString(file, labelType)) {
+            return false;
+        }
+        
+        FittedScaler scaler;
+        scaler.scaling = static_cast<FeatureScaling>(header[2]);
+        uint64_t cols = 0;
+        file.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+        bool expectedCols = scaler.scaling == FeatureScaling::None ? cols == 0 : cols == featureCount(featureType);
+        if (!file || !expectedCols) {
+            return false;
+        }
+        scaler.offset.resize(static_cast<size_t>(cols));
+        scaler.scale.resize(static_cast<size_t>(cols));
+        file.read(reinterpret_cast<char*>(scaler.offset.data()), cols * sizeof(double));
+        file.read(reinterpret_cast<char*>(scaler.scale.data()), cols * sizeof(double));
+        
+        uint64_t categoryCount = 0;
+        file.read(reinterpret_cast<char*>(&categoryCount), sizeof(categoryCount));
+        if (!file || categoryCount > (uint64_t(1) << 24)) {
+            return false;
+        }
+        std::vector<std::string> categories(static_cast<size_t>(categoryCount));
+        std::unordered_map<std::string, double> categoryCodes;
+        for (size_t i = 0; i < categories.size(); ++i) {
+            if (!readString(file, categories[i])) {
+                return false;
+            }
+            categoryCodes.emplace(categories[i], static_cast<double>(i));
+        }
+        
+        m_featureType = std::move(featureType);
+        m_labelType = std::move(labelType);
+        m_scaling = scaler.scaling;
+        m_scaler = std::move(scaler);
+        m_categories = std::move(categories);
+        m_categoryCodes = std::move(categoryCodes);
+        m_fitted = true;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool PreprocessingPipeline::usesCategories() const {
+    return m_featureType == "category_encoded" || m_featureType == "multi_feature" || m_labelType == "category";
+}
+
+double PreprocessingPipeline::categoryCode(const std::string& category) const {
+    auto it = m_categoryCodes.find(category);
+    return it != m_categoryCodes.end() ? it->second : static_cast<double>(m_categories.size());
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
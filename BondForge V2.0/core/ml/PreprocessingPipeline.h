@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "Matrix.h"
+#include "../data/DataRecord.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 特征缩放方式
+ */
+enum class FeatureScaling {
+    None,       // 原始特征
+    MinMax,     // 逐列缩放到[0,1]（与 DataPreprocessor::normalize 相同）
+    Standard    // 逐列减去均值再除以标准差
+};
+
+/**
+ * @brief 拟合得到的特征缩放参数
+ * 
+ * 每列变换为 (x - offset) * scale；取值范围或标准差为0的列变换为0。
+ */
+struct FittedScaler {
+    FeatureScaling scaling = FeatureScaling::None;
+    std::vector<double> offset;
+    std::vector<double> scale;
+    
+    /**
+     * @brief 对矩阵就地应用缩放（列数须与拟合时相同，None 时不做任何事）
+     */
+    void apply(const MatrixView& data) const;
+};
+
+/**
+ * @brief 预处理结果
+ */
+struct PreprocessedData {
+    Matrix trainFeatures;
+    Matrix testFeatures;
+    std::vector<double> trainLabels;        // 未设置标签类型或标签类型未知时为空
+    std::vector<double> testLabels;
+    std::vector<size_t> trainIndices;       // 各行对应的记录下标（按记录顺序）
+    std::vector<size_t> testIndices;
+};
+
+/**
+ * @brief 单遍预处理流水线
+ * 
+ * 分别调用 extractFeatures、extractLabels、normalize 和 splitTrainTest 时，每一步都要遍历
+ * 全部数据并分配新的矩阵，特征和标签各自重建一遍类别编码。本流水线先按随机划分确定
+ * 每条记录在训练集或测试集中的行，然后在线程池上对记录做一遍并行处理：特征和标签直接写入
+ * 预先分配的训练/测试矩阵，同时按数据块累计训练行的缩放统计量；最后按合并后的统计量
+ * 对输出矩阵就地缩放。缩放参数只由训练集拟合，测试集不参与。
+ * 
+ * 拟合后流水线保存类别编码和缩放参数，transform() 用它们处理预测时的新记录，
+ * 不需要重新计算；save()/load() 把这些参数与模型一起保存。
+ * 
+ * 设置方法返回自身，可以链式组合：
+ * @code
+ * PreprocessingPipeline pipeline;
+ * pipeline.setFeatureType("molecular_descriptors").setScaling(FeatureScaling::Standard).setTrainRatio(0.8);
+ * PreprocessedData data = pipeline.fitTransform(records);
+ * @endcode
+ */
+class PreprocessingPipeline {
+public:
+    /**
+     * @brief 特征类型（同 DataPreprocessor::extractFeatures）
+     */
+    PreprocessingPipeline& setFeatureType(const std::string& featureType);
+    
+    /**
+     * @brief 标签类型（同 DataPreprocessor::extractLabels；空字符串表示不提取标签）
+     */
+    PreprocessingPipeline& setLabelType(const std::string& labelType);
+    
+    PreprocessingPipeline& setScaling(FeatureScaling scaling);
+    
+    /**
+     * @brief 训练集比例（1表示不划分测试集）
+     */
+    PreprocessingPipeline& setTrainRatio(double trainRatio);
+    
+    /**
+     * @brief 划分的随机种子（0表示每次使用不同的随机种子）
+     */
+    PreprocessingPipeline& setSeed(uint64_t seed);
+    
+    /**
+     * @brief 拟合类别编码和缩放参数，并输出划分、缩放后的训练集和测试集
+     * 
+     * @param records 数据记录
+     * @return 预处理结果
+     */
+    PreprocessedData fitTransform(const std::vector<Data::DataRecord>& records);
+    
+    /**
+     * @brief 用已拟合的参数处理新记录（预测时使用）
+     * 
+     * 拟合时未出现过的类别编码为已知类别数。
+     * 
+     * @param records 数据记录
+     * @param features 输出的特征矩阵（每条记录一行）
+     * @return 是否成功（尚未拟合时失败）
+     */
+    bool transform(const std::vector<Data::DataRecord>& records, Matrix& features) const;
+    
+    /**
+     * @brief 保存特征类型、类别编码和缩放参数
+     */
+    bool save(const std::string& filePath) const;
+    
+    /**
+     * @brief 加载 save() 保存的参数，加载后即为已拟合状态
+     */
+    bool load(const std::string& filePath);
+    
+    bool isFitted() const { return m_fitted; }
+    const std::string& featureType() const { return m_featureType; }
+    const std::string& labelType() const { return m_labelType; }
+    const FittedScaler& scaler() const { return m_scaler; }
+    const std::vector<std::string>& categories() const { return m_categories; }
+    
+    /**
+     * @brief 特征类型对应的特征数（未知类型为0）
+     */
+    static size_t featureCount(const std::string& featureType);
+
+private:
+    bool usesCategories() const;
+    double categoryCode(const std::string& category) const;
+    
+    std::string m_featureType = "content_length";
+    std::string m_labelType = "category";
+    FeatureScaling m_scaling = FeatureScaling::None;
+    double m_trainRatio = 0.8;
+    uint64_t m_seed = 0;
+    
+    // 拟合结果
+    bool m_fitted = false;
+    std::vector<std::string> m_categories;                  // 编码 -> 类别
+    std::unordered_map<std::string, double> m_categoryCodes;
+    FittedScaler m_scaler;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,493 @@
+#include "ReducedPrecision.h"
+#include "TreeModels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 每次转换为单精度（或编码）的样本行数：一块样本和参数留在L1/L2缓存中
+constexpr size_t kBlockRows = 256;
+
+// 8位编码的阈值序号上限（编码值为 0..255）
+constexpr size_t kMaxCuts = 255;
+
+// 树的批量遍历时同步下降的样本数
+constexpr size_t kTraversalBatchRows = 64;
+
+/**
+ * @brief 把若干行双精度样本转换为连续的单精度块
+ */
+void convertRows(const ConstMatrixView& data, size_t begin, size_t end, float* out) {
+    const size_t cols = data.cols();
+    for (size_t i = begin; i < end; ++i) {
+        const double* row = data.row(i);
+        float* target = out + (i - begin) * cols;
+        size_t j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+        for (; j + 4 <= cols; j += 4) {
+            _mm_storeu_ps(target + j, _mm256_cvtpd_ps(_mm256_loadu_pd(row + j)));
+        }
+#endif
+        for (; j < cols; ++j) {
+            target[j] = static_cast<float>(row[j]);
+        }
+    }
+}
+
+// 线性层一个样本块的单精度数据量上限：转换后的块留在L1/L2缓存中，每个输出的权重都在块上重复使用
+constexpr size_t kLinearBlockBytes = 32 * 1024;
+
+#if defined(__AVX2__) && defined(__FMA__)
+inline __m256 loadWeights(const float* weights) {
+    return _mm256_loadu_ps(weights);
+}
+
+inline __m256 loadWeights(const int8_t* weights) {
+    __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(weights));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(packed));
+}
+
+inline float horizontalSum(__m256 value) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, value);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+/**
+ * @brief 同时求8个向量各自的元素和，第 k 个和写入 sums[k]
+ */
+inline void horizontalSums8(const __m256* values, float* sums) {
+    __m256 a = _mm256_hadd_ps(_mm256_hadd_ps(values[0], values[1]), _mm256_hadd_ps(values[2], values[3]));
+    __m256 b = _mm256_hadd_ps(_mm256_hadd_ps(values[4], values[5]), _mm256_hadd_ps(values[6], values[7]));
+    _mm256_storeu_ps(sums, _mm256_add_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31)));
+}
+#endif
+
+/**
+ * @brief 一组权重与一个样本的点积
+ */
+template <typename Weight>
+float dot(const Weight* weights, const float* x, size_t n) {
+    size_t j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; j + 16 <= n; j += 16) {
+        acc0 = _mm256_fmadd_ps(loadWeights(weights + j), _mm256_loadu_ps(x + j), acc0);
+        acc1 = _mm256_fmadd_ps(loadWeights(weights + j + 8), _mm256_loadu_ps(x + j + 8), acc1);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+#else
+    float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (; j + 8 <= n; j += 8) {
+        for (size_t k = 0; k < 8; ++k) {
+            acc[k] += static_cast<float>(weights[j + k]) * x[j + k];
+        }
+    }
+    float sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+#endif
+    for (; j < n; ++j) {
+        sum += static_cast<float>(weights[j]) * x[j];
+    }
+    return sum;
+}
+
+/**
+ * @brief 4个连续样本与一组权重的点积（权重每次加载后用于4个样本）
+ *
+ * 第 r 个样本的点积写入 sums[r * stride]。
+ */
+template <typename Weight>
+void dotTile4x1(const Weight* w, const float* x, size_t n, float* sums, size_t stride) {
+    size_t j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        __m256 weights = loadWeights(w + j);
+        acc0 = _mm256_fmadd_ps(weights, _mm256_loadu_ps(x + j), acc0);
+        acc1 = _mm256_fmadd_ps(weights, _mm256_loadu_ps(x + n + j), acc1);
+        acc2 = _mm256_fmadd_ps(weights, _mm256_loadu_ps(x + 2 * n + j), acc2);
+        acc3 = _mm256_fmadd_ps(weights, _mm256_loadu_ps(x + 3 * n + j), acc3);
+    }
+    float s0 = horizontalSum(acc0), s1 = horizontalSum(acc1), s2 = horizontalSum(acc2), s3 = horizontalSum(acc3);
+#else
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+#endif
+    for (; j < n; ++j) {
+        float weight = static_cast<float>(w[j]);
+        s0 += weight * x[j];
+        s1 += weight * x[n + j];
+        s2 += weight * x[2 * n + j];
+        s3 += weight * x[3 * n + j];
+    }
+    sums[0] = s0;
+    sums[stride] = s1;
+    sums[2 * stride] = s2;
+    sums[3 * stride] = s3;
+}
+
+/**
+ * @brief 4个连续样本与两组相邻权重的点积（一个 4×2 的矩阵乘法分块，8个累加器都在寄存器中）
+ *
+ * 第 r 个样本与第 k 组权重的点积写入 sums[r * stride + k]。
+ */
+template <typename Weight>
+void dotTile4x2(const Weight* w, const float* x, size_t n, float* sums, size_t stride) {
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc[8];
+    __m256 a00 = _mm256_setzero_ps(), a01 = _mm256_setzero_ps();
+    __m256 a10 = _mm256_setzero_ps(), a11 = _mm256_setzero_ps();
+    __m256 a20 = _mm256_setzero_ps(), a21 = _mm256_setzero_ps();
+    __m256 a30 = _mm256_setzero_ps(), a31 = _mm256_setzero_ps();
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256 w0 = loadWeights(w + j);
+        __m256 w1 = loadWeights(w + n + j);
+        __m256 x0 = _mm256_loadu_ps(x + j);
+        __m256 x1 = _mm256_loadu_ps(x + n + j);
+        a00 = _mm256_fmadd_ps(w0, x0, a00);
+        a01 = _mm256_fmadd_ps(w1, x0, a01);
+        a10 = _mm256_fmadd_ps(w0, x1, a10);
+        a11 = _mm256_fmadd_ps(w1, x1, a11);
+        __m256 x2 = _mm256_loadu_ps(x + 2 * n + j);
+        __m256 x3 = _mm256_loadu_ps(x + 3 * n + j);
+        a20 = _mm256_fmadd_ps(w0, x2, a20);
+        a21 = _mm256_fmadd_ps(w1, x2, a21);
+        a30 = _mm256_fmadd_ps(w0, x3, a30);
+        a31 = _mm256_fmadd_ps(w1, x3, a31);
+    }
+    acc[0] = a00; acc[1] = a01; acc[2] = a10; acc[3] = a11;
+    acc[4] = a20; acc[5] = a21; acc[6] = a30; acc[7] = a31;
+    alignas(32) float lanes[8];
+    horizontalSums8(acc, lanes);
+    for (; j < n; ++j) {
+        float w0 = static_cast<float>(w[j]);
+        float w1 = static_cast<float>(w[n + j]);
+        for (size_t r = 0; r < 4; ++r) {
+            lanes[2 * r] += w0 * x[r * n + j];
+            lanes[2 * r + 1] += w1 * x[r * n + j];
+        }
+    }
+    for (size_t r = 0; r < 4; ++r) {
+        sums[r * stride] = lanes[2 * r];
+        sums[r * stride + 1] = lanes[2 * r + 1];
+    }
+#else
+    dotTile4x1(w, x, n, sums, stride);
+    dotTile4x1(w + n, x, n, sums + 1, stride);
+#endif
+}
+
+/**
+ * @brief 一个已转换的样本块乘以全部输出的权重
+ *
+ * 输出两个一组、样本四个一组分块，每块权重和样本各加载一次，不足一组的余下部分单独计算。
+ * 第 r 个样本第 o 个输出的点积写入 out[r * outputs + o]。
+ */
+template <typename Weight>
+void multiplyBlock(const Weight* weights, size_t outputs, const float* block, size_t rows, size_t n, float* out) {
+    size_t o = 0;
+    for (; o + 2 <= outputs; o += 2) {
+        size_t r = 0;
+        for (; r + 4 <= rows; r += 4) {
+            dotTile4x2(weights + o * n, block + r * n, n, out + r * outputs + o, outputs);
+        }
+        for (; r < rows; ++r) {
+            out[r * outputs + o] = dot(weights + o * n, block + r * n, n);
+            out[r * outputs + o + 1] = dot(weights + (o + 1) * n, block + r * n, n);
+        }
+    }
+    for (; o < outputs; ++o) {
+        size_t r = 0;
+        for (; r + 4 <= rows; r += 4) {
+            dotTile4x1(weights + o * n, block + r * n, n, out + r * outputs + o, outputs);
+        }
+        for (; r < rows; ++r) {
+            out[r * outputs + o] = dot(weights + o * n, block + r * n, n);
+        }
+    }
+}
+
+bool isLeafNode(const TreeNode& node) {
+    return node.feature < 0;
+}
+
+} // namespace
+
+// ReducedLinearLayer 实现
+void ReducedLinearLayer::build(const ConstMatrixView& weights, const std::vector<double>& bias, InferencePrecision precision) {
+    clear();
+    if (precision == InferencePrecision::Double || weights.rows() == 0 || bias.size() != weights.rows()) {
+        return;
+    }
+
+    m_precision = precision;
+    m_outputs = weights.rows();
+    m_features = weights.cols();
+    m_bias.assign(bias.begin(), bias.end());
+
+    if (precision == InferencePrecision::Float32) {
+        m_weights.resize(m_outputs * m_features);
+        for (size_t o = 0; o < m_outputs; ++o) {
+            std::transform(weights.row(o), weights.row(o) + m_features, m_weights.data() + o * m_features,
+                           [](double w) { return static_cast<float>(w); });
+        }
+        return;
+    }
+
+    // 每个输出的对称量化：最大绝对值映射到127
+    m_quantized.resize(m_outputs * m_features);
+    m_scales.assign(m_outputs, 0.0f);
+    for (size_t o = 0; o < m_outputs; ++o) {
+        const double* row = weights.row(o);
+        double maxAbs = 0.0;
+        for (size_t j = 0; j < m_features; ++j) {
+            maxAbs = std::max(maxAbs, std::abs(row[j]));
+        }
+        double scale = maxAbs > 0.0 ? maxAbs / 127.0 : 1.0;
+        m_scales[o] = static_cast<float>(scale);
+        for (size_t j = 0; j < m_features; ++j) {
+            double level = std::round(row[j] / scale);
+            m_quantized[o * m_features + j] = static_cast<int8_t>(std::max(-127.0, std::min(127.0, level)));
+        }
+    }
+}
+
+void ReducedLinearLayer::clear() {
+    m_precision = InferencePrecision::Double;
+    m_outputs = 0;
+    m_features = 0;
+    m_weights.clear();
+    m_quantized.clear();
+    m_scales.clear();
+    m_bias.clear();
+}
+
+void ReducedLinearLayer::evaluate(const ConstMatrixView& data, size_t begin, size_t end, double* out) const {
+    // 每块样本只转换一次，再与全部输出的权重做一次分块的矩阵乘法
+    const size_t blockRows = std::max<size_t>(4, std::min(kBlockRows, kLinearBlockBytes / (sizeof(float) * std::max<size_t>(m_features, 1))));
+    AlignedVector<float> block(std::min(blockRows, end - begin) * m_features);
+    std::vector<float> sums(std::min(blockRows, end - begin) * m_outputs);
+    for (size_t blockBegin = begin; blockBegin < end; blockBegin += blockRows) {
+        size_t blockEnd = std::min(end, blockBegin + blockRows);
+        size_t rows = blockEnd - blockBegin;
+        convertRows(data, blockBegin, blockEnd, block.data());
+        if (m_precision == InferencePrecision::Float32) {
+            multiplyBlock(m_weights.data(), m_outputs, block.data(), rows, m_features, sums.data());
+        } else {
+            multiplyBlock(m_quantized.data(), m_outputs, block.data(), rows, m_features, sums.data());
+        }
+
+        double* target = out + (blockBegin - begin) * m_outputs;
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t o = 0; o < m_outputs; ++o) {
+                float value = m_precision == InferencePrecision::Float32 ? sums[r * m_outputs + o] : sums[r * m_outputs + o] * m_scales[o];
+                target[r * m_outputs + o] = static_cast<double>(value + m_bias[o]);
+            }
+        }
+    }
+}
+
+// ReducedTreeEnsemble 实现
+bool ReducedTreeEnsemble::build(const TreeNode* nodes, size_t nodeCount, const uint32_t* roots, size_t treeCount,
+                                const double* leafValues, size_t leafCount, size_t numFeatures,
+                                InferencePrecision precision) {
+    clear();
+    if (precision == InferencePrecision::Double || nodeCount == 0) {
+        return precision == InferencePrecision::Double;
+    }
+    if (precision == InferencePrecision::Int8 && numFeatures > std::numeric_limits<uint16_t>::max()) {
+        return false;
+    }
+
+    m_numFeatures = numFeatures;
+    m_roots.assign(roots, roots + treeCount);
+    m_leafValues.resize(leafCount);
+    std::transform(leafValues, leafValues + leafCount, m_leafValues.begin(),
+                   [](double value) { return static_cast<float>(value); });
+
+    // 每棵树的深度（子节点总在父节点之后）和叶子的叶值偏移
+    m_leafOffsets.assign(nodeCount, 0);
+    m_depths.assign(treeCount, 0);
+    std::vector<uint32_t> depths(nodeCount, 0);
+    for (size_t t = 0; t < treeCount; ++t) {
+        size_t treeEnd = t + 1 < treeCount ? roots[t + 1] : nodeCount;
+        for (size_t i = roots[t]; i < treeEnd; ++i) {
+            m_depths[t] = std::max(m_depths[t], depths[i]);
+            if (isLeafNode(nodes[i])) {
+                m_leafOffsets[i] = nodes[i].child;
+            } else {
+                depths[nodes[i].child] = depths[i] + 1;
+                depths[nodes[i].child + 1] = depths[i] + 1;
+            }
+        }
+    }
+
+    if (precision == InferencePrecision::Float32) {
+        m_floatNodes.resize(nodeCount);
+        for (size_t i = 0; i < nodeCount; ++i) {
+            FloatNode& node = m_floatNodes[i];
+            bool leaf = isLeafNode(nodes[i]);
+            node.threshold = leaf ? std::numeric_limits<float>::infinity() : static_cast<float>(nodes[i].threshold);
+            node.feature = leaf ? 0 : static_cast<uint32_t>(nodes[i].feature);
+            node.child = leaf ? static_cast<uint32_t>(i) : nodes[i].child;
+        }
+        m_precision = precision;
+        return true;
+    }
+
+    // 收集每个特征的不同阈值
+    std::vector<std::vector<double>> featureCuts(numFeatures);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (!isLeafNode(nodes[i]) && !std::isnan(nodes[i].threshold)) {
+            featureCuts[nodes[i].feature].push_back(nodes[i].threshold);
+        }
+    }
+    for (std::vector<double>& cuts : featureCuts) {
+        std::sort(cuts.begin(), cuts.end());
+        cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+        if (cuts.size() > kMaxCuts) {
+            // 阈值过多时均匀保留255个，其余阈值映射到最近的保留阈值
+            std::vector<double> kept(kMaxCuts);
+            for (size_t k = 0; k < kMaxCuts; ++k) {
+                kept[k] = cuts[k * (cuts.size() - 1) / (kMaxCuts - 1)];
+            }
+            cuts.swap(kept);
+            m_exact = false;
+        }
+    }
+    for (size_t j = 0; j < numFeatures; ++j) {
+        if (!featureCuts[j].empty()) {
+            m_usedFeatures.push_back(static_cast<uint32_t>(j));
+            size_t offset = m_cuts.size();
+            m_cuts.resize(offset + kMaxCuts, std::numeric_limits<double>::infinity());
+            std::copy(featureCuts[j].begin(), featureCuts[j].end(), m_cuts.begin() + offset);
+        }
+    }
+
+    m_byteNodes.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        ByteNode& node = m_byteNodes[i];
+        node.reserved = 0;
+        if (isLeafNode(nodes[i])) {
+            node.threshold = static_cast<uint8_t>(kMaxCuts);
+            node.feature = 0;
+            node.child = static_cast<uint32_t>(i);
+            continue;
+        }
+
+        node.feature = static_cast<uint16_t>(nodes[i].feature);
+        node.child = nodes[i].child;
+        const std::vector<double>& cuts = featureCuts[node.feature];
+        double threshold = nodes[i].threshold;
+        if (std::isnan(threshold)) {
+            // 阈值为NaN的节点所有样本都走左子节点：编码不会大于255
+            node.threshold = static_cast<uint8_t>(kMaxCuts);
+            continue;
+        }
+        size_t index = static_cast<size_t>(std::lower_bound(cuts.begin(), cuts.end(), threshold) - cuts.begin());
+        if (index == cuts.size() || (index > 0 && threshold - cuts[index - 1] < cuts[index] - threshold)) {
+            index = index > 0 ? index - 1 : 0;
+        }
+        node.threshold = static_cast<uint8_t>(index);
+    }
+
+    m_precision = precision;
+    return true;
+}
+
+void ReducedTreeEnsemble::clear() {
+    m_precision = InferencePrecision::Double;
+    m_numFeatures = 0;
+    m_exact = true;
+    m_roots.clear();
+    m_depths.clear();
+    m_leafOffsets.clear();
+    m_floatNodes.clear();
+    m_byteNodes.clear();
+    m_leafValues.clear();
+    m_usedFeatures.clear();
+    m_cuts.clear();
+}
+
+void ReducedTreeEnsemble::accumulate(const ConstMatrixView& data, size_t begin, size_t end,
+                                     size_t outputs, double* out) const {
+    const size_t cols = m_numFeatures;
+    if (m_precision == InferencePrecision::Float32) {
+        AlignedVector<float> block(std::min(kBlockRows, end - begin) * cols);
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += kBlockRows) {
+            size_t blockEnd = std::min(end, blockBegin + kBlockRows);
+            convertRows(data, blockBegin, blockEnd, block.data());
+            accumulateTrees(m_floatNodes.data(), block.data(), blockEnd - blockBegin, cols,
+                            outputs, out + (blockBegin - begin) * outputs);
+        }
+        return;
+    }
+
+    // 编码为小于样本值的阈值个数：x > 第k个阈值 等价于 编码 > k。
+    // 阈值表补齐到255项，8步无分支的二分查找即得到编码（NaN 编码为0，与双精度同样走左子节点）
+    std::vector<uint8_t> block(std::min(kBlockRows, end - begin) * cols, 0);
+    for (size_t blockBegin = begin; blockBegin < end; blockBegin += kBlockRows) {
+        size_t blockEnd = std::min(end, blockBegin + kBlockRows);
+        for (size_t i = blockBegin; i < blockEnd; ++i) {
+            const double* row = data.row(i);
+            uint8_t* codes = block.data() + (i - blockBegin) * cols;
+            for (size_t f = 0; f < m_usedFeatures.size(); ++f) {
+                const double* cuts = m_cuts.data() + f * kMaxCuts;
+                double value = row[m_usedFeatures[f]];
+                size_t position = 0;
+                for (size_t step = 128; step > 0; step >>= 1) {
+                    position += cuts[position + step - 1] < value ? step : 0;
+                }
+                codes[m_usedFeatures[f]] = static_cast<uint8_t>(position);
+            }
+        }
+        accumulateTrees(m_byteNodes.data(), block.data(), blockEnd - blockBegin, cols,
+                        outputs, out + (blockBegin - begin) * outputs);
+    }
+}
+
+template <typename Node, typename Value>
+void ReducedTreeEnsemble::accumulateTrees(const Node* nodes, const Value* block, size_t rows, size_t stride,
+                                          size_t outputs, double* out) const {
+    // 一块样本依次走完每棵树，每批样本在树上同步下降（到达叶子的样本停在原处）
+    uint32_t current[kTraversalBatchRows];
+    for (size_t t = 0; t < m_roots.size(); ++t) {
+        for (size_t batchBegin = 0; batchBegin < rows; batchBegin += kTraversalBatchRows) {
+            size_t count = std::min(kTraversalBatchRows, rows - batchBegin);
+            const Value* samples = block + batchBegin * stride;
+            for (size_t r = 0; r < count; ++r) {
+                current[r] = m_roots[t];
+            }
+            for (uint32_t level = 0; level < m_depths[t]; ++level) {
+                for (size_t r = 0; r < count; ++r) {
+                    const Node& node = nodes[current[r]];
+                    current[r] = node.child + (samples[r * stride + node.feature] > node.threshold ? 1 : 0);
+                }
+            }
+            for (size_t r = 0; r < count; ++r) {
+                const float* leaf = m_leafValues.data() + m_leafOffsets[current[r]];
+                double* target = out + (batchBegin + r) * outputs;
+                for (size_t k = 0; k < outputs; ++k) {
+                    target[k] += static_cast<double>(leaf[k]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "MLModels.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+struct TreeNode;
+
+/**
+ * @brief 低精度线性层（线性回归、逻辑回归的预测）
+ *
+ * 每个输出为权重与特征的点积加截距。Float32 时权重保存为单精度；Int8 时每个输出的权重
+ * 按该输出的最大绝对值对称量化为8位整数（权重内存为双精度的1/8），点积在单精度下计算后乘回量化系数。
+ * 样本按块转换为单精度（每块只转换一次），再与全部输出的权重做分块的矩阵乘法：
+ * 每次4个样本×2个输出，权重和样本加载一次后各用多次，累加器都留在寄存器中。
+ *
+ * 输入仍是双精度矩阵，读取样本的开销与双精度相同。输出数×特征数较大（多类逻辑回归）时
+ * 乘加占主要时间，单精度和8位都明显快于双精度；只有一个输出（线性回归）时读取样本占主要时间，
+ * 低精度不会更快，Int8 只减少低精度参数的内存。
+ */
+class ReducedLinearLayer {
+public:
+    /**
+     * @brief 由双精度参数生成低精度参数
+     *
+     * @param weights 输出数×特征数的权重（按行存放，可以有行间隔）
+     * @param bias 每个输出的截距
+     * @param precision Float32 或 Int8（Double 时清空）
+     */
+    void build(const ConstMatrixView& weights, const std::vector<double>& bias, InferencePrecision precision);
+
+    void clear();
+    bool empty() const { return m_outputs == 0; }
+    size_t outputs() const { return m_outputs; }
+    size_t features() const { return m_features; }
+
+    /**
+     * @brief 计算样本 [begin, end) 的输出，第 i 个样本的输出写入 out[(i - begin) * outputs()]
+     */
+    void evaluate(const ConstMatrixView& data, size_t begin, size_t end, double* out) const;
+
+private:
+    InferencePrecision m_precision = InferencePrecision::Double;
+    size_t m_outputs = 0;
+    size_t m_features = 0;
+    AlignedVector<float> m_weights;         // Float32：输出数×特征数
+    AlignedVector<int8_t> m_quantized;      // Int8：输出数×特征数
+    std::vector<float> m_scales;            // Int8：每个输出的量化系数
+    std::vector<float> m_bias;
+};
+
+/**
+ * @brief 低精度树集合（随机森林、梯度提升树的预测）
+ *
+ * Float32 时节点为12字节（单精度阈值），样本按块转换为单精度后遍历。
+ * Int8 时节点为8字节：分裂阈值替换为该特征所有阈值排序后的序号（8位），样本按块编码为
+ * “小于该值的阈值个数”，比较 x > 阈值 等价于比较 编码 > 序号，每个样本的每个特征只需编码一次，
+ * 之后所有树都只比较单字节。原生训练的树的阈值取自至多255个分箱边界，这种编码与双精度结果完全一致；
+ * 某个特征的不同阈值超过255个时只保留其中均匀间隔的255个，结果会有偏差（见 isExact()）。
+ *
+ * 叶子改为指向自身、永远不会走右子节点的节点，一批样本在每棵树上按树的深度同步下降固定层数，
+ * 每层都是无分支的更新，与梯度提升树的双精度批量遍历相同。
+ */
+class ReducedTreeEnsemble {
+public:
+    /**
+     * @brief 由双精度的扁平节点和叶值生成低精度参数
+     *
+     * @param nodes 所有树的节点（第 t 棵树的节点为 roots[t] 到下一棵树的根之前）
+     * @param leafValues 叶值（叶子节点的 child 为其偏移）
+     * @param numFeatures 特征数
+     * @param precision Float32 或 Int8（Double 时清空）
+     * @return 是否成功（Int8 时特征数超过65535则失败）
+     */
+    bool build(const TreeNode* nodes, size_t nodeCount, const uint32_t* roots, size_t treeCount,
+               const double* leafValues, size_t leafCount, size_t numFeatures, InferencePrecision precision);
+
+    void clear();
+    bool empty() const { return m_precision == InferencePrecision::Double; }
+
+    /**
+     * @brief Int8 编码是否与双精度的比较结果完全一致
+     */
+    bool isExact() const { return m_exact; }
+
+    /**
+     * @brief 把各树的叶值累加到样本 [begin, end) 的输出（每个样本 outputs 个值，写入 out）
+     */
+    void accumulate(const ConstMatrixView& data, size_t begin, size_t end, size_t outputs, double* out) const;
+
+private:
+    struct FloatNode {
+        float threshold;        // 叶子为+inf
+        uint32_t feature;       // 叶子为0
+        uint32_t child;         // 叶子指向自身
+    };
+
+    struct ByteNode {
+        uint8_t threshold;      // 阈值在该特征阈值表中的序号（叶子为255）
+        uint8_t reserved;
+        uint16_t feature;
+        uint32_t child;
+    };
+
+    template <typename Node, typename Value>
+    void accumulateTrees(const Node* nodes, const Value* block, size_t rows, size_t stride,
+                         size_t outputs, double* out) const;
+
+    InferencePrecision m_precision = InferencePrecision::Double;
+    size_t m_numFeatures = 0;
+    bool m_exact = true;
+    std::vector<uint32_t> m_roots;
+    std::vector<uint32_t> m_depths;             // 每棵树的深度（遍历层数）
+    std::vector<uint32_t> m_leafOffsets;        // 每个节点的叶值偏移（只对叶子有意义）
+    std::vector<FloatNode> m_floatNodes;
+    std::vector<ByteNode> m_byteNodes;
+    std::vector<float> m_leafValues;
+    std::vector<uint32_t> m_usedFeatures;       // Int8：有分裂阈值的特征
+    std::vector<double> m_cuts;                 // Int8：每个用到的特征255个升序阈值（不足的补+inf）
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
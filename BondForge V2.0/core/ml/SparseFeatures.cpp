@@ -0,0 +1,246 @@
+#include "SparseFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+// 位向量内核：四路独立累加，popcnt 指令的延迟可以重叠
+size_t popcount(const uint64_t* words, size_t count) {
+    size_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc[0] += popcount64(words[i]);
+        acc[1] += popcount64(words[i + 1]);
+        acc[2] += popcount64(words[i + 2]);
+        acc[3] += popcount64(words[i + 3]);
+    }
+    for (; i < count; ++i) {
+        acc[0] += popcount64(words[i]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+size_t intersectionCount(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc[0] += popcount64(a[i] & b[i]);
+        acc[1] += popcount64(a[i + 1] & b[i + 1]);
+        acc[2] += popcount64(a[i + 2] & b[i + 2]);
+        acc[3] += popcount64(a[i + 3] & b[i + 3]);
+    }
+    for (; i < count; ++i) {
+        acc[0] += popcount64(a[i] & b[i]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+size_t unionCount(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc[0] += popcount64(a[i] | b[i]);
+        acc[1] += popcount64(a[i + 1] | b[i + 1]);
+        acc[2] += popcount64(a[i + 2] | b[i + 2]);
+        acc[3] += popcount64(a[i + 3] | b[i + 3]);
+    }
+    for (; i < count; ++i) {
+        acc[0] += popcount64(a[i] | b[i]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+size_t hammingDistance(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc[0] += popcount64(a[i] ^ b[i]);
+        acc[1] += popcount64(a[i + 1] ^ b[i + 1]);
+        acc[2] += popcount64(a[i + 2] ^ b[i + 2]);
+        acc[3] += popcount64(a[i + 3] ^ b[i + 3]);
+    }
+    for (; i < count; ++i) {
+        acc[0] += popcount64(a[i] ^ b[i]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+double tanimotoSimilarity(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t either = unionCount(a, b, count);
+    return either == 0 ? 1.0 : static_cast<double>(intersectionCount(a, b, count)) / static_cast<double>(either);
+}
+
+double bitDot(const uint64_t* words, size_t count, const double* weights) {
+    double sum = 0.0;
+    for (size_t w = 0; w < count; ++w) {
+        const double* base = weights + w * 64;
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+            sum += base[lowestSetBit(bits)];
+        }
+    }
+    return sum;
+}
+
+// 稀疏行内核
+double sparseDot(const SparseRow& row, const double* dense) {
+    double sum = 0.0;
+    if (row.values) {
+        for (size_t k = 0; k < row.size; ++k) {
+            sum += row.values[k] * dense[row.indices[k]];
+        }
+    } else {
+        for (size_t k = 0; k < row.size; ++k) {
+            sum += dense[row.indices[k]];
+        }
+    }
+    return sum;
+}
+
+void sparseAxpy(double alpha, const SparseRow& row, double* y) {
+    if (row.values) {
+        for (size_t k = 0; k < row.size; ++k) {
+            y[row.indices[k]] += alpha * row.values[k];
+        }
+    } else {
+        for (size_t k = 0; k < row.size; ++k) {
+            y[row.indices[k]] += alpha;
+        }
+    }
+}
+
+// SparseMatrix 实现
+SparseMatrix SparseMatrix::fromDense(const ConstMatrixView& dense) {
+    SparseMatrix sparse(dense.cols());
+    size_t nonZeros = 0;
+    for (size_t i = 0; i < dense.rows(); ++i) {
+        const double* sample = dense.row(i);
+        nonZeros += dense.cols() - static_cast<size_t>(std::count(sample, sample + dense.cols(), 0.0));
+    }
+    sparse.reserve(dense.rows(), nonZeros);
+    
+    for (size_t i = 0; i < dense.rows(); ++i) {
+        const double* sample = dense.row(i);
+        for (size_t j = 0; j < dense.cols(); ++j) {
+            if (sample[j] != 0.0) {
+                sparse.m_columns.push_back(static_cast<uint32_t>(j));
+                sparse.m_values.push_back(sample[j]);
+            }
+        }
+        sparse.m_rowOffsets.push_back(sparse.m_columns.size());
+    }
+    return sparse;
+}
+
+void SparseMatrix::reserve(size_t rows, size_t nonZeros) {
+    m_rowOffsets.reserve(m_rowOffsets.size() + rows);
+    m_columns.reserve(m_columns.size() + nonZeros);
+    m_values.reserve(m_values.size() + nonZeros);
+}
+
+bool SparseMatrix::appendRow(const uint32_t* columns, const double* values, size_t count) {
+    for (size_t k = 0; k < count; ++k) {
+        if (columns[k] >= m_cols || (k > 0 && columns[k] <= columns[k - 1])) {
+            return false;
+        }
+    }
+    
+    m_columns.insert(m_columns.end(), columns, columns + count);
+    if (values) {
+        m_values.insert(m_values.end(), values, values + count);
+    } else {
+        m_values.insert(m_values.end(), count, 1.0);
+    }
+    m_rowOffsets.push_back(m_columns.size());
+    return true;
+}
+
+Matrix SparseMatrix::toDense(size_t begin, size_t end) const {
+    Matrix dense(end - begin, m_cols);
+    for (size_t i = begin; i < end; ++i) {
+        SparseRow sparseRow = row(i);
+        double* out = dense.row(i - begin);
+        for (size_t k = 0; k < sparseRow.size; ++k) {
+            out[sparseRow.indices[k]] = sparseRow.values[k];
+        }
+    }
+    return dense;
+}
+
+// BitMatrix 实现
+BitMatrix::BitMatrix(size_t rows, size_t cols)
+    : m_rows(rows),
+      m_cols(cols),
+      m_wordsPerRow((cols + 63) / 64),
+      m_words(rows * ((cols + 63) / 64), 0) {
+}
+
+BitMatrix BitMatrix::fromDense(const ConstMatrixView& dense) {
+    BitMatrix bits(dense.rows(), dense.cols());
+    for (size_t i = 0; i < dense.rows(); ++i) {
+        const double* sample = dense.row(i);
+        uint64_t* words = bits.row(i);
+        for (size_t j = 0; j < dense.cols(); ++j) {
+            if (sample[j] != 0.0 && !std::isnan(sample[j])) {
+                words[j / 64] |= uint64_t(1) << (j % 64);
+            }
+        }
+    }
+    return bits;
+}
+
+void BitMatrix::set(size_t i, size_t j, bool value) {
+    uint64_t mask = uint64_t(1) << (j % 64);
+    uint64_t& word = row(i)[j / 64];
+    word = value ? (word | mask) : (word & ~mask);
+}
+
+size_t BitMatrix::setColumns(size_t i, std::vector<uint32_t>& columns) const {
+    columns.clear();
+    const uint64_t* words = row(i);
+    for (size_t w = 0; w < m_wordsPerRow; ++w) {
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+            columns.push_back(static_cast<uint32_t>(w * 64 + lowestSetBit(bits)));
+        }
+    }
+    return columns.size();
+}
+
+Matrix BitMatrix::toDense(size_t begin, size_t end) const {
+    Matrix dense(end - begin, m_cols);
+    for (size_t i = begin; i < end; ++i) {
+        const uint64_t* words = row(i);
+        double* out = dense.row(i - begin);
+        for (size_t w = 0; w < m_wordsPerRow; ++w) {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                out[w * 64 + lowestSetBit(bits)] = 1.0;
+            }
+        }
+    }
+    return dense;
+}
+
+// SparseMatrixView 实现
+SparseRow SparseMatrixView::row(size_t i, std::vector<uint32_t>& scratch) const {
+    if (m_sparse) {
+        return m_sparse->row(i);
+    }
+    m_bits->setColumns(i, scratch);
+    return {scratch.data(), nullptr, scratch.size()};
+}
+
+double SparseMatrixView::dot(size_t i, const double* weights) const {
+    if (m_sparse) {
+        return sparseDot(m_sparse->row(i), weights);
+    }
+    return bitDot(m_bits->row(i), m_bits->wordsPerRow(), weights);
+}
+
+Matrix SparseMatrixView::toDense(size_t begin, size_t end) const {
+    return m_sparse ? m_sparse->toDense(begin, end) : m_bits->toDense(begin, end);
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
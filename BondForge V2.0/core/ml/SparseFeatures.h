@@ -0,0 +1,243 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Matrix.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 64位字中置位的个数
+ */
+inline int popcount64(uint64_t value) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(value));
+#else
+    return __builtin_popcountll(value);
+#endif
+}
+
+/**
+ * @brief 64位字中最低置位的位置（value 不能为0）
+ */
+inline int lowestSetBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+/**
+ * @brief 位向量的置位数
+ */
+size_t popcount(const uint64_t* words, size_t count);
+
+/**
+ * @brief 两个位向量的交集大小 |a ∧ b|
+ */
+size_t intersectionCount(const uint64_t* a, const uint64_t* b, size_t count);
+
+/**
+ * @brief 两个位向量的并集大小 |a ∨ b|
+ */
+size_t unionCount(const uint64_t* a, const uint64_t* b, size_t count);
+
+/**
+ * @brief 两个位向量不同的位数 |a ⊕ b|
+ */
+size_t hammingDistance(const uint64_t* a, const uint64_t* b, size_t count);
+
+/**
+ * @brief Tanimoto系数 |a ∧ b| / |a ∨ b|（两个空向量为1）
+ */
+double tanimotoSimilarity(const uint64_t* a, const uint64_t* b, size_t count);
+
+/**
+ * @brief 位向量与稠密权重的点积：置位处的权重之和（按位序累加）
+ */
+double bitDot(const uint64_t* words, size_t count, const double* weights);
+
+/**
+ * @brief 一行稀疏特征：严格升序的列下标和对应的值
+ * 
+ * values 为空时所有值都是1（二进制特征）。
+ */
+struct SparseRow {
+    const uint32_t* indices = nullptr;
+    const double* values = nullptr;
+    size_t size = 0;
+    
+    double value(size_t k) const { return values ? values[k] : 1.0; }
+};
+
+/**
+ * @brief 稀疏行与稠密向量的点积（按列下标顺序累加）
+ */
+double sparseDot(const SparseRow& row, const double* dense);
+
+/**
+ * @brief y += alpha * row（只更新非零列）
+ */
+void sparseAxpy(double alpha, const SparseRow& row, double* y);
+
+/**
+ * @brief 压缩稀疏行（CSR）矩阵
+ * 
+ * 每行只保存非零元素：第 i 行是 columns/values 中 [rowOffset(i), rowOffset(i + 1)) 的区间，
+ * 行内列下标严格升序。行只能追加，追加后内容不变。
+ */
+class SparseMatrix {
+public:
+    SparseMatrix() = default;
+    explicit SparseMatrix(size_t cols) : m_cols(cols) {}
+    
+    /**
+     * @brief 由稠密矩阵构造（只保存不为0的元素，NaN 也会保存）
+     */
+    static SparseMatrix fromDense(const ConstMatrixView& dense);
+    
+    void reserve(size_t rows, size_t nonZeros);
+    
+    /**
+     * @brief 追加一行
+     *
+     * @param columns 列下标（严格升序且小于 cols()）
+     * @param values 对应的值（为空时都为1）
+     * @param count 非零元素数
+     * @return 是否成功（列下标无效时矩阵不变）
+     */
+    bool appendRow(const uint32_t* columns, const double* values, size_t count);
+    
+    size_t rows() const { return m_rowOffsets.size() - 1; }
+    size_t cols() const { return m_cols; }
+    size_t nonZeros() const { return m_columns.size(); }
+    bool empty() const { return rows() == 0 || m_cols == 0; }
+    
+    uint64_t rowOffset(size_t i) const { return m_rowOffsets[i]; }
+    
+    SparseRow row(size_t i) const {
+        size_t begin = m_rowOffsets[i];
+        return {m_columns.data() + begin, m_values.data() + begin, size_t(m_rowOffsets[i + 1] - begin)};
+    }
+    
+    /**
+     * @brief 行区间 [begin, end) 转换为稠密矩阵
+     */
+    Matrix toDense(size_t begin, size_t end) const;
+
+private:
+    size_t m_cols = 0;
+    std::vector<uint64_t> m_rowOffsets{0};
+    std::vector<uint32_t> m_columns;
+    std::vector<double> m_values;
+};
+
+/**
+ * @brief 按位压缩的二进制特征矩阵（分子指纹）
+ * 
+ * 每行 wordsPerRow() = (cols + 63) / 64 个64位字，第 j 位在第 j / 64 个字的第 j % 64 位，
+ * 行尾多余的位始终为0。内存是稠密双精度矩阵的1/64，行之间没有填充，
+ * 布局与 FingerprintSpace 相同：data() 可以直接传给 FingerprintNeighborIndex 的 addBatch() 和 searchBatch()。
+ */
+class BitMatrix {
+public:
+    BitMatrix() = default;
+    BitMatrix(size_t rows, size_t cols);
+    
+    /**
+     * @brief 由稠密矩阵构造（不为0且不是NaN的元素置位）
+     */
+    static BitMatrix fromDense(const ConstMatrixView& dense);
+    
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+    size_t wordsPerRow() const { return m_wordsPerRow; }
+    bool empty() const { return m_rows == 0 || m_cols == 0; }
+    
+    const uint64_t* data() const { return m_words.data(); }
+    const uint64_t* row(size_t i) const { return m_words.data() + i * m_wordsPerRow; }
+    uint64_t* row(size_t i) { return m_words.data() + i * m_wordsPerRow; }
+    
+    bool test(size_t i, size_t j) const { return (row(i)[j / 64] >> (j % 64)) & 1; }
+    void set(size_t i, size_t j, bool value = true);
+    
+    /**
+     * @brief 第 i 行的置位数
+     */
+    size_t count(size_t i) const { return popcount(row(i), m_wordsPerRow); }
+    
+    /**
+     * @brief 第 i 行置位的列下标（升序，写入 columns）
+     *
+     * @return 置位数
+     */
+    size_t setColumns(size_t i, std::vector<uint32_t>& columns) const;
+    
+    /**
+     * @brief 行区间 [begin, end) 转换为稠密矩阵（0/1）
+     */
+    Matrix toDense(size_t begin, size_t end) const;
+
+private:
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    size_t m_wordsPerRow = 0;
+    std::vector<uint64_t> m_words;
+};
+
+/**
+ * @brief 稀疏特征的只读视图（CSR矩阵或二进制位矩阵，不持有数据）
+ * 
+ * 模型的稀疏训练和预测接口接受这个视图，SparseMatrix 和 BitMatrix 都可以隐式转换。
+ * row() 对位矩阵把置位解码为列下标（写入调用者提供的缓冲区），dot() 对位矩阵直接按字扫描。
+ */
+class SparseMatrixView {
+public:
+    SparseMatrixView(const SparseMatrix& matrix) : m_sparse(&matrix) {}
+    SparseMatrixView(const BitMatrix& matrix) : m_bits(&matrix) {}
+    
+    size_t rows() const { return m_sparse ? m_sparse->rows() : m_bits->rows(); }
+    size_t cols() const { return m_sparse ? m_sparse->cols() : m_bits->cols(); }
+    bool empty() const { return m_sparse ? m_sparse->empty() : m_bits->empty(); }
+    
+    /**
+     * @brief 所有非零值都是1（位矩阵）
+     */
+    bool isBinary() const { return m_bits != nullptr; }
+    
+    const SparseMatrix* sparse() const { return m_sparse; }
+    const BitMatrix* bits() const { return m_bits; }
+    
+    /**
+     * @brief 第 i 行的非零元素（位矩阵的列下标写入 scratch，结果在下一次使用 scratch 前有效）
+     */
+    SparseRow row(size_t i, std::vector<uint32_t>& scratch) const;
+    
+    /**
+     * @brief 第 i 行与稠密向量的点积
+     */
+    double dot(size_t i, const double* weights) const;
+    
+    /**
+     * @brief 行区间 [begin, end) 转换为稠密矩阵
+     */
+    Matrix toDense(size_t begin, size_t end) const;
+
+private:
+    const SparseMatrix* m_sparse = nullptr;
+    const BitMatrix* m_bits = nullptr;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,638 @@
+#include "TimeSeriesModels.h"
+#include "ModelCommon.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 平滑系数搜索：坐标轮换的轮数和每次一维黄金分割的迭代次数
+constexpr int kSmoothingSweeps = 3;
+constexpr int kGoldenSectionIterations = 24;
+
+// 保存文件中各状态数组长度的上限（防止损坏的文件触发巨大的分配）
+constexpr uint64_t kMaxStateLength = uint64_t(1) << 24;
+
+// 计数序列允许的最大周期数
+constexpr uint64_t kMaxCountPeriods = uint64_t(1) << 24;
+
+// 模型文件中的节；ARIMA的状态数组在Holt-Winters下为空
+constexpr uint32_t kShapeSection = sectionTag("SHAP");
+constexpr uint32_t kScalarsSection = sectionTag("SCAL");
+constexpr uint32_t kSeasonalSection = sectionTag("SEAS");
+constexpr uint32_t kArSection = sectionTag("ARCO");
+constexpr uint32_t kMaSection = sectionTag("MACO");
+constexpr uint32_t kIntegrationSection = sectionTag("INTG");
+constexpr uint32_t kHistorySection = sectionTag("HIST");
+constexpr uint32_t kResidualsSection = sectionTag("RESD");
+
+/**
+ * @brief 在 [low, high] 上用黄金分割搜索单峰函数的最小值点
+ */
+double goldenSection(const std::function<double(double)>& objective, double low, double high) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double a = low;
+    double b = high;
+    double c = b - ratio * (b - a);
+    double d = a + ratio * (b - a);
+    double fc = objective(c);
+    double fd = objective(d);
+    for (int i = 0; i < kGoldenSectionIterations; ++i) {
+        if (fc < fd) {
+            b = d;
+            d = c;
+            fd = fc;
+            c = b - ratio * (b - a);
+            fc = objective(c);
+        } else {
+            a = c;
+            c = d;
+            fc = fd;
+            d = a + ratio * (b - a);
+            fd = objective(d);
+        }
+    }
+    return fc < fd ? c : d;
+}
+
+/**
+ * @brief 最小二乘 design·x ≈ targets（正规方程 + 极小的岭项 + 部分选主元消元）
+ * 
+ * @param design 行主序的设计矩阵，每行 cols 个元素
+ * @return 方程是否可解
+ */
+bool solveLeastSquares(const std::vector<double>& design, const std::vector<double>& targets,
+                       size_t cols, std::vector<double>& solution) {
+    std::vector<double> normal(cols * (cols + 1), 0.0);
+    const size_t rows = targets.size();
+    for (size_t r = 0; r < rows; ++r) {
+        const double* x = design.data() + r * cols;
+        for (size_t i = 0; i < cols; ++i) {
+            double* out = normal.data() + i * (cols + 1);
+            for (size_t j = 0; j < cols; ++j) {
+                out[j] += x[i] * x[j];
+            }
+            out[cols] += x[i] * targets[r];
+        }
+    }
+    
+    double trace = 0.0;
+    for (size_t i = 0; i < cols; ++i) {
+        trace += normal[i * (cols + 1) + i];
+    }
+    double ridge = 1e-10 * std::max(trace / static_cast<double>(cols), 1.0);
+    for (size_t i = 0; i < cols; ++i) {
+        normal[i * (cols + 1) + i] += ridge;
+    }
+    
+    for (size_t k = 0; k < cols; ++k) {
+        size_t pivot = k;
+        for (size_t i = k + 1; i < cols; ++i) {
+            if (std::abs(normal[i * (cols + 1) + k]) > std::abs(normal[pivot * (cols + 1) + k])) {
+                pivot = i;
+            }
+        }
+        if (std::abs(normal[pivot * (cols + 1) + k]) < 1e-300) {
+            return false;
+        }
+        if (pivot != k) {
+            std::swap_ranges(normal.begin() + k * (cols + 1), normal.begin() + (k + 1) * (cols + 1),
+                             normal.begin() + pivot * (cols + 1));
+        }
+        for (size_t i = k + 1; i < cols; ++i) {
+            double factor = normal[i * (cols + 1) + k] / normal[k * (cols + 1) + k];
+            for (size_t j = k; j <= cols; ++j) {
+                normal[i * (cols + 1) + j] -= factor * normal[k * (cols + 1) + j];
+            }
+        }
+    }
+    
+    solution.assign(cols, 0.0);
+    for (size_t k = cols; k-- > 0;) {
+        double sum = normal[k * (cols + 1) + cols];
+        for (size_t j = k + 1; j < cols; ++j) {
+            sum -= normal[k * (cols + 1) + j] * solution[j];
+        }
+        solution[k] = sum / normal[k * (cols + 1) + k];
+    }
+    return std::all_of(solution.begin(), solution.end(), [](double v) { return std::isfinite(v); });
+}
+
+/**
+ * @brief 把 value 放到最近值数组的最前面（数组长度不变）
+ */
+void pushFront(std::vector<double>& recent, double value) {
+    if (recent.empty()) {
+        return;
+    }
+    std::copy_backward(recent.begin(), recent.end() - 1, recent.end());
+    recent[0] = value;
+}
+
+double mean(const std::vector<double>& values, size_t begin, size_t end) {
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += values[i];
+    }
+    return sum / static_cast<double>(end - begin);
+}
+
+} // namespace
+
+// TimeSeriesModel 实现
+TrainingResult TimeSeriesModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    (void)trainingData;
+    return fit(trainingLabels, parameters);
+}
+
+TrainingResult TimeSeriesModel::fit(const std::vector<double>& series, const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (!std::all_of(series.begin(), series.end(), [](double v) { return std::isfinite(v); })) {
+        result.errorMessage = "Series contains non-finite values";
+        return result;
+    }
+    
+    Method method = parameterOr(parameters, "method", 0.0) == 1.0 ? Method::Arima : Method::HoltWinters;
+    size_t warmup = 1;
+    
+    if (method == Method::HoltWinters) {
+        size_t period = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "seasonPeriod", 0.0)));
+        if (period == 1) {
+            period = 0;
+        }
+        if (series.size() < std::max<size_t>(3, period + 2)) {
+            result.errorMessage = "Series too short for the requested model";
+            return result;
+        }
+        
+        m_method = method;
+        m_trendEnabled = parameterOr(parameters, "trend", 1.0) != 0.0;
+        m_seasonal.assign(period, 0.0);
+        warmup = std::max<size_t>(1, period);
+        
+        // 未给出的平滑系数按一步预测误差平方和搜索
+        double* coefficients[3] = {&m_alpha, &m_beta, &m_gamma};
+        const char* names[3] = {"alpha", "beta", "gamma"};
+        bool used[3] = {true, m_trendEnabled, period > 0};
+        double initial[3] = {0.3, 0.1, 0.1};
+        bool searched[3] = {false, false, false};
+        for (int c = 0; c < 3; ++c) {
+            double value = parameterOr(parameters, names[c], -1.0);
+            searched[c] = used[c] && value < 0.0;
+            *coefficients[c] = used[c] ? std::min(1.0, std::max(0.0, searched[c] ? initial[c] : value)) : 0.0;
+        }
+        
+        auto sumOfSquares = [&]() {
+            resetState(series);
+            double sum = 0.0;
+            for (size_t t = 0; t < series.size(); ++t) {
+                double error = update(series[t]);
+                if (t >= warmup) {
+                    sum += error * error;
+                }
+            }
+            return std::isfinite(sum) ? sum : std::numeric_limits<double>::max();
+        };
+        
+        for (int sweep = 0; sweep < kSmoothingSweeps; ++sweep) {
+            for (int c = 0; c < 3; ++c) {
+                if (!searched[c]) {
+                    continue;
+                }
+                double* target = coefficients[c];
+                *target = goldenSection([&](double value) {
+                    *target = value;
+                    return sumOfSquares();
+                }, c == 0 ? 0.01 : 0.0, 1.0);
+            }
+        }
+    } else {
+        size_t p = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "arOrder", 2)));
+        size_t d = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "differencing", 1)));
+        size_t q = static_cast<size_t>(std::max(0.0, parameterOr(parameters, "maOrder", 1)));
+        
+        // d 阶差分
+        std::vector<double> w(series);
+        for (size_t l = 0; l < d && !w.empty(); ++l) {
+            for (size_t t = 0; t + 1 < w.size(); ++t) {
+                w[t] = w[t + 1] - w[t];
+            }
+            w.pop_back();
+        }
+        
+        size_t longOrder = q > 0 ? std::max<size_t>(p + q + 5, 10) : 0;
+        size_t start = std::max(p, longOrder + q);
+        size_t cols = 1 + p + q;
+        if (w.size() < start + std::max<size_t>(2 * cols, 10)) {
+            result.errorMessage = "Series too short for the requested model";
+            return result;
+        }
+        
+        // 第一步：长AR的残差作为不可观测的新息的估计
+        std::vector<double> innovations(w.size(), 0.0);
+        std::vector<double> design;
+        std::vector<double> targets;
+        std::vector<double> solution;
+        if (q > 0) {
+            for (size_t t = longOrder; t < w.size(); ++t) {
+                design.push_back(1.0);
+                for (size_t i = 1; i <= longOrder; ++i) {
+                    design.push_back(w[t - i]);
+                }
+                targets.push_back(w[t]);
+            }
+            if (!solveLeastSquares(design, targets, longOrder + 1, solution)) {
+                result.errorMessage = "Failed to fit the autoregressive approximation";
+                return result;
+            }
+            for (size_t t = longOrder; t < w.size(); ++t) {
+                double fitted = solution[0];
+                for (size_t i = 1; i <= longOrder; ++i) {
+                    fitted += solution[i] * w[t - i];
+                }
+                innovations[t] = w[t] - fitted;
+            }
+        }
+        
+        // 第二步：对滞后值和滞后新息回归
+        design.clear();
+        targets.clear();
+        for (size_t t = start; t < w.size(); ++t) {
+            design.push_back(1.0);
+            for (size_t i = 1; i <= p; ++i) {
+                design.push_back(w[t - i]);
+            }
+            for (size_t j = 1; j <= q; ++j) {
+                design.push_back(innovations[t - j]);
+            }
+            targets.push_back(w[t]);
+        }
+        if (!solveLeastSquares(design, targets, cols, solution)) {
+            result.errorMessage = "Failed to fit the ARMA coefficients";
+            return result;
+        }
+        
+        m_method = method;
+        m_differencing = d;
+        m_constant = solution[0];
+        m_arCoefficients.assign(solution.begin() + 1, solution.begin() + 1 + p);
+        m_maCoefficients.assign(solution.begin() + 1 + p, solution.end());
+        warmup = d + std::max(p, q);
+    }
+    
+    // 从头重放一遍得到最终状态和样本内一步预测误差
+    resetState(series);
+    double minValue = *std::min_element(series.begin(), series.end());
+    double maxValue = *std::max_element(series.begin(), series.end());
+    double threshold = 0.1 * std::max(maxValue - minValue, std::numeric_limits<double>::epsilon());
+    double squaredError = 0.0;
+    double absoluteError = 0.0;
+    double percentageError = 0.0;
+    double symmetricError = 0.0;
+    size_t percentageCount = 0;
+    size_t withinThreshold = 0;
+    size_t count = 0;
+    for (size_t t = 0; t < series.size(); ++t) {
+        double predicted = predictNext();
+        double error = update(series[t]);
+        if (t < warmup) {
+            continue;
+        }
+        squaredError += error * error;
+        absoluteError += std::abs(error);
+        if (series[t] != 0.0) {
+            percentageError += std::abs(error / series[t]);
+            ++percentageCount;
+        }
+        double scale = std::abs(series[t]) + std::abs(predicted);
+        symmetricError += scale > 0.0 ? 2.0 * std::abs(error) / scale : 0.0;
+        withinThreshold += std::abs(error) < threshold ? 1 : 0;
+        ++count;
+    }
+    
+    double n = static_cast<double>(std::max<size_t>(count, 1));
+    result.success = true;
+    result.meanSquaredError = squaredError / n;
+    result.accuracy = static_cast<double>(withinThreshold) / n;
+    result.additionalMetrics["mae"] = absoluteError / n;
+    result.additionalMetrics["mape"] = percentageCount > 0 ? percentageError / static_cast<double>(percentageCount) : 0.0;
+    result.additionalMetrics["smape"] = symmetricError / n;
+    if (m_method == Method::HoltWinters) {
+        result.additionalMetrics["alpha"] = m_alpha;
+        result.additionalMetrics["beta"] = m_beta;
+        result.additionalMetrics["gamma"] = m_gamma;
+    } else {
+        result.additionalMetrics["constant"] = m_constant;
+    }
+    return result;
+}
+
+void TimeSeriesModel::resetState(const std::vector<double>& series) {
+    m_observations = 0;
+    if (m_method == Method::HoltWinters) {
+        const size_t period = m_seasonal.size();
+        m_seasonIndex = 0;
+        if (period > 0) {
+            // 初始水平取第一个周期的均值，趋势取前两个周期均值之差，季节项取第一个周期的偏差
+            double first = mean(series, 0, period);
+            m_trend = m_trendEnabled && series.size() >= 2 * period ?
+                (mean(series, period, 2 * period) - first) / static_cast<double>(period) : 0.0;
+            for (size_t i = 0; i < period; ++i) {
+                m_seasonal[i] = series[i] - first;
+            }
+            m_level = first - m_trend * static_cast<double>(period + 1) / 2.0;
+        } else {
+            m_trend = m_trendEnabled && series.size() >= 2 ? series[1] - series[0] : 0.0;
+            m_level = series.empty() ? 0.0 : series[0] - m_trend;
+        }
+    } else {
+        m_integration.assign(m_differencing, 0.0);
+        m_history.assign(m_arCoefficients.size(), 0.0);
+        m_residuals.assign(m_maCoefficients.size(), 0.0);
+    }
+}
+
+double TimeSeriesModel::predictNext() const {
+    if (m_method == Method::HoltWinters) {
+        return m_level + m_trend + (m_seasonal.empty() ? 0.0 : m_seasonal[m_seasonIndex]);
+    }
+    
+    if (m_observations < m_differencing) {
+        return m_integration.empty() ? 0.0 : m_integration[0];
+    }
+    double value = m_constant;
+    for (size_t i = 0; i < m_history.size(); ++i) {
+        value += m_arCoefficients[i] * m_history[i];
+    }
+    for (size_t j = 0; j < m_residuals.size(); ++j) {
+        value += m_maCoefficients[j] * m_residuals[j];
+    }
+    for (size_t l = m_differencing; l-- > 0;) {
+        value += m_integration[l];
+    }
+    return value;
+}
+
+double TimeSeriesModel::update(double value) {
+    double error = value - predictNext();
+    
+    if (m_method == Method::HoltWinters) {
+        double seasonal = m_seasonal.empty() ? 0.0 : m_seasonal[m_seasonIndex];
+        double level = m_alpha * (value - seasonal) + (1.0 - m_alpha) * (m_level + m_trend);
+        if (m_trendEnabled) {
+            m_trend = m_beta * (level - m_level) + (1.0 - m_beta) * m_trend;
+        }
+        m_level = level;
+        if (!m_seasonal.empty()) {
+            m_seasonal[m_seasonIndex] = m_gamma * (value - level) + (1.0 - m_gamma) * seasonal;
+            m_seasonIndex = (m_seasonIndex + 1) % m_seasonal.size();
+        }
+    } else {
+        // 逐阶差分；前 d 个观测只用来建立各阶的上一个值
+        double differenced = value;
+        bool ready = true;
+        for (size_t l = 0; l < m_differencing; ++l) {
+            if (m_observations <= l) {
+                m_integration[l] = differenced;
+                ready = false;
+                break;
+            }
+            double next = differenced - m_integration[l];
+            m_integration[l] = differenced;
+            differenced = next;
+        }
+        if (ready) {
+            pushFront(m_history, differenced);
+            pushFront(m_residuals, error);
+        } else {
+            error = 0.0;
+        }
+    }
+    
+    ++m_observations;
+    return error;
+}
+
+std::vector<double> TimeSeriesModel::forecast(size_t horizon) const {
+    std::vector<double> values(horizon);
+    
+    if (m_method == Method::HoltWinters) {
+        for (size_t h = 0; h < horizon; ++h) {
+            double seasonal = m_seasonal.empty() ? 0.0 : m_seasonal[(m_seasonIndex + h) % m_seasonal.size()];
+            values[h] = m_level + static_cast<double>(h + 1) * m_trend + seasonal;
+        }
+        return values;
+    }
+    
+    // 未来的新息取期望0，逐步递推并积分回原始尺度
+    std::vector<double> history(m_history);
+    std::vector<double> residuals(m_residuals);
+    std::vector<double> integration(m_integration);
+    for (size_t h = 0; h < horizon; ++h) {
+        double differenced = m_constant;
+        for (size_t i = 0; i < history.size(); ++i) {
+            differenced += m_arCoefficients[i] * history[i];
+        }
+        for (size_t j = 0; j < residuals.size(); ++j) {
+            differenced += m_maCoefficients[j] * residuals[j];
+        }
+        pushFront(history, differenced);
+        pushFront(residuals, 0.0);
+        
+        double value = differenced;
+        for (size_t l = integration.size(); l-- > 0;) {
+            value += integration[l];
+            integration[l] = value;
+        }
+        values[h] = value;
+    }
+    return values;
+}
+
+std::vector<double> TimeSeriesModel::predict(const ConstMatrixView& testData) {
+    return forecast(testData.rows());
+}
+
+std::vector<TrainingResult> TimeSeriesModel::fitBatch(
+    std::vector<TimeSeriesModel>& models,
+    const std::vector<std::vector<double>>& series,
+    const std::map<std::string, double>& parameters) {
+    
+    models.assign(series.size(), TimeSeriesModel());
+    std::vector<TrainingResult> results(series.size());
+    Utils::ThreadPool::instance().parallelFor(0, series.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            results[s] = models[s].fit(series[s], parameters);
+        }
+    });
+    return results;
+}
+
+bool TimeSeriesModel::saveModel(const std::string& filePath) {
+    try {
+        uint64_t shape[4] = {static_cast<uint64_t>(m_method), m_observations, m_seasonIndex, m_differencing};
+        double scalars[7] = {m_alpha, m_beta, m_gamma, m_trendEnabled ? 1.0 : 0.0, m_level, m_trend, m_constant};
+        bool arima = m_method == Method::Arima;
+        
+        ModelFileWriter writer(ModelType::TimeSeries);
+        writer.addArray(kShapeSection, shape, 4);
+        writer.addArray(kScalarsSection, scalars, 7);
+        writer.addArray(kSeasonalSection, m_seasonal);
+        writer.addArray(kArSection, m_arCoefficients);
+        writer.addArray(kMaSection, m_maCoefficients);
+        writer.addArray(kIntegrationSection, m_integration.data(), arima ? m_integration.size() : 0);
+        writer.addArray(kHistorySection, m_history.data(), arima ? m_history.size() : 0);
+        writer.addArray(kResidualsSection, m_residuals.data(), arima ? m_residuals.size() : 0);
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool TimeSeriesModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::TimeSeries) {
+            return false;
+        }
+        
+        auto shape = file->section<uint64_t>(kShapeSection);
+        auto scalars = file->section<double>(kScalarsSection);
+        auto seasonal = file->section<double>(kSeasonalSection);
+        auto arCoefficients = file->section<double>(kArSection);
+        auto maCoefficients = file->section<double>(kMaSection);
+        auto integration = file->section<double>(kIntegrationSection);
+        auto history = file->section<double>(kHistorySection);
+        auto residuals = file->section<double>(kResidualsSection);
+        if (!shape.valid || shape.count != 4 || shape.data[0] > 1 || !scalars.valid || scalars.count != 7 ||
+            !seasonal.valid || !arCoefficients.valid || !maCoefficients.valid ||
+            !integration.valid || !history.valid || !residuals.valid) {
+            return false;
+        }
+        
+        Method method = static_cast<Method>(shape.data[0]);
+        bool arima = method == Method::Arima;
+        if (shape.data[3] > kMaxStateLength ||
+            (seasonal.count > 0 ? shape.data[2] >= seasonal.count : shape.data[2] != 0) ||
+            integration.count != (arima ? shape.data[3] : 0) ||
+            history.count != (arima ? arCoefficients.count : 0) ||
+            residuals.count != (arima ? maCoefficients.count : 0)) {
+            return false;
+        }
+        
+        m_method = method;
+        m_observations = shape.data[1];
+        m_seasonIndex = shape.data[2];
+        m_differencing = shape.data[3];
+        m_alpha = scalars.data[0];
+        m_beta = scalars.data[1];
+        m_gamma = scalars.data[2];
+        m_trendEnabled = scalars.data[3] != 0.0;
+        m_level = scalars.data[4];
+        m_trend = scalars.data[5];
+        m_constant = scalars.data[6];
+        m_seasonal.assign(seasonal.data, seasonal.data + seasonal.count);
+        m_arCoefficients.assign(arCoefficients.data, arCoefficients.data + arCoefficients.count);
+        m_maCoefficients.assign(maCoefficients.data, maCoefficients.data + maCoefficients.count);
+        m_integration.assign(integration.data, integration.data + integration.count);
+        m_history.assign(history.data, history.data + history.count);
+        m_residuals.assign(residuals.data, residuals.data + residuals.count);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// EventCountForecaster 实现
+EventCountForecaster::EventCountForecaster(uint64_t periodSeconds)
+    : m_periodSeconds(std::max<uint64_t>(1, periodSeconds)) {
+}
+
+TrainingResult EventCountForecaster::fit(const std::vector<uint64_t>& timestamps, const std::map<std::string, double>& parameters) {
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (timestamps.empty()) {
+        result.errorMessage = "No timestamps";
+        return result;
+    }
+    
+    auto range = std::minmax_element(timestamps.begin(), timestamps.end());
+    uint64_t first = *range.first / m_periodSeconds;
+    uint64_t last = *range.second / m_periodSeconds;
+    if (last - first >= kMaxCountPeriods) {
+        result.errorMessage = "Timestamp range too large for the period";
+        return result;
+    }
+    
+    // 最后一个周期尚未结束，只作为当前计数
+    std::vector<double> counts(last - first + 1, 0.0);
+    for (uint64_t timestamp : timestamps) {
+        counts[timestamp / m_periodSeconds - first] += 1.0;
+    }
+    m_currentPeriod = last;
+    m_currentCount = counts.back();
+    m_started = true;
+    counts.pop_back();
+    
+    return m_model.fit(counts, parameters);
+}
+
+void EventCountForecaster::addTimestamp(uint64_t timestamp) {
+    uint64_t period = timestamp / m_periodSeconds;
+    if (!m_started) {
+        m_started = true;
+        m_currentPeriod = period;
+        m_currentCount = 1.0;
+        return;
+    }
+    if (period <= m_currentPeriod) {
+        m_currentCount += 1.0;
+        return;
+    }
+    
+    // 当前周期结束，连同中间的空周期依次并入模型
+    m_model.update(m_currentCount);
+    uint64_t gap = std::min<uint64_t>(period - m_currentPeriod - 1, kMaxCountPeriods);
+    for (uint64_t k = 0; k < gap; ++k) {
+        m_model.update(0.0);
+    }
+    m_currentPeriod = period;
+    m_currentCount = 1.0;
+}
+
+std::vector<double> EventCountForecaster::forecast(size_t periods) const {
+    // 计数不会为负，趋势外推到0以下时截断
+    std::vector<double> values = m_model.forecast(periods);
+    for (double& value : values) {
+        value = std::max(0.0, value);
+    }
+    return values;
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
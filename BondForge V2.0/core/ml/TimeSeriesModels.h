@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "MLModels.h"
+#include "ModelFile.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 增量时间序列预测模型（不依赖mlpack）
+ * 
+ * 提供两种方法：
+ * - Holt-Winters 加法指数平滑（水平、趋势和可选的季节项），未给出平滑系数时
+ *   按一步预测误差平方和逐坐标做黄金分割搜索；
+ * - ARIMA(p, d, q)：d 阶差分后的ARMA，用Hannan-Rissanen两步最小二乘估计
+ *   （先拟合长AR得到残差估计，再对滞后值和滞后残差回归）。
+ * 
+ * 模型只保存预测所需的最近状态（水平/趋势/一个季节周期，或最近 p 个差分值、q 个残差和
+ * 各阶差分的上一个值），新观测通过 update() 以 O(1) 的代价并入，不需要在完整历史上重新训练。
+ * 
+ * 作为 IMLModel 使用时，训练标签按时间顺序构成序列（训练数据不参与拟合），
+ * predict() 返回与测试数据行数相同步数的预测。
+ * 
+ * 训练参数：
+ * - method：0 为Holt-Winters（默认），1 为ARIMA
+ * - seasonPeriod：季节周期（默认0，无季节项；仅Holt-Winters）
+ * - trend：是否包含趋势项（默认1；仅Holt-Winters）
+ * - alpha、beta、gamma：水平、趋势、季节的平滑系数（默认自动估计）
+ * - arOrder、differencing、maOrder：ARIMA的 p、d、q（默认 2、1、1）
+ */
+class TimeSeriesModel : public IMLModel {
+public:
+    enum class Method : uint32_t {
+        HoltWinters = 0,
+        Arima = 1
+    };
+    
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 在按时间顺序排列的序列上拟合模型
+     * 
+     * @param series 观测序列
+     * @param parameters 训练参数
+     * @return 训练结果（一步预测误差：meanSquaredError，additionalMetrics 中的 mape、smape 等）
+     */
+    TrainingResult fit(const std::vector<double>& series, const std::map<std::string, double>& parameters = {});
+    
+    /**
+     * @brief 预测接下来 testData.rows() 步
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 并入一个新观测（O(1)，模型参数不变）
+     * 
+     * @return 并入前对该观测的一步预测误差
+     */
+    double update(double value);
+    
+    /**
+     * @brief 预测接下来 horizon 步
+     */
+    std::vector<double> forecast(size_t horizon) const;
+    
+    /**
+     * @brief 在线程池上并行拟合多条序列（每条序列一个模型）
+     * 
+     * @param models 输出的模型，大小调整为序列数
+     * @param series 各条序列
+     * @param parameters 所有序列共用的训练参数
+     * @return 每条序列的训练结果
+     */
+    static std::vector<TrainingResult> fitBatch(
+        std::vector<TimeSeriesModel>& models,
+        const std::vector<std::vector<double>>& series,
+        const std::map<std::string, double>& parameters = {});
+    
+    ModelType getModelType() const override { return ModelType::TimeSeries; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    Method method() const { return m_method; }
+    uint64_t observationCount() const { return m_observations; }
+
+private:
+    double predictNext() const;
+    void resetState(const std::vector<double>& series);
+    
+    Method m_method = Method::HoltWinters;
+    uint64_t m_observations = 0;
+    
+    // Holt-Winters
+    double m_alpha = 0.5;
+    double m_beta = 0.0;
+    double m_gamma = 0.0;
+    bool m_trendEnabled = true;
+    double m_level = 0.0;
+    double m_trend = 0.0;
+    std::vector<double> m_seasonal;     // 一个周期的季节项
+    size_t m_seasonIndex = 0;           // 下一个观测对应的季节项
+    
+    // ARIMA
+    size_t m_differencing = 1;
+    double m_constant = 0.0;
+    std::vector<double> m_arCoefficients;
+    std::vector<double> m_maCoefficients;
+    std::vector<double> m_integration;  // 第 l 阶差分序列的上一个值
+    std::vector<double> m_history;      // 最近的差分值（最新在前）
+    std::vector<double> m_residuals;    // 最近的一步预测残差（最新在前）
+};
+
+/**
+ * @brief 事件计数序列的增量预测（如按 DataRecord::timestamp 统计的上传量）
+ * 
+ * 时间戳按固定周期计数，一个周期结束时才把该周期的计数（包括中间没有事件的空周期）
+ * 送入模型的 update()，因此新记录到达时预测随之刷新，不必重新拉取完整历史。
+ * 早于当前周期的时间戳计入当前周期。
+ */
+class EventCountForecaster {
+public:
+    explicit EventCountForecaster(uint64_t periodSeconds = 86400);
+    
+    /**
+     * @brief 用历史时间戳（无需排序）构建计数序列并拟合模型
+     */
+    TrainingResult fit(const std::vector<uint64_t>& timestamps, const std::map<std::string, double>& parameters = {});
+    
+    /**
+     * @brief 记录一个新事件
+     */
+    void addTimestamp(uint64_t timestamp);
+    
+    /**
+     * @brief 预测接下来若干个完整周期的事件数
+     */
+    std::vector<double> forecast(size_t periods) const;
+    
+    const TimeSeriesModel& model() const { return m_model; }
+
+private:
+    uint64_t m_periodSeconds;
+    uint64_t m_currentPeriod = 0;
+    double m_currentCount = 0.0;
+    bool m_started = false;
+    TimeSeriesModel m_model;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
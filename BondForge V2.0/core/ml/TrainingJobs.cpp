@@ -0,0 +1,465 @@
+#include "TrainingJobs.h"
+#include "ModelCommon.h"
+#include <algorithm>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+thread_local TrainingControl* t_currentControl = nullptr;
+
+TrainingResult failedResult(const std::string& message) {
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    result.errorMessage = message;
+    return result;
+}
+
+} // namespace
+
+// TrainingControl 实现
+TrainingControl::TrainingControl(double timeLimitSeconds, ProgressCallback progress)
+    : m_progress(std::move(progress)) {
+    if (timeLimitSeconds > 0.0) {
+        m_hasDeadline = true;
+        m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeLimitSeconds));
+    }
+}
+
+void TrainingControl::cancel() {
+    m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool TrainingControl::isTimedOut() const {
+    return m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline;
+}
+
+std::string TrainingControl::stopReason() const {
+    if (isCancelled()) {
+        return "Training cancelled";
+    }
+    return isTimedOut() ? "Training time limit exceeded" : std::string();
+}
+
+void TrainingControl::report(double fraction, const std::map<std::string, double>& metrics) {
+    if (!m_progress) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+    fraction = std::min(1.0, fraction);
+    if (fraction < m_fraction) {
+        return;
+    }
+    m_fraction = fraction;
+    m_progress(fraction, metrics);
+}
+
+bool TrainingControl::checkpoint(double fraction, TrainingResult& result, const std::map<std::string, double>& metrics) {
+    report(fraction, metrics);
+    if (!shouldStop()) {
+        return false;
+    }
+    result.success = false;
+    result.errorMessage = stopReason();
+    return true;
+}
+
+TrainingControl* TrainingControl::current() {
+    return t_currentControl;
+}
+
+TrainingControl::Scope::Scope(TrainingControl* control)
+    : m_previous(t_currentControl) {
+    t_currentControl = control;
+}
+
+TrainingControl::Scope::~Scope() {
+    t_currentControl = m_previous;
+}
+
+const char* trainingJobStatusName(TrainingJobStatus status) {
+    switch (status) {
+        case TrainingJobStatus::Pending:
+            return "pending";
+        case TrainingJobStatus::Running:
+            return "running";
+        case TrainingJobStatus::Completed:
+            return "completed";
+        case TrainingJobStatus::Failed:
+            return "failed";
+        case TrainingJobStatus::Cancelled:
+            return "cancelled";
+        case TrainingJobStatus::TimedOut:
+            return "timed_out";
+    }
+    return "unknown";
+}
+
+// TrainingJobManager 实现
+TrainingJobManager::TrainingJobManager(const TrainingJobManagerOptions& options)
+    : m_options(options) {
+    if (m_options.cpuBudget == 0) {
+        m_options.cpuBudget = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_dispatcher = std::thread(&TrainingJobManager::dispatchLoop, this);
+}
+
+TrainingJobManager::~TrainingJobManager() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (auto& entry : m_jobs) {
+            entry.second->control->cancel();
+        }
+    }
+    m_condition.notify_all();
+
+    // 调度线程结束排队中的任务并等到所有训练线程退出后才返回
+    if (m_dispatcher.joinable()) {
+        m_dispatcher.join();
+    }
+}
+
+TrainingJobManager& TrainingJobManager::instance() {
+    static TrainingJobManager manager;
+    return manager;
+}
+
+uint64_t TrainingJobManager::submit(TrainingJobRequest request) {
+    return submit(std::move(request), TrainingJobBody());
+}
+
+uint64_t TrainingJobManager::submit(TrainingJobRequest request, TrainingJobBody body) {
+    auto job = std::make_shared<Job>();
+    job->info.name = request.name;
+    job->info.description = request.description;
+    job->info.modelType = request.modelType;
+    job->info.timeLimitSeconds = request.timeLimitSeconds < 0.0 ? m_options.defaultTimeLimitSeconds
+                                                                : request.timeLimitSeconds;
+    job->info.cpuCost = std::max<size_t>(1, request.cpuCost);
+    job->request = std::move(request);
+    job->body = std::move(body);
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextId++;
+        job->info.id = id;
+        // 时限从任务开始运行时计算，控制对象在开始时替换；排队期间只用于接收取消请求
+        job->control = std::make_unique<TrainingControl>();
+        if (m_stopping) {
+            job->control->cancel();
+        }
+        m_jobs.emplace(id, job);
+        m_pending.push_back(std::move(job));
+    }
+    m_condition.notify_all();
+    return id;
+}
+
+bool TrainingJobManager::cancel(uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(id);
+        if (it == m_jobs.end() || it->second->info.isFinished()) {
+            return false;
+        }
+        it->second->control->cancel();
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+void TrainingJobManager::cancelAll() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_jobs) {
+            if (!entry.second->info.isFinished()) {
+                entry.second->control->cancel();
+            }
+        }
+    }
+    m_condition.notify_all();
+}
+
+bool TrainingJobManager::wait(uint64_t id, double timeoutSeconds) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto finished = [&]() {
+        auto it = m_jobs.find(id);
+        return it == m_jobs.end() || it->second->callbacksDone;
+    };
+    if (timeoutSeconds < 0.0) {
+        m_finished.wait(lock, finished);
+        return true;
+    }
+    return m_finished.wait_for(lock, std::chrono::duration<double>(timeoutSeconds), finished);
+}
+
+bool TrainingJobManager::getJob(uint64_t id, TrainingJobInfo& info) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) {
+        return false;
+    }
+    info = it->second->info;
+    if (info.status == TrainingJobStatus::Running) {
+        info.elapsedSeconds = secondsSince(it->second->started);
+    }
+    return true;
+}
+
+std::vector<TrainingJobInfo> TrainingJobManager::listJobs(const std::string& statusFilter) const {
+    std::vector<TrainingJobInfo> jobs;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = Clock::now();
+    for (const auto& entry : m_jobs) {
+        const TrainingJobInfo& info = entry.second->info;
+        if (!statusFilter.empty() && statusFilter != trainingJobStatusName(info.status)) {
+            continue;
+        }
+        jobs.push_back(info);
+        if (info.status == TrainingJobStatus::Running) {
+            jobs.back().elapsedSeconds = std::chrono::duration<double>(now - entry.second->started).count();
+        }
+    }
+    return jobs;
+}
+
+TrainingResult TrainingJobManager::getResult(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || !it->second->info.isFinished()) {
+        return failedResult(it == m_jobs.end() ? "Unknown training job" : "Training job has not finished");
+    }
+    return it->second->result;
+}
+
+std::shared_ptr<IMLModel> TrainingJobManager::getModel(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    return it != m_jobs.end() ? it->second->model : nullptr;
+}
+
+bool TrainingJobManager::removeJob(uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || !it->second->info.isFinished()) {
+        return false;
+    }
+    m_jobs.erase(it);
+    m_finishedOrder.erase(std::remove(m_finishedOrder.begin(), m_finishedOrder.end(), id), m_finishedOrder.end());
+    return true;
+}
+
+void TrainingJobManager::setCpuBudget(size_t cpuBudget) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_options.cpuBudget = cpuBudget > 0 ? cpuBudget : std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_condition.notify_all();
+}
+
+size_t TrainingJobManager::cpuBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options.cpuBudget;
+}
+
+size_t TrainingJobManager::cpuInUse() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cpuInUse;
+}
+
+size_t TrainingJobManager::effectiveCost(const Job& job) const {
+    return std::min(job.info.cpuCost, m_options.cpuBudget);
+}
+
+void TrainingJobManager::dispatchLoop() {
+    std::vector<std::shared_ptr<Job>> active;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        // 回收已结束的训练线程（线程在最后一步才标记结束，join 不会等待锁）
+        for (auto it = active.begin(); it != active.end();) {
+            if ((*it)->threadDone) {
+                (*it)->thread.join();
+                it = active.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // 排队中被取消的任务直接结束
+        std::vector<std::shared_ptr<Job>> cancelled;
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if ((*it)->control->isCancelled()) {
+                cancelled.push_back(*it);
+                it = m_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!cancelled.empty()) {
+            lock.unlock();
+            for (auto& job : cancelled) {
+                finishJob(*job, TrainingJobStatus::Cancelled, failedResult("Training cancelled"), nullptr);
+            }
+            lock.lock();
+            continue;
+        }
+
+        // 按提交顺序启动，队首放不下时后面的任务也等待
+        while (!m_pending.empty() && m_cpuInUse + effectiveCost(*m_pending.front()) <= m_options.cpuBudget) {
+            std::shared_ptr<Job> job = m_pending.front();
+            m_pending.pop_front();
+            m_cpuInUse += effectiveCost(*job);
+
+            job->info.status = TrainingJobStatus::Running;
+            job->info.startTime = localTimeString();
+            job->info.lastUpdateTime = job->info.startTime;
+            job->started = Clock::now();
+            job->lastProgress = job->started;
+            Job* raw = job.get();
+            job->control = std::make_unique<TrainingControl>(job->info.timeLimitSeconds,
+                [this, raw](double fraction, const std::map<std::string, double>& metrics) {
+                    onJobProgress(*raw, fraction, metrics);
+                });
+            job->thread = std::thread(&TrainingJobManager::runJob, this, job);
+            active.push_back(std::move(job));
+        }
+
+        if (m_stopping && m_pending.empty() && active.empty()) {
+            break;
+        }
+        m_condition.wait(lock);
+    }
+}
+
+void TrainingJobManager::runJob(std::shared_ptr<Job> job) {
+    TrainingControl& control = *job->control;
+    TrainingResult result = failedResult("");
+    std::shared_ptr<IMLModel> model;
+
+    try {
+        TrainingControl::Scope scope(&control);
+        if (job->body) {
+            result = job->body(control, model);
+        } else {
+            model = ModelFactory::createModel(job->info.modelType);
+            result = model->train(job->request.data, job->request.labels, job->request.parameters);
+        }
+    } catch (const std::exception& e) {
+        result = failedResult(e.what());
+    } catch (...) {
+        result = failedResult("Unknown error during training");
+    }
+
+    // 不支持中断的模型训练结束后才检查：超时或被取消的结果同样丢弃
+    TrainingJobStatus status = TrainingJobStatus::Completed;
+    if (control.isCancelled()) {
+        status = TrainingJobStatus::Cancelled;
+    } else if (control.isTimedOut()) {
+        status = TrainingJobStatus::TimedOut;
+    } else if (!result.success) {
+        status = TrainingJobStatus::Failed;
+    }
+    if (status == TrainingJobStatus::Cancelled || status == TrainingJobStatus::TimedOut) {
+        result.success = false;
+        result.errorMessage = control.stopReason();
+        model.reset();
+    } else if (status == TrainingJobStatus::Failed) {
+        model.reset();
+    }
+
+    // 训练数据不再需要
+    job->request.data = Matrix();
+    job->request.labels = std::vector<double>();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cpuInUse -= effectiveCost(*job);
+    }
+    m_condition.notify_all();
+
+    finishJob(*job, status, result, std::move(model));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->threadDone = true;
+    }
+    m_condition.notify_all();
+}
+
+void TrainingJobManager::onJobProgress(Job& job, double fraction, const std::map<std::string, double>& metrics) {
+    TrainingJobInfo snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = Clock::now();
+        job.info.progressPercentage = 100.0 * fraction;
+        job.info.metrics = metrics;
+        job.info.lastUpdateTime = localTimeString();
+        job.info.elapsedSeconds = std::chrono::duration<double>(now - job.started).count();
+        if (!job.request.onProgress ||
+            (fraction < 1.0 && std::chrono::duration<double>(now - job.lastProgress).count() < m_options.progressIntervalSeconds)) {
+            return;
+        }
+        job.lastProgress = now;
+        snapshot = job.info;
+    }
+    job.request.onProgress(snapshot);
+}
+
+void TrainingJobManager::finishJob(Job& job, TrainingJobStatus status, const TrainingResult& result,
+                                   std::shared_ptr<IMLModel> model) {
+    TrainingJobInfo snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job.info.status = status;
+        job.info.endTime = localTimeString();
+        job.info.lastUpdateTime = job.info.endTime;
+        job.info.errorLog = result.success ? std::string() : result.errorMessage;
+        if (status == TrainingJobStatus::Completed) {
+            job.info.progressPercentage = 100.0;
+            job.info.metrics = result.additionalMetrics;
+            job.info.metrics["accuracy"] = result.accuracy;
+            job.info.metrics["meanSquaredError"] = result.meanSquaredError;
+        }
+        if (!job.info.startTime.empty()) {
+            job.info.elapsedSeconds = secondsSince(job.started);
+        }
+        job.result = result;
+        job.model = model;
+        m_finishedOrder.push_back(job.info.id);
+        pruneFinishedJobs();
+        snapshot = job.info;
+    }
+
+    if (job.request.onFinished) {
+        job.request.onFinished(snapshot, result, std::move(model));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job.callbacksDone = true;
+    }
+    m_finished.notify_all();
+}
+
+void TrainingJobManager::pruneFinishedJobs() {
+    while (m_finishedOrder.size() > m_options.maxFinishedJobs) {
+        m_jobs.erase(m_finishedOrder.front());
+        m_finishedOrder.pop_front();
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <deque>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+#include "MLModels.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 训练的取消、时限和进度报告
+ *
+ * 训练任务在调用 IMLModel::train() 前用 Scope 把控制对象设为当前线程的控制对象，
+ * 支持中断的模型（逻辑回归、随机森林、梯度提升树、K均值、流式训练）在每轮迭代 / 每棵树之后
+ * 通过 current() 取得它，报告进度并检查是否应停止。应停止时模型放弃本次训练，
+ * 返回失败的 TrainingResult（错误信息为 stopReason()），此时模型的参数不确定，不应再用于预测。
+ * 其他模型不检查，只在训练结束后由训练任务判断是否超时。
+ *
+ * 进度回调可能在线程池的工作线程上并发调用，控制对象内部串行化这些调用。
+ */
+class TrainingControl {
+public:
+    using ProgressCallback = std::function<void(double fraction, const std::map<std::string, double>& metrics)>;
+
+    /**
+     * @brief 构造控制对象，时限从构造时开始计算
+     *
+     * @param timeLimitSeconds 训练时限（秒，0表示不限）
+     * @param progress 进度回调（可为空）
+     */
+    explicit TrainingControl(double timeLimitSeconds = 0.0, ProgressCallback progress = {});
+
+    TrainingControl(const TrainingControl&) = delete;
+    TrainingControl& operator=(const TrainingControl&) = delete;
+
+    /**
+     * @brief 请求取消（可在任何线程调用）
+     */
+    void cancel();
+
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 是否已超过时限
+     */
+    bool isTimedOut() const;
+
+    /**
+     * @brief 是否应停止训练（已取消或已超时）
+     */
+    bool shouldStop() const { return isCancelled() || isTimedOut(); }
+
+    /**
+     * @brief 停止的原因（用作训练结果的错误信息）
+     */
+    std::string stopReason() const;
+
+    /**
+     * @brief 报告进度
+     *
+     * @param fraction 已完成的比例（0~1，小于之前报告的值时忽略）
+     * @param metrics 当前的训练指标（如损失）
+     */
+    void report(double fraction, const std::map<std::string, double>& metrics = {});
+
+    /**
+     * @brief 报告进度并检查是否应停止
+     *
+     * @return 是否应停止（此时已把 stopReason() 写入 result.errorMessage）
+     */
+    bool checkpoint(double fraction, TrainingResult& result, const std::map<std::string, double>& metrics = {});
+
+    /**
+     * @brief 当前线程的控制对象（没有时返回空指针）
+     */
+    static TrainingControl* current();
+
+    /**
+     * @brief 在作用域内把控制对象设为当前线程的控制对象
+     */
+    class Scope {
+    public:
+        explicit Scope(TrainingControl* control);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TrainingControl* m_previous;
+    };
+
+private:
+    std::atomic<bool> m_cancelled{false};
+    bool m_hasDeadline = false;
+    std::chrono::steady_clock::time_point m_deadline;
+    ProgressCallback m_progress;
+    std::mutex m_progressMutex;
+    double m_fraction = 0.0;
+};
+
+/**
+ * @brief 训练任务状态
+ */
+enum class TrainingJobStatus {
+    Pending,        // 排队等待CPU配额
+    Running,
+    Completed,
+    Failed,
+    Cancelled,
+    TimedOut
+};
+
+/**
+ * @brief 状态名称（pending/running/completed/failed/cancelled/timed_out，与训练任务表的 status 列一致）
+ */
+const char* trainingJobStatusName(TrainingJobStatus status);
+
+/**
+ * @brief 训练任务的状态快照
+ *
+ * 字段对应训练任务表（TrainingTask）和训练进度表（TrainingProgress），可直接持久化。
+ * 时间为本地时间 "YYYY-MM-DD HH:MM:SS"，尚未开始/结束时为空。
+ */
+struct TrainingJobInfo {
+    uint64_t id = 0;
+    std::string name;
+    std::string description;
+    ModelType modelType = ModelType::LinearRegression;
+    TrainingJobStatus status = TrainingJobStatus::Pending;
+    std::string startTime;
+    std::string endTime;
+    std::string errorLog;
+    double progressPercentage = 0.0;        // 0~100
+    std::string lastUpdateTime;
+    std::map<std::string, double> metrics;  // 最近一次进度报告的指标；结束后为训练结果的指标
+    double elapsedSeconds = 0.0;
+    double timeLimitSeconds = 0.0;
+    size_t cpuCost = 1;
+
+    bool isFinished() const {
+        return status != TrainingJobStatus::Pending && status != TrainingJobStatus::Running;
+    }
+};
+
+/**
+ * @brief 自定义训练过程：在 control 的作用域内训练，把得到的模型写入 model
+ */
+using TrainingJobBody = std::function<TrainingResult(TrainingControl& control, std::shared_ptr<IMLModel>& model)>;
+
+/**
+ * @brief 训练任务请求
+ */
+struct TrainingJobRequest {
+    std::string name;
+    std::string description;
+    ModelType modelType = ModelType::LinearRegression;
+
+    // 默认的训练过程：由 ModelFactory::createModel(modelType) 创建模型，在 data / labels 上训练
+    Matrix data;
+    std::vector<double> labels;
+    std::map<std::string, double> parameters;
+
+    double timeLimitSeconds = -1.0;     // 训练时限（秒，0表示不限，负数表示使用管理器的默认时限）
+    size_t cpuCost = 1;                 // 占用的CPU配额（超过总配额时按总配额计）
+
+    /**
+     * @brief 进度回调（在训练线程上调用，两次调用至少间隔 progressIntervalSeconds）
+     */
+    std::function<void(const TrainingJobInfo&)> onProgress;
+
+    /**
+     * @brief 结束回调（在训练线程上调用一次；模型只在完成时非空）
+     */
+    std::function<void(const TrainingJobInfo&, const TrainingResult&, std::shared_ptr<IMLModel>)> onFinished;
+};
+
+/**
+ * @brief 训练任务管理器选项
+ */
+struct TrainingJobManagerOptions {
+    size_t cpuBudget = 0;                   // 同时运行的任务的CPU配额总和上限（0表示硬件线程数）
+    double defaultTimeLimitSeconds = 3600.0;  // 默认训练时限（对应配置项 ml.max_training_time）
+    double progressIntervalSeconds = 0.1;   // 进度回调的最小间隔
+    size_t maxFinishedJobs = 256;           // 保留的已结束任务数（超过时删除最早结束的）
+};
+
+/**
+ * @brief 异步训练任务管理器
+ *
+ * 每个任务在单独的线程上运行（不占用计算线程池的工作线程，模型内部的并行循环仍在共享线程池上执行），
+ * 通过回调报告进度和指标，可以随时取消，超过时限时自动停止。
+ * 任务按提交顺序排队：队首任务的CPU配额加上运行中任务的配额不超过总配额时才开始，
+ * 因此多个任务可以并发训练，而大任务不会被不断到来的小任务饿死。
+ *
+ * 回调在训练线程上调用，界面代码需要自行切换到界面线程。
+ */
+class TrainingJobManager {
+public:
+    explicit TrainingJobManager(const TrainingJobManagerOptions& options = {});
+
+    /**
+     * @brief 取消所有任务，等待运行中的任务停止后返回
+     */
+    ~TrainingJobManager();
+
+    TrainingJobManager(const TrainingJobManager&) = delete;
+    TrainingJobManager& operator=(const TrainingJobManager&) = delete;
+
+    /**
+     * @brief 全局训练任务管理器（默认选项）
+     */
+    static TrainingJobManager& instance();
+
+    /**
+     * @brief 提交训练任务（默认训练过程）
+     *
+     * @return 任务ID
+     */
+    uint64_t submit(TrainingJobRequest request);
+
+    /**
+     * @brief 提交使用自定义训练过程的任务（request 中的数据、标签和参数被忽略）
+     */
+    uint64_t submit(TrainingJobRequest request, TrainingJobBody body);
+
+    /**
+     * @brief 取消任务（排队中的任务直接结束，运行中的任务在下一个检查点停止）
+     *
+     * @return 任务是否存在且尚未结束
+     */
+    bool cancel(uint64_t id);
+
+    /**
+     * @brief 取消所有未结束的任务
+     */
+    void cancelAll();
+
+    /**
+     * @brief 等待任务结束（返回时结束回调已执行完，因此不能在结束回调中等待同一任务）
+     *
+     * @param id 任务ID
+     * @param timeoutSeconds 最长等待时间（负数表示一直等待）
+     * @return 任务是否已结束（任务不存在时返回true）
+     */
+    bool wait(uint64_t id, double timeoutSeconds = -1.0);
+
+    /**
+     * @brief 任务的状态快照
+     *
+     * @return 任务是否存在
+     */
+    bool getJob(uint64_t id, TrainingJobInfo& info) const;
+
+    /**
+     * @brief 所有任务的状态快照（按ID升序）
+     *
+     * @param statusFilter 只列出该状态的任务（状态名称，空表示全部）
+     */
+    std::vector<TrainingJobInfo> listJobs(const std::string& statusFilter = "") const;
+
+    /**
+     * @brief 任务的训练结果（任务尚未结束时返回默认值）
+     */
+    TrainingResult getResult(uint64_t id) const;
+
+    /**
+     * @brief 已完成任务训练得到的模型（未完成时返回空指针）
+     */
+    std::shared_ptr<IMLModel> getModel(uint64_t id) const;
+
+    /**
+     * @brief 删除已结束的任务
+     *
+     * @return 任务是否存在且已结束
+     */
+    bool removeJob(uint64_t id);
+
+    /**
+     * @brief 修改CPU配额总和上限（0表示硬件线程数）
+     */
+    void setCpuBudget(size_t cpuBudget);
+
+    size_t cpuBudget() const;
+    size_t cpuInUse() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        TrainingJobInfo info;
+        TrainingJobRequest request;
+        TrainingJobBody body;
+        std::unique_ptr<TrainingControl> control;
+        TrainingResult result;
+        std::shared_ptr<IMLModel> model;
+        Clock::time_point started;
+        Clock::time_point lastProgress;
+        std::thread thread;
+        bool callbacksDone = false;         // 已结束且结束回调已返回
+        bool threadDone = false;
+    };
+
+    void dispatchLoop();
+    void runJob(std::shared_ptr<Job> job);
+    void onJobProgress(Job& job, double fraction, const std::map<std::string, double>& metrics);
+    void finishJob(Job& job, TrainingJobStatus status, const TrainingResult& result, std::shared_ptr<IMLModel> model);
+    void pruneFinishedJobs();
+    size_t effectiveCost(const Job& job) const;
+
+    TrainingJobManagerOptions m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;        // 调度线程：有任务排队、结束或配额改变
+    std::condition_variable m_finished;         // wait()：有任务结束
+    std::map<uint64_t, std::shared_ptr<Job>> m_jobs;
+    std::deque<std::shared_ptr<Job>> m_pending;
+    std::deque<uint64_t> m_finishedOrder;
+    uint64_t m_nextId = 1;
+    size_t m_cpuInUse = 0;
+    bool m_stopping = false;
+
+    std::thread m_dispatcher;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
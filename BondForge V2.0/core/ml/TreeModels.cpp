@@ -0,0 +1,1581 @@
+#include "TreeModels.h"
+#include "ModelCommon.h"
+#include "TrainingJobs.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <cmath>
+#include <limits>
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+namespace {
+
+// 分箱编码为单字节，每个特征至多256个分箱
+constexpr size_t kMaxBins = 256;
+
+// 计算分位数边界时每个特征最多抽取的样本数
+constexpr size_t kBinningSampleRows = 200000;
+
+// 并行统计直方图时每块的最少行数和最多块数（块划分只取决于行数，合并顺序固定）
+constexpr size_t kHistogramBlockRows = 16384;
+constexpr size_t kMaxHistogramBlocks = 16;
+
+// 预测时每批的行数：一批样本依次走完每棵树，树的节点在批内保持在缓存中
+constexpr size_t kPredictBlockRows = 256;
+
+// 不需要直方图的节点（不会再分裂）
+constexpr size_t kNoHistogram = static_cast<size_t>(-1);
+
+// 批量遍历时同步下降的样本数
+constexpr size_t kTraversalBatchRows = 64;
+
+// 模型文件中的节
+constexpr uint32_t kShapeSection = sectionTag("SHAP");
+constexpr uint32_t kClassesSection = sectionTag("CLAS");
+constexpr uint32_t kRootsSection = sectionTag("ROOT");
+constexpr uint32_t kDepthsSection = sectionTag("DPTH");
+constexpr uint32_t kNodesSection = sectionTag("NODE");
+constexpr uint32_t kLeavesSection = sectionTag("LEAF");
+constexpr uint32_t kBaseScoreSection = sectionTag("BASE");
+constexpr uint32_t kGainsSection = sectionTag("GAIN");
+
+/**
+ * @brief 按分位数离散化后的特征矩阵（行主序单字节编码）
+ */
+struct BinnedMatrix {
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<uint8_t> codes;
+    std::vector<std::vector<double>> edges;     // 每个特征的分箱上界：编码 b 等价于 x <= edges[b]
+    std::vector<uint32_t> binOffsets;           // 每个特征在直方图中的起始分箱（cols + 1 个）
+    
+    const uint8_t* row(size_t i) const { return codes.data() + i * cols; }
+    size_t binCount(size_t feature) const { return binOffsets[feature + 1] - binOffsets[feature]; }
+    size_t totalBins() const { return binOffsets.back(); }
+};
+
+/**
+ * @brief 由一个特征的抽样取值求分箱边界
+ * 
+ * values 为升序的非NaN取值，zeros 为不在 values 中的隐含0的个数（稀疏特征）。
+ * 取值种类不超过 maxBins 时以相邻取值的中点为边界，否则取分位数。
+ */
+void appendEdges(std::vector<double>& values, size_t zeros, size_t maxBins, std::vector<double>& edges) {
+    size_t zeroPosition = std::lower_bound(values.begin(), values.end(), 0.0) - values.begin();
+    bool zeroPresent = zeroPosition < values.size() && values[zeroPosition] == 0.0;
+    size_t total = values.size() + zeros;
+    size_t distinct = values.empty() ? 0 :
+        1 + std::inner_product(values.begin() + 1, values.end(), values.begin(), size_t(0),
+                               std::plus<size_t>(), std::not_equal_to<double>());
+    if (zeros > 0 && !zeroPresent) {
+        ++distinct;
+    }
+    
+    if (distinct <= maxBins) {
+        // 只取决于不同的取值，隐含的0插入一个即可
+        if (zeros > 0 && !zeroPresent) {
+            values.insert(values.begin() + zeroPosition, 0.0);
+        }
+        for (size_t k = 1; k < values.size(); ++k) {
+            if (values[k] != values[k - 1]) {
+                edges.push_back(values[k - 1] + (values[k] - values[k - 1]) / 2);
+            }
+        }
+        return;
+    }
+    
+    // 分位数按合并了隐含0的有序序列取：[0, zeroPosition) 为负值，之后 zeros 个0，再之后为其余取值
+    auto valueAt = [&](size_t k) {
+        return k < zeroPosition ? values[k] : k < zeroPosition + zeros ? 0.0 : values[k - zeros];
+    };
+    for (size_t b = 1; b < maxBins; ++b) {
+        double edge = valueAt(b * total / maxBins);
+        if (edges.empty() || edge > edges.back()) {
+            edges.push_back(edge);
+        }
+    }
+}
+
+void computeBinOffsets(BinnedMatrix& binned) {
+    for (size_t f = 0; f < binned.cols; ++f) {
+        binned.binOffsets[f + 1] = binned.binOffsets[f] + static_cast<uint32_t>(binned.edges[f].size() + 1);
+    }
+}
+
+/**
+ * @brief 把特征离散化为分箱编码
+ * 
+ * 分箱边界由抽样数据求得（见 appendEdges）。NaN 的编码为0，与预测时 NaN 走左子节点一致。
+ */
+BinnedMatrix binFeatures(const ConstMatrixView& data, size_t maxBins) {
+    BinnedMatrix binned;
+    binned.rows = data.rows();
+    binned.cols = data.cols();
+    binned.edges.resize(binned.cols);
+    binned.binOffsets.assign(binned.cols + 1, 0);
+    
+    auto& pool = Utils::ThreadPool::instance();
+    size_t step = std::max<size_t>(1, binned.rows / kBinningSampleRows);
+    
+    pool.parallelFor(0, binned.cols, 1, [&](size_t featureBegin, size_t featureEnd) {
+        std::vector<double> values;
+        for (size_t f = featureBegin; f < featureEnd; ++f) {
+            values.clear();
+            for (size_t i = 0; i < binned.rows; i += step) {
+                double value = data(i, f);
+                if (!std::isnan(value)) {
+                    values.push_back(value);
+                }
+            }
+            std::sort(values.begin(), values.end());
+            appendEdges(values, 0, maxBins, binned.edges[f]);
+        }
+    });
+    computeBinOffsets(binned);
+    
+    binned.codes.resize(binned.rows * binned.cols);
+    pool.parallelFor(0, binned.rows, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const double* sample = data.row(i);
+            uint8_t* codes = binned.codes.data() + i * binned.cols;
+            for (size_t f = 0; f < binned.cols; ++f) {
+                const std::vector<double>& edges = binned.edges[f];
+                codes[f] = std::isnan(sample[f]) ? 0 : static_cast<uint8_t>(
+                    std::lower_bound(edges.begin(), edges.end(), sample[f]) - edges.begin());
+            }
+        }
+    });
+    
+    return binned;
+}
+
+/**
+ * @brief 把稀疏特征离散化为分箱编码（与稠密版本的分箱边界相同）
+ * 
+ * 抽样行的非零元素按列收集后求边界，隐含的0只计数；编码先填入各特征0的编码，再改写非零元素。
+ */
+BinnedMatrix binFeatures(const SparseMatrixView& data, size_t maxBins) {
+    BinnedMatrix binned;
+    binned.rows = data.rows();
+    binned.cols = data.cols();
+    binned.edges.resize(binned.cols);
+    binned.binOffsets.assign(binned.cols + 1, 0);
+    
+    auto& pool = Utils::ThreadPool::instance();
+    size_t step = std::max<size_t>(1, binned.rows / kBinningSampleRows);
+    size_t sampledRows = (binned.rows + step - 1) / step;
+    
+    // 抽样行按列转置（CSC）
+    std::vector<uint32_t> scratch;
+    std::vector<size_t> columnOffsets(binned.cols + 1, 0);
+    for (size_t i = 0; i < binned.rows; i += step) {
+        SparseRow row = data.row(i, scratch);
+        for (size_t k = 0; k < row.size; ++k) {
+            ++columnOffsets[row.indices[k] + 1];
+        }
+    }
+    for (size_t f = 0; f < binned.cols; ++f) {
+        columnOffsets[f + 1] += columnOffsets[f];
+    }
+    std::vector<double> columnValues(columnOffsets.back());
+    std::vector<size_t> fill(columnOffsets.begin(), columnOffsets.end() - 1);
+    for (size_t i = 0; i < binned.rows; i += step) {
+        SparseRow row = data.row(i, scratch);
+        for (size_t k = 0; k < row.size; ++k) {
+            columnValues[fill[row.indices[k]]++] = row.value(k);
+        }
+    }
+    
+    pool.parallelFor(0, binned.cols, 1, [&](size_t featureBegin, size_t featureEnd) {
+        std::vector<double> values;
+        for (size_t f = featureBegin; f < featureEnd; ++f) {
+            values.clear();
+            for (size_t k = columnOffsets[f]; k < columnOffsets[f + 1]; ++k) {
+                if (!std::isnan(columnValues[k])) {
+                    values.push_back(columnValues[k]);
+                }
+            }
+            std::sort(values.begin(), values.end());
+            size_t zeros = sampledRows - (columnOffsets[f + 1] - columnOffsets[f]);
+            appendEdges(values, zeros, maxBins, binned.edges[f]);
+        }
+    });
+    computeBinOffsets(binned);
+    
+    std::vector<uint8_t> zeroCodes(binned.cols);
+    for (size_t f = 0; f < binned.cols; ++f) {
+        const std::vector<double>& edges = binned.edges[f];
+        zeroCodes[f] = static_cast<uint8_t>(std::lower_bound(edges.begin(), edges.end(), 0.0) - edges.begin());
+    }
+    
+    binned.codes.resize(binned.rows * binned.cols);
+    pool.parallelFor(0, binned.rows, 4096, [&](size_t begin, size_t end) {
+        std::vector<uint32_t> rowScratch;
+        for (size_t i = begin; i < end; ++i) {
+            uint8_t* codes = binned.codes.data() + i * binned.cols;
+            std::copy(zeroCodes.begin(), zeroCodes.end(), codes);
+            SparseRow row = data.row(i, rowScratch);
+            for (size_t k = 0; k < row.size; ++k) {
+                double value = row.value(k);
+                const std::vector<double>& edges = binned.edges[row.indices[k]];
+                codes[row.indices[k]] = std::isnan(value) ? 0 : static_cast<uint8_t>(
+                    std::lower_bound(edges.begin(), edges.end(), value) - edges.begin());
+            }
+        }
+    });
+    
+    return binned;
+}
+
+/**
+ * @brief 分裂准则
+ */
+enum class SplitCriterion {
+    Gini,       // 分类：直方图统计各类别样本数
+    Newton      // 回归/梯度提升：直方图统计样本数、一阶和二阶梯度
+};
+
+/**
+ * @brief 树的生长参数
+ */
+struct GrowthOptions {
+    SplitCriterion criterion = SplitCriterion::Gini;
+    size_t numClasses = 2;          // Gini 准则的类别数
+    size_t maxDepth = 16;
+    size_t maxLeaves = 0;           // 0 表示不限制（深度优先生长），否则按增益最大优先生长
+    size_t minSamplesLeaf = 1;
+    size_t featuresPerSplit = 0;    // 每次分裂随机考虑的特征数，0 表示全部
+    double minGain = 1e-12;
+    double lambda = 0.0;            // Newton 准则的L2正则
+    bool parallel = true;           // 大节点的直方图是否在线程池上并行统计
+};
+
+/**
+ * @brief 单棵树的生长器
+ * 
+ * 每个线程一个实例，直方图缓冲区和特征抽样工作区随实例复用。
+ */
+class TreeBuilder {
+public:
+    TreeBuilder(const BinnedMatrix& binned, const GrowthOptions& options)
+        : m_binned(binned),
+          m_options(options),
+          m_stats(options.criterion == SplitCriterion::Gini ? options.numClasses : 3),
+          m_features(binned.cols) {}
+    
+    /**
+     * @brief 在 rows 指定的样本（可重复）上生长一棵树
+     * 
+     * 节点和叶值追加到 nodes/leafValues 末尾，子节点和叶值偏移是这两个数组内的下标。
+     * rows 会被重新排列。Gini 准则使用 classTargets，Newton 准则使用 gradients 和 hessians
+     * （hessians 为空时视为全1）。nodeGains 与 nodes 一一对应，新节点的分裂增益写入其中（叶子为0）。
+     */
+    void grow(std::vector<uint32_t>& rows,
+              const uint32_t* classTargets,
+              const double* gradients,
+              const double* hessians,
+              std::mt19937_64& rng,
+              std::vector<TreeNode>& nodes,
+              std::vector<double>& leafValues,
+              std::vector<double>& nodeGains);
+
+private:
+    struct Split {
+        int32_t feature = -1;
+        uint32_t bin = 0;
+        double gain = 0.0;
+        std::vector<double> leftTotals;
+    };
+    
+    struct PendingNode {
+        uint32_t node = 0;
+        size_t begin = 0;
+        size_t end = 0;
+        size_t depth = 0;
+        size_t histogram = kNoHistogram;
+        std::vector<double> totals;
+        Split split;
+    };
+    
+    size_t histogramSize() const { return m_binned.totalBins() * m_stats; }
+    size_t acquireHistogram();
+    void releaseHistogram(size_t id) {
+        if (id != kNoHistogram) {
+            m_freeHistograms.push_back(id);
+        }
+    }
+    void buildHistogram(const uint32_t* rows, size_t count, double* histogram);
+    void accumulateRows(const uint32_t* rows, size_t count, double* histogram) const;
+    double score(const double* totals) const;
+    bool splittable(size_t count, size_t depth) const;
+    Split findSplit(const double* histogram, const std::vector<double>& totals, size_t count, std::mt19937_64& rng);
+    void writeLeaf(const std::vector<double>& totals, TreeNode& node, std::vector<double>& leafValues) const;
+    
+    const BinnedMatrix& m_binned;
+    GrowthOptions m_options;
+    size_t m_stats;     // 每个分箱的统计量个数
+    
+    const uint32_t* m_classTargets = nullptr;
+    const double* m_gradients = nullptr;
+    const double* m_hessians = nullptr;
+    
+    std::vector<std::vector<double>> m_histograms;
+    std::vector<size_t> m_freeHistograms;
+    std::vector<std::vector<double>> m_blockHistograms;
+    std::vector<uint32_t> m_features;
+};
+
+size_t TreeBuilder::acquireHistogram() {
+    if (!m_freeHistograms.empty()) {
+        size_t id = m_freeHistograms.back();
+        m_freeHistograms.pop_back();
+        return id;
+    }
+    m_histograms.emplace_back(histogramSize());
+    return m_histograms.size() - 1;
+}
+
+void TreeBuilder::accumulateRows(const uint32_t* rows, size_t count, double* histogram) const {
+    const size_t cols = m_binned.cols;
+    const uint32_t* offsets = m_binned.binOffsets.data();
+    
+    if (m_options.criterion == SplitCriterion::Gini) {
+        const size_t classes = m_stats;
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* codes = m_binned.row(rows[i]);
+            uint32_t target = m_classTargets[rows[i]];
+            for (size_t f = 0; f < cols; ++f) {
+                histogram[(offsets[f] + codes[f]) * classes + target] += 1.0;
+            }
+        }
+        return;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t row = rows[i];
+        const uint8_t* codes = m_binned.row(row);
+        double gradient = m_gradients[row];
+        double hessian = m_hessians ? m_hessians[row] : 1.0;
+        for (size_t f = 0; f < cols; ++f) {
+            double* bin = histogram + (offsets[f] + codes[f]) * 3;
+            bin[0] += 1.0;
+            bin[1] += gradient;
+            bin[2] += hessian;
+        }
+    }
+}
+
+void TreeBuilder::buildHistogram(const uint32_t* rows, size_t count, double* histogram) {
+    const size_t size = histogramSize();
+    std::fill(histogram, histogram + size, 0.0);
+    
+    if (!m_options.parallel || count < 2 * kHistogramBlockRows) {
+        accumulateRows(rows, count, histogram);
+        return;
+    }
+    
+    // 各块统计到自己的直方图，再按块序号合并
+    size_t blocks = std::min(kMaxHistogramBlocks, count / kHistogramBlockRows);
+    if (m_blockHistograms.size() < blocks - 1) {
+        m_blockHistograms.resize(blocks - 1);
+    }
+    Utils::ThreadPool::instance().parallelFor(0, blocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            double* target = histogram;
+            if (b > 0) {
+                m_blockHistograms[b - 1].assign(size, 0.0);
+                target = m_blockHistograms[b - 1].data();
+            }
+            size_t begin = count * b / blocks;
+            size_t end = count * (b + 1) / blocks;
+            accumulateRows(rows + begin, end - begin, target);
+        }
+    });
+    for (size_t b = 1; b < blocks; ++b) {
+        const double* partial = m_blockHistograms[b - 1].data();
+        for (size_t k = 0; k < size; ++k) {
+            histogram[k] += partial[k];
+        }
+    }
+}
+
+double TreeBuilder::score(const double* totals) const {
+    if (m_options.criterion == SplitCriterion::Gini) {
+        double count = 0.0;
+        double squares = 0.0;
+        for (size_t k = 0; k < m_stats; ++k) {
+            count += totals[k];
+            squares += totals[k] * totals[k];
+        }
+        return count > 0.0 ? squares / count : 0.0;
+    }
+    double denominator = totals[2] + m_options.lambda;
+    return denominator > 0.0 ? totals[1] * totals[1] / denominator : 0.0;
+}
+
+bool TreeBuilder::splittable(size_t count, size_t depth) const {
+    return depth < m_options.maxDepth && count >= 2 * m_options.minSamplesLeaf && count >= 2;
+}
+
+TreeBuilder::Split TreeBuilder::findSplit(const double* histogram, const std::vector<double>& totals,
+                                          size_t count, std::mt19937_64& rng) {
+    Split best;
+    
+    // 随机抽取本次分裂考虑的特征（部分Fisher-Yates洗牌）
+    size_t cols = m_binned.cols;
+    size_t featureCount = cols;
+    std::iota(m_features.begin(), m_features.end(), 0);
+    if (m_options.featuresPerSplit > 0 && m_options.featuresPerSplit < cols) {
+        featureCount = m_options.featuresPerSplit;
+        for (size_t i = 0; i < featureCount; ++i) {
+            std::uniform_int_distribution<size_t> pick(i, cols - 1);
+            std::swap(m_features[i], m_features[pick(rng)]);
+        }
+    }
+    
+    const double parentScore = score(totals.data());
+    const double minLeaf = static_cast<double>(std::max<size_t>(1, m_options.minSamplesLeaf));
+    const double total = static_cast<double>(count);
+    std::vector<double> left(m_stats);
+    std::vector<double> right(m_stats);
+    
+    for (size_t i = 0; i < featureCount; ++i) {
+        uint32_t f = m_features[i];
+        size_t bins = m_binned.binCount(f);
+        if (bins < 2) {
+            continue;
+        }
+        
+        const double* featureHistogram = histogram + m_binned.binOffsets[f] * m_stats;
+        std::fill(left.begin(), left.end(), 0.0);
+        double leftCount = 0.0;
+        
+        for (size_t b = 0; b + 1 < bins; ++b) {
+            const double* bin = featureHistogram + b * m_stats;
+            double binCount = 0.0;
+            if (m_options.criterion == SplitCriterion::Gini) {
+                for (size_t k = 0; k < m_stats; ++k) {
+                    left[k] += bin[k];
+                    binCount += bin[k];
+                }
+            } else {
+                left[0] += bin[0];
+                left[1] += bin[1];
+                left[2] += bin[2];
+                binCount = bin[0];
+            }
+            if (binCount == 0.0) {
+                continue;
+            }
+            leftCount += binCount;
+            if (leftCount < minLeaf) {
+                continue;
+            }
+            if (total - leftCount < minLeaf) {
+                break;
+            }
+            
+            for (size_t k = 0; k < m_stats; ++k) {
+                right[k] = totals[k] - left[k];
+            }
+            double gain = score(left.data()) + score(right.data()) - parentScore;
+            if (gain > best.gain) {
+                best.feature = static_cast<int32_t>(f);
+                best.bin = static_cast<uint32_t>(b);
+                best.gain = gain;
+                best.leftTotals = left;
+            }
+        }
+    }
+    
+    if (best.gain <= m_options.minGain) {
+        best.feature = -1;
+    }
+    return best;
+}
+
+void TreeBuilder::writeLeaf(const std::vector<double>& totals, TreeNode& node, std::vector<double>& leafValues) const {
+    node.feature = -1;
+    node.child = static_cast<uint32_t>(leafValues.size());
+    
+    if (m_options.criterion == SplitCriterion::Gini) {
+        double count = std::accumulate(totals.begin(), totals.end(), 0.0);
+        for (size_t k = 0; k < m_stats; ++k) {
+            leafValues.push_back(count > 0.0 ? totals[k] / count : 0.0);
+        }
+        return;
+    }
+    
+    double denominator = totals[2] + m_options.lambda;
+    leafValues.push_back(denominator > 0.0 ? -totals[1] / denominator : 0.0);
+}
+
+void TreeBuilder::grow(std::vector<uint32_t>& rows,
+                       const uint32_t* classTargets,
+                       const double* gradients,
+                       const double* hessians,
+                       std::mt19937_64& rng,
+                       std::vector<TreeNode>& nodes,
+                       std::vector<double>& leafValues,
+                       std::vector<double>& nodeGains) {
+    m_classTargets = classTargets;
+    m_gradients = gradients;
+    m_hessians = hessians;
+    
+    const bool bestFirst = m_options.maxLeaves > 0;
+    std::vector<PendingNode> pending;
+    
+    // 根节点：直方图中任一特征的分箱之和即节点合计
+    PendingNode root;
+    root.node = static_cast<uint32_t>(nodes.size());
+    root.end = rows.size();
+    root.histogram = acquireHistogram();
+    nodes.emplace_back();
+    nodeGains.resize(nodes.size(), 0.0);
+    
+    double* rootHistogram = m_histograms[root.histogram].data();
+    buildHistogram(rows.data(), rows.size(), rootHistogram);
+    root.totals.assign(m_stats, 0.0);
+    if (m_binned.cols > 0) {
+        for (size_t b = 0; b < m_binned.binCount(0); ++b) {
+            for (size_t k = 0; k < m_stats; ++k) {
+                root.totals[k] += rootHistogram[b * m_stats + k];
+            }
+        }
+    }
+    if (splittable(rows.size(), 0)) {
+        root.split = findSplit(rootHistogram, root.totals, rows.size(), rng);
+    }
+    pending.push_back(std::move(root));
+    
+    size_t leaves = 1;
+    while (!pending.empty()) {
+        // 深度优先取栈顶；限制叶子数时取增益最大的待分裂节点
+        size_t pick = pending.size() - 1;
+        if (bestFirst) {
+            for (size_t i = 0; i < pending.size(); ++i) {
+                const Split& candidate = pending[i].split;
+                const Split& current = pending[pick].split;
+                if (candidate.feature >= 0 &&
+                    (current.feature < 0 || candidate.gain > current.gain ||
+                     (candidate.gain == current.gain && pending[i].node < pending[pick].node))) {
+                    pick = i;
+                }
+            }
+        }
+        if (pick != pending.size() - 1) {
+            std::swap(pending[pick], pending.back());
+        }
+        PendingNode current = std::move(pending.back());
+        pending.pop_back();
+        
+        bool canSplit = current.split.feature >= 0 && (m_options.maxLeaves == 0 || leaves < m_options.maxLeaves);
+        if (!canSplit) {
+            writeLeaf(current.totals, nodes[current.node], leafValues);
+            releaseHistogram(current.histogram);
+            continue;
+        }
+        
+        // 按分裂条件原地划分样本
+        const uint32_t feature = static_cast<uint32_t>(current.split.feature);
+        const uint32_t splitBin = current.split.bin;
+        auto middle = std::partition(rows.begin() + current.begin, rows.begin() + current.end,
+            [&](uint32_t row) { return m_binned.row(row)[feature] <= splitBin; });
+        size_t mid = static_cast<size_t>(middle - rows.begin());
+        
+        uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+        nodes[current.node].feature = static_cast<int32_t>(feature);
+        nodes[current.node].threshold = m_binned.edges[feature][splitBin];
+        nodes[current.node].child = leftIndex;
+        nodes.emplace_back();
+        nodes.emplace_back();
+        nodeGains.resize(nodes.size(), 0.0);
+        nodeGains[current.node] = current.split.gain;
+        ++leaves;
+        
+        PendingNode left;
+        left.node = leftIndex;
+        left.begin = current.begin;
+        left.end = mid;
+        left.depth = current.depth + 1;
+        left.totals = std::move(current.split.leftTotals);
+        
+        PendingNode right;
+        right.node = leftIndex + 1;
+        right.begin = mid;
+        right.end = current.end;
+        right.depth = current.depth + 1;
+        right.totals.resize(m_stats);
+        for (size_t k = 0; k < m_stats; ++k) {
+            right.totals[k] = current.totals[k] - left.totals[k];
+        }
+        
+        // 较小的子节点直接统计直方图，较大的子节点用父节点直方图减去较小者
+        bool leftSmaller = left.end - left.begin <= right.end - right.begin;
+        PendingNode& small = leftSmaller ? left : right;
+        PendingNode& large = leftSmaller ? right : left;
+        bool smallNeeds = splittable(small.end - small.begin, small.depth);
+        bool largeNeeds = splittable(large.end - large.begin, large.depth);
+        
+        if (largeNeeds) {
+            small.histogram = acquireHistogram();
+            double* smallHistogram = m_histograms[small.histogram].data();
+            buildHistogram(rows.data() + small.begin, small.end - small.begin, smallHistogram);
+            
+            large.histogram = current.histogram;
+            double* largeHistogram = m_histograms[large.histogram].data();
+            const size_t size = histogramSize();
+            for (size_t k = 0; k < size; ++k) {
+                largeHistogram[k] -= smallHistogram[k];
+            }
+            large.split = findSplit(largeHistogram, large.totals, large.end - large.begin, rng);
+        } else if (smallNeeds) {
+            small.histogram = current.histogram;
+            buildHistogram(rows.data() + small.begin, small.end - small.begin, m_histograms[small.histogram].data());
+        } else {
+            releaseHistogram(current.histogram);
+        }
+        if (smallNeeds) {
+            small.split = findSplit(m_histograms[small.histogram].data(), small.totals, small.end - small.begin, rng);
+        }
+        
+        pending.push_back(std::move(right));
+        pending.push_back(std::move(left));
+    }
+}
+
+/**
+ * @brief 把标签值映射为升序类别下标
+ */
+std::vector<uint32_t> encodeClasses(const std::vector<double>& labels, std::vector<double>& classes) {
+    classes = labels;
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    
+    std::vector<uint32_t> targets(labels.size());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        targets[i] = static_cast<uint32_t>(std::lower_bound(classes.begin(), classes.end(), labels[i]) - classes.begin());
+    }
+    return targets;
+}
+
+/**
+ * @brief 把节点的分裂增益按分裂特征累加到 featureGains
+ */
+void accumulateSplitGains(const TreeNode* nodes, const double* nodeGains, size_t count, std::vector<double>& featureGains) {
+    for (size_t k = 0; k < count; ++k) {
+        if (nodes[k].feature >= 0) {
+            featureGains[nodes[k].feature] += nodeGains[k];
+        }
+    }
+}
+
+/**
+ * @brief 校验扁平树数组的下标
+ * 
+ * 子节点必须位于父节点之后、叶值偏移不越界，保证加载的模型在预测时不会越界或死循环。
+ */
+template <typename Nodes, typename Roots>
+bool validTreeArrays(const Nodes& nodes, const Roots& roots, size_t leafCount, size_t numFeatures, size_t outputs) {
+    for (uint32_t root : roots) {
+        if (root >= nodes.size()) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const TreeNode& node = nodes[i];
+        if (node.feature >= 0) {
+            if (static_cast<size_t>(node.feature) >= numFeatures || node.child <= i ||
+                static_cast<size_t>(node.child) + 1 >= nodes.size()) {
+                return false;
+            }
+        } else if (static_cast<size_t>(node.child) + outputs > leafCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 一批样本在一棵树上同步逐层下降，把叶值累加到 scores
+ * 
+ * 每层对批内所有样本做同样的无分支更新（到达叶子的样本停在原处），
+ * 各样本的节点访问相互独立，内存访问可以重叠，层数固定为树的深度。
+ */
+void addTreeScoresBatched(const TreeNode* nodes, uint32_t root, uint32_t depth, const double* leafValues,
+                          const ConstMatrixView& data, size_t begin, size_t end, double* scores) {
+    uint32_t current[kTraversalBatchRows];
+    for (size_t batchBegin = begin; batchBegin < end; batchBegin += kTraversalBatchRows) {
+        size_t count = std::min(kTraversalBatchRows, end - batchBegin);
+        for (size_t r = 0; r < count; ++r) {
+            current[r] = root;
+        }
+        for (uint32_t level = 0; level < depth; ++level) {
+            for (size_t r = 0; r < count; ++r) {
+                const TreeNode& node = nodes[current[r]];
+                bool internal = node.feature >= 0;
+                double value = data.row(batchBegin + r)[internal ? node.feature : 0];
+                uint32_t next = node.child + (value > node.threshold ? 1 : 0);
+                current[r] = internal ? next : current[r];
+            }
+        }
+        double* out = scores + (batchBegin - begin);
+        for (size_t r = 0; r < count; ++r) {
+            out[r] += leafValues[nodes[current[r]].child];
+        }
+    }
+}
+
+/**
+ * @brief 计算节点区间 [first, end) 内一棵树的深度（子节点总在父节点之后）
+ */
+template <typename Nodes>
+uint32_t treeDepth(const Nodes& nodes, size_t first, size_t end) {
+    std::vector<uint32_t> depths(end - first, 0);
+    uint32_t maxDepth = 0;
+    for (size_t i = first; i < end; ++i) {
+        uint32_t depth = depths[i - first];
+        maxDepth = std::max(maxDepth, depth);
+        if (nodes[i].feature >= 0 && static_cast<size_t>(nodes[i].child) + 1 < end) {
+            depths[nodes[i].child - first] = depth + 1;
+            depths[nodes[i].child + 1 - first] = depth + 1;
+        }
+    }
+    return maxDepth;
+}
+
+/**
+ * @brief 校验每棵树的遍历层数与树的实际深度一致（层数取自文件）
+ */
+template <typename Nodes, typename Indices>
+bool validTreeDepths(const Nodes& nodes, const Indices& roots, const Indices& depths) {
+    if (depths.size() != roots.size()) {
+        return false;
+    }
+    for (size_t t = 0; t < roots.size(); ++t) {
+        size_t end = t + 1 < roots.size() ? roots[t + 1] : nodes.size();
+        if (end <= roots[t] || end > nodes.size()) {
+            return false;
+        }
+        if (treeDepth(nodes, roots[t], end) != depths[t]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 节点区间 [begin, end) 的分裂阈值对应的分箱编码（写入 bins 的同一区间）
+ * 
+ * 分裂阈值就是分箱边界 edges[feature][b]，x <= edges[b] 等价于编码 <= b（NaN 的编码为0，同样走左子节点），
+ * 因此训练样本在分箱编码上遍历与在原始特征上遍历到达同一个叶子，训练中的评估不需要原始特征。
+ */
+void splitBins(const BinnedMatrix& binned, const TreeNode* nodes, size_t begin, size_t end, std::vector<uint8_t>& bins) {
+    bins.resize(std::max(bins.size(), end), 0);
+    for (size_t i = begin; i < end; ++i) {
+        if (nodes[i].feature >= 0) {
+            const std::vector<double>& edges = binned.edges[nodes[i].feature];
+            bins[i] = static_cast<uint8_t>(std::lower_bound(edges.begin(), edges.end(), nodes[i].threshold) - edges.begin());
+        }
+    }
+}
+
+/**
+ * @brief 训练样本（分箱编码）在一棵树上到达的叶子的叶值偏移
+ */
+inline uint32_t binnedLeaf(const TreeNode* nodes, const uint8_t* bins, uint32_t root, const uint8_t* codes) {
+    uint32_t current = root;
+    while (nodes[current].feature >= 0) {
+        current = nodes[current].child + (codes[nodes[current].feature] > bins[current] ? 1 : 0);
+    }
+    return nodes[current].child;
+}
+
+} // namespace
+
+// RandomForestModel 实现
+RandomForestModel::RandomForestModel(ModelType type)
+    : m_modelType(type) {
+    if (m_modelType != ModelType::DecisionTree && m_modelType != ModelType::RandomForestRegression) {
+        m_modelType = ModelType::RandomForest;
+    }
+}
+
+TrainingResult RandomForestModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+TrainingResult RandomForestModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+template <typename Features>
+TrainingResult RandomForestModel::fit(
+    const Features& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    if (trainingData.rows() > std::numeric_limits<uint32_t>::max()) {
+        result.errorMessage = "Too many training samples";
+        return result;
+    }
+    
+    const bool classifier = isClassifier();
+    const bool singleTree = m_modelType == ModelType::DecisionTree;
+    const size_t numSamples = trainingData.rows();
+    const size_t numFeatures = trainingData.cols();
+    
+    size_t numTrees = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "numTrees", singleTree ? 1 : 100)));
+    size_t maxDepth = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "maxDepth", singleTree ? 10 : 16)));
+    size_t minSamplesLeaf = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "minSamplesLeaf", classifier ? 1 : 5)));
+    double maxFeatures = std::min(1.0, std::max(0.0, parameterOr(parameters, "maxFeatures", 0.0)));
+    size_t maxBins = static_cast<size_t>(std::min<double>(kMaxBins, std::max(2.0, parameterOr(parameters, "maxBins", 255))));
+    bool bootstrap = parameterOr(parameters, "bootstrap", singleTree ? 0.0 : 1.0) != 0.0;
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    size_t featuresPerSplit = numFeatures;
+    if (maxFeatures > 0.0) {
+        featuresPerSplit = static_cast<size_t>(std::lround(maxFeatures * numFeatures));
+    } else if (!singleTree) {
+        featuresPerSplit = classifier ? static_cast<size_t>(std::lround(std::sqrt(static_cast<double>(numFeatures))))
+                                      : numFeatures / 3;
+    }
+    featuresPerSplit = std::max<size_t>(1, std::min(featuresPerSplit, numFeatures));
+    
+    // 分类标签编码为类别下标；回归以 -y 为一阶梯度、二阶梯度恒为1，叶值即样本均值
+    std::vector<double> classes;
+    std::vector<uint32_t> targets;
+    std::vector<double> gradients;
+    if (classifier) {
+        targets = encodeClasses(trainingLabels, classes);
+    } else {
+        gradients.resize(numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            gradients[i] = -trainingLabels[i];
+        }
+    }
+    
+    auto& pool = Utils::ThreadPool::instance();
+    BinnedMatrix binned = binFeatures(trainingData, maxBins);
+    
+    GrowthOptions options;
+    options.criterion = classifier ? SplitCriterion::Gini : SplitCriterion::Newton;
+    options.numClasses = classifier ? classes.size() : 1;
+    options.maxDepth = maxDepth;
+    options.minSamplesLeaf = minSamplesLeaf;
+    options.featuresPerSplit = featuresPerSplit == numFeatures ? 0 : featuresPerSplit;
+    // 树少于线程数时在节点内并行统计直方图，否则按树并行
+    options.parallel = numTrees < pool.threadCount();
+    
+    struct GrownTree {
+        std::vector<TreeNode> nodes;
+        std::vector<double> leafValues;
+        std::vector<double> nodeGains;
+    };
+    std::vector<GrownTree> trees(numTrees);
+    
+    // 训练任务的控制对象只在调用线程上可见，各树在工作线程上通过捕获的指针检查和报告
+    TrainingControl* control = TrainingControl::current();
+    std::atomic<size_t> treesGrown(0);
+    
+    pool.parallelFor(0, numTrees, 1, [&](size_t treeBegin, size_t treeEnd) {
+        TreeBuilder builder(binned, options);
+        std::vector<uint32_t> rows(numSamples);
+        for (size_t t = treeBegin; t < treeEnd; ++t) {
+            if (control && control->shouldStop()) {
+                return;
+            }
+            // 每棵树的随机序列只取决于种子和树的序号
+            std::mt19937_64 rng(seed + 0x9E3779B97F4A7C15ULL * (t + 1));
+            if (bootstrap) {
+                std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(numSamples - 1));
+                for (auto& row : rows) {
+                    row = pick(rng);
+                }
+            } else {
+                std::iota(rows.begin(), rows.end(), 0);
+            }
+            builder.grow(rows, targets.data(), gradients.data(), nullptr, rng,
+                         trees[t].nodes, trees[t].leafValues, trees[t].nodeGains);
+            if (control) {
+                control->report(static_cast<double>(++treesGrown) / static_cast<double>(numTrees));
+            }
+        }
+    });
+    if (control && control->checkpoint(1.0, result)) {
+        return result;
+    }
+    
+    // 按树的顺序拼接为一个扁平节点数组，分裂增益也按树的顺序累加
+    std::vector<TreeNode> nodes;
+    std::vector<uint32_t> treeRoots;
+    std::vector<double> leafValues;
+    std::vector<double> splitGains(numFeatures, 0.0);
+    for (const GrownTree& tree : trees) {
+        accumulateSplitGains(tree.nodes.data(), tree.nodeGains.data(), tree.nodes.size(), splitGains);
+        uint32_t nodeOffset = static_cast<uint32_t>(nodes.size());
+        uint32_t leafOffset = static_cast<uint32_t>(leafValues.size());
+        treeRoots.push_back(nodeOffset);
+        for (TreeNode node : tree.nodes) {
+            node.child += node.feature >= 0 ? nodeOffset : leafOffset;
+            nodes.push_back(node);
+        }
+        leafValues.insert(leafValues.end(), tree.leafValues.begin(), tree.leafValues.end());
+    }
+    m_reduced.clear();
+    m_nodes = std::move(nodes);
+    m_treeRoots = std::move(treeRoots);
+    m_leafValues = std::move(leafValues);
+    m_splitGains = std::move(splitGains);
+    m_numFeatures = numFeatures;
+    m_outputs = classifier ? classes.size() : 1;
+    m_classes = std::move(classes);
+    
+    // 评估：在分箱编码上遍历，与在原始特征上预测的结果相同
+    std::vector<uint8_t> bins;
+    splitBins(binned, m_nodes.data(), 0, m_nodes.size(), bins);
+    Matrix outputs(numSamples, m_outputs);
+    double scale = 1.0 / static_cast<double>(m_treeRoots.size());
+    pool.parallelFor(0, numSamples, kPredictBlockRows, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t* codes = binned.row(i);
+            double* out = outputs.row(i);
+            for (uint32_t root : m_treeRoots) {
+                const double* leaf = m_leafValues.data() + binnedLeaf(m_nodes.data(), bins.data(), root, codes);
+                for (size_t k = 0; k < m_outputs; ++k) {
+                    out[k] += leaf[k];
+                }
+            }
+            for (size_t k = 0; k < m_outputs; ++k) {
+                out[k] *= scale;
+            }
+        }
+    });
+    if (classifier) {
+        std::vector<uint32_t> predicted(numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            const double* row = outputs.row(i);
+            predicted[i] = static_cast<uint32_t>(std::max_element(row, row + m_outputs) - row);
+        }
+        fillClassificationMetrics(result, predicted, targets, m_outputs);
+        result.additionalMetrics["classes"] = static_cast<double>(m_outputs);
+    } else {
+        std::vector<double> predictions(outputs.data(), outputs.data() + numSamples);
+        fillRegressionMetrics(result, predictions, trainingLabels);
+    }
+    
+    refreshReducedPrecision();
+    result.success = true;
+    result.additionalMetrics["trees"] = static_cast<double>(m_treeRoots.size());
+    result.additionalMetrics["nodes"] = static_cast<double>(m_nodes.size());
+    return result;
+}
+
+void RandomForestModel::accumulateOutputs(const ConstMatrixView& data, size_t begin, size_t end, double* outputs) const {
+    std::fill(outputs, outputs + (end - begin) * m_outputs, 0.0);
+    
+    // 一批样本依次走完每棵树，树的节点在批内留在缓存中
+    for (uint32_t root : m_treeRoots) {
+        for (size_t i = begin; i < end; ++i) {
+            const double* sample = data.row(i);
+            const TreeNode* node = &m_nodes[root];
+            while (node->feature >= 0) {
+                node = &m_nodes[node->child + (sample[node->feature] > node->threshold ? 1 : 0)];
+            }
+            const double* leaf = m_leafValues.data() + node->child;
+            double* out = outputs + (i - begin) * m_outputs;
+            for (size_t k = 0; k < m_outputs; ++k) {
+                out[k] += leaf[k];
+            }
+        }
+    }
+}
+
+Matrix RandomForestModel::predictOutputs(const ConstMatrixView& data) const {
+    Matrix outputs(data.rows(), m_outputs);
+    double scale = 1.0 / static_cast<double>(m_treeRoots.size());
+    
+    Utils::ThreadPool::instance().parallelFor(0, data.rows(), kPredictBlockRows, [&](size_t begin, size_t end) {
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += kPredictBlockRows) {
+            size_t blockEnd = std::min(end, blockBegin + kPredictBlockRows);
+            double* out = outputs.row(blockBegin);
+            if (m_reduced.empty()) {
+                accumulateOutputs(data, blockBegin, blockEnd, out);
+            } else {
+                std::fill(out, out + (blockEnd - blockBegin) * m_outputs, 0.0);
+                m_reduced.accumulate(data, blockBegin, blockEnd, m_outputs, out);
+            }
+            for (size_t k = 0; k < (blockEnd - blockBegin) * m_outputs; ++k) {
+                out[k] *= scale;
+            }
+        }
+    });
+    
+    return outputs;
+}
+
+std::vector<double> RandomForestModel::predict(const ConstMatrixView& testData) {
+    
+    if (m_treeRoots.empty() || testData.empty() || testData.cols() != m_numFeatures) {
+        return {};
+    }
+    
+    Matrix outputs = predictOutputs(testData);
+    std::vector<double> predictions(testData.rows());
+    for (size_t i = 0; i < testData.rows(); ++i) {
+        const double* row = outputs.row(i);
+        if (isClassifier()) {
+            predictions[i] = m_classes[std::max_element(row, row + m_outputs) - row];
+        } else {
+            predictions[i] = row[0];
+        }
+    }
+    
+    return predictions;
+}
+
+Matrix RandomForestModel::predictProbabilities(const ConstMatrixView& testData) const {
+    
+    if (!isClassifier() || m_treeRoots.empty() || testData.empty() || testData.cols() != m_numFeatures) {
+        return Matrix();
+    }
+    
+    return predictOutputs(testData);
+}
+
+bool RandomForestModel::setInferencePrecision(InferencePrecision precision) {
+    m_precision = precision;
+    refreshReducedPrecision();
+    return true;
+}
+
+void RandomForestModel::refreshReducedPrecision() {
+    m_reduced.clear();
+    if (!m_nodes.empty()) {
+        m_reduced.build(m_nodes.data(), m_nodes.size(), m_treeRoots.data(), m_treeRoots.size(),
+                        m_leafValues.data(), m_leafValues.size(), m_numFeatures, m_precision);
+    }
+}
+
+bool RandomForestModel::saveModel(const std::string& filePath) {
+    try {
+        uint64_t shape[2] = {m_numFeatures, m_outputs};
+        ModelFileWriter writer(m_modelType);
+        writer.addArray(kShapeSection, shape, 2);
+        writer.addArray(kClassesSection, m_classes);
+        writer.addArray(kRootsSection, m_treeRoots.data(), m_treeRoots.size());
+        writer.addArray(kNodesSection, m_nodes.data(), m_nodes.size());
+        writer.addArray(kLeavesSection, m_leafValues.data(), m_leafValues.size());
+        writer.addArray(kGainsSection, m_splitGains);
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool RandomForestModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file) {
+            return false;
+        }
+        
+        ModelType type = file->modelType();
+        bool classifier = type == ModelType::DecisionTree || type == ModelType::RandomForest;
+        if (!classifier && type != ModelType::RandomForestRegression) {
+            return false;
+        }
+        
+        auto shape = file->section<uint64_t>(kShapeSection);
+        auto classes = file->section<double>(kClassesSection);
+        auto roots = file->section<uint32_t>(kRootsSection);
+        auto nodes = file->section<TreeNode>(kNodesSection);
+        auto leaves = file->section<double>(kLeavesSection);
+        if (!shape.valid || shape.count != 2 || !classes.valid || !roots.valid || !nodes.valid || !leaves.valid) {
+            return false;
+        }
+        
+        const uint64_t limit = std::numeric_limits<uint32_t>::max();
+        const uint64_t numFeatures = shape.data[0];
+        const uint64_t outputs = shape.data[1];
+        if (outputs < 1 || roots.count < 1 || numFeatures > limit || outputs > limit ||
+            nodes.count > limit || leaves.count > limit) {
+            return false;
+        }
+        if (classifier ? classes.count != outputs : (outputs != 1 || classes.count != 0)) {
+            return false;
+        }
+        
+        // 树数组直接引用映射的文件内容
+        auto mappedRoots = ModelArray<uint32_t>::mapped(roots, file);
+        auto mappedNodes = ModelArray<TreeNode>::mapped(nodes, file);
+        if (!validTreeArrays(mappedNodes, mappedRoots, leaves.count, numFeatures, outputs)) {
+            return false;
+        }
+        
+        m_modelType = type;
+        m_numFeatures = numFeatures;
+        m_outputs = outputs;
+        m_classes.assign(classes.data, classes.data + classes.count);
+        m_treeRoots = std::move(mappedRoots);
+        m_nodes = std::move(mappedNodes);
+        m_leafValues = ModelArray<double>::mapped(leaves, file);
+        
+        // 增益节是后来加入的：旧文件没有这一节，此时没有分裂增益
+        auto gains = file->section<double>(kGainsSection);
+        if (gains.valid && gains.count == m_numFeatures) {
+            m_splitGains.assign(gains.data, gains.data + gains.count);
+        } else {
+            m_splitGains.clear();
+        }
+        refreshReducedPrecision();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// GradientBoostingModel 实现
+TrainingResult GradientBoostingModel::train(
+    const ConstMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+TrainingResult GradientBoostingModel::train(
+    const SparseMatrixView& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    return fit(trainingData, trainingLabels, parameters);
+}
+
+template <typename Features>
+TrainingResult GradientBoostingModel::fit(
+    const Features& trainingData,
+    const std::vector<double>& trainingLabels,
+    const std::map<std::string, double>& parameters) {
+    
+    TrainingResult result;
+    result.success = false;
+    result.accuracy = 0.0;
+    result.precision = 0.0;
+    result.recall = 0.0;
+    result.f1Score = 0.0;
+    result.meanSquaredError = 0.0;
+    
+    if (trainingData.empty()) {
+        result.errorMessage = "Empty training data";
+        return result;
+    }
+    if (trainingLabels.size() != trainingData.rows()) {
+        result.errorMessage = "Label count does not match sample count";
+        return result;
+    }
+    if (trainingData.rows() > std::numeric_limits<uint32_t>::max()) {
+        result.errorMessage = "Too many training samples";
+        return result;
+    }
+    
+    Objective objective = parameterOr(parameters, "objective", 0.0) == 1.0 ? Objective::Binary : Objective::SquaredError;
+    size_t numRounds = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "numRounds", 100)));
+    double learningRate = parameterOr(parameters, "learningRate", 0.1);
+    size_t maxLeaves = static_cast<size_t>(std::max(2.0, parameterOr(parameters, "maxLeaves", 31)));
+    double maxDepth = std::max(0.0, parameterOr(parameters, "maxDepth", 0.0));
+    size_t minSamplesLeaf = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "minSamplesLeaf", 20)));
+    double lambda = std::max(0.0, parameterOr(parameters, "lambda", 1.0));
+    double subsample = std::min(1.0, std::max(0.0, parameterOr(parameters, "subsample", 1.0)));
+    double featureFraction = std::min(1.0, std::max(0.0, parameterOr(parameters, "featureFraction", 1.0)));
+    size_t maxBins = static_cast<size_t>(std::min<double>(kMaxBins, std::max(2.0, parameterOr(parameters, "maxBins", 255))));
+    double validationFraction = std::min(0.5, std::max(0.0, parameterOr(parameters, "validationFraction", 0.0)));
+    size_t earlyStoppingRounds = static_cast<size_t>(std::max(1.0, parameterOr(parameters, "earlyStoppingRounds", 10)));
+    uint64_t seed = static_cast<uint64_t>(parameterOr(parameters, "seed", 42));
+    
+    if (!(learningRate > 0.0) || !(subsample > 0.0)) {
+        result.errorMessage = "Learning rate and subsample must be positive";
+        return result;
+    }
+    
+    const size_t numSamples = trainingData.rows();
+    const size_t numFeatures = trainingData.cols();
+    auto& pool = Utils::ThreadPool::instance();
+    
+    // 二分类标签映射为 0/1
+    std::vector<double> classes;
+    std::vector<double> targets(trainingLabels);
+    if (objective == Objective::Binary) {
+        std::vector<uint32_t> encoded = encodeClasses(trainingLabels, classes);
+        if (classes.size() != 2) {
+            result.errorMessage = "Binary objective requires exactly two classes";
+            return result;
+        }
+        for (size_t i = 0; i < numSamples; ++i) {
+            targets[i] = static_cast<double>(encoded[i]);
+        }
+    }
+    
+    // 留出验证集（只用于提前停止）
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> isValidation(numSamples, 0);
+    std::vector<uint32_t> trainPool;
+    std::vector<uint32_t> validationRows;
+    if (validationFraction > 0.0) {
+        std::bernoulli_distribution pick(validationFraction);
+        for (size_t i = 0; i < numSamples; ++i) {
+            isValidation[i] = pick(rng) ? 1 : 0;
+        }
+    }
+    for (size_t i = 0; i < numSamples; ++i) {
+        (isValidation[i] ? validationRows : trainPool).push_back(static_cast<uint32_t>(i));
+    }
+    if (trainPool.empty()) {
+        result.errorMessage = "No training samples left after the validation split";
+        return result;
+    }
+    
+    // 初始得分：回归取均值，二分类取正类比例的对数几率
+    double targetMean = 0.0;
+    for (uint32_t row : trainPool) {
+        targetMean += targets[row];
+    }
+    targetMean /= static_cast<double>(trainPool.size());
+    double baseScore = targetMean;
+    if (objective == Objective::Binary) {
+        double rate = std::min(1.0 - 1e-6, std::max(1e-6, targetMean));
+        baseScore = std::log(rate / (1.0 - rate));
+    }
+    
+    BinnedMatrix binned = binFeatures(trainingData, maxBins);
+    
+    GrowthOptions options;
+    options.criterion = SplitCriterion::Newton;
+    options.maxDepth = maxDepth >= 1.0 ? static_cast<size_t>(maxDepth) : std::numeric_limits<size_t>::max();
+    options.maxLeaves = maxLeaves;
+    options.minSamplesLeaf = minSamplesLeaf;
+    options.featuresPerSplit = featureFraction > 0.0 && featureFraction < 1.0 ?
+        std::max<size_t>(1, static_cast<size_t>(std::lround(featureFraction * numFeatures))) : 0;
+    options.lambda = lambda;
+    options.parallel = true;
+    TreeBuilder builder(binned, options);
+    
+    // 集成先在局部构建，全部轮次完成后才替换当前模型；中途取消时原模型保持可用
+    std::vector<TreeNode> nodes;
+    std::vector<uint32_t> treeRoots;
+    std::vector<uint32_t> treeDepths;
+    std::vector<double> leafValues;
+    
+    std::vector<double> scores(numSamples, baseScore);
+    std::vector<double> gradients(numSamples, 0.0);
+    std::vector<double> hessians(numSamples, 1.0);
+    std::vector<uint32_t> rows;
+    std::vector<size_t> leafStarts;
+    std::vector<uint8_t> bins;
+    std::vector<double> nodeGains;
+    
+    // 一组样本的平均损失（回归为均方误差的一半，二分类为对数损失）
+    auto averageLoss = [&](const std::vector<uint32_t>& subset) {
+        double sum = 0.0;
+        for (uint32_t row : subset) {
+            double score = scores[row];
+            if (objective == Objective::Binary) {
+                sum += std::max(score, 0.0) - score * targets[row] + std::log1p(std::exp(-std::abs(score)));
+            } else {
+                double error = score - targets[row];
+                sum += 0.5 * error * error;
+            }
+        }
+        return subset.empty() ? 0.0 : sum / static_cast<double>(subset.size());
+    };
+    
+    double bestLoss = std::numeric_limits<double>::max();
+    size_t bestRounds = 0;
+    size_t roundsRun = 0;
+    TrainingControl* control = TrainingControl::current();
+    
+    for (size_t round = 0; round < numRounds; ++round) {
+        // 当前得分处的一阶和二阶梯度
+        pool.parallelFor(0, numSamples, kHistogramBlockRows, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (objective == Objective::Binary) {
+                    double probability = 1.0 / (1.0 + std::exp(-scores[i]));
+                    gradients[i] = probability - targets[i];
+                    hessians[i] = std::max(probability * (1.0 - probability), 1e-16);
+                } else {
+                    gradients[i] = scores[i] - targets[i];
+                }
+            }
+        });
+        
+        // 行采样按原顺序保留，统计直方图时对分箱编码顺序访问
+        if (subsample < 1.0) {
+            std::bernoulli_distribution keep(subsample);
+            rows.clear();
+            for (uint32_t row : trainPool) {
+                if (keep(rng)) {
+                    rows.push_back(row);
+                }
+            }
+            if (rows.empty()) {
+                rows.push_back(trainPool[rng() % trainPool.size()]);
+            }
+        } else {
+            rows = trainPool;
+        }
+        
+        size_t nodeStart = nodes.size();
+        size_t leafStart = leafValues.size();
+        builder.grow(rows, nullptr, gradients.data(),
+                     objective == Objective::Binary ? hessians.data() : nullptr,
+                     rng, nodes, leafValues, nodeGains);
+        for (size_t k = leafStart; k < leafValues.size(); ++k) {
+            leafValues[k] *= learningRate;
+        }
+        treeRoots.push_back(static_cast<uint32_t>(nodeStart));
+        treeDepths.push_back(treeDepth(nodes, nodeStart, nodes.size()));
+        leafStarts.push_back(leafStart);
+        ++roundsRun;
+        
+        // 所有样本（含验证集）在分箱编码上加上新树的输出
+        splitBins(binned, nodes.data(), nodeStart, nodes.size(), bins);
+        pool.parallelFor(0, numSamples, kHistogramBlockRows, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                scores[i] += leafValues[binnedLeaf(nodes.data(), bins.data(), treeRoots.back(), binned.row(i))];
+            }
+        });
+        
+        double loss = validationRows.empty() ? 0.0 : averageLoss(validationRows);
+        if (control && control->checkpoint(static_cast<double>(roundsRun) / static_cast<double>(numRounds), result,
+                                           validationRows.empty() ? std::map<std::string, double>()
+                                                                  : std::map<std::string, double>{{"validationLoss", loss}})) {
+            return result;
+        }
+        if (!validationRows.empty()) {
+            if (loss < bestLoss) {
+                bestLoss = loss;
+                bestRounds = roundsRun;
+            } else if (roundsRun - bestRounds >= earlyStoppingRounds) {
+                break;
+            }
+        }
+    }
+    
+    // 提前停止时截掉验证损失最低之后的树
+    if (!validationRows.empty() && bestRounds < treeRoots.size()) {
+        nodes.resize(treeRoots[bestRounds]);
+        nodeGains.resize(treeRoots[bestRounds]);
+        leafValues.resize(leafStarts[bestRounds]);
+        treeRoots.resize(bestRounds);
+        treeDepths.resize(bestRounds);
+    }
+    std::vector<double> splitGains(numFeatures, 0.0);
+    accumulateSplitGains(nodes.data(), nodeGains.data(), nodes.size(), splitGains);
+    
+    // 评估（使用全部样本，在分箱编码上遍历）
+    std::vector<double> raw(numSamples, baseScore);
+    pool.parallelFor(0, numSamples, kHistogramBlockRows, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (uint32_t root : treeRoots) {
+                raw[i] += leafValues[binnedLeaf(nodes.data(), bins.data(), root, binned.row(i))];
+            }
+        }
+    });
+    if (objective == Objective::Binary) {
+        std::vector<uint32_t> predicted(numSamples);
+        std::vector<uint32_t> actual(numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            predicted[i] = raw[i] > 0.0 ? 1 : 0;
+            actual[i] = static_cast<uint32_t>(targets[i]);
+        }
+        fillClassificationMetrics(result, predicted, actual, 2);
+    } else {
+        fillRegressionMetrics(result, raw, trainingLabels);
+    }
+    
+    m_reduced.clear();
+    m_objective = objective;
+    m_numFeatures = numFeatures;
+    m_baseScore = baseScore;
+    m_classes = std::move(classes);
+    m_nodes = std::move(nodes);
+    m_treeRoots = std::move(treeRoots);
+    m_treeDepths = std::move(treeDepths);
+    m_leafValues = std::move(leafValues);
+    m_splitGains = std::move(splitGains);
+    
+    refreshReducedPrecision();
+    result.success = true;
+    result.additionalMetrics["rounds"] = static_cast<double>(m_treeRoots.size());
+    result.additionalMetrics["nodes"] = static_cast<double>(m_nodes.size());
+    result.additionalMetrics["learningRate"] = learningRate;
+    if (!validationRows.empty()) {
+        result.additionalMetrics["validationLoss"] = bestLoss;
+    }
+    return result;
+}
+
+void GradientBoostingModel::addTreeScores(size_t tree, const ConstMatrixView& data, size_t begin, size_t end, double* scores) const {
+    addTreeScoresBatched(m_nodes.data(), m_treeRoots[tree], m_treeDepths[tree], m_leafValues.data(),
+                         data, begin, end, scores);
+}
+
+std::vector<double> GradientBoostingModel::predictRaw(const ConstMatrixView& testData) const {
+    
+    if (m_treeRoots.empty() && m_nodes.empty() && m_numFeatures == 0) {
+        return {};
+    }
+    if (testData.empty() || testData.cols() != m_numFeatures) {
+        return {};
+    }
+    
+    std::vector<double> scores(testData.rows(), m_baseScore);
+    Utils::ThreadPool::instance().parallelFor(0, testData.rows(), kPredictBlockRows, [&](size_t begin, size_t end) {
+        // 一批样本依次走完所有树，树的节点在批内保持在缓存中
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += kPredictBlockRows) {
+            size_t blockEnd = std::min(end, blockBegin + kPredictBlockRows);
+            if (!m_reduced.empty()) {
+                m_reduced.accumulate(testData, blockBegin, blockEnd, 1, scores.data() + blockBegin);
+                continue;
+            }
+            for (size_t tree = 0; tree < m_treeRoots.size(); ++tree) {
+                addTreeScores(tree, testData, blockBegin, blockEnd, scores.data() + blockBegin);
+            }
+        }
+    });
+    
+    return scores;
+}
+
+std::vector<double> GradientBoostingModel::predict(const ConstMatrixView& testData) {
+    
+    std::vector<double> predictions = predictRaw(testData);
+    if (isClassifier()) {
+        for (double& value : predictions) {
+            value = m_classes[value > 0.0 ? 1 : 0];
+        }
+    }
+    return predictions;
+}
+
+bool GradientBoostingModel::setInferencePrecision(InferencePrecision precision) {
+    m_precision = precision;
+    refreshReducedPrecision();
+    return true;
+}
+
+void GradientBoostingModel::refreshReducedPrecision() {
+    m_reduced.clear();
+    if (!m_nodes.empty()) {
+        m_reduced.build(m_nodes.data(), m_nodes.size(), m_treeRoots.data(), m_treeRoots.size(),
+                        m_leafValues.data(), m_leafValues.size(), m_numFeatures, m_precision);
+    }
+}
+
+bool GradientBoostingModel::saveModel(const std::string& filePath) {
+    try {
+        uint64_t shape[2] = {m_numFeatures, static_cast<uint64_t>(m_objective)};
+        ModelFileWriter writer(ModelType::GradientBoosting);
+        writer.addArray(kShapeSection, shape, 2);
+        writer.addArray(kBaseScoreSection, &m_baseScore, 1);
+        writer.addArray(kClassesSection, m_classes);
+        writer.addArray(kRootsSection, m_treeRoots.data(), m_treeRoots.size());
+        writer.addArray(kDepthsSection, m_treeDepths.data(), m_treeDepths.size());
+        writer.addArray(kNodesSection, m_nodes.data(), m_nodes.size());
+        writer.addArray(kLeavesSection, m_leafValues.data(), m_leafValues.size());
+        writer.addArray(kGainsSection, m_splitGains);
+        return writer.write(filePath);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool GradientBoostingModel::loadModel(const std::string& filePath) {
+    try {
+        std::shared_ptr<const MappedModelFile> file = MappedModelFile::open(filePath);
+        if (!file || file->modelType() != ModelType::GradientBoosting) {
+            return false;
+        }
+        
+        auto shape = file->section<uint64_t>(kShapeSection);
+        auto baseScore = file->section<double>(kBaseScoreSection);
+        auto classes = file->section<double>(kClassesSection);
+        auto roots = file->section<uint32_t>(kRootsSection);
+        auto depths = file->section<uint32_t>(kDepthsSection);
+        auto nodes = file->section<TreeNode>(kNodesSection);
+        auto leaves = file->section<double>(kLeavesSection);
+        if (!shape.valid || shape.count != 2 || !baseScore.valid || baseScore.count != 1 || !classes.valid ||
+            !roots.valid || !depths.valid || !nodes.valid || !leaves.valid || shape.data[1] > 1) {
+            return false;
+        }
+        
+        Objective objective = static_cast<Objective>(shape.data[1]);
+        const uint64_t limit = std::numeric_limits<uint32_t>::max();
+        if (shape.data[0] > limit || roots.count > limit || nodes.count > limit || leaves.count > limit ||
+            classes.count != (objective == Objective::Binary ? 2u : 0u)) {
+            return false;
+        }
+        
+        auto mappedRoots = ModelArray<uint32_t>::mapped(roots, file);
+        auto mappedDepths = ModelArray<uint32_t>::mapped(depths, file);
+        auto mappedNodes = ModelArray<TreeNode>::mapped(nodes, file);
+        if (!validTreeArrays(mappedNodes, mappedRoots, leaves.count, shape.data[0], 1) ||
+            !validTreeDepths(mappedNodes, mappedRoots, mappedDepths)) {
+            return false;
+        }
+        
+        m_objective = objective;
+        m_numFeatures = shape.data[0];
+        m_baseScore = baseScore.data[0];
+        m_classes.assign(classes.data, classes.data + classes.count);
+        m_treeRoots = std::move(mappedRoots);
+        m_treeDepths = std::move(mappedDepths);
+        m_nodes = std::move(mappedNodes);
+        m_leafValues = ModelArray<double>::mapped(leaves, file);
+        
+        // 增益节是后来加入的：旧文件没有这一节，此时没有分裂增益
+        auto gains = file->section<double>(kGainsSection);
+        if (gains.valid && gains.count == m_numFeatures) {
+            m_splitGains.assign(gains.data, gains.data + gains.count);
+        } else {
+            m_splitGains.clear();
+        }
+        refreshReducedPrecision();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "MLModels.h"
+#include "ModelFile.h"
+#include "ReducedPrecision.h"
+
+namespace BondForge {
+namespace Core {
+namespace ML {
+
+/**
+ * @brief 扁平化的决策树节点
+ * 
+ * 一个模型的所有树的节点连续存放在同一个数组中；内部节点的两个子节点相邻存放
+ * （右子节点下标为 child + 1），预测时每层只做一次比较和一次下标计算。
+ */
+struct TreeNode {
+    double threshold = 0.0;     // x[feature] <= threshold（或为NaN）时走左子节点
+    int32_t feature = -1;       // 分裂特征，叶子为-1
+    uint32_t child = 0;         // 内部节点：左子节点下标；叶子：叶值在叶值数组中的偏移
+};
+
+/**
+ * @brief 基于直方图的决策树/随机森林（不依赖mlpack）
+ * 
+ * 训练前把每个特征按分位数离散化为至多255个分箱，之后只在单字节的分箱编码上寻找分裂点：
+ * 节点的直方图由较小的子节点直接统计、较大的子节点用父节点直方图相减得到；
+ * 单棵树时大节点的直方图按固定行块在线程池上并行统计，森林则按树并行生长。
+ * 分类使用Gini增益、叶子保存类别概率，回归使用方差下降、叶子保存均值。
+ * 
+ * 同一个类按构造时的模型类型提供三种默认配置：
+ * - DecisionTree：单棵分类树，不做自助采样，使用全部特征
+ * - RandomForest：分类森林，每次分裂随机选取 sqrt(特征数) 个特征
+ * - RandomForestRegression：回归森林，每次分裂随机选取 1/3 的特征
+ * 
+ * 训练参数（未给出时使用上述默认配置）：
+ * - numTrees：树的数量（森林默认100）
+ * - maxDepth：最大深度（单棵树默认10，森林默认16）
+ * - minSamplesLeaf：叶子的最少样本数（分类默认1，回归默认5）
+ * - maxFeatures：每次分裂考虑的特征比例（0表示使用默认值）
+ * - maxBins：每个特征的最大分箱数（默认255）
+ * - bootstrap：是否自助采样（森林默认1）
+ * - seed：随机种子（默认42）
+ * 
+ * 从模型文件加载时，节点、树根和叶值数组直接引用映射的文件内容，不复制。
+ * 
+ * 稀疏特征（CSR或位矩阵）上训练时直接由非零元素得到分箱编码，隐含的0只在分位数中计数，
+ * 不展开为稠密的双精度矩阵；训练数据上的评估在分箱编码上遍历树（分裂阈值就是分箱边界）。
+ * 
+ * 低精度预测（setInferencePrecision）使用单独的低精度节点副本，见 ReducedTreeEnsemble。
+ */
+class RandomForestModel : public IMLModel {
+public:
+    explicit RandomForestModel(ModelType type = ModelType::RandomForest);
+    
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsSparseFeatures() const override { return true; }
+    
+    TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测（分类返回类别标签值，回归返回预测值）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 预测各类别的概率（仅分类）
+     * 
+     * @param testData 测试数据
+     * @return 样本数×类别数的概率矩阵（列顺序同 classes()），回归模型返回空矩阵
+     */
+    Matrix predictProbabilities(const ConstMatrixView& testData) const;
+    
+    ModelType getModelType() const override { return m_modelType; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 支持 Float32 和 Int8（分裂阈值编码为8位序号，叶值为单精度）
+     */
+    bool setInferencePrecision(InferencePrecision precision) override;
+    InferencePrecision inferencePrecision() const override { return m_precision; }
+    
+    bool isClassifier() const { return m_modelType != ModelType::RandomForestRegression; }
+    size_t treeCount() const { return m_treeRoots.size(); }
+    size_t nodeCount() const { return m_nodes.size(); }
+    
+    /**
+     * @brief 训练时出现的类别标签值（升序，仅分类）
+     */
+    const std::vector<double>& classes() const { return m_classes; }
+    
+    /**
+     * @brief 每个特征的分裂增益之和（所有树上以该特征分裂的节点）
+     * 
+     * 分类为按样本数加权的Gini下降，回归为平方误差的下降；训练时精确累加，随模型文件保存，
+     * 从不含增益的旧模型文件加载时为空。
+     */
+    const std::vector<double>& splitGains() const { return m_splitGains; }
+
+private:
+    template <typename Features>
+    TrainingResult fit(const Features& data, const std::vector<double>& labels,
+                       const std::map<std::string, double>& parameters);
+    
+    void accumulateOutputs(const ConstMatrixView& data, size_t begin, size_t end, double* outputs) const;
+    Matrix predictOutputs(const ConstMatrixView& data) const;
+    void refreshReducedPrecision();
+    
+    ModelType m_modelType;
+    size_t m_numFeatures = 0;
+    size_t m_outputs = 1;               // 每个叶子的输出数（分类为类别数）
+    std::vector<double> m_classes;
+    ModelArray<TreeNode> m_nodes;       // 所有树的节点
+    ModelArray<uint32_t> m_treeRoots;   // 每棵树根节点的下标
+    ModelArray<double> m_leafValues;    // 所有叶子的输出
+    std::vector<double> m_splitGains;   // 每个特征的分裂增益之和
+    
+    InferencePrecision m_precision = InferencePrecision::Double;
+    ReducedTreeEnsemble m_reduced;      // 低精度的节点和叶值（双精度时为空）
+};
+
+/**
+ * @brief 梯度提升决策树（GBDT，不依赖mlpack）
+ * 
+ * 与随机森林共用直方图建树：每轮用当前预测的一阶/二阶梯度统计直方图，
+ * 按分裂增益最大优先（叶子优先）生长一棵限定叶子数的树，叶值为带L2正则的牛顿步，
+ * 乘以收缩系数后累加到预测中。根节点等大节点的直方图在线程池上按固定行块并行统计。
+ * 预测时一批样本在每棵树上同步逐层下降（无分支的交错遍历），所有树共用扁平节点数组。
+ * 
+ * 训练参数：
+ * - objective：0 为平方误差回归（默认），1 为二分类对数损失
+ * - numRounds：提升轮数（默认100）
+ * - learningRate：收缩系数（默认0.1）
+ * - maxLeaves：每棵树的最大叶子数（默认31）
+ * - maxDepth：最大深度（默认0，不限制）
+ * - minSamplesLeaf：叶子的最少样本数（默认20）
+ * - lambda：叶值的L2正则（默认1）
+ * - subsample：每轮随机使用的样本比例（默认1）
+ * - featureFraction：每次分裂随机考虑的特征比例（默认1）
+ * - maxBins：每个特征的最大分箱数（默认255）
+ * - validationFraction：提前停止使用的验证集比例（默认0，不提前停止）
+ * - earlyStoppingRounds：验证损失连续多少轮没有下降即停止（默认10）
+ * - seed：随机种子（默认42）
+ * 
+ * 与随机森林相同，从模型文件加载时树数组直接引用映射的文件内容，也同样支持低精度预测和稀疏特征上的训练；
+ * 每轮新树的输出在训练样本的分箱编码上累加。
+ */
+class GradientBoostingModel : public IMLModel {
+public:
+    using IMLModel::train;
+    using IMLModel::predict;
+    
+    TrainingResult train(
+        const ConstMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    bool supportsSparseFeatures() const override { return true; }
+    
+    TrainingResult train(
+        const SparseMatrixView& trainingData,
+        const std::vector<double>& trainingLabels,
+        const std::map<std::string, double>& parameters = {}) override;
+    
+    /**
+     * @brief 预测（回归返回预测值，二分类返回类别标签值）
+     */
+    std::vector<double> predict(const ConstMatrixView& testData) override;
+    
+    /**
+     * @brief 原始得分（回归为预测值，二分类为正类的对数几率）
+     */
+    std::vector<double> predictRaw(const ConstMatrixView& testData) const;
+    
+    ModelType getModelType() const override { return ModelType::GradientBoosting; }
+    bool supportsConcurrentPrediction() const override { return true; }
+    
+    bool saveModel(const std::string& filePath) override;
+    bool loadModel(const std::string& filePath) override;
+    
+    /**
+     * @brief 支持 Float32 和 Int8（分裂阈值编码为8位序号，叶值为单精度）
+     */
+    bool setInferencePrecision(InferencePrecision precision) override;
+    InferencePrecision inferencePrecision() const override { return m_precision; }
+    
+    bool isClassifier() const { return m_objective == Objective::Binary; }
+    size_t treeCount() const { return m_treeRoots.size(); }
+    
+    /**
+     * @brief 每个特征的分裂增益之和（牛顿步增益 G²/(H+λ) 的增加量，只计入提前停止后保留的树）
+     * 
+     * 与随机森林相同，从不含增益的旧模型文件加载时为空。
+     */
+    const std::vector<double>& splitGains() const { return m_splitGains; }
+
+private:
+    enum class Objective : uint32_t {
+        SquaredError = 0,
+        Binary = 1
+    };
+    
+    template <typename Features>
+    TrainingResult fit(const Features& data, const std::vector<double>& labels,
+                       const std::map<std::string, double>& parameters);
+    
+    void addTreeScores(size_t tree, const ConstMatrixView& data, size_t begin, size_t end, double* scores) const;
+    void refreshReducedPrecision();
+    
+    Objective m_objective = Objective::SquaredError;
+    size_t m_numFeatures = 0;
+    double m_baseScore = 0.0;
+    std::vector<double> m_classes;      // 二分类的两个标签值
+    ModelArray<TreeNode> m_nodes;
+    ModelArray<uint32_t> m_treeRoots;
+    ModelArray<uint32_t> m_treeDepths;  // 每棵树的深度（批量遍历的层数）
+    ModelArray<double> m_leafValues;    // 已乘收缩系数的叶值
+    std::vector<double> m_splitGains;
+    
+    InferencePrecision m_precision = InferencePrecision::Double;
+    ReducedTreeEnsemble m_reduced;
+};
+
+} // namespace ML
+} // namespace Core
+} // namespace BondForge
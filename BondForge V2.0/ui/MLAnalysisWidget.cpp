@@ -1,7 +1,10 @@
 #include "MLAnalysisWidget.h"
 #include "core/ml/MLModels.h"
 #include "core/ml/StatisticalAnalysis.h"
+#include "core/ml/TrainingJobs.h"
+#include "core/ml/FeatureImportance.h"
 #include "utils/Logger.h"
+#include "utils/ConfigManager.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSplitter>
@@ -46,6 +49,16 @@ MLAnalysisWidget::MLAnalysisWidget(QWidget *parent)
 
 MLAnalysisWidget::~MLAnalysisWidget()
 {
+    // 训练任务的回调引用本对象：先取消并等待任务结束
+    if (m_trainingJobId != 0) {
+        Core::ML::TrainingJobManager::instance().cancel(m_trainingJobId);
+        Core::ML::TrainingJobManager::instance().wait(m_trainingJobId);
+    }
+    if (m_importanceJobId != 0) {
+        Core::ML::TrainingJobManager::instance().cancel(m_importanceJobId);
+        Core::ML::TrainingJobManager::instance().wait(m_importanceJobId);
+    }
+    
     // 不需要手动删除m_currentModel，由MLModelManager管理
 }
 
@@ -500,6 +513,11 @@ void MLAnalysisWidget::setupTrainingHistoryTab()
     m_trainingStatusLabel = new QLabel(tr("Ready to train"), this);
     trainingProgressLayout->addWidget(m_trainingStatusLabel);
     
+    m_cancelTrainingButton = new QPushButton(tr("Cancel Training"), this);
+    m_cancelTrainingButton->setEnabled(false);
+    connect(m_cancelTrainingButton, &QPushButton::clicked, this, &MLAnalysisWidget::cancelTraining);
+    trainingProgressLayout->addWidget(m_cancelTrainingButton);
+    
     layout->addWidget(trainingProgressGroup);
     
     // 训练日志
@@ -541,6 +559,39 @@ void MLAnalysisWidget::setupModelEvaluationTab()
     
     layout->addWidget(m_confusionMatrixGroup);
     
+    // 特征重要性
+    QGroupBox* importanceGroup = new QGroupBox(tr("Feature Importance"), this);
+    QVBoxLayout* importanceLayout = new QVBoxLayout(importanceGroup);
+    
+    QHBoxLayout* importanceControlsLayout = new QHBoxLayout();
+    m_importanceMethodCombo = new QComboBox(this);
+    m_importanceMethodCombo->addItem(tr("Permutation"), static_cast<int>(Core::ML::ImportanceMethod::Permutation));
+    m_importanceMethodCombo->addItem(tr("Split gain (tree models)"), static_cast<int>(Core::ML::ImportanceMethod::SplitGain));
+    importanceControlsLayout->addWidget(m_importanceMethodCombo);
+    
+    m_importanceRepeatsSpin = new QSpinBox(this);
+    m_importanceRepeatsSpin->setRange(1, 100);
+    m_importanceRepeatsSpin->setValue(5);
+    m_importanceRepeatsSpin->setPrefix(tr("Repeats: "));
+    importanceControlsLayout->addWidget(m_importanceRepeatsSpin);
+    
+    m_importanceButton = new QPushButton(tr("Compute Importance"), this);
+    m_importanceButton->setEnabled(false);
+    connect(m_importanceButton, &QPushButton::clicked, this, &MLAnalysisWidget::computeFeatureImportance);
+    importanceControlsLayout->addWidget(m_importanceButton);
+    importanceLayout->addLayout(importanceControlsLayout);
+    
+    m_importanceTable = new QTableWidget(this);
+    m_importanceTable->setColumnCount(4);
+    m_importanceTable->setHorizontalHeaderLabels({tr("Feature"), tr("Importance"), tr("Std"), tr("Seconds")});
+    m_importanceTable->horizontalHeader()->setStretchLastSection(true);
+    importanceLayout->addWidget(m_importanceTable);
+    
+    m_importanceTimingLabel = new QLabel(this);
+    importanceLayout->addWidget(m_importanceTimingLabel);
+    
+    layout->addWidget(importanceGroup);
+    
     m_resultsTabWidget->addTab(modelEvaluationTab, tr("Model Evaluation"));
 }
 
@@ -657,6 +708,11 @@ void MLAnalysisWidget::trainModel()
         return;
     }
     
+    if (m_trainingJobId != 0) {
+        QMessageBox::information(this, tr("Information"), tr("A training job is already running"));
+        return;
+    }
+    
     // 获取选定的模型
     QString modelType = m_modelSelectionCombo->currentData().toString();
     if (modelType.isEmpty()) {
@@ -699,36 +755,168 @@ void MLAnalysisWidget::trainModel()
         }
     }
     
-    // 训练模型
-    Core::ML::DataProcessor::TrainingResult result = m_dataProcessor->trainModel(
-        modelType, modelParams, trainingParams, selectedFeatures);
+    // 在训练任务线程上训练，界面线程保持响应；训练时限取配置项 ml.max_training_time
+    Utils::ConfigManager config;
+    Core::ML::TrainingJobRequest request;
+    request.name = modelType.toStdString();
+    request.description = tr("Trained from the ML analysis panel").toStdString();
+    request.timeLimitSeconds = config.getInt("ml.max_training_time", 3600);
+    
+    auto outcome = std::make_shared<Core::ML::DataProcessor::TrainingResult>();
+    Core::ML::DataProcessor* processor = m_dataProcessor;
+    Core::ML::TrainingJobBody body = [processor, outcome, modelType, modelParams, trainingParams, selectedFeatures](
+        Core::ML::TrainingControl&, std::shared_ptr<Core::ML::IMLModel>&) {
+        *outcome = processor->trainModel(modelType, modelParams, trainingParams, selectedFeatures);
+        Core::ML::TrainingResult result{};
+        result.success = outcome->success;
+        result.errorMessage = outcome->errorMessage.toStdString();
+        return result;
+    };
+    
+    // 结束回调在训练线程上调用，切换到界面线程处理结果
+    request.onFinished = [this, outcome, modelType](const Core::ML::TrainingJobInfo& info,
+                                                    const Core::ML::TrainingResult&,
+                                                    std::shared_ptr<Core::ML::IMLModel>) {
+        QMetaObject::invokeMethod(this, [this, outcome, modelType, info]() {
+            const Core::ML::DataProcessor::TrainingResult& result = *outcome;
+            m_trainingJobId = 0;
+            m_cancelTrainingButton->setEnabled(false);
+            
+            if (info.status == Core::ML::TrainingJobStatus::Completed) {
+                m_currentModel = result.model;
+                m_trainingProgressBar->setValue(100);
+                m_trainingStatusLabel->setText(tr("Training completed successfully"));
+                m_trainingLogText->append(tr("Training completed in %1 seconds").arg(result.trainingTime));
+                m_trainingLogText->append(tr("Best parameters: %1").arg(result.bestParams.toString()));
+                
+                // 更新模型信息
+                m_modelInfoLabel->setText(tr("Model: %1, Accuracy: %2").arg(modelType).arg(result.metrics.value("accuracy", 0).toDouble(), 0, 'f', 4));
+                
+                // 更新评估结果
+                updateEvaluationResults(result.metrics);
+                
+                // 树模型的分裂增益不需要预测，训练完成后直接显示；置换重要性由用户另行计算
+                if (m_currentModel) {
+                    Core::ML::ImportanceReport gains = Core::ML::FeatureImportance::splitGain(*m_currentModel);
+                    if (gains.success) {
+                        updateFeatureImportance(gains);
+                    }
+                }
+                m_importanceButton->setEnabled(true);
+                
+                // 切换到评估结果选项卡
+                m_resultsTabWidget->setCurrentIndex(1);
+                
+                // 启用预测按钮
+                m_predictButton->setEnabled(true);
+            } else if (info.status == Core::ML::TrainingJobStatus::Cancelled) {
+                m_trainingStatusLabel->setText(tr("Training cancelled"));
+                m_trainingLogText->append(tr("Training cancelled"));
+            } else if (info.status == Core::ML::TrainingJobStatus::TimedOut) {
+                m_trainingStatusLabel->setText(tr("Training stopped"));
+                m_trainingLogText->append(tr("Training exceeded the time limit of %1 seconds").arg(info.timeLimitSeconds));
+            } else {
+                QString message = QString::fromStdString(info.errorLog);
+                m_trainingStatusLabel->setText(tr("Training failed"));
+                m_trainingLogText->append(tr("Training failed: %1").arg(message));
+                QMessageBox::critical(this, tr("Error"), tr("Training failed: %1").arg(message));
+            }
+            
+            // 断开连接
+            disconnect(m_dataProcessor, nullptr, this, nullptr);
+        }, Qt::QueuedConnection);
+    };
     
-    if (result.success) {
-        m_currentModel = result.model;
-        m_trainingProgressBar->setValue(100);
-        m_trainingStatusLabel->setText(tr("Training completed successfully"));
-        m_trainingLogText->append(tr("Training completed in %1 seconds").arg(result.trainingTime));
-        m_trainingLogText->append(tr("Best parameters: %1").arg(result.bestParams.toString()));
-        
-        // 更新模型信息
-        m_modelInfoLabel->setText(tr("Model: %1, Accuracy: %2").arg(modelType).arg(result.metrics.value("accuracy", 0).toDouble(), 0, 'f', 4));
-        
-        // 更新评估结果
-        updateEvaluationResults(result.metrics);
-        
-        // 切换到评估结果选项卡
-        m_resultsTabWidget->setCurrentIndex(1);
-        
-        // 启用预测按钮
-        m_predictButton->setEnabled(true);
-    } else {
-        m_trainingStatusLabel->setText(tr("Training failed"));
-        m_trainingLogText->append(tr("Training failed: %1").arg(result.errorMessage));
-        QMessageBox::critical(this, tr("Error"), tr("Training failed: %1").arg(result.errorMessage));
+    m_trainingJobId = Core::ML::TrainingJobManager::instance().submit(std::move(request), std::move(body));
+    m_cancelTrainingButton->setEnabled(true);
+}
+
+void MLAnalysisWidget::cancelTraining()
+{
+    if (m_trainingJobId == 0) {
+        return;
+    }
+    
+    Core::ML::TrainingJobManager::instance().cancel(m_trainingJobId);
+    m_cancelTrainingButton->setEnabled(false);
+    m_trainingStatusLabel->setText(tr("Cancelling training..."));
+}
+
+void MLAnalysisWidget::setHeldOutData(Core::ML::Matrix features, std::vector<double> labels)
+{
+    m_testFeatures = std::make_shared<const Core::ML::Matrix>(std::move(features));
+    m_testLabels = std::make_shared<const std::vector<double>>(std::move(labels));
+}
+
+void MLAnalysisWidget::computeFeatureImportance()
+{
+    if (!m_currentModel) {
+        QMessageBox::information(this, tr("Information"), tr("No trained model available"));
+        return;
     }
     
-    // 断开连接
-    disconnect(m_dataProcessor, nullptr, this, nullptr);
+    if (m_importanceJobId != 0) {
+        QMessageBox::information(this, tr("Information"), tr("Feature importance is already being computed"));
+        return;
+    }
+    
+    Core::ML::ImportanceMethod method = static_cast<Core::ML::ImportanceMethod>(m_importanceMethodCombo->currentData().toInt());
+    if (method == Core::ML::ImportanceMethod::Permutation && (!m_testFeatures || !m_testLabels || m_testFeatures->empty())) {
+        QMessageBox::information(this, tr("Information"), tr("No held-out test data available"));
+        return;
+    }
+    
+    Core::ML::ImportanceOptions options;
+    options.repeats = static_cast<size_t>(m_importanceRepeatsSpin->value());
+    options.seed = static_cast<uint64_t>(m_randomSeedSpin->value());
+    
+    // 置换重要性要在留出的测试集上重复预测，与训练一样作为后台任务执行，可以取消
+    Core::ML::TrainingJobRequest request;
+    request.name = "feature-importance";
+    request.description = tr("Feature importance from the ML analysis panel").toStdString();
+    request.timeLimitSeconds = 0.0;
+    
+    auto report = std::make_shared<Core::ML::ImportanceReport>();
+    std::shared_ptr<Core::ML::IMLModel> model = m_currentModel;
+    std::shared_ptr<const Core::ML::Matrix> features = m_testFeatures;
+    std::shared_ptr<const std::vector<double>> labels = m_testLabels;
+    Core::ML::TrainingJobBody body = [report, model, features, labels, method, options](
+        Core::ML::TrainingControl&, std::shared_ptr<Core::ML::IMLModel>&) {
+        if (method == Core::ML::ImportanceMethod::SplitGain) {
+            *report = Core::ML::FeatureImportance::splitGain(*model);
+        } else {
+            *report = Core::ML::FeatureImportance::permutation(*model, *features, *labels, options);
+        }
+        Core::ML::TrainingResult result{};
+        result.success = report->success;
+        result.errorMessage = report->errorMessage;
+        return result;
+    };
+    
+    request.onFinished = [this, report](const Core::ML::TrainingJobInfo& info,
+                                        const Core::ML::TrainingResult&,
+                                        std::shared_ptr<Core::ML::IMLModel>) {
+        QMetaObject::invokeMethod(this, [this, report, info]() {
+            m_importanceJobId = 0;
+            m_importanceButton->setEnabled(true);
+            
+            if (info.status == Core::ML::TrainingJobStatus::Completed) {
+                updateFeatureImportance(*report);
+                m_statusLabel->setText(tr("Feature importance computed in %1 seconds").arg(report->totalSeconds, 0, 'f', 2));
+                m_resultsTabWidget->setCurrentIndex(1);
+            } else if (info.status == Core::ML::TrainingJobStatus::Cancelled) {
+                m_statusLabel->setText(tr("Feature importance cancelled"));
+            } else {
+                QString message = QString::fromStdString(info.errorLog);
+                m_statusLabel->setText(tr("Feature importance failed"));
+                QMessageBox::critical(this, tr("Error"), tr("Feature importance failed: %1").arg(message));
+            }
+        }, Qt::QueuedConnection);
+    };
+    
+    m_importanceJobId = Core::ML::TrainingJobManager::instance().submit(std::move(request), std::move(body));
+    m_importanceButton->setEnabled(false);
+    m_statusLabel->setText(tr("Computing feature importance..."));
 }
 
 void MLAnalysisWidget::evaluateModel()
@@ -1096,6 +1284,53 @@ void MLAnalysisWidget::updateEvaluationResults(const QMap<QString, QVariant>& me
     }
 }
 
+void MLAnalysisWidget::updateFeatureImportance(const Core::ML::ImportanceReport& report)
+{
+    // 特征名称取当前勾选的特征（与训练时的特征顺序一致）
+    QStringList names;
+    for (int row = 0; row < m_featureTable->rowCount(); ++row) {
+        QCheckBox* checkBox = qobject_cast<QCheckBox*>(m_featureTable->cellWidget(row, 2));
+        if (checkBox && checkBox->isChecked()) {
+            names << m_featureTable->item(row, 0)->text();
+        }
+    }
+    
+    // 按重要性从高到低列出
+    m_importanceTable->setRowCount(0);
+    for (size_t index : report.ranking()) {
+        const Core::ML::FeatureImportanceResult& result = report.features[index];
+        int row = m_importanceTable->rowCount();
+        m_importanceTable->insertRow(row);
+        
+        QString name = static_cast<size_t>(names.size()) == report.features.size()
+            ? names[static_cast<int>(result.feature)] : QString("#%1").arg(result.feature);
+        QStringList cells = {
+            name,
+            QString::number(result.importance, 'f', 4),
+            QString::number(result.stdImportance, 'f', 4),
+            QString::number(result.seconds, 'f', 3)
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[column]);
+            item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+            m_importanceTable->setItem(row, column, item);
+        }
+    }
+    
+    if (report.method == Core::ML::ImportanceMethod::Permutation) {
+        m_importanceTimingLabel->setText(tr("Permutation importance: baseline score %1, %2 samples x %3 repeats, "
+                                            "%4 concurrent; baseline %5 s, total %6 s")
+            .arg(report.baselineScore, 0, 'f', 4)
+            .arg(report.samples)
+            .arg(report.repeats)
+            .arg(report.concurrency)
+            .arg(report.baselineSeconds, 0, 'f', 3)
+            .arg(report.totalSeconds, 0, 'f', 3));
+    } else {
+        m_importanceTimingLabel->setText(tr("Split-gain importance (fraction of total gain)"));
+    }
+}
+
 void MLAnalysisWidget::updatePredictionResults(const QVariantList& predictions)
 {
     // 清空表格
@@ -25,6 +25,8 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 // 前向声明
 namespace BondForge {
@@ -35,6 +37,9 @@ namespace BondForge {
         namespace ML {
             class MLModels;
             class StatisticalAnalysis;
+            class IMLModel;
+            class Matrix;
+            struct ImportanceReport;
         }
     }
 }
@@ -49,6 +54,11 @@ class MLAnalysisWidget : public QWidget
 public:
     explicit MLAnalysisWidget(std::shared_ptr<Core::Data::DataService> dataService, QWidget *parent = nullptr);
     ~MLAnalysisWidget();
+    
+    /**
+     * @brief 设置留出的测试集（置换重要性在其上评分，应与训练集不重叠）
+     */
+    void setHeldOutData(Core::ML::Matrix features, std::vector<double> labels);
 
 protected:
     void showEvent(QShowEvent *event) override;
@@ -108,6 +118,9 @@ private:
     void loadAvailableFeatures();
     void loadFeaturePreview();
     void trainModel();
+    void cancelTraining();
+    void computeFeatureImportance();
+    void updateFeatureImportance(const Core::ML::ImportanceReport& report);
     void saveModel();
     void loadModel();
     void testModel();
@@ -168,6 +181,7 @@ private:
     QComboBox* m_optimizerCombo;
     QComboBox* m_lossFunctionCombo;
     QPushButton* m_trainModelButton;
+    QPushButton* m_cancelTrainingButton;
     QPushButton* m_saveModelButton;
     QPushButton* m_loadModelButton;
     QPushButton* m_testModelButton;
@@ -233,6 +247,13 @@ private:
     QString m_currentModelPath;
     QString m_selectedDataSet;
     QStringList m_selectedFeatures;
+    uint64_t m_trainingJobId = 0;       // 运行中的训练任务（0表示没有）
+    uint64_t m_importanceJobId = 0;     // 运行中的特征重要性任务（0表示没有）
+    
+    // 当前模型和留出的测试集（后台任务持有共享引用，替换时不影响正在进行的计算）
+    std::shared_ptr<Core::ML::IMLModel> m_currentModel;
+    std::shared_ptr<const Core::ML::Matrix> m_testFeatures;
+    std::shared_ptr<const std::vector<double>> m_testLabels;
 };
 
 } // namespace UI
@@ -1,5 +1,8 @@
 #include "VisualizationWidget.h"
 #include "core/chemistry/MoleculeRenderer.h"
+#include "core/chemistry/MoleculeView3D.h"
+#include "core/data/DataService.h"
+#include "core/ml/Decomposition.h"
 #include "utils/Logger.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -21,17 +24,33 @@
 #include <QWebEngineView>
 #include <QWebEngineSettings>
 #include <QWebChannel>
-#include <QOpenGLWidget>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
+#include <QTimer>
+#include <QImage>
+#include <QtConcurrent>
+#include <QScatter3DSeries>
+#include <QScatterDataProxy>
+#include <QValue3DAxis>
 
 namespace UI {
 
-VisualizationWidget::VisualizationWidget(QWidget *parent)
+VisualizationWidget::VisualizationWidget(std::shared_ptr<Core::Data::DataService> dataService, QWidget *parent)
     : QWidget(parent)
+    , m_rotationSlider(nullptr)
+    , m_moleculeView(nullptr)
+    , m_moleculeScene(nullptr)
+    , m_chartTypeCombo(nullptr)
+    , m_chartView(nullptr)
+    , m_currentChart(nullptr)
+    , m_chartStack(nullptr)
+    , m_scatter3D(nullptr)
+    , m_scatter3DContainer(nullptr)
+    , m_projectionWatcher(nullptr)
+    , m_dataService(std::move(dataService))
     , m_moleculeRenderer(nullptr)
+    , m_backgroundColor(Qt::white)
     , m_2dView(nullptr)
-    , m_3dView(nullptr)
     , m_webView(nullptr)
     , m_propertiesWidget(nullptr)
     , m_renderingOptionsWidget(nullptr)
@@ -139,6 +158,7 @@ void VisualizationWidget::setupToolBar(QToolBar* toolBar)
     m_zoomSlider->setValue(100);
     m_zoomSlider->setMaximumWidth(150);
     connect(m_zoomSlider, &QSlider::valueChanged, this, &VisualizationWidget::setZoomLevel);
+    connect(m_zoomSlider, &QSlider::valueChanged, this, &VisualizationWidget::onZoomChanged);
     
     QLabel* zoomLabel = new QLabel(tr("Zoom:"), this);
     toolBar->addWidget(zoomLabel);
@@ -147,6 +167,17 @@ void VisualizationWidget::setupToolBar(QToolBar* toolBar)
     m_zoomLevelLabel = new QLabel("100%", this);
     toolBar->addWidget(m_zoomLevelLabel);
     
+    // 3D视图绕竖直轴的旋转角度
+    m_rotationSlider = new QSlider(Qt::Horizontal, this);
+    m_rotationSlider->setRange(0, 359);
+    m_rotationSlider->setValue(0);
+    m_rotationSlider->setMaximumWidth(150);
+    connect(m_rotationSlider, &QSlider::valueChanged, this, &VisualizationWidget::onRotationChanged);
+    
+    QLabel* rotationLabel = new QLabel(tr("Rotation:"), this);
+    toolBar->addWidget(rotationLabel);
+    toolBar->addWidget(m_rotationSlider);
+    
     toolBar->addSeparator();
     
     // 渲染控制
@@ -173,9 +204,11 @@ void VisualizationWidget::setupViews()
     
     m_viewTabWidget->addTab(m_2dView, tr("2D View"));
     
-    // 3D视图 - 基于QOpenGLWidget的3D分子渲染
-    m_3dView = new QOpenGLWidget(this);
-    m_viewTabWidget->addTab(m_3dView, tr("3D View"));
+    // 3D视图 - 软件3D视图把整个分子绘制为场景中的一张图片
+    m_moleculeScene = new QGraphicsScene(this);
+    m_moleculeView = new QGraphicsView(m_moleculeScene, this);
+    m_moleculeView->setAlignment(Qt::AlignCenter);
+    m_viewTabWidget->addTab(m_moleculeView, tr("3D View"));
     
     // Web视图 - 基于QWebEngineView的WebGL分子渲染
     m_webView = new QWebEngineView(this);
@@ -183,10 +216,43 @@ void VisualizationWidget::setupViews()
     m_webView->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
     m_viewTabWidget->addTab(m_webView, tr("Web View"));
     
+    // 图表 - 分子描述符的主成分散点图
+    setupDataChartsTab();
+    
     // 设置当前视图为2D视图
     m_currentViewType = View2D;
 }
 
+void VisualizationWidget::setupDataChartsTab()
+{
+    m_chartTab = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(m_chartTab);
+    
+    m_chartTypeCombo = new QComboBox(m_chartTab);
+    m_chartTypeCombo->addItem(tr("PCA Scatter (2D)"), "scatter_2d");
+    m_chartTypeCombo->addItem(tr("PCA Scatter (3D)"), "scatter_3d");
+    connect(m_chartTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this]() { onChartTypeChanged(m_chartTypeCombo->currentData().toString()); });
+    layout->addWidget(m_chartTypeCombo);
+    
+    // 2D图表和3D散点图叠放，按投影的维数切换
+    m_chartStack = new QStackedWidget(m_chartTab);
+    m_chartView = new QChartView(m_chartStack);
+    m_chartView->setRenderHint(QPainter::Antialiasing);
+    m_chartStack->addWidget(m_chartView);
+    
+    m_scatter3D = new Q3DScatter();
+    m_scatter3DContainer = QWidget::createWindowContainer(m_scatter3D, m_chartStack);
+    m_chartStack->addWidget(m_scatter3DContainer);
+    layout->addWidget(m_chartStack);
+    
+    // 投影在后台线程上计算，完成后回到界面线程绘制
+    m_projectionWatcher = new QFutureWatcher<std::shared_ptr<const Core::ML::Projection>>(this);
+    connect(m_projectionWatcher, &QFutureWatcherBase::finished, this, &VisualizationWidget::onScatterProjectionReady);
+    
+    m_viewTabWidget->addTab(m_chartTab, tr("Charts"));
+}
+
 void VisualizationWidget::setupPropertiesPanel()
 {
     m_propertiesWidget = new QGroupBox(tr("Molecule Properties"), this);
@@ -316,9 +382,15 @@ void VisualizationWidget::setupConnections()
                     case 0: m_currentViewType = View2D; break;
                     case 1: m_currentViewType = View3D; break;
                     case 2: m_currentViewType = ViewWeb; break;
+                    case 3:
+                        // 图表标签页不显示分子；投影有缓存，每次切换过来都按当前数据重新生成
+                        onChartTypeChanged(m_chartTypeCombo->currentData().toString());
+                        return;
                 }
                 
-                if (m_currentMolecule) {
+                if (m_currentViewType == View3D && loadMoleculeView3D()) {
+                    refreshMoleculeView3D();
+                } else if (m_currentMolecule) {
                     updateView();
                 }
             });
@@ -475,15 +547,17 @@ void VisualizationWidget::render3DView(const Core::Chemistry::RenderingOptions&
         return;
     }
     
-    // 3D渲染实现
-    // 在实际实现中，这里应该使用OpenGL渲染3D分子结构
-    // 这里我们留空，只是显示一个占位符
-    if (!m_3dView->isValid()) {
-        m_3dView->makeCurrent();
+    // 选中的记录带坐标时由软件3D视图绘制，否则回退到渲染器的3D模式
+    if (loadMoleculeView3D()) {
+        refreshMoleculeView3D();
+        return;
     }
     
-    // 发送更新信号触发重绘
-    m_3dView->update();
+    m_moleculeScene->clear();
+    m_moleculePixmapItem = nullptr;
+    if (m_moleculeRenderer->renderToGraphicsScene(m_currentMolecule, m_moleculeScene, options)) {
+        m_moleculeView->fitInView(m_moleculeScene->sceneRect(), Qt::KeepAspectRatio);
+    }
 }
 
 void VisualizationWidget::renderWebView(const Core::Chemistry::RenderingOptions& options)
@@ -607,8 +681,9 @@ void VisualizationWidget::clearView()
         m_2dScene->clear();
     }
     
-    if (m_currentViewType == View3D && m_3dView) {
-        // 清除3D视图
+    if (m_currentViewType == View3D && m_moleculeScene) {
+        m_moleculeScene->clear();
+        m_moleculePixmapItem = nullptr;
     }
     
     if (m_currentViewType == ViewWeb && m_webView) {
@@ -658,6 +733,232 @@ void VisualizationWidget::setZoomLevel(int level)
     // 3D视图和Web视图的缩放可以通过相机控制实现
 }
 
+void VisualizationWidget::onMoleculeSelected(const QString &recordId)
+{
+    if (recordId == m_selectedMoleculeId) {
+        return;
+    }
+    
+    m_selectedMoleculeId = recordId;
+    if (m_currentViewType != View3D) {
+        return;
+    }
+    
+    if (loadMoleculeView3D()) {
+        refreshMoleculeView3D();
+    } else {
+        // 没有坐标的记录不保留上一个分子的图片
+        m_moleculeScene->clear();
+        m_moleculePixmapItem = nullptr;
+    }
+}
+
+void VisualizationWidget::onZoomChanged(int value)
+{
+    if (m_currentViewType != View3D || !loadMoleculeView3D()) {
+        return;
+    }
+    
+    // 缩放不改变深度顺序，视图只重新光栅化
+    m_moleculeView3D->setZoom(value / 100.0f);
+    refreshMoleculeView3D();
+}
+
+void VisualizationWidget::onRotationChanged(int value)
+{
+    if (m_currentViewType != View3D || !loadMoleculeView3D()) {
+        return;
+    }
+    
+    // 拖动滑块期间降低细节层次，松开后补画一帧完整细节
+    bool dragging = m_rotationSlider->isSliderDown();
+    m_moleculeView3D->setInteractive(dragging);
+    m_moleculeView3D->setRotation(static_cast<float>(value), 20.0f);
+    refreshMoleculeView3D();
+    
+    if (dragging) {
+        QTimer::singleShot(150, this, [this]() {
+            if (m_moleculeView3D && !m_rotationSlider->isSliderDown()) {
+                m_moleculeView3D->setInteractive(false);
+                refreshMoleculeView3D();
+            }
+        });
+    }
+}
+
+bool VisualizationWidget::loadMoleculeView3D()
+{
+    if (m_selectedMoleculeId.isEmpty() || !m_dataService) {
+        return false;
+    }
+    
+    if (m_moleculeView3D && m_view3DRecordId == m_selectedMoleculeId) {
+        return !m_moleculeView3D->isEmpty();
+    }
+    
+    auto record = m_dataService->getData(m_selectedMoleculeId.toStdString());
+    if (!record) {
+        return false;
+    }
+    
+    Core::Chemistry::MolecularGraph graph;
+    if (!Core::Chemistry::MoleculeParser::parse(record->content, record->format, graph)) {
+        return false;
+    }
+    
+    m_moleculeView3D = std::make_unique<Core::Chemistry::MoleculeView3D>();
+    m_view3DRecordId = m_selectedMoleculeId;
+    m_moleculePixmapItem = nullptr;
+    if (!m_moleculeView3D->setMolecule(graph)) {
+        return false;   // 没有坐标，保持原有渲染
+    }
+    
+    m_moleculeView3D->setBackground(m_backgroundColor.rgba());
+    m_moleculeView3D->setZoom(m_zoomSlider->value() / 100.0f);
+    m_moleculeView3D->setRotation(static_cast<float>(m_rotationSlider->value()), 20.0f);
+    return true;
+}
+
+void VisualizationWidget::refreshMoleculeView3D()
+{
+    QSize viewportSize = m_moleculeView->viewport()->size();
+    m_moleculeView3D->setViewport(viewportSize.width(), viewportSize.height());
+    
+    const uint32_t* pixels = m_moleculeView3D->render();
+    QImage image(reinterpret_cast<const uchar*>(pixels), m_moleculeView3D->width(), m_moleculeView3D->height(),
+                 m_moleculeView3D->width() * 4, QImage::Format_ARGB32_Premultiplied);
+    QPixmap pixmap = QPixmap::fromImage(image);
+    
+    // 复用同一个图元，不重建场景（清空 m_moleculeScene 的地方都会把图元指针置空，之后在这里重新创建）
+    if (!m_moleculePixmapItem) {
+        m_moleculeScene->clear();
+        m_moleculePixmapItem = m_moleculeScene->addPixmap(pixmap);
+        m_moleculeView->resetTransform();   // 图片已按视口大小绘制，不再缩放
+    } else {
+        m_moleculePixmapItem->setPixmap(pixmap);
+    }
+    m_moleculeScene->setSceneRect(m_moleculePixmapItem->boundingRect());
+}
+
+void VisualizationWidget::onChartTypeChanged(const QString &type)
+{
+    if (type == "scatter_2d" || type == "scatter_3d") {
+        generateScatterChart();
+    }
+}
+
+void VisualizationWidget::generateScatterChart()
+{
+    if (!m_dataService || !m_projectionWatcher) {
+        return;
+    }
+    
+    // 分子描述符的前两个或三个主成分；投影按数据版本缓存，切换图表时不重新拟合
+    Core::ML::FeatureRequest request;
+    request.featureType = "molecular_descriptors";
+    request.labelType = "category";
+    request.scaling = Core::ML::FeatureScaling::Standard;
+    
+    Core::ML::RandomizedSvdOptions options;
+    options.components = m_chartTypeCombo->currentData().toString() == "scatter_3d" ? 3 : 2;
+    
+    // 未缓存时要提取特征并拟合，放到后台线程上；新的请求替换正在等待的结果（旧的计算照常完成并进入缓存）
+    std::shared_ptr<Core::Data::DataService> dataService = m_dataService;
+    m_projectionWatcher->setFuture(QtConcurrent::run([dataService, request, options]() {
+        return Core::ML::ProjectionCache::instance().getProjection(*dataService, request, options);
+    }));
+    m_statusLabel->setText(tr("Projecting descriptor data..."));
+}
+
+void VisualizationWidget::onScatterProjectionReady()
+{
+    std::shared_ptr<const Core::ML::Projection> projection = m_projectionWatcher->result();
+    if (!projection || projection->coordinates.rows() == 0) {
+        m_statusLabel->setText(tr("No descriptor data to project"));
+        return;
+    }
+    
+    const Core::ML::Matrix& coordinates = projection->coordinates;
+    size_t rows = coordinates.rows();
+    size_t components = std::min<size_t>(coordinates.cols(), 3);
+    
+    // 每个类别一个系列；记录很多时等间隔抽样，散点图只需要显示分布
+    const size_t maxPoints = 20000;
+    size_t step = (rows + maxPoints - 1) / maxPoints;
+    std::map<double, std::vector<size_t>> rowsByLabel;
+    for (size_t i = 0; i < rows; i += step) {
+        rowsByLabel[i < projection->labels.size() ? projection->labels[i] : 0.0].push_back(i);
+    }
+    
+    const std::vector<double>& ratios = projection->pca.explainedVarianceRatio();
+    auto axisTitle = [&ratios](size_t component) {
+        if (component >= ratios.size()) {
+            return tr("PC%1").arg(component + 1);
+        }
+        return tr("PC%1 (%2%)").arg(component + 1).arg(ratios[component] * 100.0, 0, 'f', 1);
+    };
+    
+    if (components == 3) {
+        // 三个主成分依次对应X、Y（竖直）、Z轴
+        for (QScatter3DSeries* series : m_scatter3D->seriesList()) {
+            m_scatter3D->removeSeries(series);
+            delete series;
+        }
+        for (const auto& [label, indices] : rowsByLabel) {
+            QScatterDataArray* points = new QScatterDataArray();
+            points->reserve(static_cast<int>(indices.size()));
+            for (size_t i : indices) {
+                points->append(QScatterDataItem(QVector3D(coordinates(i, 0), coordinates(i, 1), coordinates(i, 2))));
+            }
+            QScatter3DSeries* series = new QScatter3DSeries();
+            series->setName(tr("Category %1").arg(label));
+            series->setItemSize(0.05f);
+            series->dataProxy()->resetArray(points);
+            m_scatter3D->addSeries(series);
+        }
+        QValue3DAxis* axes[] = {m_scatter3D->axisX(), m_scatter3D->axisY(), m_scatter3D->axisZ()};
+        for (size_t k = 0; k < 3; ++k) {
+            axes[k]->setTitle(axisTitle(k));
+            axes[k]->setTitleVisible(true);
+        }
+        m_chartStack->setCurrentWidget(m_scatter3DContainer);
+    } else {
+        QChart* chart = new QChart();
+        chart->setTitle(tr("Descriptor PCA"));
+        for (const auto& [label, indices] : rowsByLabel) {
+            QList<QPointF> points;
+            points.reserve(static_cast<int>(indices.size()));
+            for (size_t i : indices) {
+                points.append(QPointF(coordinates(i, 0), components > 1 ? coordinates(i, 1) : 0.0));
+            }
+            QScatterSeries* series = new QScatterSeries();
+            series->setName(tr("Category %1").arg(label));
+            series->setMarkerSize(6.0);
+            series->replace(points);
+            chart->addSeries(series);
+        }
+        chart->createDefaultAxes();
+        
+        QList<QAbstractAxis*> horizontalAxes = chart->axes(Qt::Horizontal);
+        QList<QAbstractAxis*> verticalAxes = chart->axes(Qt::Vertical);
+        if (!horizontalAxes.isEmpty()) {
+            horizontalAxes.first()->setTitleText(axisTitle(0));
+        }
+        if (!verticalAxes.isEmpty() && components > 1) {
+            verticalAxes.first()->setTitleText(axisTitle(1));
+        }
+        
+        // QChartView 不删除被替换的图表
+        m_chartView->setChart(chart);
+        delete m_currentChart;
+        m_currentChart = chart;
+        m_chartStack->setCurrentWidget(m_chartView);
+    }
+    
+    m_statusLabel->setText(tr("Projected %1 records (%2 shown, fitted in %3 s)")
+                           .arg(rows).arg((rows + step - 1) / step).arg(projection->fitSeconds, 0, 'f', 2));
+}
+
 void VisualizationWidget::updateView()
 {
     renderMolecule();
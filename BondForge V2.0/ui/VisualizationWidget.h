@@ -6,6 +6,7 @@
 #include <QTabWidget>
 #include <QGraphicsView>
 #include <QGraphicsScene>
+#include <QGraphicsPixmapItem>
 #include <QTableView>
 #include <QPushButton>
 #include <QComboBox>
@@ -33,6 +34,9 @@
 #include <QValueAxis>
 #include <QCategoryAxis>
 #include <QLegend>
+#include <QStackedWidget>
+#include <QFutureWatcher>
+#include <Q3DScatter>
 #include <memory>
 
 // QT_CHARTS_USE_NAMESPACE
@@ -46,6 +50,10 @@ namespace BondForge {
         }
         namespace Chemistry {
             class MoleculeRenderer;
+            class MoleculeView3D;
+        }
+        namespace ML {
+            struct Projection;
         }
     }
 }
@@ -87,6 +95,7 @@ private slots:
     void onChartRefreshClicked();
     void onChartExportClicked();
     void onChartAnimationToggled(bool enabled);
+    void onScatterProjectionReady();
     
     // 趋势分析
     void onTrendTimeRangeChanged(const QString &range);
@@ -124,6 +133,8 @@ private:
     void renderMolecule(const QString &recordId);
     void updateMoleculeControls();
     void exportMolecule(const QString &filePath);
+    bool loadMoleculeView3D();
+    void refreshMoleculeView3D();
     
     // 数据图表
     void updateChartData();
@@ -179,6 +190,11 @@ private:
     QGraphicsView* m_moleculeView;
     QGraphicsScene* m_moleculeScene;
     
+    // 软件3D视图：整个分子绘制为一个图元，旋转/缩放时只更新这张图片
+    std::unique_ptr<Core::Chemistry::MoleculeView3D> m_moleculeView3D;
+    QGraphicsPixmapItem* m_moleculePixmapItem = nullptr;    // 属于 m_moleculeScene，清空该场景时必须置空
+    QString m_view3DRecordId;
+    
     // 数据图表标签页
     QWidget* m_chartTab;
     QWidget* m_chartControlPanel;
@@ -192,6 +208,12 @@ private:
     QChartView* m_chartView;
     QChart* m_currentChart;
     
+    // 主成分散点图：2D时显示在 m_chartView 中，3D时显示在 m_scatter3D 中
+    QStackedWidget* m_chartStack;
+    Q3DScatter* m_scatter3D;
+    QWidget* m_scatter3DContainer;
+    QFutureWatcher<std::shared_ptr<const Core::ML::Projection>>* m_projectionWatcher;
+    
     // 趋势分析标签页
     QWidget* m_trendTab;
     QWidget* m_trendControlPanel;
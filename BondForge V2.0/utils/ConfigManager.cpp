@@ -333,6 +333,7 @@ void ConfigManager::initializeDefaultConfig() {
     registerConfigItem({"ml.default_algorithm", std::string("linear_regression"), "Default ML algorithm", "ml", true, false});
     registerConfigItem({"ml.use_gpu", false, "Use GPU for ML computations", "ml", true, false});
     registerConfigItem({"ml.model_dir", std::string("./models"), "Directory to save ML models", "ml", true, false});
+    registerConfigItem({"ml.max_training_time", 3600, "Maximum training time per job in seconds (0 = unlimited)", "ml", true, false});
     
     // 协作设置
     registerConfigItem({"collab.auto_refresh", true, "Auto-refresh shared data", "collaboration", true, false});
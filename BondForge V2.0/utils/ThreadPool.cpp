@@ -0,0 +1,169 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+
+namespace BondForge {
+namespace Utils {
+
+namespace {
+
+/**
+ * @brief parallelFor 的共享状态
+ * 
+ * 由调用线程和辅助任务共同持有，辅助任务即使在调用返回后才被调度也能安全退出。
+ */
+struct ParallelForState {
+    size_t begin = 0;
+    size_t end = 0;
+    size_t grainSize = 1;
+    size_t blockCount = 0;
+    const std::function<void(size_t, size_t)>* body = nullptr;
+    
+    std::atomic<size_t> nextBlock{0};
+    std::atomic<size_t> finishedBlocks{0};
+    
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+    
+    /**
+     * @brief 领取并执行剩余的块，直到没有可领取的块
+     */
+    void drain() {
+        while (true) {
+            size_t block = nextBlock.fetch_add(1);
+            if (block >= blockCount) {
+                return;
+            }
+            
+            size_t blockBegin = begin + block * grainSize;
+            size_t blockEnd = std::min(end, blockBegin + grainSize);
+            
+            try {
+                (*body)(blockBegin, blockEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            
+            if (finishedBlocks.fetch_add(1) + 1 == blockCount) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_stopping(false) {
+    
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            
+            if (m_stopping && m_tasks.empty()) {
+                return;
+            }
+            
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize,
+                             const std::function<void(size_t, size_t)>& body) {
+    if (begin >= end) {
+        return;
+    }
+    
+    size_t count = end - begin;
+    size_t participants = m_workers.size() + 1;
+    
+    if (grainSize == 0) {
+        // 每个参与线程约分到4块，兼顾负载均衡与调度开销
+        grainSize = std::max<size_t>(1, count / (participants * 4));
+    }
+    
+    size_t blockCount = (count + grainSize - 1) / grainSize;
+    if (blockCount == 1) {
+        body(begin, end);
+        return;
+    }
+    
+    auto state = std::make_shared<ParallelForState>();
+    state->begin = begin;
+    state->end = end;
+    state->grainSize = grainSize;
+    state->blockCount = blockCount;
+    state->body = &body;
+    
+    // 调用线程自身也会执行，因此辅助任务数最多为块数-1
+    size_t helpers = std::min(m_workers.size(), blockCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue([state]() { state->drain(); });
+    }
+    
+    state->drain();
+    
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state]() {
+            return state->finishedBlocks.load() == state->blockCount;
+        });
+    }
+    
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace Utils
+} // namespace BondForge
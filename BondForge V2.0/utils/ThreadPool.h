@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+
+namespace BondForge {
+namespace Utils {
+
+/**
+ * @brief 固定大小的工作线程池
+ * 
+ * 供计算密集型模块（描述符计算、模型训练等）共享，避免各模块各自创建线程。
+ * parallelFor 的调用线程会参与执行分块，因此在工作线程内嵌套调用也不会死锁。
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief 构造线程池
+     * 
+     * @param threadCount 工作线程数（0表示使用硬件并发数）
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * @brief 获取全局共享线程池
+     * 
+     * @return 线程池实例
+     */
+    static ThreadPool& instance();
+    
+    /**
+     * @brief 获取工作线程数
+     * 
+     * @return 线程数
+     */
+    size_t threadCount() const { return m_workers.size(); }
+    
+    /**
+     * @brief 提交任务
+     * 
+     * @param task 任务函数
+     * @return 任务结果的future
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using ResultType = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(task));
+        std::future<ResultType> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+    
+    /**
+     * @brief 并行执行区间 [begin, end)
+     * 
+     * 区间按 grainSize 切分为若干块，body(blockBegin, blockEnd) 在工作线程和调用线程上执行。
+     * 任一块抛出的第一个异常会在所有块结束后重新抛出。
+     * 
+     * @param begin 起始下标
+     * @param end 结束下标（不含）
+     * @param grainSize 每块的最小元素数（0表示自动选择）
+     * @param body 块处理函数
+     */
+    void parallelFor(size_t begin, size_t end, size_t grainSize,
+                     const std::function<void(size_t, size_t)>& body);
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+    
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+};
+
+} // namespace Utils
+} // namespace BondForge